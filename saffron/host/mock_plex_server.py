@@ -0,0 +1,509 @@
+#!/usr/bin/env python3
+"""Local stand-in for a Plex Media Server, for driving the host build.
+
+Responses come from recorded JSON fixtures when one matches the request
+path, otherwise from a synthetic library generated from a seed, so large
+libraries can be served without recording one. Every response can be
+delayed and throttled to imitate a slow or distant server.
+
+    python3 mock_plex_server.py --port 32400 --items 50000 \
+        --latency-ms 80 --bandwidth-kbps 20000
+
+Fixtures live under --fixtures, named after the request path with '/'
+replaced by '_' (e.g. library_sections_1_all.json for
+/library/sections/1/all). Query strings are ignored when matching, except
+that paged endpoints are sliced by X-Plex-Container-Start/Size.
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import random
+import re
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, urlparse
+
+GENRES = ["Action", "Comedy", "Drama", "Documentary", "Horror", "Animation", "Thriller", "Romance"]
+RESOLUTIONS = [("4k", 3840, 2160, 40000), ("1080", 1920, 1080, 12000), ("720", 1280, 720, 5000)]
+
+
+class Library:
+    """Deterministic synthetic library: the same seed gives the same items."""
+
+    def __init__(self, sections, items, episodes, seed, part_size):
+        self.sections = sections
+        self.part_size = part_size  # bytes served for a synthetic media part
+        self.items = items
+        self.episodes = episodes
+        self.seed = seed
+        self.created = int(time.time()) - 365 * 86400
+
+    # Rating keys: section s holds keys s*10^7 + 1 .. s*10^7 + items;
+    # a show's episodes are key*100 + 1 .. key*100 + episodes
+    def section_type(self, section):
+        return "movie" if section % 2 == 1 else "show"
+
+    def section_of(self, key):
+        return key // 10_000_000
+
+    def section(self, section):
+        return {
+            "key": str(section),
+            "uuid": hashlib.md5(f"section{section}".encode()).hexdigest(),
+            "type": self.section_type(section),
+            "title": f"{'Movies' if self.section_type(section) == 'movie' else 'TV Shows'} {section}",
+            "thumb": f"/library/sections/{section}/thumb",
+            "art": f"/library/sections/{section}/art",
+            "allowSync": True,
+            "updatedAt": self.created + section,
+            "scannedAt": self.created + section,
+        }
+
+    def media(self, key, duration):
+        rng = random.Random(self.seed * 7919 + key)
+        res, width, height, bitrate = rng.choice(RESOLUTIONS)
+        codec = rng.choice(["h264", "hevc"])
+        return [{
+            "id": key,
+            "duration": duration,
+            "bitrate": bitrate,
+            "width": width,
+            "height": height,
+            "aspectRatio": 1.78,
+            "audioChannels": 6,
+            "audioCodec": "eac3",
+            "videoCodec": codec,
+            "videoResolution": res,
+            "container": "mkv",
+            "videoFrameRate": "24p",
+            "Part": [{
+                "id": key,
+                "key": f"/library/parts/{key}/file.mkv",
+                "duration": duration,
+                "file": f"/media/{key}.mkv",
+                "size": self.part_size,
+                "container": "mkv",
+                "Stream": [
+                    {"id": key * 10 + 1, "streamType": 1, "codec": codec, "index": 0,
+                     "bitrate": bitrate, "width": width, "height": height, "frameRate": 23.976,
+                     "displayTitle": f"{res.upper()} ({codec.upper()})", "default": True, "selected": True},
+                    {"id": key * 10 + 2, "streamType": 2, "codec": "eac3", "index": 1, "channels": 6,
+                     "language": "English", "languageCode": "eng", "displayTitle": "English (EAC3 5.1)",
+                     "default": True, "selected": True},
+                    {"id": key * 10 + 3, "streamType": 3, "codec": "srt", "index": 2,
+                     "language": "English", "languageCode": "eng", "displayTitle": "English (SRT)"},
+                ],
+            }],
+        }]
+
+    def item(self, key, detailed=False):
+        section = self.section_of(key)
+        index = key % 10_000_000
+        rng = random.Random(self.seed * 104729 + key)
+        kind = self.section_type(section)
+        meta = {
+            "ratingKey": str(key),
+            "key": f"/library/metadata/{key}" + ("/children" if kind == "show" else ""),
+            "guid": f"plex://{kind}/{hashlib.md5(str(key).encode()).hexdigest()[:24]}",
+            "type": kind,
+            "title": f"Synthetic {kind.title()} {index}",
+            "titleSort": f"Synthetic {kind.title()} {index:08d}",
+            "summary": " ".join(rng.choice(["A", "The", "quiet", "story", "of", "loss", "and", "return"])
+                               for _ in range(40 if detailed else 12)),
+            "thumb": f"/library/metadata/{key}/thumb/{self.created}",
+            "art": f"/library/metadata/{key}/art/{self.created}",
+            "year": 1970 + rng.randrange(55),
+            "contentRating": rng.choice(["G", "PG", "PG-13", "R"]),
+            "rating": round(rng.uniform(3, 10), 1),
+            "audienceRating": round(rng.uniform(3, 10), 1),
+            "addedAt": self.created + index * 60,
+            "updatedAt": self.created + index * 60,
+            "librarySectionID": section,
+            "Genre": [{"tag": g} for g in rng.sample(GENRES, 2)],
+        }
+        if kind == "movie":
+            meta["duration"] = rng.randrange(80, 180) * 60_000
+            meta["Media"] = self.media(key, meta["duration"])
+        else:
+            meta["leafCount"] = self.episodes
+            meta["viewedLeafCount"] = 0
+            meta["childCount"] = 1
+        if detailed:
+            meta["tagline"] = "Generated for load testing"
+            meta["studio"] = "Mock Studios"
+            meta["Director"] = [{"id": 900000 + key % 500, "tag": f"Director {key % 500}"}]
+            meta["Role"] = [{"id": 800000 + (key + i) % 5000, "tag": f"Actor {(key + i) % 5000}",
+                             "role": f"Character {i}", "thumb": f"/people/{(key + i) % 5000}.jpg"}
+                            for i in range(12)]
+        return meta
+
+    def episode(self, show, number):
+        key = show * 100 + number
+        duration = 42 * 60_000
+        return {
+            "ratingKey": str(key),
+            "key": f"/library/metadata/{key}",
+            "type": "episode",
+            "title": f"Episode {number}",
+            "index": number,
+            "parentIndex": 1,
+            "parentRatingKey": str(show * 100),
+            "grandparentRatingKey": str(show),
+            "grandparentTitle": f"Synthetic Show {show % 10_000_000}",
+            "thumb": f"/library/metadata/{key}/thumb/{self.created}",
+            "duration": duration,
+            "addedAt": self.created,
+            "librarySectionID": self.section_of(show),
+            "Media": self.media(key, duration),
+        }
+
+    def lookup(self, key):
+        """Metadata for any key this library hands out, None if unknown."""
+        section = self.section_of(key)
+        if 1 <= section <= self.sections and 1 <= key % 10_000_000 <= self.items:
+            return self.item(key, detailed=True)
+        show, number = divmod(key, 100)
+        if 1 <= number <= self.episodes and self.section_of(show) in range(1, self.sections + 1):
+            return self.episode(show, number)
+        return None
+
+    def keys(self, section):
+        base = section * 10_000_000
+        return range(base + 1, base + self.items + 1)
+
+
+def container(**fields):
+    return {"MediaContainer": fields}
+
+
+# Date filters as the spec's filter section defines them: the operator's
+# non-'=' characters end the (decoded) query key, e.g. "updatedAt>>" for
+# updatedAt>>=. Values are epoch seconds, or relative to now as +N/-N with
+# an optional unit.
+DATE_FIELDS = ("addedAt", "updatedAt")
+DATE_OPERATORS = {
+    "": lambda a, b: a == b,
+    "!": lambda a, b: a != b,
+    ">>": lambda a, b: a > b,
+    "<<": lambda a, b: a < b,
+}
+DATE_UNITS = {"": 1, "m": 60, "h": 3600, "d": 86400, "w": 7 * 86400, "mon": 30 * 86400, "y": 365 * 86400}
+
+
+def parse_date(value):
+    m = re.fullmatch(r"([+-]?)(\d+)(m|h|d|w|mon|y)?", value)
+    if not m:
+        raise ValueError(value)
+    amount = int(m.group(2)) * DATE_UNITS[m.group(3) or ""]
+    if not m.group(1):
+        return amount
+    return int(time.time()) + (amount if m.group(1) == "+" else -amount)
+
+
+def date_filters(query):
+    """Returns [(field, compare, value)] for the date filters in query.
+
+    Raises ValueError for an operator or value the spec does not define."""
+    filters = []
+    for key, values in query.items():
+        field = next((f for f in DATE_FIELDS if key.startswith(f)), None)
+        if field is None:
+            continue
+        op = key[len(field):]
+        if op not in DATE_OPERATORS:
+            raise ValueError(f"{key}= is not a date operator")
+        filters.append((field, DATE_OPERATORS[op], parse_date(values[0])))
+    return filters
+
+
+class MockPlex:
+    def __init__(self, args):
+        self.library = Library(args.sections, args.items, args.episodes, args.seed, args.part_mb * 1024 * 1024)
+        self.fixtures = args.fixtures
+        self.latency = args.latency_ms / 1000.0
+        self.jitter = args.jitter_ms / 1000.0
+        self.bytes_per_second = args.bandwidth_kbps * 1000 / 8 if args.bandwidth_kbps > 0 else 0
+        self.error_rate = args.error_rate
+        self.verbose = args.verbose
+        self.stats_lock = threading.Lock()
+        self.requests = 0
+        self.bytes_sent = 0
+
+    def fixture(self, path):
+        if not self.fixtures:
+            return None
+        name = path.strip("/").replace("/", "_").replace(":", "") or "root"
+        file = os.path.join(self.fixtures, name + ".json")
+        if not os.path.isfile(file):
+            return None
+        with open(file, "rb") as f:
+            return f.read()
+
+    def route(self, path, query):
+        """Returns (status, body) for a JSON endpoint, or None if unknown."""
+        lib = self.library
+        start = int(query.get("X-Plex-Container-Start", ["0"])[0])
+        size = int(query.get("X-Plex-Container-Size", [str(lib.items)])[0])
+
+        if path == "/identity":
+            return container(machineIdentifier="mock-plex", version="1.40.0.0")
+        if path == "/library/sections":
+            return container(size=lib.sections,
+                             Directory=[lib.section(s) for s in range(1, lib.sections + 1)])
+
+        m = re.fullmatch(r"/library/sections/(\d+)/(all|recentlyAdded|collections)", path)
+        if m:
+            section, kind = int(m.group(1)), m.group(2)
+            if section < 1 or section > lib.sections:
+                return 404, container(size=0)
+            keys = lib.keys(section)
+            if kind == "recentlyAdded":
+                chosen = keys[-min(50, len(keys)):][::-1]
+                return container(size=len(chosen), Metadata=[lib.item(k) for k in chosen])
+            if kind == "collections":
+                cols = [{"ratingKey": str(section * 1000 + c), "key": f"/library/collections/{section * 1000 + c}/children",
+                         "type": "collection", "title": f"Collection {c}", "childCount": 20,
+                         "addedAt": lib.created, "updatedAt": lib.created} for c in range(1, 11)]
+                return container(size=len(cols), Metadata=cols)
+            # Library sync: ratingKey-only listings and date-filtered changes
+            if query.get("includeFields") == ["ratingKey"]:
+                return container(size=len(keys), totalSize=len(keys),
+                                 Metadata=[{"ratingKey": str(k)} for k in keys])
+            try:
+                filters = date_filters(query)
+            except ValueError as e:
+                return 400, {"error": str(e)}
+            if filters:
+                # addedAt == updatedAt == created + index * 60 for synthetic items
+                matching = [k for k in keys
+                            if all(compare(lib.created + (k % 10_000_000) * 60, value)
+                                   for _, compare, value in filters)]
+                chosen = matching[start:start + size]
+                return container(size=len(chosen), totalSize=len(matching), offset=start,
+                                 Metadata=[lib.item(k) for k in chosen])
+            chosen = keys[start:start + size]
+            return container(size=len(chosen), totalSize=len(keys), offset=start,
+                             Metadata=[lib.item(k) for k in chosen])
+
+        m = re.fullmatch(r"/library/metadata/(\d+)(/children)?", path)
+        if m:
+            key = int(m.group(1))
+            if m.group(2):
+                if lib.lookup(key) is None or lib.section_type(lib.section_of(key)) != "show":
+                    return container(size=0, Metadata=[])
+                eps = [lib.episode(key, n) for n in range(1, lib.episodes + 1)]
+                return container(size=len(eps), Metadata=eps)
+            meta = lib.lookup(key)
+            if meta is None:
+                return 404, container(size=0)
+            return container(size=1, Metadata=[meta])
+
+        m = re.fullmatch(r"/library/collections/(\d+)/children", path)
+        if m:
+            section = max(1, min(lib.sections, int(m.group(1)) // 1000))
+            keys = lib.keys(section)[:20]
+            return container(size=len(keys), Metadata=[lib.item(k) for k in keys])
+
+        if path in ("/hubs", "/hubs/continueWatching", "/library/onDeck"):
+            items = [lib.item(k) for k in lib.keys(1)[:20]]
+            for i, item in enumerate(items):
+                item["viewOffset"] = (i + 1) * 60_000
+            if path == "/library/onDeck":
+                return container(size=len(items), Metadata=items)
+            hub = {"hubKey": "/hubs/continueWatching", "key": "/hubs/continueWatching",
+                   "title": "Continue Watching", "type": "mixed", "hubIdentifier": "home.continue",
+                   "size": len(items), "more": False, "Metadata": items}
+            return container(size=1, Hub=[hub])
+
+        if path == "/hubs/search":
+            term = query.get("query", [""])[0]
+            limit = int(query.get("limit", ["10"])[0])
+            items = [lib.item(k) for k in lib.keys(1)[:limit]]
+            return container(size=1, Hub=[{"title": f"Movies matching {term}", "type": "movie",
+                                           "hubIdentifier": "movie", "size": len(items), "Metadata": items}])
+
+        if path == "/playlists":
+            pls = [{"ratingKey": str(p), "key": f"/playlists/{p}/items", "type": "playlist",
+                    "title": f"Playlist {p}", "playlistType": "video", "leafCount": 25,
+                    "addedAt": lib.created, "updatedAt": lib.created} for p in range(1, 6)]
+            return container(size=len(pls), Metadata=pls)
+        m = re.fullmatch(r"/playlists/(\d+)/items", path)
+        if m:
+            keys = lib.keys(1)[:25]
+            return container(size=len(keys), Metadata=[lib.item(k) for k in keys])
+
+        m = re.fullmatch(r"/library/people/(\d+)/media", path)
+        if m:
+            keys = lib.keys(1)[:30]
+            return container(size=len(keys), Metadata=[lib.item(k) for k in keys])
+
+        if path == "/video/:/transcode/universal/decision":
+            key = int(query.get("path", ["/library/metadata/0"])[0].rsplit("/", 1)[-1] or 0)
+            meta = lib.lookup(key)
+            if meta is None:
+                return 404, container(size=0)
+            direct = query.get("directPlay", ["1"])[0] == "1"
+            return container(size=1,
+                             generalDecisionCode=1000, generalDecisionText="Direct play OK." if direct else "Transcode OK.",
+                             directPlayDecisionCode=1000 if direct else 3000,
+                             directPlayDecisionText="Direct play OK." if direct else "Direct play disabled.",
+                             transcodeDecisionCode=1001 if direct else 1000,
+                             Metadata=[meta])
+
+        if path == "/:/timeline":
+            return container(size=0)
+        return None
+
+    def binary(self, path):
+        """Size of a generated binary resource, None if the path is not one."""
+        if re.fullmatch(r"/library/parts/\d+/.*", path):
+            return self.library.part_size, "video/x-matroska"
+        if path == "/photo/:/transcode" or re.fullmatch(r"/library/(metadata|sections)/\d+/(thumb|art).*", path):
+            return 64 * 1024, "image/jpeg"
+        return None
+
+    def count(self, sent):
+        with self.stats_lock:
+            self.requests += 1
+            self.bytes_sent += sent
+
+
+def make_handler(mock):
+    class Handler(BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"
+
+        def log_message(self, fmt, *args):
+            if mock.verbose:
+                super().log_message(fmt, *args)
+
+        def delay(self):
+            wait = mock.latency + (random.uniform(-mock.jitter, mock.jitter) if mock.jitter else 0)
+            if wait > 0:
+                time.sleep(wait)
+
+        def write_throttled(self, body):
+            # Pace writes so the body arrives at the configured bandwidth
+            chunk = 16 * 1024
+            began = time.monotonic()
+            for offset in range(0, len(body), chunk):
+                self.wfile.write(body[offset:offset + chunk])
+                if mock.bytes_per_second:
+                    due = began + (offset + chunk) / mock.bytes_per_second
+                    ahead = due - time.monotonic()
+                    if ahead > 0:
+                        time.sleep(ahead)
+            mock.count(len(body))
+
+        def send_body(self, status, body, content_type, extra=None):
+            self.send_response(status)
+            self.send_header("Content-Type", content_type)
+            self.send_header("Content-Length", str(len(body)))
+            for name, value in (extra or {}).items():
+                self.send_header(name, value)
+            self.end_headers()
+            if self.command != "HEAD":
+                self.write_throttled(body)
+
+        def serve_binary(self, path, size, content_type):
+            start, end = 0, size - 1
+            status, extra = 200, {"Accept-Ranges": "bytes"}
+            match = re.fullmatch(r"bytes=(\d*)-(\d*)", self.headers.get("Range", ""))
+            if match and (match.group(1) or match.group(2)):
+                if match.group(1):
+                    start = int(match.group(1))
+                    end = min(int(match.group(2)), size - 1) if match.group(2) else size - 1
+                else:
+                    start = max(0, size - int(match.group(2)))
+                if start > end:
+                    self.send_body(416, b"", "text/plain", {"Content-Range": f"bytes */{size}"})
+                    return
+                status = 206
+                extra["Content-Range"] = f"bytes {start}-{end}/{size}"
+            # Repeatable filler so range reads can be checked against each other
+            seed = hashlib.sha256(path.encode()).digest()
+            block = (seed * (4096 // len(seed) + 1))[:4096]
+            first = start % len(block)
+            length = end - start + 1
+            body = (block[first:] + block * (length // len(block) + 2))[:length]
+            self.send_body(status, body, content_type, extra)
+
+        def handle_request(self):
+            url = urlparse(self.path)
+            query = parse_qs(url.query, keep_blank_values=True)
+            self.delay()
+
+            if mock.error_rate and random.random() < mock.error_rate:
+                self.send_body(503, b"", "text/plain")
+                return
+
+            body = mock.fixture(url.path)
+            if body is not None:
+                self.send_body(200, body, "application/json")
+                return
+
+            binary = mock.binary(url.path)
+            if binary:
+                self.serve_binary(url.path, *binary)
+                return
+
+            result = mock.route(url.path, query)
+            if result is None:
+                self.send_body(404, b"", "text/plain")
+                return
+            status, payload = result if isinstance(result, tuple) else (200, result)
+            self.send_body(status, json.dumps(payload, separators=(",", ":")).encode(), "application/json")
+
+        def do_GET(self):
+            self.handle_request()
+
+        def do_HEAD(self):
+            self.handle_request()
+
+        def do_POST(self):
+            length = int(self.headers.get("Content-Length", "0") or 0)
+            if length:
+                self.rfile.read(length)
+            self.handle_request()
+
+        def do_PUT(self):
+            self.do_POST()
+
+    return Handler
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=32400)
+    parser.add_argument("--fixtures", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "fixtures"),
+                        help="directory of recorded JSON responses, '' to disable")
+    parser.add_argument("--sections", type=int, default=2, help="synthetic sections (odd: movies, even: shows)")
+    parser.add_argument("--items", type=int, default=1000, help="synthetic items per section")
+    parser.add_argument("--episodes", type=int, default=10, help="episodes per synthetic show")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--latency-ms", type=float, default=0, help="delay before every response")
+    parser.add_argument("--jitter-ms", type=float, default=0, help="uniform +/- spread on the delay")
+    parser.add_argument("--bandwidth-kbps", type=float, default=0, help="per-connection cap, 0 for none")
+    parser.add_argument("--part-mb", type=int, default=8, help="size of a synthetic media part")
+    parser.add_argument("--error-rate", type=float, default=0, help="fraction of requests answered with 503")
+    parser.add_argument("--verbose", action="store_true", help="log every request")
+    args = parser.parse_args()
+
+    mock = MockPlex(args)
+    server = ThreadingHTTPServer((args.host, args.port), make_handler(mock))
+    server.daemon_threads = True
+    print(f"mock plex on http://{args.host}:{args.port} ({args.sections} sections x {args.items} items, "
+          f"latency {args.latency_ms} ms, bandwidth {args.bandwidth_kbps or 'unlimited'} kbps)", flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        print(f"served {mock.requests} requests, {mock.bytes_sent} bytes", flush=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,116 @@
+// Host stand-in for the parts of borealis the core uses, so the non-UI
+// code builds and runs on a desktop. Not used by the Switch build.
+#ifndef SAFFRON_HOST_BOREALIS_HPP
+#define SAFFRON_HOST_BOREALIS_HPP
+
+#include <fmt/format.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <list>
+#include <string>
+#include <utility>
+
+namespace brls {
+
+enum class LogLevel {
+    LOG_ERROR = 0,
+    LOG_WARNING,
+    LOG_INFO,
+    LOG_DEBUG,
+    LOG_VERBOSE
+};
+
+class Logger {
+public:
+    static void setLogLevel(LogLevel level) { s_level.store(level); }
+    static LogLevel getLogLevel() { return s_level.load(); }
+
+    template <typename... Args>
+    static void error(fmt::format_string<Args...> format, Args&&... args) {
+        log(LogLevel::LOG_ERROR, "ERROR", fmt::format(format, std::forward<Args>(args)...));
+    }
+
+    template <typename... Args>
+    static void warning(fmt::format_string<Args...> format, Args&&... args) {
+        log(LogLevel::LOG_WARNING, "WARNING", fmt::format(format, std::forward<Args>(args)...));
+    }
+
+    template <typename... Args>
+    static void info(fmt::format_string<Args...> format, Args&&... args) {
+        log(LogLevel::LOG_INFO, "INFO", fmt::format(format, std::forward<Args>(args)...));
+    }
+
+    template <typename... Args>
+    static void debug(fmt::format_string<Args...> format, Args&&... args) {
+        log(LogLevel::LOG_DEBUG, "DEBUG", fmt::format(format, std::forward<Args>(args)...));
+    }
+
+    template <typename... Args>
+    static void verbose(fmt::format_string<Args...> format, Args&&... args) {
+        log(LogLevel::LOG_VERBOSE, "VERBOSE", fmt::format(format, std::forward<Args>(args)...));
+    }
+
+private:
+    static void log(LogLevel level, const char* tag, const std::string& message) {
+        if (level > s_level.load()) return;
+        fprintf(stderr, "[%s] %s\n", tag, message.c_str());
+    }
+
+    inline static std::atomic<LogLevel> s_level{LogLevel::LOG_INFO};
+};
+
+// Runs on a worker thread; `dedicated` gives the task a thread of its own
+// so long blocking calls cannot starve the pool
+void async(std::function<void()> task, bool dedicated = false);
+// Runs on the thread that pumps the host main loop
+void sync(std::function<void()> task);
+// Runs on the main loop after `ms` milliseconds; returns an id for cancelDelay
+size_t delay(long ms, std::function<void()> task);
+void cancelDelay(size_t id);
+
+template <typename... Args>
+class Event {
+public:
+    using Callback = std::function<void(Args...)>;
+    using Subscription = typename std::list<Callback>::iterator;
+
+    Subscription subscribe(Callback callback) {
+        m_callbacks.push_back(std::move(callback));
+        return std::prev(m_callbacks.end());
+    }
+
+    void unsubscribe(Subscription subscription) { m_callbacks.erase(subscription); }
+
+    void fire(Args... args) {
+        for (auto& callback : m_callbacks) callback(args...);
+    }
+
+private:
+    std::list<Callback> m_callbacks;
+};
+
+using VoidEvent = Event<>;
+
+// Stands in for the application main loop
+namespace host {
+
+// Runs every queued sync task and every due delay; returns how many ran
+int pump();
+
+// Pumps until done() is true or the timeout passes; false on timeout
+bool runUntil(const std::function<bool()>& done, std::chrono::milliseconds timeout);
+
+// Worker threads used by async(); call once before the first async()
+void setWorkerCount(int count);
+
+// Stops the workers after they finish what they are running
+void shutdown();
+
+}  // namespace host
+
+}  // namespace brls
+
+#endif
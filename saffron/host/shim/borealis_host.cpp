@@ -0,0 +1,174 @@
+#include <borealis.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace brls {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class WorkerPool {
+public:
+    ~WorkerPool() { stop(); }
+
+    void setSize(int count) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_threads.empty()) m_size = std::max(1, count);
+    }
+
+    void post(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopping) return;
+            if (m_threads.empty()) {
+                for (int i = 0; i < m_size; i++) m_threads.emplace_back([this]() { run(); });
+            }
+            m_tasks.push_back(std::move(task));
+        }
+        m_cv.notify_one();
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_cv.notify_all();
+        for (auto& thread : m_threads) {
+            if (thread.joinable()) thread.join();
+        }
+        m_threads.clear();
+    }
+
+private:
+    void run() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+                if (m_tasks.empty()) return;
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::function<void()>> m_tasks;
+    std::vector<std::thread> m_threads;
+    int m_size = 4;  // borealis runs async work on a small pool as well
+    bool m_stopping = false;
+};
+
+struct MainLoop {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> tasks;
+    std::multimap<Clock::time_point, std::pair<size_t, std::function<void()>>> timers;
+    size_t nextTimerId = 1;
+};
+
+WorkerPool& workers() {
+    static WorkerPool pool;
+    return pool;
+}
+
+MainLoop& mainLoop() {
+    static MainLoop loop;
+    return loop;
+}
+
+}  // namespace
+
+void async(std::function<void()> task, bool dedicated) {
+    if (dedicated) {
+        std::thread(std::move(task)).detach();
+        return;
+    }
+    workers().post(std::move(task));
+}
+
+void sync(std::function<void()> task) {
+    auto& loop = mainLoop();
+    {
+        std::lock_guard<std::mutex> lock(loop.mutex);
+        loop.tasks.push_back(std::move(task));
+    }
+    loop.cv.notify_all();
+}
+
+size_t delay(long ms, std::function<void()> task) {
+    auto& loop = mainLoop();
+    std::lock_guard<std::mutex> lock(loop.mutex);
+    size_t id = loop.nextTimerId++;
+    loop.timers.emplace(Clock::now() + std::chrono::milliseconds(ms), std::make_pair(id, std::move(task)));
+    loop.cv.notify_all();
+    return id;
+}
+
+void cancelDelay(size_t id) {
+    auto& loop = mainLoop();
+    std::lock_guard<std::mutex> lock(loop.mutex);
+    for (auto it = loop.timers.begin(); it != loop.timers.end(); ++it) {
+        if (it->second.first == id) {
+            loop.timers.erase(it);
+            return;
+        }
+    }
+}
+
+namespace host {
+
+int pump() {
+    auto& loop = mainLoop();
+    std::deque<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(loop.mutex);
+        ready.swap(loop.tasks);
+        Clock::time_point now = Clock::now();
+        while (!loop.timers.empty() && loop.timers.begin()->first <= now) {
+            ready.push_back(std::move(loop.timers.begin()->second.second));
+            loop.timers.erase(loop.timers.begin());
+        }
+    }
+    for (auto& task : ready) task();
+    return static_cast<int>(ready.size());
+}
+
+bool runUntil(const std::function<bool()>& done, std::chrono::milliseconds timeout) {
+    auto& loop = mainLoop();
+    Clock::time_point deadline = Clock::now() + timeout;
+    while (!done()) {
+        if (pump() > 0) continue;
+
+        Clock::time_point now = Clock::now();
+        if (now >= deadline) return false;
+
+        std::unique_lock<std::mutex> lock(loop.mutex);
+        Clock::time_point wakeAt = deadline;
+        if (!loop.timers.empty()) wakeAt = std::min(wakeAt, loop.timers.begin()->first);
+        loop.cv.wait_until(lock, wakeAt, [&loop]() { return !loop.tasks.empty(); });
+    }
+    return true;
+}
+
+void setWorkerCount(int count) {
+    workers().setSize(count);
+}
+
+void shutdown() {
+    workers().stop();
+}
+
+}  // namespace host
+
+}  // namespace brls
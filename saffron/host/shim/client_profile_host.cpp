@@ -0,0 +1,20 @@
+// Host builds without FFmpeg have no decoder list to advertise, so the
+// server sees the base profile, as it would for a client without extras
+#include "core/client_profile.hpp"
+
+const std::string& ClientProfile::getExtra() {
+    static const std::string extra;
+    return extra;
+}
+
+std::vector<std::string> ClientProfile::getVideoCodecs() {
+    return {};
+}
+
+std::vector<std::string> ClientProfile::getAudioCodecs() {
+    return {};
+}
+
+std::vector<std::string> ClientProfile::getContainers() {
+    return {};
+}
@@ -0,0 +1,16 @@
+// Host stand-in for the parts of libmpv's client API the core uses outside
+// MPVCore, so RangeStream builds without libmpv. Not used by the Switch build.
+#ifndef SAFFRON_HOST_MPV_CLIENT_H
+#define SAFFRON_HOST_MPV_CLIENT_H
+
+#include <cstdint>
+
+typedef struct mpv_handle mpv_handle;
+
+typedef enum mpv_error {
+    MPV_ERROR_SUCCESS = 0,
+    MPV_ERROR_LOADING_FAILED = -13,
+    MPV_ERROR_GENERIC = -20
+} mpv_error;
+
+#endif
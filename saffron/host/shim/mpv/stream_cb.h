@@ -0,0 +1,48 @@
+// Host stand-in for libmpv's stream callback API. Registered protocols are
+// kept so a bench can open a URL through them the way mpv would.
+#ifndef SAFFRON_HOST_MPV_STREAM_CB_H
+#define SAFFRON_HOST_MPV_STREAM_CB_H
+
+#include "mpv/client.h"
+
+#include <map>
+#include <string>
+
+typedef int64_t (*mpv_stream_cb_read_fn)(void* cookie, char* buf, uint64_t nbytes);
+typedef int64_t (*mpv_stream_cb_seek_fn)(void* cookie, int64_t offset);
+typedef int64_t (*mpv_stream_cb_size_fn)(void* cookie);
+typedef void (*mpv_stream_cb_close_fn)(void* cookie);
+typedef void (*mpv_stream_cb_cancel_fn)(void* cookie);
+
+typedef struct mpv_stream_cb_info {
+    void* cookie;
+    mpv_stream_cb_read_fn read_fn;
+    mpv_stream_cb_seek_fn seek_fn;
+    mpv_stream_cb_size_fn size_fn;
+    mpv_stream_cb_close_fn close_fn;
+    mpv_stream_cb_cancel_fn cancel_fn;
+} mpv_stream_cb_info;
+
+typedef int (*mpv_stream_cb_open_ro_fn)(void* user_data, char* uri, mpv_stream_cb_info* info);
+
+inline std::map<std::string, std::pair<mpv_stream_cb_open_ro_fn, void*>>& mpv_host_stream_protocols() {
+    static std::map<std::string, std::pair<mpv_stream_cb_open_ro_fn, void*>> protocols;
+    return protocols;
+}
+
+inline int mpv_stream_cb_add_ro(mpv_handle*, const char* protocol, void* user_data, mpv_stream_cb_open_ro_fn open_fn) {
+    mpv_host_stream_protocols()[protocol] = {open_fn, user_data};
+    return 0;
+}
+
+// Host only: opens uri through the protocol registered for its scheme
+inline int mpv_host_stream_open(const std::string& uri, mpv_stream_cb_info* info) {
+    size_t colon = uri.find("://");
+    if (colon == std::string::npos) return MPV_ERROR_LOADING_FAILED;
+    auto it = mpv_host_stream_protocols().find(uri.substr(0, colon));
+    if (it == mpv_host_stream_protocols().end()) return MPV_ERROR_LOADING_FAILED;
+    std::string copy = uri;
+    return it->second.first(it->second.second, &copy[0], info);
+}
+
+#endif
@@ -0,0 +1,15 @@
+// Host stand-in for the libnx calls the core makes
+#ifndef SAFFRON_HOST_SWITCH_H
+#define SAFFRON_HOST_SWITCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+inline void csrngGetRandomBytes(void* out, size_t size) {
+    static thread_local std::random_device device;
+    uint8_t* bytes = static_cast<uint8_t*>(out);
+    for (size_t i = 0; i < size; i++) bytes[i] = static_cast<uint8_t>(device());
+}
+
+#endif
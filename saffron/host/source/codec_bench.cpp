@@ -0,0 +1,493 @@
+// Round-trip checks for the binary codec (plex_codec) and a comparison with
+// caching the same entities as JSON text:
+//
+//   ./saffron-codec-bench                  # 10000 items
+//   ./saffron-codec-bench --items 50000 --file /tmp/section.bin
+//
+// Every model is round-tripped through an archive and re-encoded byte for
+// byte; items with every field set check that no field is dropped. The
+// timings are for a library section of --items movies: JSON is dump, then
+// parse + from_json as a JSON cache would load it; binary is encodeArchive,
+// then mapping the file and reading titles in place or decoding everything.
+
+#include "models/plex_codec.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using json = nlohmann::json;
+using namespace plex::codec;
+
+const char* const GENRES[] = {"Action", "Comedy", "Drama", "Documentary", "Horror", "Science Fiction"};
+
+int g_failures = 0;
+
+void check(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "FAILED: %s\n", what);
+        g_failures++;
+    }
+}
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+plex::Stream makeStream(int id, int type) {
+    plex::Stream s;
+    s.id = id;
+    s.streamType = type;
+    s.codec = type == 1 ? "hevc" : (type == 2 ? "eac3" : "srt");
+    s.language = "English";
+    s.languageCode = "eng";
+    s.displayTitle = "English (" + s.codec + ")";
+    s.selected = type != 3;
+    s.isDefault = type == 1;
+    s.decision = "copy";
+    s.key = type == 3 ? "/library/streams/" + std::to_string(id) : "";
+    s.index = id % 10;
+    s.channels = type == 2 ? 6 : 0;
+    s.bitrate = type == 1 ? 19500 : 640;
+    s.profile = "main 10";
+    s.audioChannelLayout = type == 2 ? "5.1(side)" : "";
+    s.bitDepth = 10;
+    s.colorSpace = "bt2020nc";
+    s.colorRange = "tv";
+    s.colorPrimaries = "bt2020";
+    s.width = 3840;
+    s.height = 1600;
+    s.frameRate = 23.976;
+    return s;
+}
+
+plex::Media makeMedia(int id, int streams) {
+    plex::Part part;
+    part.id = id;
+    part.key = "/library/parts/" + std::to_string(id) + "/1700000000/file.mkv";
+    part.duration = 7260000;
+    part.file = "/media/movies/Title " + std::to_string(id) + "/Title.mkv";
+    part.size = 18234567890;
+    part.container = "mkv";
+    part.videoProfile = "main 10";
+    part.audioProfile = "dts";
+    for (int i = 0; i < streams; i++) {
+        part.streams.push_back(makeStream(id * 100 + i, i == 0 ? 1 : (i < 3 ? 2 : 3)));
+    }
+
+    plex::Media media;
+    media.id = id;
+    media.duration = 7260000;
+    media.bitrate = 21000;
+    media.width = 3840;
+    media.height = 1600;
+    media.aspectRatio = "2.35";
+    media.audioChannels = 6;
+    media.audioCodec = "eac3";
+    media.videoCodec = "hevc";
+    media.videoResolution = "4k";
+    media.container = "mkv";
+    media.videoFrameRate = "24p";
+    media.videoProfile = "main 10";
+    media.audioProfile = "dts";
+    media.parts.push_back(part);
+    return media;
+}
+
+plex::Tag makeTag(int id, const std::string& name) {
+    plex::Tag tag;
+    tag.id = id;
+    tag.tag = name;
+    return tag;
+}
+
+// A movie as a section listing returns it
+plex::MediaItem makeItem(int key) {
+    plex::MediaItem item;
+    item.ratingKey = key;
+    item.key = "/library/metadata/" + std::to_string(key);
+    item.guid = "plex://movie/5d7768" + std::to_string(100000 + key);
+    item.type = "movie";
+    item.mediaType = plex::MediaType::Movie;
+    item.title = "Title " + std::to_string(key);
+    item.titleSort = item.title;
+    item.summary = "A long summary of the film that runs to a couple of sentences, as Plex listings "
+                   "include it for every item whether or not the client shows it.";
+    item.thumb = "/library/metadata/" + std::to_string(key) + "/thumb/1700000000";
+    item.art = "/library/metadata/" + std::to_string(key) + "/art/1700000000";
+    item.duration = 7260000;
+    item.addedAt = 1700000000 + key;
+    item.updatedAt = 1700000000 + key;
+    item.year = 1980 + key % 45;
+    item.contentRating = "PG-13";
+    item.rating = 7.4;
+    item.audienceRating = 8.1;
+    item.audienceRatingImage = "rottentomatoes://image.rating.upright";
+    item.studio = "Example Pictures";
+    item.tagline = "Every story has a beginning.";
+    item.originallyAvailableAt = "2014-11-05";
+    item.viewOffset = key % 4 == 0 ? 1200000 : 0;
+    item.viewCount = key % 3;
+    item.lastViewedAt = item.viewCount ? 1710000000 + key : 0;
+    item.librarySectionId = 1;
+    item.media.push_back(makeMedia(key, 0));
+    item.genres = {makeTag(0, GENRES[key % 6]), makeTag(0, GENRES[(key + 1) % 6])};
+    item.countries = {makeTag(0, "United States of America")};
+    item.directors = {makeTag(0, "Director " + std::to_string(key % 50))};
+    item.writers = {makeTag(0, "Writer " + std::to_string(key % 70))};
+    item.cast = {makeTag(0, "Actor A"), makeTag(0, "Actor B"), makeTag(0, "Actor C")};
+    return item;
+}
+
+// Every field away from its default, so a dropped field shows up
+plex::MediaItem makeFullItem() {
+    plex::MediaItem item = makeItem(7);
+    item.mediaType = plex::MediaType::Episode;
+    item.editionTitle = "Director's Cut";
+    item.banner = "/banner";
+    item.originalTitle = "Titre";
+    item.viewOffset = -1;
+    item.viewCount = 1;
+    item.lastViewedAt = 1;
+    item.parentRatingKey = 2;
+    item.grandparentRatingKey = 3;
+    item.index = 4;
+    item.parentIndex = 5;
+    item.grandparentTitle = "Show";
+    item.parentTitle = "Season 5";
+    item.grandparentThumb = "/show/thumb";
+    item.parentThumb = "/season/thumb";
+    item.leafCount = 6;
+    item.viewedLeafCount = 7;
+    item.childCount = 8;
+    item.media = {makeMedia(9, 4)};
+    item.media[0].editionTitle = "Director's Cut";
+    item.media[0].optimizedForStreaming = true;
+    plex::Stream& stream = item.media[0].parts[0].streams[0];
+    stream.key = "/library/streams/1";
+    stream.index = 1;
+    stream.channels = 2;
+    stream.audioChannelLayout = "stereo";
+    item.cast[0].role = "Lead";
+    item.cast[0].thumb = "/people/1.jpg";
+    item.cast[0].id = 11;
+    // Long enough to need a multi-byte length
+    item.summary.assign(20000, 's');
+    return item;
+}
+
+plex::Hub makeHub(int index, int items) {
+    plex::Hub hub;
+    hub.hubKey = "/hubs/" + std::to_string(index);
+    hub.key = hub.hubKey + "/all";
+    hub.title = "Hub " + std::to_string(index);
+    hub.type = "movie";
+    hub.hubIdentifier = "movie.recent." + std::to_string(index);
+    hub.context = "hub.movie";
+    hub.size = items;
+    hub.more = true;
+    hub.style = "shelf";
+    hub.promoted = true;
+    for (int i = 0; i < items; i++) hub.items.push_back(makeItem(index * 100 + i));
+    return hub;
+}
+
+plex::Library makeLibrary(int key) {
+    plex::Library lib;
+    lib.key = key;
+    lib.uuid = "a1b2c3d4-" + std::to_string(key);
+    lib.type = "movie";
+    lib.title = "Movies " + std::to_string(key);
+    lib.art = "/art";
+    lib.thumb = "/thumb";
+    lib.composite = "/composite";
+    lib.allowSync = true;
+    lib.updatedAt = 1700000000;
+    lib.scannedAt = 1700000001;
+    return lib;
+}
+
+plex::Collection makeCollection(int key) {
+    plex::Collection col;
+    col.ratingKey = key;
+    col.key = "/library/collections/" + std::to_string(key);
+    col.guid = "collection://" + std::to_string(key);
+    col.type = "collection";
+    col.title = "Collection " + std::to_string(key);
+    col.summary = "Summary";
+    col.thumb = "/thumb";
+    col.art = "/art";
+    col.childCount = 12;
+    col.addedAt = 1700000000;
+    col.updatedAt = 1700000001;
+    return col;
+}
+
+plex::Playlist makePlaylist(int key) {
+    plex::Playlist pl;
+    pl.ratingKey = key;
+    pl.key = "/playlists/" + std::to_string(key) + "/items";
+    pl.guid = "com.plexapp.agents.none://" + std::to_string(key);
+    pl.type = "playlist";
+    pl.title = "Playlist " + std::to_string(key);
+    pl.summary = "Summary";
+    pl.thumb = "/thumb";
+    pl.composite = "/composite";
+    pl.leafCount = 40;
+    pl.duration = 9000000;
+    pl.smart = true;
+    pl.playlistType = "video";
+    pl.addedAt = 1700000000;
+    pl.updatedAt = 1700000001;
+    return pl;
+}
+
+plex::CardItem makeCard(int key) {
+    plex::CardItem card = plex::CardItem::fromMediaItem(makeFullItem());
+    card.ratingKey = key;
+    card.titleSort = "Sort " + std::to_string(key);
+    return card;
+}
+
+// Number of distinct field ids in a record
+size_t distinctFields(std::string_view record) {
+    std::set<uint32_t> ids;
+    FieldCursor cursor(record);
+    while (cursor.next()) ids.insert(cursor.id());
+    return ids.size();
+}
+
+// Encode, open, decode everything and encode again: the bytes must match
+template <typename T>
+void roundTrip(const char* name, const std::vector<T>& records, size_t fieldCount) {
+    std::string encoded = encodeArchive(records);
+    Archive archive;
+    std::string label = std::string(name) + " archive opens";
+    check(archive.open(encoded) && archive.size() == records.size(), label.c_str());
+
+    std::vector<T> decoded;
+    label = std::string(name) + " decodes";
+    check(archive.decodeAll(decoded), label.c_str());
+    label = std::string(name) + " re-encodes identically";
+    check(encodeArchive(decoded) == encoded, label.c_str());
+
+    label = std::string(name) + " writes every field";
+    check(records.empty() || distinctFields(archive[0].data()) == fieldCount, label.c_str());
+}
+
+void checkFormat() {
+    plex::MediaItem full = makeFullItem();
+    roundTrip("MediaItem", std::vector<plex::MediaItem>{full, makeItem(1), plex::MediaItem()},
+              static_cast<size_t>(ItemField::Cast));
+    roundTrip("Hub", std::vector<plex::Hub>{makeHub(1, 3), plex::Hub()}, static_cast<size_t>(HubField::Items));
+    roundTrip("Library", std::vector<plex::Library>{makeLibrary(1), makeLibrary(2)},
+              static_cast<size_t>(LibraryField::ScannedAt));
+    roundTrip("Collection", std::vector<plex::Collection>{makeCollection(1)},
+              static_cast<size_t>(CollectionField::UpdatedAt));
+    roundTrip("Playlist", std::vector<plex::Playlist>{makePlaylist(1)},
+              static_cast<size_t>(PlaylistField::UpdatedAt));
+    roundTrip("Card", std::vector<plex::CardItem>{makeCard(1), plex::CardItem()},
+              static_cast<size_t>(CardField::Resolutions));
+    roundTrip("empty", std::vector<plex::Playlist>{}, 0);
+
+    // Nested records of the full item
+    Encoder encoder;
+    encode(encoder, full);
+    RecordView view(encoder.buffer());
+    size_t mediaFields = 0, partFields = 0, streamFields = 0, castFields = 0;
+    view.forEach(ItemField::Media, [&](RecordView media) {
+        mediaFields = distinctFields(media.data());
+        media.forEach(MediaField::Parts, [&](RecordView part) {
+            partFields = distinctFields(part.data());
+            part.forEach(PartField::Streams, [&](RecordView stream) {
+                streamFields = std::max(streamFields, distinctFields(stream.data()));
+            });
+        });
+    });
+    view.forEach(ItemField::Cast, [&](RecordView tag) { castFields = std::max(castFields, distinctFields(tag.data())); });
+    check(mediaFields == static_cast<size_t>(MediaField::Parts), "Media writes every field");
+    check(partFields == static_cast<size_t>(PartField::Streams), "Part writes every field");
+    check(streamFields == static_cast<size_t>(StreamField::FrameRate), "Stream writes every field");
+    check(castFields == static_cast<size_t>(TagField::Thumb), "Tag writes every field");
+
+    // Lazy reads agree with the decoded values
+    check(view.getString(ItemField::Title) == full.title, "lazy string");
+    check(view.getInt(ItemField::ViewOffset) == full.viewOffset, "lazy negative int");
+    check(view.getDouble(ItemField::Rating) == full.rating, "lazy double");
+    check(view.getString(ItemField::Summary).size() == full.summary.size(), "lazy long string");
+    check(view.getInt(ItemField::Banner) == 0, "lazy read of the wrong wire type");
+
+    // A MediaItem archive does not decode as another kind
+    std::string items = encodeArchive(std::vector<plex::MediaItem>{full});
+    Archive archive;
+    plex::Hub hub;
+    check(archive.open(items) && !archive.decode(0, hub), "kind is checked");
+
+    // Truncations and corruption are rejected or decode to something, but
+    // never read out of bounds (run under ASan to be sure)
+    for (size_t length = 0; length < items.size(); length += 97) {
+        Archive truncated;
+        if (truncated.open(std::string_view(items).substr(0, length))) {
+            plex::MediaItem item;
+            truncated.decode(0, item);
+        }
+    }
+    std::string corrupt = items;
+    srand(1);
+    for (int i = 0; i < 2000; i++) {
+        corrupt[20 + static_cast<size_t>(rand()) % (corrupt.size() - 20)] = static_cast<char>(rand());
+        Archive damaged;
+        plex::MediaItem item;
+        if (damaged.open(corrupt)) damaged.decode(0, item);
+    }
+    std::string badVersion = items;
+    badVersion[4] = 99;
+    check(!archive.open(badVersion), "unknown version is rejected");
+}
+
+json toJson(const plex::Tag& t) {
+    json j = {{"tag", t.tag}};
+    if (t.id) j["id"] = t.id;
+    if (!t.role.empty()) j["role"] = t.role;
+    if (!t.thumb.empty()) j["thumb"] = t.thumb;
+    return j;
+}
+
+json toJson(const std::vector<plex::Tag>& tags) {
+    json list = json::array();
+    for (const auto& t : tags) list.push_back(toJson(t));
+    return list;
+}
+
+// The item as Plex sends it, for what a JSON cache would store
+json toJson(const plex::MediaItem& item) {
+    const plex::Media& m = item.media[0];
+    const plex::Part& p = m.parts[0];
+    return {
+        {"ratingKey", std::to_string(item.ratingKey)}, {"key", item.key}, {"guid", item.guid},
+        {"type", item.type}, {"title", item.title}, {"titleSort", item.titleSort}, {"summary", item.summary},
+        {"thumb", item.thumb}, {"art", item.art}, {"duration", item.duration}, {"addedAt", item.addedAt},
+        {"updatedAt", item.updatedAt}, {"year", item.year}, {"contentRating", item.contentRating},
+        {"rating", item.rating}, {"audienceRating", item.audienceRating},
+        {"audienceRatingImage", item.audienceRatingImage}, {"studio", item.studio}, {"tagline", item.tagline},
+        {"originallyAvailableAt", item.originallyAvailableAt}, {"viewOffset", item.viewOffset},
+        {"viewCount", item.viewCount}, {"lastViewedAt", item.lastViewedAt},
+        {"librarySectionID", item.librarySectionId},
+        {"Media", json::array({{
+            {"id", m.id}, {"duration", m.duration}, {"bitrate", m.bitrate}, {"width", m.width},
+            {"height", m.height}, {"aspectRatio", m.aspectRatio}, {"audioChannels", m.audioChannels},
+            {"audioCodec", m.audioCodec}, {"videoCodec", m.videoCodec},
+            {"videoResolution", m.videoResolution}, {"container", m.container},
+            {"videoFrameRate", m.videoFrameRate}, {"videoProfile", m.videoProfile},
+            {"audioProfile", m.audioProfile},
+            {"Part", json::array({{
+                {"id", p.id}, {"key", p.key}, {"duration", p.duration}, {"file", p.file}, {"size", p.size},
+                {"container", p.container}, {"videoProfile", p.videoProfile}, {"audioProfile", p.audioProfile},
+            }})},
+        }})},
+        {"Genre", toJson(item.genres)}, {"Country", toJson(item.countries)},
+        {"Director", toJson(item.directors)}, {"Writer", toJson(item.writers)}, {"Role", toJson(item.cast)},
+    };
+}
+
+void compare(int count, const std::string& path) {
+    std::vector<plex::MediaItem> items;
+    items.reserve(count);
+    for (int i = 0; i < count; i++) items.push_back(makeItem(1000 + i));
+
+    Clock::time_point start = Clock::now();
+    json list = json::array();
+    for (const auto& item : items) list.push_back(toJson(item));
+    std::string text = json({{"MediaContainer", {{"size", count}, {"Metadata", list}}}}).dump();
+    double jsonEncodeMs = msSince(start);
+
+    start = Clock::now();
+    json document = json::parse(text);
+    std::vector<plex::MediaItem> fromJson;
+    fromJson.reserve(count);
+    for (const auto& meta : document["MediaContainer"]["Metadata"]) {
+        plex::MediaItem item;
+        plex::from_json(meta, item);
+        fromJson.push_back(std::move(item));
+    }
+    double jsonLoadMs = msSince(start);
+
+    start = Clock::now();
+    std::string binary = encodeArchive(items);
+    double binaryEncodeMs = msSince(start);
+    if (!writeArchive(path, binary)) {
+        fprintf(stderr, "cannot write %s\n", path.c_str());
+        g_failures++;
+        return;
+    }
+
+    start = Clock::now();
+    MappedFile file;
+    Archive archive;
+    bool opened = file.open(path) && archive.open(file.data());
+    double openMs = msSince(start);
+    check(opened && archive.size() == items.size(), "section archive opens");
+
+    // What a grid needs to draw its first screen: titles read in place
+    start = Clock::now();
+    size_t titleBytes = 0;
+    for (size_t i = 0; i < archive.size(); i++) titleBytes += archive[i].getString(ItemField::Title).size();
+    double lazyMs = msSince(start);
+
+    start = Clock::now();
+    std::vector<plex::MediaItem> decoded;
+    check(archive.decodeAll(decoded), "section decodes");
+    double decodeMs = msSince(start);
+
+    size_t expectedTitleBytes = 0;
+    for (const auto& item : items) expectedTitleBytes += item.title.size();
+    check(titleBytes == expectedTitleBytes, "lazy titles match");
+    check(decoded.size() == items.size() && decoded.back().title == items.back().title, "decoded section matches");
+
+    printf("%d items\n", count);
+    printf("  %-22s %10s %12s %12s\n", "", "bytes", "encode ms", "load ms");
+    printf("  %-22s %10zu %12.2f %12.2f\n", "json (parse+from_json)", text.size(), jsonEncodeMs, jsonLoadMs);
+    printf("  %-22s %10zu %12.2f %12.2f\n", "binary (decode all)", binary.size(), binaryEncodeMs, openMs + decodeMs);
+    printf("  %-22s %10s %12s %12.3f\n", "binary (open)", "", "", openMs);
+    printf("  %-22s %10s %12s %12.3f\n", "binary (open+titles)", "", "", openMs + lazyMs);
+    printf("  size %.1f%% of json, full load %.1fx faster\n", 100.0 * binary.size() / text.size(),
+           jsonLoadMs / (openMs + decodeMs));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int count = 10000;
+    std::string path = "saffron-codec-bench.bin";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--items" && i + 1 < argc) {
+            count = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--file" && i + 1 < argc) {
+            path = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--items N] [--file PATH]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    checkFormat();
+    compare(count, path);
+    remove(path.c_str());
+
+    if (g_failures > 0) {
+        fprintf(stderr, "%d checks failed\n", g_failures);
+        return 1;
+    }
+    printf("round-trip checks passed\n");
+    return 0;
+}
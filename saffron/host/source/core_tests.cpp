@@ -0,0 +1,402 @@
+// Checks for core code that has nothing to talk to on the console side,
+// run by ctest:
+//
+//   ./saffron-core-tests
+//
+// Exits non-zero if any check fails.
+
+#include "core/abr_controller.hpp"
+#include "core/chunk_ring.hpp"
+#include "core/entity_store.hpp"
+#include "core/search_index.hpp"
+#include "models/card_item.hpp"
+#include "util/binary_io.hpp"
+#include "util/deferred_writer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const char* const GENRES[] = {"Action", "Comedy", "Drama", "Documentary", "Horror", "Science Fiction"};
+const char* const STUDIOS[] = {"Warner Bros. Pictures", "Universal Pictures", "Paramount Pictures",
+                               "Columbia Pictures", "A24", "Studio Ghibli"};
+const char* const RATINGS[] = {"G", "PG", "PG-13", "R", "NR"};
+
+int g_failures = 0;
+
+void check(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "FAILED: %s\n", what);
+        g_failures++;
+    }
+}
+
+// A movie as a section listing returns it: long summary, art, tags and one
+// media entry with streams
+plex::MediaItem makeMovie(int ratingKey) {
+    plex::MediaItem item;
+    item.ratingKey = ratingKey;
+    item.key = "/library/metadata/" + std::to_string(ratingKey);
+    item.guid = "plex://movie/5d7768" + std::to_string(100000 + ratingKey);
+    item.type = "movie";
+    item.mediaType = plex::MediaType::Movie;
+    item.title = "The Movie Number " + std::to_string(ratingKey);
+    item.titleSort = "Movie Number " + std::to_string(ratingKey);
+    item.summary = std::string(400, 's');
+    item.thumb = item.key + "/thumb/1700000000";
+    item.art = item.key + "/art/1700000000";
+    item.year = 1980 + ratingKey % 45;
+    item.contentRating = RATINGS[ratingKey % 5];
+    item.studio = STUDIOS[ratingKey % 6];
+    item.tagline = "A tagline that is long enough to allocate";
+    item.originallyAvailableAt = "2001-01-01";
+    item.duration = 6000000;
+    item.updatedAt = 1700000000 + ratingKey;
+    item.librarySectionId = 1;
+
+    plex::Media media;
+    media.videoCodec = "hevc";
+    media.videoResolution = "1080";
+    media.container = "mkv";
+    plex::Part part;
+    part.key = "/library/parts/" + std::to_string(ratingKey) + "/1700000000/file.mkv";
+    part.file = "/data/movies/The Movie Number " + std::to_string(ratingKey) + ".mkv";
+    for (int type = 1; type <= 3; type++) {
+        plex::Stream stream;
+        stream.streamType = type;
+        stream.codec = type == 1 ? "hevc" : (type == 2 ? "eac3" : "srt");
+        stream.displayTitle = "English (" + stream.codec + " 5.1)";
+        part.streams.push_back(stream);
+    }
+    media.parts.push_back(part);
+    item.media.push_back(media);
+
+    for (int i = 0; i < 3; i++) {
+        plex::Tag tag;
+        tag.tag = GENRES[(ratingKey + i) % 6];
+        item.genres.push_back(tag);
+    }
+    return item;
+}
+
+// A 10k-item section held as cards must stay a small fraction of the same
+// section held as MediaItems
+void checkCardFootprint() {
+    const int items = 10000;
+
+    std::vector<plex::MediaItem> movies;
+    movies.reserve(items);
+    size_t fullBytes = 0;
+    for (int i = 1; i <= items; i++) {
+        movies.push_back(makeMovie(i));
+        fullBytes += plex::memoryFootprint(movies.back());
+    }
+
+    auto& pool = plex::StringPool::instance();
+    size_t poolBefore = pool.memoryUsage();
+
+    std::vector<EntityRef> cards = EntityStore::getInstance()->mergeAll(movies);
+    check(cards.size() == movies.size(), "every item merged");
+    check(EntityStore::getInstance()->size() == movies.size(), "store holds one entity per item");
+
+    size_t cardBytes = 0;
+    size_t largestCard = 0;
+    for (const auto& card : cards) {
+        size_t bytes = plex::memoryFootprint(*card);
+        cardBytes += bytes;
+        if (bytes > largestCard) largestCard = bytes;
+    }
+    size_t poolBytes = pool.memoryUsage() - poolBefore;
+
+    // Fixed fields, plus title, sort title and thumb spilling out of the
+    // small-string buffer
+    check(largestCard <= sizeof(plex::CardItem) + 3 * 48, "card holds only its own strings");
+    // Repeated studios and ratings are stored once
+    check(pool.size() <= 16, "interned values are deduplicated");
+    check(poolBytes <= 4096, "string pool stays small");
+    check((cardBytes + poolBytes) * 4 <= fullBytes, "cards are under a quarter of MediaItems");
+
+    printf("card footprint: %zu items, %zu KB as MediaItem, %zu KB as CardItem + %zu B pool "
+           "(%zu B/card, largest %zu B)\n",
+           movies.size(), fullBytes / 1024, cardBytes / 1024, poolBytes,
+           cardBytes / cards.size(), largestCard);
+
+    // Round trip keeps what a card promises to keep
+    plex::MediaItem back = cards.front()->toMediaItem();
+    check(back.ratingKey == movies.front().ratingKey && back.title == movies.front().title &&
+          back.titleSort == movies.front().titleSort && back.studio == movies.front().studio,
+          "card converts back to its listing fields");
+}
+
+// Local progress survives a page fetched before the server saw it, but the
+// server's watch state wins once it echoes the report, whatever the clocks
+// say, and a switch to another server leaves no entities behind
+void checkWatchState() {
+    auto* store = EntityStore::getInstance();
+    store->clear();
+
+    plex::MediaItem item = makeMovie(42);
+    item.viewOffset = 60000;
+    item.lastViewedAt = 1700000000;
+    EntityRef entity = store->merge(item);
+
+    store->updateProgress(42, 90000);
+    store->merge(item);
+    check(entity->viewOffset == 90000, "a stale page does not roll back local progress");
+
+    plex::MediaItem acked = item;
+    acked.viewOffset = 90000;
+    store->merge(acked);
+    check(entity->viewOffset == 90000, "the server echoes the local progress");
+
+    // Marked unwatched on another client: offset and count reset, with the
+    // server's lastViewedAt behind what it reported before
+    plex::MediaItem unwatched = item;
+    unwatched.viewOffset = 0;
+    unwatched.viewCount = 0;
+    unwatched.lastViewedAt = 1600000000;
+    store->merge(unwatched);
+    check(entity->viewOffset == 0 && entity->lastViewedAt == 1600000000, "acknowledged server state wins");
+
+    store->markWatched(42);
+    store->merge(unwatched);
+    check(entity->viewCount == 1, "a stale page does not undo a local mark as watched");
+
+    store->clear();
+    check(store->find(42) == nullptr && store->size() == 0, "clearing forgets every entity");
+    check(entity->viewCount == 1, "refs handed out keep their data");
+}
+
+// Synthetic vocabulary: three syllables per word gives ~27k distinct words,
+// so the term list, postings and trigrams are about as large as a real
+// library's
+const char* const SYLLABLES[] = {"ka", "ro", "mi", "tel", "van", "dor", "su", "bri", "an", "qua",
+                                 "zen", "lo", "per", "ith", "gar", "mon", "ne", "shi", "ul", "fax",
+                                 "dre", "po", "wyn", "tor", "el", "ba", "cy", "ost", "lu", "ver"};
+
+std::string syntheticWord(uint32_t n) {
+    const size_t count = sizeof(SYLLABLES) / sizeof(SYLLABLES[0]);
+    return std::string(SYLLABLES[n % count]) + SYLLABLES[n / count % count] + SYLLABLES[n / count / count % count];
+}
+
+plex::MediaItem makeSearchDoc(int ratingKey, const std::string& title, int year) {
+    plex::MediaItem item;
+    item.ratingKey = ratingKey;
+    item.librarySectionId = 1;
+    item.mediaType = plex::MediaType::Movie;
+    item.title = title;
+    item.year = year;
+    item.thumb = "/library/metadata/" + std::to_string(ratingKey) + "/thumb/1";
+    return item;
+}
+
+std::vector<int> searchKeys(SearchIndex* index, const std::string& query, size_t limit = 50) {
+    std::vector<int> keys;
+    for (const auto& item : index->search(query, limit)) keys.push_back(item.ratingKey);
+    return keys;
+}
+
+bool contains(const std::vector<int>& keys, int key) {
+    return std::find(keys.begin(), keys.end(), key) != keys.end();
+}
+
+// Prefix and substring matching, ranking and tombstones over 50k synthetic
+// documents, a save/load round trip, and a corrupt file; prints query times
+void checkSearchIndex() {
+    const int items = 50000;
+    const int schindler = 900001, adrian = 900002, listen = 900003, taken = 900004;
+
+    // The index persists under the host's sdmc: directory, next to the binary
+    mkdir("sdmc:", 0755);
+    mkdir("sdmc:/switch", 0755);
+    mkdir("sdmc:/switch/saffron", 0755);
+    mkdir("sdmc:/switch/saffron/cache", 0755);
+    remove("sdmc:/switch/saffron/cache/search_core-tests.bin");
+
+    auto* index = SearchIndex::getInstance();
+    index->setServer("core-tests");
+
+    uint32_t seed = 12345;
+    auto next = [&seed]() { return seed = seed * 1664525u + 1013904223u; };
+    for (int i = 1; i <= items; i++) {
+        plex::MediaItem item = makeSearchDoc(i, "The " + syntheticWord(next() % 27000) + " " +
+                                                    syntheticWord(next() % 27000), 1950 + i % 75);
+        for (int c = 0; c < 3; c++) {
+            plex::Tag tag;
+            tag.tag = syntheticWord(next() % 27000) + " " + syntheticWord(next() % 27000);
+            item.cast.push_back(tag);
+        }
+        index->add(item);
+    }
+    index->add(makeSearchDoc(schindler, "Schindler's List", 1993));
+    index->add(makeSearchDoc(adrian, "The List of Adrian Messenger", 1963));
+    index->add(makeSearchDoc(listen, "Listen", 2020));
+    plex::MediaItem takenItem = makeSearchDoc(taken, "Taken", 2008);
+    plex::Tag neeson;
+    neeson.tag = "Liam Neeson";
+    takenItem.cast.push_back(neeson);
+    index->add(takenItem);
+    check(index->size() == static_cast<size_t>(items) + 4, "index holds every document");
+
+    check(searchKeys(index, "schin") == std::vector<int>{schindler}, "a prefix matches a title word");
+    check(searchKeys(index, "schindlers") == std::vector<int>{schindler}, "apostrophes fold into the word");
+    check(contains(searchKeys(index, "indler"), schindler), "a substring matches through trigrams");
+    check(searchKeys(index, "list adrian") == std::vector<int>{adrian}, "every query word must match");
+    check(searchKeys(index, "neeson") == std::vector<int>{taken}, "cast names are searchable");
+
+    // Title start, then title words, then other fields
+    std::vector<int> list = searchKeys(index, "list");
+    check(list.size() >= 3 && list[0] == listen, "a title starting with the query ranks first");
+    check(list.size() >= 3 && contains({list[1], list[2]}, schindler) && contains({list[1], list[2]}, adrian),
+          "title word matches rank next");
+
+    // Tombstoned documents stay out of results and come back when re-added
+    index->remove(schindler);
+    check(searchKeys(index, "schindler").empty(), "a removed document is not returned");
+    index->add(makeSearchDoc(adrian, "The List of Adrian Messenger (Director's Cut)", 1963));
+    check(searchKeys(index, "director") == std::vector<int>{adrian}, "an update replaces the document");
+    check(searchKeys(index, "list adrian") == std::vector<int>{adrian}, "an update leaves no duplicate");
+
+    // Queries of each kind: short prefixes, whole words, substrings, two words
+    std::vector<std::string> queries;
+    for (int i = 0; i < 200; i++) {
+        std::string word = syntheticWord(next() % 27000);
+        switch (i % 4) {
+            case 0: queries.push_back(word.substr(0, 2)); break;
+            case 1: queries.push_back(word); break;
+            case 2: queries.push_back(word.substr(1)); break;
+            default: queries.push_back(word + " " + syntheticWord(next() % 27000).substr(0, 3)); break;
+        }
+    }
+    std::vector<double> times;
+    for (const auto& query : queries) {
+        auto start = std::chrono::steady_clock::now();
+        index->search(query, 50);
+        times.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    printf("search index: %zu items, %zu queries, p50 %.0f us, p95 %.0f us, max %.0f us\n", index->size(),
+           times.size(), times[times.size() / 2], times[times.size() * 95 / 100], times.back());
+
+    // The file is written compacted and read back whole
+    size_t live = index->size();
+    index->flush();
+    index->setServer("core-tests-other");
+    index->setServer("core-tests");
+    check(index->size() == live, "a saved index loads every live document");
+    check(searchKeys(index, "schindler").empty(), "tombstones are not saved");
+    check(searchKeys(index, "director") == std::vector<int>{adrian}, "a loaded index answers queries");
+
+    // A count far past the file's size is rejected instead of allocated
+    BinaryWriter corrupt;
+    corrupt.put<uint32_t>(0x31495353);
+    corrupt.put<uint16_t>(2);
+    corrupt.put<uint32_t>(0xFFFFFFF0u);
+    DeferredWriter::writeFile("sdmc:/switch/saffron/cache/search_core-tests-corrupt.bin", corrupt.buffer());
+    index->setServer("core-tests-corrupt");
+    check(index->size() == 0, "a corrupt index file is ignored");
+    index->setServer("");
+    remove("sdmc:/switch/saffron/cache/search_core-tests-corrupt.bin");
+}
+
+// RangeStream's SD card tier: the oldest chunks give way once the ring is
+// full, and the segment files never grow past their fixed size
+void checkChunkRing() {
+    const char* dir = "core-tests-ring";
+    const int64_t chunk = 4096;
+    mkdir(dir, 0755);
+    auto chunkData = [chunk](int64_t index) { return std::string(static_cast<size_t>(chunk), static_cast<char>('a' + index % 26)); };
+    auto fileSize = [dir](int segment) {
+        struct stat st;
+        std::string path = std::string(dir) + "/ring" + std::to_string(segment) + ".bin";
+        return stat(path.c_str(), &st) == 0 ? static_cast<int64_t>(st.st_size) : -1;
+    };
+
+    {
+        // 10 slots over segments of 4
+        ChunkRing ring(dir, chunk * 10, chunk, chunk * 4);
+        check(ring.getCapacity() == chunk * 10, "the ring holds whole chunks");
+        for (int64_t i = 0; i < 10; i++) ring.store("file", i, chunkData(i));
+
+        std::string data;
+        bool all = true;
+        for (int64_t i = 0; i < 10; i++) all = all && ring.load("file", i, data) && data == chunkData(i);
+        check(all, "every chunk of a full ring reads back");
+        check(!ring.load("other", 3, data), "chunks are keyed by stream");
+
+        for (int64_t i = 10; i < 13; i++) ring.store("file", i, chunkData(i));
+        check(!ring.load("file", 0, data) && !ring.load("file", 2, data), "the oldest chunks are overwritten");
+        check(ring.load("file", 3, data) && data == chunkData(3), "newer chunks survive the wrap");
+        check(ring.load("file", 12, data) && data == chunkData(12), "the wrapped chunk reads back");
+
+        ring.store("file", 13, "tail");
+        check(ring.load("file", 13, data) && data == "tail", "a short last chunk keeps its length");
+        check(ring.getHits() == 13, "hits are counted");
+
+        check(fileSize(0) == chunk * 4 && fileSize(1) == chunk * 4 && fileSize(2) == chunk * 2,
+              "segment files stay at their fixed size");
+    }
+    check(fileSize(0) < 0 && fileSize(2) < 0, "the ring removes its files");
+    rmdir(dir);
+}
+
+// A transcode that stalls mid-stream: mpv pauses for the cache while the
+// player state stays Playing, so the stall reaches the controller only
+// through paused-for-cache
+void checkAbrStall() {
+    using Clock = AbrController::Clock;
+
+    AbrController abr;
+    check(abr.start(1, 8000, 20000, 1080, "http://127.0.0.1:32400"), "ABR starts below the source");
+    check(abr.getCurrentStep().bitrate == 8000, "ABR starts at the requested rung");
+    Clock::time_point t = Clock::now();
+
+    // A cold start: stalls inside the grace period are the restart's own
+    AbrController::Sample sample;
+    sample.buffering = true;
+    sample.downloadKbps = 9000;
+    for (int i = 0; i < 3; i++) {
+        check(!abr.update(sample, t + std::chrono::seconds(i)), "startup buffering is not a stall");
+    }
+
+    // Steady playback, then the cache drains and mpv waits for it
+    const double cacheTrace[] = {20, 20, 19, 18, 18, 17, 15, 12, 9, 6, 3, 1, 0};
+    int second = 3;
+    bool switched = false;
+    for (double cache : cacheTrace) {
+        sample.positionMs = second * 1000;
+        sample.cacheSeconds = cache;
+        sample.downloadKbps = cache > 10 ? 9000 : 2500;
+        sample.buffering = cache == 0;
+        switched = abr.update(sample, t + std::chrono::seconds(second++));
+        if (switched) break;
+    }
+    check(switched && sample.buffering, "ABR steps down on the stall");
+    check(abr.getCurrentStep().bitrate == 4000, "ABR steps one rung down");
+
+    // The stall continues into the restart; no second step for the same one
+    check(!abr.update(sample, t + std::chrono::seconds(second + 1)), "a stall right after a switch is the switch's");
+}
+
+}
+
+int main() {
+    checkCardFootprint();
+    checkWatchState();
+    checkSearchIndex();
+    checkChunkRing();
+    checkAbrStall();
+
+    if (g_failures > 0) {
+        fprintf(stderr, "%d checks failed\n", g_failures);
+        return 1;
+    }
+    printf("core checks passed\n");
+    return 0;
+}
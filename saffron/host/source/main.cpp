@@ -0,0 +1,283 @@
+// Headless driver for the core library: walks a server the way the app
+// does when browsing (sections, pages of items, details, a playback
+// decision) and reports per-call latency. Point it at mock_plex_server.py
+// to reproduce a library size, latency and bandwidth on a desktop.
+
+#include <borealis.hpp>
+
+#include "core/bandwidth_estimator.hpp"
+#include "core/plex_api.hpp"
+#include "core/plex_server.hpp"
+#include "util/trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string server = "http://127.0.0.1:32400";
+    std::string token;
+    int runs = 1;
+    int concurrency = 4;
+    int pages = 3;
+    int pageSize = 50;
+    int details = 10;  // items per page opened in detail
+    int timeoutSec = 300;
+    bool verbose = false;
+    std::string trace;  // Chrome trace output, with SAFFRON_TRACE
+};
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--server URL] [--token TOKEN] [--runs N] [--concurrency N]\n"
+            "          [--pages N] [--page-size N] [--details N] [--timeout SEC] [--trace FILE] [--verbose]\n",
+            argv0);
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&](int& target) {
+            if (i + 1 >= argc) return false;
+            target = atoi(argv[++i]);
+            return true;
+        };
+        bool ok = true;
+        if (arg == "--server" && i + 1 < argc) options.server = argv[++i];
+        else if (arg == "--token" && i + 1 < argc) options.token = argv[++i];
+        else if (arg == "--runs") ok = next(options.runs);
+        else if (arg == "--concurrency") ok = next(options.concurrency);
+        else if (arg == "--pages") ok = next(options.pages);
+        else if (arg == "--page-size") ok = next(options.pageSize);
+        else if (arg == "--details") ok = next(options.details);
+        else if (arg == "--timeout") ok = next(options.timeoutSec);
+        else if (arg == "--trace" && i + 1 < argc) options.trace = argv[++i];
+        else if (arg == "--verbose") options.verbose = true;
+        else ok = false;
+        if (!ok) return false;
+    }
+    options.concurrency = std::max(1, options.concurrency);
+    return true;
+}
+
+// Splits http[s]://host[:port] into the fields PlexServer keeps
+bool configureServer(PlexServer& server, const std::string& url) {
+    std::string rest = url;
+    bool https = false;
+    if (rest.rfind("https://", 0) == 0) {
+        https = true;
+        rest = rest.substr(8);
+    } else if (rest.rfind("http://", 0) == 0) {
+        rest = rest.substr(7);
+    }
+    while (!rest.empty() && rest.back() == '/') rest.pop_back();
+    if (rest.empty()) return false;
+
+    int port = https ? 443 : 32400;
+    size_t colon = rest.rfind(':');
+    if (colon != std::string::npos) {
+        port = atoi(rest.c_str() + colon + 1);
+        rest = rest.substr(0, colon);
+    }
+
+    server.setAddress(rest);
+    server.setPort(port);
+    server.setHttps(https);
+    server.setReachable(true);
+    return port > 0;
+}
+
+// Keeps up to `limit` requests in flight. Everything here runs on the
+// main loop, like the views that issue these calls in the app.
+class Driver {
+public:
+    using Done = std::function<void()>;
+    using Job = std::function<void(Done)>;
+
+    explicit Driver(int limit) : m_limit(limit) {}
+
+    // `name` groups the call in the report; the job calls done() once
+    void submit(const std::string& name, Job job) {
+        m_queue.push_back({name, std::move(job)});
+        startMore();
+    }
+
+    bool idle() const { return m_queue.empty() && m_inFlight == 0; }
+
+    int failures() const { return m_failures; }
+    void fail(const std::string& name, const std::string& error) {
+        m_failures++;
+        brls::Logger::warning("{} failed: {}", name, error);
+    }
+
+    void report(double wallSeconds, uint64_t bytes) const {
+        printf("%-14s %7s %9s %9s %9s %9s\n", "call", "count", "p50 ms", "p95 ms", "max ms", "mean ms");
+        for (const auto& entry : m_latencies) {
+            std::vector<double> values = entry.second;
+            std::sort(values.begin(), values.end());
+            double sum = 0;
+            for (double v : values) sum += v;
+            printf("%-14s %7zu %9.1f %9.1f %9.1f %9.1f\n", entry.first.c_str(), values.size(),
+                   percentile(values, 0.50), percentile(values, 0.95), values.back(), sum / values.size());
+        }
+        printf("\n%d calls, %d failed, %.2f s, %.1f calls/s, %.2f MB received\n", m_completed, m_failures,
+               wallSeconds, wallSeconds > 0 ? m_completed / wallSeconds : 0.0, bytes / (1024.0 * 1024.0));
+    }
+
+private:
+    struct Pending {
+        std::string name;
+        Job job;
+    };
+
+    // Nearest rank
+    static double percentile(const std::vector<double>& sorted, double p) {
+        size_t rank = static_cast<size_t>(p * sorted.size() + 0.999999);
+        return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    void startMore() {
+        while (m_inFlight < m_limit && !m_queue.empty()) {
+            Pending next = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_inFlight++;
+
+            Clock::time_point started = Clock::now();
+            std::string name = next.name;
+            next.job([this, name, started]() {
+                double ms = std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+                m_latencies[name].push_back(ms);
+                m_completed++;
+                m_inFlight--;
+                startMore();
+            });
+        }
+    }
+
+    int m_limit;
+    int m_inFlight = 0;
+    int m_completed = 0;
+    int m_failures = 0;
+    std::deque<Pending> m_queue;
+    std::map<std::string, std::vector<double>> m_latencies;
+};
+
+void browseSection(Driver& driver, PlexServer* server, const Options& options, const plex::Library& library) {
+    for (int page = 0; page < options.pages; page++) {
+        int start = page * options.pageSize;
+        driver.submit("items", [&driver, server, &options, start, library](Driver::Done done) {
+            PlexApi::getLibraryItems(server, library.key, start, options.pageSize,
+                [&driver, server, &options, done](std::vector<plex::MediaItem> items, int) {
+                    int opened = 0;
+                    for (const auto& item : items) {
+                        if (opened++ >= options.details) break;
+                        int ratingKey = item.ratingKey;
+                        driver.submit("metadata", [&driver, server, ratingKey](Driver::Done done) {
+                            PlexApi::getMetadata(server, ratingKey,
+                                [done](plex::MediaItem) { done(); },
+                                [&driver, done](const std::string& error) { driver.fail("metadata", error); done(); });
+                        });
+                        if (item.mediaType == plex::MediaType::Show) {
+                            driver.submit("children", [&driver, server, ratingKey](Driver::Done done) {
+                                PlexApi::getChildren(server, ratingKey,
+                                    [done](std::vector<plex::MediaItem>) { done(); },
+                                    [&driver, done](const std::string& error) { driver.fail("children", error); done(); });
+                            });
+                        }
+                    }
+                    // One playback decision per page, as if the first title were played
+                    if (!items.empty() && items.front().mediaType == plex::MediaType::Movie) {
+                        int ratingKey = items.front().ratingKey;
+                        driver.submit("decision", [&driver, server, ratingKey](Driver::Done done) {
+                            PlexApi::getPlaybackDecision(server, ratingKey, 0, "", false, 0, 0,
+                                [done](plex::PlaybackInfo) { done(); },
+                                [&driver, done](const std::string& error) { driver.fail("decision", error); done(); });
+                        });
+                    }
+                    done();
+                },
+                [&driver, done](const std::string& error) { driver.fail("items", error); done(); });
+        });
+    }
+}
+
+void runScenario(Driver& driver, PlexServer* server, const Options& options) {
+    driver.submit("sections", [&driver, server, &options](Driver::Done done) {
+        PlexApi::getLibrarySections(server,
+            [&driver, server, &options, done](std::vector<plex::Library> libraries) {
+                for (const auto& library : libraries) browseSection(driver, server, options, library);
+                done();
+            },
+            [&driver, done](const std::string& error) { driver.fail("sections", error); done(); });
+    });
+    driver.submit("hubs", [&driver, server](Driver::Done done) {
+        PlexApi::getHubs(server,
+            [done](std::vector<plex::Hub>) { done(); },
+            [&driver, done](const std::string& error) { driver.fail("hubs", error); done(); });
+    });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage(argv[0]);
+        return 2;
+    }
+    brls::Logger::setLogLevel(options.verbose ? brls::LogLevel::LOG_DEBUG : brls::LogLevel::LOG_WARNING);
+    trace::setThreadName("main");
+
+    PlexServer server("host-driver");
+    if (!configureServer(server, options.server)) {
+        fprintf(stderr, "invalid server url: %s\n", options.server.c_str());
+        return 2;
+    }
+    server.setAccessToken(options.token);
+
+    // One worker per request in flight, so the pool is not the bottleneck
+    brls::host::setWorkerCount(options.concurrency);
+
+    Driver driver(options.concurrency);
+    uint64_t bytesBefore = PlexApi::getBytesReceived();
+    Clock::time_point started = Clock::now();
+
+    for (int run = 0; run < options.runs; run++) runScenario(driver, &server, options);
+    bool finished = brls::host::runUntil([&driver]() { return driver.idle(); },
+                                         std::chrono::seconds(options.timeoutSec));
+
+    double wallSeconds = std::chrono::duration<double>(Clock::now() - started).count();
+    driver.report(wallSeconds, PlexApi::getBytesReceived() - bytesBefore);
+
+    std::string baseUrl = server.getBaseUrl();
+    BandwidthEstimator* estimator = BandwidthEstimator::getInstance();
+    printf("estimated link: %d kbps, rtt %d ms\n", estimator->getThroughputKbps(baseUrl),
+           estimator->getRttMs(baseUrl));
+
+    if (!options.trace.empty()) {
+        if (trace::dump(options.trace)) {
+            printf("trace written to %s\n", options.trace.c_str());
+        } else {
+            fprintf(stderr, "trace not written to %s (needs -DSAFFRON_TRACE=ON)\n", options.trace.c_str());
+        }
+    }
+
+    if (!finished) {
+        // Workers still blocked in curl cannot be joined; leave without unwinding
+        fprintf(stderr, "timed out with requests still in flight\n");
+        fflush(stdout);
+        std::_Exit(1);
+    }
+    brls::host::shutdown();
+    return driver.failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,446 @@
+// Times JSON parsing and model mapping (plex::from_json) of responses
+// shaped like a real server's, and counts heap allocations per item, so
+// parser and mapper changes can be compared by numbers:
+//
+//   ./saffron-parse-bench                      # built-in cases
+//   ./saffron-parse-bench --fixture page.json  # a recorded MediaContainer
+//
+// Parse is nlohmann::json::parse of the body; map is the from_json loop
+// PlexApi runs on the parsed document. Gen is the same body read into the
+// models generated from the OpenAPI spec, which do both in one pass.
+
+#include "models/plex_schema.hpp"
+#include "models/plex_types.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+
+}  // namespace
+
+// Every replaceable form is routed through one counted malloc/free pair so
+// aligned allocations are counted too. GCC matches new against delete when
+// it inlines these and flags the free() as a mismatch, which it is not here.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+namespace {
+
+void* countedAlloc(size_t size, size_t alignment) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    void* p = nullptr;
+    if (alignment <= alignof(std::max_align_t)) {
+        p = malloc(size);
+    } else {
+        // aligned_alloc wants a multiple of the alignment
+        p = aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    return countedAlloc(size, 0);
+}
+
+void* operator new[](size_t size) {
+    return countedAlloc(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return countedAlloc(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return countedAlloc(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept {
+    free(p);
+}
+
+#pragma GCC diagnostic pop
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using json = nlohmann::json;
+
+const char* const GENRES[] = {"Action", "Comedy", "Drama", "Documentary", "Horror", "Science Fiction"};
+
+json stream(int id, int type, int index, const std::string& codec, const std::string& language) {
+    json s = {
+        {"id", id}, {"streamType", type}, {"codec", codec}, {"index", index},
+        {"language", language}, {"languageCode", language.substr(0, 3)},
+        {"displayTitle", language + " (" + codec + ")"},
+        {"extendedDisplayTitle", language + " (" + codec + " " + std::to_string(index) + ")"},
+    };
+    if (type == 1) {
+        s.update({{"bitrate", 19500}, {"bitDepth", 10}, {"chromaLocation", "left"},
+                  {"chromaSubsampling", "4:2:0"}, {"codedHeight", 1608}, {"codedWidth", 3840},
+                  {"colorPrimaries", "bt2020"}, {"colorRange", "tv"}, {"colorSpace", "bt2020nc"},
+                  {"colorTrc", "smpte2084"}, {"frameRate", 23.976}, {"height", 1600}, {"width", 3840},
+                  {"level", 150}, {"profile", "main 10"}, {"refFrames", 1}, {"default", true}});
+    } else if (type == 2) {
+        s.update({{"bitrate", 640}, {"channels", 6}, {"audioChannelLayout", "5.1(side)"},
+                  {"samplingRate", 48000}, {"selected", index == 1}, {"default", index == 1}});
+    } else {
+        s.update({{"forced", false}, {"title", "SDH"}});
+        if (index % 3 == 0) s["key"] = "/library/streams/" + std::to_string(id);
+    }
+    return s;
+}
+
+json media(int id, int streams) {
+    json part = {
+        {"id", id}, {"key", "/library/parts/" + std::to_string(id) + "/1700000000/file.mkv"},
+        {"duration", 7260000}, {"file", "/media/movies/Title " + std::to_string(id) + "/Title.mkv"},
+        {"size", int64_t(18234567890)}, {"audioProfile", "dts"}, {"container", "mkv"},
+        {"videoProfile", "main 10"}, {"indexes", "sd"}, {"has64bitOffsets", false},
+    };
+    if (streams > 0) {
+        json list = json::array();
+        const char* languages[] = {"English", "French", "German", "Spanish", "Japanese", "Italian"};
+        for (int i = 0; i < streams; i++) {
+            int type = i == 0 ? 1 : (i <= streams / 4 ? 2 : 3);
+            list.push_back(stream(id * 100 + i, type, i, type == 1 ? "hevc" : (type == 2 ? "eac3" : "srt"),
+                                  languages[i % 6]));
+        }
+        part["Stream"] = list;
+    }
+    return {
+        {"id", id}, {"duration", 7260000}, {"bitrate", 21000}, {"width", 3840}, {"height", 1600},
+        {"aspectRatio", 2.35}, {"audioChannels", 6}, {"audioCodec", "eac3"}, {"videoCodec", "hevc"},
+        {"videoResolution", "4k"}, {"container", "mkv"}, {"videoFrameRate", "24p"},
+        {"audioProfile", "dts"}, {"videoProfile", "main 10"}, {"has64bitOffsets", false},
+        {"Part", json::array({part})},
+    };
+}
+
+// A movie as /library/sections/{id}/all lists it, unknown fields included
+json libraryItem(int key) {
+    json item = {
+        {"ratingKey", std::to_string(key)}, {"key", "/library/metadata/" + std::to_string(key)},
+        {"guid", "plex://movie/5d7768" + std::to_string(100000 + key)},
+        {"slug", "title-" + std::to_string(key)}, {"studio", "Example Pictures"}, {"type", "movie"},
+        {"title", "Title " + std::to_string(key)}, {"titleSort", "Title " + std::to_string(key)},
+        {"librarySectionTitle", "Movies"}, {"librarySectionID", 1}, {"librarySectionKey", "/library/sections/1"},
+        {"contentRating", "PG-13"},
+        {"summary", "A long summary of the film that runs to a couple of sentences, as Plex listings "
+                    "include it for every item whether or not the client shows it."},
+        {"rating", 7.4}, {"audienceRating", 8.1}, {"viewCount", key % 3}, {"lastViewedAt", 1710000000 + key},
+        {"year", 1980 + key % 45}, {"tagline", "Every story has a beginning."},
+        {"thumb", "/library/metadata/" + std::to_string(key) + "/thumb/1700000000"},
+        {"art", "/library/metadata/" + std::to_string(key) + "/art/1700000000"},
+        {"duration", 7260000}, {"originallyAvailableAt", "2014-11-05"},
+        {"addedAt", 1700000000 + key}, {"updatedAt", 1700000000 + key},
+        {"audienceRatingImage", "rottentomatoes://image.rating.upright"},
+        {"chapterSource", "media"}, {"primaryExtraKey", "/library/metadata/" + std::to_string(key + 1)},
+        {"ratingImage", "rottentomatoes://image.rating.ripe"},
+        {"Image", json::array({
+            {{"alt", "Title"}, {"type", "coverPoster"}, {"url", "/library/metadata/1/thumb/1"}},
+            {{"alt", "Title"}, {"type", "background"}, {"url", "/library/metadata/1/art/1"}},
+        })},
+        {"UltraBlurColors", {{"topLeft", "5c3d2a"}, {"topRight", "8a5b38"}, {"bottomRight", "2b1c14"},
+                             {"bottomLeft", "1a120d"}}},
+        {"Media", json::array({media(key, 0)})},
+        {"Genre", json::array({{{"tag", GENRES[key % 6]}}, {{"tag", GENRES[(key + 1) % 6]}}})},
+        {"Country", json::array({{{"tag", "United States of America"}}})},
+        {"Director", json::array({{{"tag", "Director " + std::to_string(key % 50)}}})},
+        {"Writer", json::array({{{"tag", "Writer " + std::to_string(key % 70)}}})},
+        {"Role", json::array({{{"tag", "Actor A"}}, {{"tag", "Actor B"}}, {{"tag", "Actor C"}}})},
+    };
+    if (key % 4 == 0) item["viewOffset"] = 1200000;
+    return item;
+}
+
+json libraryPage(int count) {
+    json items = json::array();
+    for (int i = 0; i < count; i++) items.push_back(libraryItem(1000 + i));
+    return {{"MediaContainer", {
+        {"size", count}, {"totalSize", 25000}, {"offset", 0}, {"allowSync", true},
+        {"art", "/:/resources/movie-fanart.jpg"}, {"identifier", "com.plexapp.plugins.library"},
+        {"librarySectionID", 1}, {"librarySectionTitle", "Movies"}, {"viewGroup", "movie"},
+        {"Metadata", items},
+    }}};
+}
+
+json hubs() {
+    json list = json::array();
+    const char* identifiers[] = {"home.continue", "home.ondeck", "movie.recentlyadded.1", "tv.recentlyadded.2",
+                                 "movie.recentlyreleased.1", "movie.genre.1", "movie.toprated.1",
+                                 "movie.by.actor.1", "home.playlists", "movie.recentlyviewed.1"};
+    int key = 5000;
+    for (const char* identifier : identifiers) {
+        json items = json::array();
+        for (int i = 0; i < 20; i++) items.push_back(libraryItem(key++));
+        list.push_back({
+            {"hubKey", std::string("/hubs/") + identifier}, {"key", std::string("/hubs/") + identifier},
+            {"title", identifier}, {"type", "movie"}, {"hubIdentifier", identifier},
+            {"context", "hub.movie"}, {"size", 20}, {"more", true}, {"style", "shelf"},
+            {"promoted", true}, {"Metadata", items},
+        });
+    }
+    json directories = json::array();
+    for (int i = 0; i < 20; i++) {
+        directories.push_back({{"id", 300 + i}, {"tag", "Actor " + std::to_string(i)},
+                               {"thumb", "/people/" + std::to_string(i) + ".jpg"}, {"librarySectionID", 1}});
+    }
+    list.push_back({{"hubKey", "/hubs/people"}, {"title", "Cast"}, {"type", "person"},
+                    {"hubIdentifier", "movie.cast.1"}, {"size", 20}, {"Directory", directories}});
+    return {{"MediaContainer", {{"size", list.size()}, {"allowSync", true}, {"Hub", list}}}};
+}
+
+// A detailed item with several versions and many tracks, as returned for
+// a playback decision
+json decision() {
+    json item = libraryItem(42);
+    item["Media"] = json::array({media(4201, 48), media(4202, 48), media(4203, 32)});
+    json roles = json::array();
+    for (int i = 0; i < 40; i++) {
+        roles.push_back({{"id", 700 + i}, {"tag", "Actor " + std::to_string(i)},
+                         {"role", "Character " + std::to_string(i)},
+                         {"thumb", "https://metadata-static.plex.tv/people/" + std::to_string(i) + ".jpg"}});
+    }
+    item["Role"] = roles;
+    return {{"MediaContainer", {
+        {"size", 1}, {"allowSync", true}, {"generalDecisionCode", 1000},
+        {"generalDecisionText", "Direct play OK."}, {"directPlayDecisionCode", 1000},
+        {"directPlayDecisionText", "Direct play OK."}, {"transcodeDecisionCode", 1001},
+        {"transcodeDecisionText", "Direct play OK."}, {"Metadata", json::array({item})},
+    }}};
+}
+
+// The same mapping loops PlexApi runs on each response; returns items mapped
+using Mapper = std::function<size_t(const json&)>;
+
+size_t mapMetadata(const json& document) {
+    std::vector<plex::MediaItem> items;
+    const auto& mc = document["MediaContainer"];
+    if (mc.contains("Metadata")) {
+        for (const auto& meta : mc["Metadata"]) {
+            plex::MediaItem item;
+            plex::from_json(meta, item);
+            items.push_back(item);
+        }
+    }
+    return items.size();
+}
+
+size_t mapHubs(const json& document) {
+    std::vector<plex::Hub> list;
+    size_t count = 0;
+    for (const auto& hubJson : document["MediaContainer"]["Hub"]) {
+        plex::Hub hub;
+        plex::from_json(hubJson, hub);
+        count += hub.items.size();
+        list.push_back(hub);
+    }
+    return count;
+}
+
+// The generated path; documents are reused across iterations, as a view
+// reloading its page would, so their buffers are warm
+using Generated = std::function<size_t(const std::string&)>;
+
+size_t generatedMetadata(const std::string& body) {
+    static plex::schema::Document<plex::schema::MetadataPage> document;
+    if (!document.parse(body)) return 0;
+    return document.root().mediaContainer.metadata.size();
+}
+
+size_t generatedHubs(const std::string& body) {
+    static plex::schema::Document<plex::schema::HubPage> document;
+    if (!document.parse(body)) return 0;
+    size_t count = 0;
+    for (const auto& hub : document.root().mediaContainer.hub) {
+        count += hub.metadata.size() + hub.directory.size();
+    }
+    return count;
+}
+
+size_t generatedDecision(const std::string& body) {
+    static plex::schema::Document<plex::schema::DecisionPage> document;
+    if (!document.parse(body)) return 0;
+    return document.root().mediaContainer.metadata.size();
+}
+
+struct Case {
+    std::string name;
+    std::string body;
+    Mapper map;
+    Generated generated;
+};
+
+struct Result {
+    size_t items = 0;
+    int iterations = 0;
+    double parseUs = 0;  // per iteration
+    double mapUs = 0;
+    double parseAllocs = 0;  // per iteration
+    double mapAllocs = 0;
+    size_t generatedItems = 0;
+    double generatedUs = 0;
+    double generatedAllocs = 0;
+};
+
+Result run(const Case& c, double minSeconds, int minIterations) {
+    Result result;
+    double parseSeconds = 0;
+    double mapSeconds = 0;
+    uint64_t parseAllocs = 0;
+    uint64_t mapAllocs = 0;
+
+    Clock::time_point began = Clock::now();
+    while (result.iterations < minIterations ||
+           std::chrono::duration<double>(Clock::now() - began).count() < minSeconds) {
+        uint64_t before = g_allocations.load(std::memory_order_relaxed);
+        Clock::time_point t0 = Clock::now();
+        json document = json::parse(c.body);
+        Clock::time_point t1 = Clock::now();
+        uint64_t parsed = g_allocations.load(std::memory_order_relaxed);
+        result.items = c.map(document);
+        Clock::time_point t2 = Clock::now();
+        uint64_t mapped = g_allocations.load(std::memory_order_relaxed);
+
+        parseSeconds += std::chrono::duration<double>(t1 - t0).count();
+        mapSeconds += std::chrono::duration<double>(t2 - t1).count();
+        parseAllocs += parsed - before;
+        mapAllocs += mapped - parsed;
+        result.iterations++;
+    }
+
+    result.parseUs = parseSeconds * 1e6 / result.iterations;
+    result.mapUs = mapSeconds * 1e6 / result.iterations;
+    result.parseAllocs = static_cast<double>(parseAllocs) / result.iterations;
+    result.mapAllocs = static_cast<double>(mapAllocs) / result.iterations;
+
+    // One untimed pass to size the document's buffers
+    c.generated(c.body);
+    double generatedSeconds = 0;
+    uint64_t generatedAllocs = 0;
+    int iterations = 0;
+    began = Clock::now();
+    while (iterations < minIterations || std::chrono::duration<double>(Clock::now() - began).count() < minSeconds) {
+        uint64_t before = g_allocations.load(std::memory_order_relaxed);
+        Clock::time_point t0 = Clock::now();
+        result.generatedItems = c.generated(c.body);
+        Clock::time_point t1 = Clock::now();
+        generatedSeconds += std::chrono::duration<double>(t1 - t0).count();
+        generatedAllocs += g_allocations.load(std::memory_order_relaxed) - before;
+        iterations++;
+    }
+    result.generatedUs = generatedSeconds * 1e6 / iterations;
+    result.generatedAllocs = static_cast<double>(generatedAllocs) / iterations;
+    return result;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    double minSeconds = 1.0;
+    int minIterations = 5;
+    std::vector<Case> cases;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--seconds" && i + 1 < argc) {
+            minSeconds = atof(argv[++i]);
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            minIterations = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--fixture" && i + 1 < argc) {
+            std::string path = argv[++i];
+            std::string body = readFile(path);
+            if (body.empty()) {
+                fprintf(stderr, "cannot read %s\n", path.c_str());
+                return 2;
+            }
+            bool isHubs = json::parse(body)["MediaContainer"].contains("Hub");
+            cases.push_back({path, body, isHubs ? Mapper(mapHubs) : Mapper(mapMetadata),
+                             isHubs ? Generated(generatedHubs) : Generated(generatedMetadata)});
+        } else {
+            fprintf(stderr, "usage: %s [--seconds S] [--iterations N] [--fixture FILE]...\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (cases.empty()) {
+        cases.push_back({"page-100", libraryPage(100).dump(), mapMetadata, generatedMetadata});
+        cases.push_back({"page-1000", libraryPage(1000).dump(), mapMetadata, generatedMetadata});
+        cases.push_back({"hubs", hubs().dump(), mapHubs, generatedHubs});
+        cases.push_back({"decision", decision().dump(), mapMetadata, generatedDecision});
+    }
+
+    printf("%-12s %6s %9s %6s %10s %10s %12s %12s %12s %10s %12s %10s %8s\n", "case", "items", "bytes", "iters",
+           "parse us", "map us", "items/s", "parse a/item", "map a/item", "gen us", "gen items/s", "gen a/item",
+           "speedup");
+    int status = 0;
+    for (const auto& c : cases) {
+        Result r = run(c, minSeconds, minIterations);
+        double perItem = r.items > 0 ? static_cast<double>(r.items) : 1.0;
+        double itemsPerSecond = perItem * 1e6 / (r.parseUs + r.mapUs);
+        printf("%-12s %6zu %9zu %6d %10.1f %10.1f %12.0f %12.1f %12.1f %10.1f %12.0f %10.2f %7.1fx\n",
+               c.name.c_str(), r.items, c.body.size(), r.iterations, r.parseUs, r.mapUs, itemsPerSecond,
+               r.parseAllocs / perItem, r.mapAllocs / perItem, r.generatedUs, perItem * 1e6 / r.generatedUs,
+               r.generatedAllocs / perItem, (r.parseUs + r.mapUs) / r.generatedUs);
+        if (r.generatedItems != r.items) {
+            fprintf(stderr, "%s: generated models read %zu items, from_json %zu\n", c.name.c_str(),
+                    r.generatedItems, r.items);
+            status = 1;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,221 @@
+// Sequential and post-seek read throughput of RangeStream against a plain
+// single GET, opened through the stream callbacks as mpv would open them:
+//
+//   python3 host/mock_plex_server.py --part-mb 64 --bandwidth-kbps 40000 &
+//   ./saffron-range-bench
+//   ./saffron-range-bench --url http://plex:32400/library/parts/1/file.mkv?X-Plex-Token=T
+//
+// Every read is compared byte for byte with the single GET. With
+// --error-rate on the mock server, failed chunks show up as retries in the
+// log and a read only fails once a chunk has exhausted its attempts.
+//
+// --disk-mb N adds the SD card ring: one stream reads the file into it,
+// and a fresh stream then rewinds into the file, which must come from the
+// ring.
+
+#include <borealis.hpp>
+
+#include "core/chunk_ring.hpp"
+#include "core/range_stream.hpp"
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string url = "http://127.0.0.1:32400/library/parts/1/file.mkv";
+    std::vector<int> connections = {1, 2, 4, 6};
+    size_t readSize = 128 * 1024;
+    int diskMb = 0;
+};
+
+void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [--url URL] [--connections 1,2,4,6] [--read-kb N] [--disk-mb N]\n", argv0);
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--url" && hasValue) options.url = argv[++i];
+        else if (arg == "--connections" && hasValue) {
+            options.connections.clear();
+            std::stringstream list(argv[++i]);
+            std::string count;
+            while (std::getline(list, count, ',')) {
+                if (atoi(count.c_str()) <= 0) return false;
+                options.connections.push_back(atoi(count.c_str()));
+            }
+        }
+        else if (arg == "--read-kb" && hasValue) options.readSize = static_cast<size_t>(std::max(1, atoi(argv[++i]))) * 1024;
+        else if (arg == "--disk-mb" && hasValue) options.diskMb = std::max(0, atoi(argv[++i]));
+        else return false;
+    }
+    return !options.connections.empty();
+}
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double mbits(size_t bytes, double seconds) {
+    return seconds > 0 ? bytes * 8.0 / 1e6 / seconds : 0.0;
+}
+
+size_t appendBody(char* ptr, size_t size, size_t nmemb, void* userdata) {
+    static_cast<std::string*>(userdata)->append(ptr, size * nmemb);
+    return size * nmemb;
+}
+
+bool singleGet(const std::string& url, std::string& body) {
+    CURL* curl = curl_easy_init();
+    if (!curl) return false;
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, appendBody);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    CURLcode res = curl_easy_perform(curl);
+    long httpCode = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+    curl_easy_cleanup(curl);
+    return res == CURLE_OK && httpCode == 200;
+}
+
+// Reads [offset, offset + length) and checks it against the reference body
+bool readRange(const mpv_stream_cb_info& info, int64_t offset, int64_t length, const std::string& reference,
+               size_t readSize) {
+    if (info.seek_fn(info.cookie, offset) != offset) return false;
+    std::vector<char> buffer(readSize);
+    int64_t position = offset;
+    while (position < offset + length) {
+        int64_t want = std::min<int64_t>(static_cast<int64_t>(readSize), offset + length - position);
+        int64_t got = info.read_fn(info.cookie, buffer.data(), static_cast<uint64_t>(want));
+        if (got <= 0) return false;
+        if (reference.compare(static_cast<size_t>(position), static_cast<size_t>(got), buffer.data(),
+                              static_cast<size_t>(got)) != 0) {
+            fprintf(stderr, "data mismatch at %lld\n", static_cast<long long>(position));
+            return false;
+        }
+        position += got;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage(argv[0]);
+        return 2;
+    }
+    brls::Logger::setLogLevel(brls::LogLevel::LOG_WARNING);
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    RangeStream::registerProtocol(nullptr);
+
+    // The reference read is retried too, for a mock server injecting errors
+    std::string reference;
+    Clock::time_point start;
+    bool fetched = false;
+    for (int attempt = 0; attempt < 3 && !fetched; attempt++) {
+        reference.clear();
+        start = Clock::now();
+        fetched = singleGet(options.url, reference) && !reference.empty();
+    }
+    if (!fetched) {
+        fprintf(stderr, "cannot fetch %s\n", options.url.c_str());
+        return 2;
+    }
+    double single = secondsSince(start);
+    int64_t size = static_cast<int64_t>(reference.size());
+    printf("%.1f MB, read %zu KB at a time\n\n", size / 1e6, options.readSize / 1024);
+    printf("%-18s %12s %16s\n", "", "sequential", "first MB at 3/4");
+    printf("%-18s %7.1f Mbit/s %16s\n", "single GET", mbits(reference.size(), single), "-");
+
+    int failures = 0;
+    for (int connections : options.connections) {
+        RangeStream::setConnectionCount(connections);
+
+        mpv_stream_cb_info info = {};
+        start = Clock::now();
+        bool ok = mpv_host_stream_open(RangeStream::wrapUrl(options.url), &info) == 0 &&
+                  info.size_fn(info.cookie) == size &&
+                  readRange(info, 0, size, reference, options.readSize);
+        double sequential = secondsSince(start);
+
+        // Back from the end of a file larger than the window, the seek lands
+        // outside it; time until its first chunk is read
+        double seek = 0;
+        if (ok) {
+            int64_t target = size * 3 / 4;
+            start = Clock::now();
+            ok = readRange(info, target, std::min<int64_t>(1024 * 1024, size - target), reference, options.readSize);
+            seek = secondsSince(start);
+        }
+        if (info.close_fn) info.close_fn(info.cookie);
+
+        std::string label = "RangeStream x" + std::to_string(connections);
+        if (ok) {
+            printf("%-18s %7.1f Mbit/s %13.0f ms\n", label.c_str(), mbits(reference.size(), sequential), seek * 1000);
+        } else {
+            printf("%-18s %12s\n", label.c_str(), "FAILED");
+            failures++;
+        }
+    }
+
+    // The rewind a player makes once mpv's own back-buffer is gone: every
+    // chunk must be read back from the card, not fetched again
+    const char* ringDir = "range-bench-ring";
+    if (options.diskMb > 0) {
+        mkdir(ringDir, 0755);
+        RangeStream::setDiskCache(ringDir, static_cast<int64_t>(options.diskMb) * 1024 * 1024);
+    }
+    std::shared_ptr<ChunkRing> ring = RangeStream::getDiskCache();
+    if (ring) {
+        RangeStream::setConnectionCount(options.connections.back());
+        mpv_stream_cb_info info = {};
+        bool ok = mpv_host_stream_open(RangeStream::wrapUrl(options.url), &info) == 0 &&
+                  readRange(info, 0, size, reference, options.readSize);
+        if (info.close_fn) info.close_fn(info.cookie);
+
+        info = {};
+        int64_t target = size / 4;
+        int64_t length = std::min<int64_t>(4 * 1024 * 1024, size - target);
+        uint64_t hitsBefore = ring->getHits();
+        start = Clock::now();
+        ok = ok && mpv_host_stream_open(RangeStream::wrapUrl(options.url), &info) == 0 &&
+             readRange(info, target, length, reference, options.readSize);
+        double rewind = secondsSince(start);
+        if (info.close_fn) info.close_fn(info.cookie);
+
+        // The stream may read ahead of the range, so at least every chunk of it
+        uint64_t hits = ring->getHits() - hitsBefore;
+        uint64_t wanted = static_cast<uint64_t>((length + 1024 * 1024 - 1) / (1024 * 1024));
+        if (ok && hits >= wanted) {
+            printf("%-18s %12s %13.0f ms (%llu chunks from the card)\n", "SD ring rewind", "-", rewind * 1000,
+                   static_cast<unsigned long long>(hits));
+        } else {
+            printf("%-18s %12s (%llu of %llu chunks from the card)\n", "SD ring rewind", "FAILED",
+                   static_cast<unsigned long long>(hits), static_cast<unsigned long long>(wanted));
+            failures++;
+        }
+        ring.reset();
+        RangeStream::setDiskCache("", 0);
+        rmdir(ringDir);
+    }
+
+    curl_global_cleanup();
+    return failures > 0 ? 1 : 0;
+}
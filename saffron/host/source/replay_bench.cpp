@@ -0,0 +1,313 @@
+// Times a fixed navigation script end to end against a recorded server, so
+// a slow hub or pagination seen on one server can be reproduced anywhere:
+//
+//   ./saffron-replay-bench --server http://plex:32400 --token T --record nav.spxr
+//   ./saffron-replay-bench --replay nav.spxr                  # recorded latency
+//   ./saffron-replay-bench --replay nav.spxr --latency zero   # client time only
+//   ./saffron-replay-bench --replay nav.spxr --latency 0.5    # half the latency
+//
+// The script follows a user through the app: home (hubs), opening the first
+// movie section (sections, first page), scrolling through further pages,
+// opening an item's details and asking for its playback decision. Each step
+// waits for the previous one, as the views do, so its time is what the user
+// would wait. Archives recorded by the app (switch/saffron/recordings) can
+// be replayed too; steps that were not browsed there fail as not recorded.
+
+#include <borealis.hpp>
+
+#include "core/http_recorder.hpp"
+#include "core/plex_api.hpp"
+#include "core/plex_server.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string server = "http://127.0.0.1:32400";
+    std::string token;
+    std::string record;
+    std::string replay;
+    HttpRecorder::Latency latency = HttpRecorder::Latency::Original;
+    double scale = 1.0;
+    int runs = 5;
+    int pages = 5;
+    int pageSize = 50;
+    int timeoutSec = 120;
+};
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s (--record FILE [--server URL] [--token TOKEN] | --replay FILE [--latency original|zero|FACTOR])\n"
+            "          [--runs N] [--pages N] [--page-size N] [--timeout SEC]\n",
+            argv0);
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--server" && hasValue) options.server = argv[++i];
+        else if (arg == "--token" && hasValue) options.token = argv[++i];
+        else if (arg == "--record" && hasValue) options.record = argv[++i];
+        else if (arg == "--replay" && hasValue) options.replay = argv[++i];
+        else if (arg == "--latency" && hasValue) {
+            std::string value = argv[++i];
+            if (value == "original") {
+                options.latency = HttpRecorder::Latency::Original;
+            } else if (value == "zero") {
+                options.latency = HttpRecorder::Latency::Zero;
+            } else {
+                options.latency = HttpRecorder::Latency::Scaled;
+                options.scale = atof(value.c_str());
+                if (options.scale <= 0) return false;
+            }
+        }
+        else if (arg == "--runs" && hasValue) options.runs = atoi(argv[++i]);
+        else if (arg == "--pages" && hasValue) options.pages = atoi(argv[++i]);
+        else if (arg == "--page-size" && hasValue) options.pageSize = atoi(argv[++i]);
+        else if (arg == "--timeout" && hasValue) options.timeoutSec = atoi(argv[++i]);
+        else return false;
+    }
+    options.runs = std::max(1, options.runs);
+    options.pageSize = std::max(1, options.pageSize);
+    return options.record.empty() != options.replay.empty();
+}
+
+// Splits http[s]://host[:port] into the fields PlexServer keeps
+bool configureServer(PlexServer& server, const std::string& url) {
+    std::string rest = url;
+    bool https = false;
+    if (rest.rfind("https://", 0) == 0) {
+        https = true;
+        rest = rest.substr(8);
+    } else if (rest.rfind("http://", 0) == 0) {
+        rest = rest.substr(7);
+    }
+    while (!rest.empty() && rest.back() == '/') rest.pop_back();
+    if (rest.empty()) return false;
+
+    int port = https ? 443 : 32400;
+    size_t colon = rest.rfind(':');
+    if (colon != std::string::npos) {
+        port = atoi(rest.c_str() + colon + 1);
+        rest = rest.substr(0, colon);
+    }
+
+    server.setAddress(rest);
+    server.setPort(port);
+    server.setHttps(https);
+    server.setReachable(true);
+    return port > 0;
+}
+
+// Runs the steps one after another on the main loop; a step calls next()
+// when the view it stands for would be filled in
+class Script {
+public:
+    using Next = std::function<void()>;
+    using Step = std::function<void(Next)>;
+
+    void add(const std::string& name, Step step) { m_steps.push_back({name, std::move(step)}); }
+
+    void start() {
+        m_index = 0;
+        runNext();
+    }
+
+    bool finished() const { return m_index >= m_steps.size(); }
+
+    void fail(const std::string& name, const std::string& error) {
+        m_failures++;
+        brls::Logger::warning("{} failed: {}", name, error);
+    }
+    int failures() const { return m_failures; }
+
+    // Per-step times of each finished run, in script order
+    const std::vector<std::pair<std::string, double>>& times() const { return m_times; }
+
+private:
+    struct Entry {
+        std::string name;
+        Step step;
+    };
+
+    void runNext() {
+        if (m_index >= m_steps.size()) return;
+        m_started = Clock::now();
+        m_steps[m_index].step([this]() {
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - m_started).count();
+            m_times.push_back({m_steps[m_index].name, ms});
+            m_index++;
+            runNext();
+        });
+    }
+
+    std::vector<Entry> m_steps;
+    size_t m_index = 0;
+    Clock::time_point m_started;
+    int m_failures = 0;
+    std::vector<std::pair<std::string, double>> m_times;
+};
+
+// What earlier steps found, for the later ones to open
+struct Browse {
+    int sectionId = 0;
+    int ratingKey = 0;
+};
+
+void buildScript(Script& script, PlexServer* server, const Options& options, Browse& browse) {
+    script.add("home", [&script, server](Script::Next next) {
+        PlexApi::getHubs(server,
+            [next](std::vector<plex::Hub>) { next(); },
+            [&script, next](const std::string& error) { script.fail("home", error); next(); });
+    });
+
+    script.add("section", [&script, server, &options, &browse](Script::Next next) {
+        PlexApi::getLibrarySections(server,
+            [&script, server, &options, &browse, next](std::vector<plex::Library> libraries) {
+                auto movies = std::find_if(libraries.begin(), libraries.end(),
+                                           [](const plex::Library& l) { return l.type == "movie"; });
+                if (movies == libraries.end()) movies = libraries.begin();
+                if (movies == libraries.end()) {
+                    script.fail("section", "no libraries");
+                    next();
+                    return;
+                }
+                browse.sectionId = movies->key;
+                PlexApi::getLibraryItems(server, browse.sectionId, 0, options.pageSize,
+                    [&browse, next](std::vector<plex::MediaItem> items, int) {
+                        if (!items.empty()) browse.ratingKey = items.front().ratingKey;
+                        next();
+                    },
+                    [&script, next](const std::string& error) { script.fail("section", error); next(); });
+            },
+            [&script, next](const std::string& error) { script.fail("section", error); next(); });
+    });
+
+    for (int page = 1; page <= options.pages; page++) {
+        int start = page * options.pageSize;
+        script.add("scroll", [&script, server, &options, &browse, start](Script::Next next) {
+            PlexApi::getLibraryItems(server, browse.sectionId, start, options.pageSize,
+                [next](std::vector<plex::MediaItem>, int) { next(); },
+                [&script, next](const std::string& error) { script.fail("scroll", error); next(); });
+        });
+    }
+
+    script.add("detail", [&script, server, &browse](Script::Next next) {
+        PlexApi::getMetadata(server, browse.ratingKey,
+            [next](plex::MediaItem) { next(); },
+            [&script, next](const std::string& error) { script.fail("detail", error); next(); });
+    });
+
+    script.add("decision", [&script, server, &browse](Script::Next next) {
+        PlexApi::getPlaybackDecision(server, browse.ratingKey, 0, "", false, 0, 0,
+            [next](plex::PlaybackInfo) { next(); },
+            [&script, next](const std::string& error) { script.fail("decision", error); next(); });
+    });
+}
+
+// Nearest rank
+double percentile(const std::vector<double>& sorted, double p) {
+    size_t rank = static_cast<size_t>(p * sorted.size() + 0.999999);
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+void report(const std::vector<std::vector<std::pair<std::string, double>>>& runs) {
+    // Steps in script order, with the scroll pages of a run summed
+    std::vector<std::string> order;
+    std::map<std::string, std::vector<double>> totals;
+    std::vector<double> endToEnd;
+    for (const auto& run : runs) {
+        std::map<std::string, double> perStep;
+        double total = 0;
+        for (const auto& [name, ms] : run) {
+            if (std::find(order.begin(), order.end(), name) == order.end()) order.push_back(name);
+            perStep[name] += ms;
+            total += ms;
+        }
+        for (const auto& [name, ms] : perStep) totals[name].push_back(ms);
+        endToEnd.push_back(total);
+    }
+    order.push_back("end-to-end");
+    totals["end-to-end"] = endToEnd;
+
+    printf("%-12s %9s %9s %9s %9s\n", "step", "p50 ms", "p95 ms", "min ms", "max ms");
+    for (const auto& name : order) {
+        std::vector<double> values = totals[name];
+        std::sort(values.begin(), values.end());
+        printf("%-12s %9.1f %9.1f %9.1f %9.1f\n", name.c_str(), percentile(values, 0.50),
+               percentile(values, 0.95), values.front(), values.back());
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage(argv[0]);
+        return 2;
+    }
+    brls::Logger::setLogLevel(brls::LogLevel::LOG_WARNING);
+
+    PlexServer server("replay-bench");
+    if (!configureServer(server, options.server)) {
+        fprintf(stderr, "invalid server url: %s\n", options.server.c_str());
+        return 2;
+    }
+    server.setAccessToken(options.token);
+
+    HttpRecorder* recorder = HttpRecorder::getInstance();
+    bool started = options.replay.empty() ? recorder->startRecording(options.record)
+                                          : recorder->startReplay(options.replay, options.latency, options.scale);
+    if (!started) {
+        fprintf(stderr, "cannot open %s\n", options.replay.empty() ? options.record.c_str() : options.replay.c_str());
+        return 2;
+    }
+
+    std::vector<std::vector<std::pair<std::string, double>>> runs;
+    int failures = 0;
+    bool finished = true;
+    for (int run = 0; run < options.runs && finished; run++) {
+        Browse browse;
+        Script script;
+        buildScript(script, &server, options, browse);
+        script.start();
+        finished = brls::host::runUntil([&script]() { return script.finished(); },
+                                        std::chrono::seconds(options.timeoutSec));
+        if (finished) runs.push_back(script.times());
+        failures += script.failures();
+    }
+
+    if (!runs.empty()) report(runs);
+    size_t exchanges = recorder->size();
+    size_t misses = recorder->getMisses();
+    if (!options.replay.empty()) {
+        printf("\n%zu runs replayed from %zu recorded exchanges, %zu not recorded, %d failed steps\n", runs.size(),
+               exchanges, misses, failures);
+    }
+    bool saved = recorder->stop();
+    if (!options.record.empty()) {
+        printf("\n%zu runs, %zu exchanges recorded to %s%s, %d failed steps\n", runs.size(), exchanges,
+               options.record.c_str(), saved ? "" : " (write failed)", failures);
+    }
+
+    if (!finished) {
+        // Workers still blocked in curl cannot be joined; leave without unwinding
+        fprintf(stderr, "timed out with requests still in flight\n");
+        fflush(stdout);
+        std::_Exit(1);
+    }
+    brls::host::shutdown();
+    return failures == 0 && misses == 0 && saved ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+#ifndef SAFFRON_ABR_CONTROLLER_HPP
+#define SAFFRON_ABR_CONTROLLER_HPP
+
+#include "core/bandwidth_estimator.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Picks the transcode bitrate while an HLS stream plays, from the demuxer
+// cache level, the rate mpv downloads at and buffering stalls. Steps go one
+// ladder rung at a time: down on a stall or a cache that stays low, up only
+// after the cache has stayed full for a while and the link has clear
+// headroom over the next rung. An up-switch that is followed by a
+// down-switch soon after doubles the wait before the next try, so a link
+// sitting between two rungs does not flip back and forth.
+//
+// Every switch is appended with its inputs to abr_log.csv for offline
+// analysis. Must only be used from the UI thread.
+class AbrController {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Sample {
+        int64_t positionMs = 0;
+        double cacheSeconds = 0;  // demuxer-cache-duration
+        double downloadKbps = 0;  // cache-speed
+        bool buffering = false;   // loading, or paused-for-cache mid-stream
+    };
+
+    // Starts adapting from the given bitrate for a source of this size;
+    // returns false if the ladder offers nothing to switch to
+    bool start(int ratingKey, int bitrateKbps, int sourceBitrate, int sourceHeight, const std::string& serverUrl);
+    void stop() { m_active = false; }
+    bool isActive() const { return m_active; }
+
+    // The stream is being restarted (switch or seek); stalls right after it
+    // are part of the restart, not the link
+    void onRestart(Clock::time_point now);
+
+    // Feeds one sample (about once a second); returns true if the bitrate
+    // should change to getCurrentStep()
+    bool update(const Sample& sample, Clock::time_point now);
+
+    const QualityStep& getCurrentStep() const { return m_steps[m_current]; }
+
+private:
+    void switchTo(size_t index, const Sample& sample, const char* reason, Clock::time_point now);
+    void logDecision(const Sample& sample, int fromKbps, int toKbps, const char* reason);
+
+    std::vector<QualityStep> m_steps;  // best first
+    size_t m_current = 0;
+    bool m_active = false;
+    int m_ratingKey = 0;
+    std::string m_serverUrl;
+
+    bool m_wasBuffering = false;
+    int m_lowSamples = 0;
+    int m_highSamples = 0;
+    double m_downloadKbps = 0;  // EWMA over samples where mpv was reading
+    Clock::time_point m_restartAt;
+    Clock::time_point m_lastUpAt;
+    Clock::time_point m_lastDownAt;
+    std::chrono::seconds m_upDelay{UP_DELAY_MIN_SECONDS};
+
+    static constexpr int STARTUP_GRACE_SECONDS = 10;
+    static constexpr double LOW_CACHE_SECONDS = 4.0;
+    static constexpr int LOW_CACHE_SAMPLES = 5;
+    static constexpr double HIGH_CACHE_SECONDS = 30.0;
+    static constexpr int HIGH_CACHE_SAMPLES = 20;
+    static constexpr double UP_HEADROOM = 1.5;
+    static constexpr int UP_DELAY_MIN_SECONDS = 30;
+    static constexpr int UP_DELAY_MAX_SECONDS = 480;
+    static constexpr int FAILED_UP_WINDOW_SECONDS = 60;
+    static constexpr double DOWNLOAD_ALPHA = 0.2;
+
+    static constexpr const char* LOG_PATH = "sdmc:/switch/saffron/abr_log.csv";
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef SAFFRON_BANDWIDTH_ESTIMATOR_HPP
+#define SAFFRON_BANDWIDTH_ESTIMATOR_HPP
+
+#include <curl/curl.h>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Plex recommended bitrate/resolution pairing
+struct QualityStep {
+    int bitrate;  // kbps, 0 for the original file
+    int height;
+    const char* label;
+};
+
+// Per-server estimate of link throughput and round-trip time, fed by the
+// transfer stats of every API, image and direct play request. Both are
+// EWMAs so a single slow poster or a burst of cached responses does not
+// swing the estimate. Samples are per connection, which is what a single
+// HLS transcode stream gets.
+//
+// Safe to use from any thread.
+class BandwidthEstimator {
+public:
+    static BandwidthEstimator* getInstance();
+
+    // Reads the timing of a finished transfer; call before the handle is
+    // reset or cleaned up
+    void record(CURL* curl);
+
+    void addThroughputSample(const std::string& url, uint64_t bytes, double seconds);
+    void addRttSample(const std::string& url, double seconds);
+
+    // 0 while there are not enough samples
+    int getThroughputKbps(const std::string& url) const;
+    int getRttMs(const std::string& url) const;
+
+    // Highest bitrate the link should sustain with headroom, 0 if unknown
+    int getSustainableKbps(const std::string& url) const;
+
+    // Plex recommended steps, best first
+    static const std::vector<QualityStep>& qualityLadder();
+
+    // Best quality for a source of the given bitrate and height: the
+    // original while the link can carry it (or nothing is known yet),
+    // otherwise the highest ladder step the link sustains
+    QualityStep chooseQuality(const std::string& url, int sourceBitrate, int sourceHeight) const;
+
+    // scheme://host:port part of a URL, which identifies the server
+    static std::string originOf(const std::string& url);
+
+private:
+    BandwidthEstimator() = default;
+
+    struct Stats {
+        double throughputKbps = 0;
+        double rttMs = 0;
+        int throughputSamples = 0;
+        int rttSamples = 0;
+    };
+
+    std::unordered_map<std::string, Stats> m_stats;
+    mutable std::mutex m_mutex;
+
+    static constexpr double THROUGHPUT_ALPHA = 0.3;
+    static constexpr double RTT_ALPHA = 0.125;
+    static constexpr double HEADROOM = 0.7;
+    static constexpr uint64_t MIN_SAMPLE_BYTES = 64 * 1024;  // smaller bodies measure latency, not bandwidth
+    static constexpr double MIN_SAMPLE_SECONDS = 0.01;
+    static constexpr int MIN_SAMPLES = 2;
+};
+
+#endif
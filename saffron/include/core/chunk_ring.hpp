@@ -0,0 +1,64 @@
+#ifndef SAFFRON_CHUNK_RING_HPP
+#define SAFFRON_CHUNK_RING_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// SD card tier behind RangeStream. Fetched chunks are written into a fixed
+// set of slots spread over segment files of SEGMENT_BYTES each, well under
+// FAT32's 4 GB file limit. Slots are reused in ring order, so the card
+// holds the most recently fetched chunks up to the capacity and the files
+// never grow past it, however long the stream plays.
+//
+// Chunks are keyed by stream (the URL) and chunk index. Thread-safe; reads
+// and writes are serialized, which the card does anyway.
+class ChunkRing {
+public:
+    ChunkRing(const std::string& dir, int64_t capacityBytes, int64_t chunkBytes,
+              int64_t segmentBytes = SEGMENT_BYTES);
+    // Closes and removes the segment files
+    ~ChunkRing();
+
+    ChunkRing(const ChunkRing&) = delete;
+    ChunkRing& operator=(const ChunkRing&) = delete;
+
+    // False on a miss or a failed read
+    bool load(const std::string& stream, int64_t index, std::string& data);
+    // Overwrites the oldest slot; data may be shorter than a chunk
+    void store(const std::string& stream, int64_t index, const std::string& data);
+
+    int64_t getCapacity() const { return static_cast<int64_t>(m_slots.size()) * m_chunkBytes; }
+    uint64_t getHits() const { return m_hits.load(); }
+
+    static constexpr int64_t SEGMENT_BYTES = 256LL * 1024 * 1024;
+
+private:
+    using Key = std::pair<std::string, int64_t>;
+
+    struct Slot {
+        Key key{"", -1};
+        int64_t size = 0;
+    };
+
+    FILE* segmentFor(size_t slot);
+    std::string segmentPath(size_t segment) const;
+
+    std::string m_dir;
+    int64_t m_chunkBytes;
+    size_t m_slotsPerSegment;
+
+    std::mutex m_mutex;
+    std::vector<Slot> m_slots;
+    std::vector<FILE*> m_segments;  // opened on first write
+    std::map<Key, size_t> m_index;
+    size_t m_next = 0;
+    std::atomic<uint64_t> m_hits{0};
+};
+
+#endif
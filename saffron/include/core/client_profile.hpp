@@ -0,0 +1,34 @@
+#ifndef SAFFRON_CLIENT_PROFILE_HPP
+#define SAFFRON_CLIENT_PROFILE_HPP
+
+#include <string>
+#include <vector>
+
+// Describes to the server what this build can play, as an
+// X-Plex-Client-Profile-Extra augmentation of the Generic base profile:
+// direct play profiles, the HLS transcode target and the decoder limits.
+// The codec and container lists come from the decoders and demuxers
+// compiled into our FFmpeg, so the server only converts what mpv really
+// cannot handle.
+class ClientProfile {
+public:
+    // Profile augmentation, not yet url-encoded; built once
+    static const std::string& getExtra();
+
+    // Plex names of the codecs / containers FFmpeg can decode / demux
+    static std::vector<std::string> getVideoCodecs();
+    static std::vector<std::string> getAudioCodecs();
+    static std::vector<std::string> getContainers();
+
+private:
+    static std::string build();
+    static std::string join(const std::vector<std::string>& values);
+
+    // Hardware decoding tops out at 4K; 10-bit H.264 has no hardware path
+    static constexpr int MAX_WIDTH = 3840;
+    static constexpr int MAX_HEIGHT = 2160;
+    static constexpr int MAX_H264_LEVEL = 51;
+    static constexpr int MAX_H264_BIT_DEPTH = 8;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef SAFFRON_ENTITY_STORE_HPP
+#define SAFFRON_ENTITY_STORE_HPP
+
+#include <borealis.hpp>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "models/plex_types.hpp"
+#include "models/card_item.hpp"
+
+using EntityRef = std::shared_ptr<const plex::CardItem>;
+
+// Single copy of every item the UI has seen, keyed by ratingKey. Views and
+// caches hold EntityRefs instead of their own copies, so a progress update
+// or fresher metadata is visible everywhere at once. An entity lives as long
+// as something references it. ratingKeys are per server, so the store holds
+// one server's items at a time and is cleared when the server changes.
+//
+// Must only be used from the UI thread; API callbacks already arrive there.
+class EntityStore {
+public:
+    using ChangeEvent = brls::Event<int>;
+
+    static EntityStore* getInstance();
+
+    EntityRef merge(const plex::MediaItem& item);
+    EntityRef merge(const plex::CardItem& item);
+    std::vector<EntityRef> mergeAll(const std::vector<plex::MediaItem>& items);
+    EntityRef find(int ratingKey) const;
+
+    // Local watch state wins over server responses until the server reports
+    // the same values back, or PENDING_WATCH_SECONDS pass
+    void updateProgress(int ratingKey, int64_t viewOffset);
+    void markWatched(int ratingKey);
+
+    // Forgets every entity; refs already handed out keep their data but no
+    // longer receive merges
+    void clear();
+
+    // Fired with the ratingKey of an entity whose fields changed
+    ChangeEvent* getChangeEvent() { return &m_changeEvent; }
+
+    size_t size() const { return m_entities.size(); }
+
+private:
+    EntityStore() = default;
+
+    // Watch state set locally and not yet seen in a server response
+    struct PendingWatch {
+        int64_t viewOffset = 0;
+        int viewCount = 0;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    bool mergeInto(plex::CardItem& existing, const plex::CardItem& incoming);
+    void setPendingWatch(const plex::CardItem& entity);
+    bool isWatchPending(const plex::CardItem& existing, const plex::CardItem& incoming);
+    void pruneExpired();
+
+    std::unordered_map<int, std::weak_ptr<plex::CardItem>> m_entities;
+    std::unordered_map<int, PendingWatch> m_pendingWatch;
+    ChangeEvent m_changeEvent;
+    size_t m_mergesSincePrune = 0;
+
+    static constexpr size_t PRUNE_INTERVAL = 512;
+    // Past a timeline report or two; a server that never echoes the value
+    // (e.g. it cleared an offset near the end) takes over after this
+    static constexpr int PENDING_WATCH_SECONDS = 120;
+};
+
+#endif
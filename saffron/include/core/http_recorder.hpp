@@ -0,0 +1,118 @@
+#ifndef SAFFRON_HTTP_RECORDER_HPP
+#define SAFFRON_HTTP_RECORDER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Records the HTTP exchanges made by PlexApi and the image loader to an
+// archive, and serves them back in place of the network, so a slow hub or a
+// library's pagination can be reproduced without the server it came from.
+//
+// Requests are matched on method and path: the scheme and host are dropped,
+// and so are the token and the query parameters that change from one run to
+// the next (session ids, cache busters, the measured peak bitrate), so the
+// token is never written to the archive. A request made several times is
+// answered with its recorded responses in order, repeating the last one.
+//
+// record() and replay() are called from the worker threads doing requests.
+class HttpRecorder {
+public:
+    enum class Mode {
+        Off,
+        Record,
+        Replay
+    };
+
+    // How long replay() waits before answering
+    enum class Latency {
+        Original,  // as long as the recorded request took
+        Scaled,    // the recorded time times a factor
+        Zero
+    };
+
+    struct Exchange {
+        std::string method;
+        std::string url;  // normalized, see normalizeUrl()
+        long status = 0;  // 0 when the transfer itself failed
+        std::string error;
+        std::string body;
+        int64_t startUs = 0;  // since recording began
+        int64_t elapsedUs = 0;
+    };
+
+    static HttpRecorder* getInstance();
+
+    // Begins collecting exchanges; they are written to `path` by stop()
+    bool startRecording(const std::string& path);
+
+    // Records to RECORD_DIR/<time>.spxr, as the app does when the
+    // network_recording setting is on
+    bool startRecordingSession();
+
+    // Loads an archive and answers every request from it from now on
+    bool startReplay(const std::string& path, Latency latency = Latency::Original, double scale = 1.0);
+
+    // Writes the recording out, or leaves replay; false if the write failed
+    bool stop();
+
+    Mode getMode() const;
+    bool isRecording() const { return getMode() == Mode::Record; }
+    bool isReplaying() const { return getMode() == Mode::Replay; }
+
+    // Adds a finished request while recording; a no-op otherwise
+    void record(const std::string& method, const std::string& url, std::chrono::steady_clock::time_point started,
+                long status, const std::string& body, const std::string& error = "");
+
+    // The recorded answer to a request, after waiting out its latency.
+    // Requests that were not recorded fail with an error rather than going
+    // to the network, so a replay never depends on a server.
+    Exchange replay(const std::string& method, const std::string& url);
+
+    // Exchanges recorded or loaded so far, and replayed requests that had
+    // no recorded answer
+    size_t size() const;
+    size_t getMisses() const;
+
+    static std::string normalizeUrl(const std::string& url);
+
+    static bool writeArchive(const std::string& path, const std::vector<Exchange>& exchanges);
+    static bool readArchive(const std::string& path, std::vector<Exchange>& exchanges);
+
+    static constexpr uint32_t MAGIC = 0x52585053;  // "SPXR"
+    static constexpr uint16_t VERSION = 1;
+
+    // Recording stops taking bodies past this, so leaving it on while
+    // browsing images cannot fill the SD card
+    static constexpr size_t MAX_RECORD_BYTES = 64 * 1024 * 1024;
+
+    static constexpr const char* RECORD_DIR = "sdmc:/switch/saffron/recordings";
+
+private:
+    HttpRecorder() = default;
+
+    static std::string key(const std::string& method, const std::string& url);
+
+    mutable std::mutex m_mutex;
+    Mode m_mode = Mode::Off;
+    std::string m_path;
+    std::vector<Exchange> m_exchanges;
+    size_t m_recordedBytes = 0;
+    bool m_full = false;
+    std::chrono::steady_clock::time_point m_start;
+
+    // Replay: indices into m_exchanges per request, and the next to serve
+    struct Queue {
+        std::vector<size_t> indices;
+        size_t next = 0;
+    };
+    std::unordered_map<std::string, Queue> m_queues;
+    Latency m_latency = Latency::Original;
+    double m_scale = 1.0;
+    size_t m_misses = 0;
+};
+
+#endif
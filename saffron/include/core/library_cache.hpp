@@ -0,0 +1,89 @@
+#ifndef SAFFRON_LIBRARY_CACHE_HPP
+#define SAFFRON_LIBRARY_CACHE_HPP
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/entity_store.hpp"
+#include "models/plex_types.hpp"
+#include "util/deferred_writer.hpp"
+
+// Byte-bounded LRU of library section listings for the current server.
+// The cache is persisted to the SD card so the library tabs and the
+// last-viewed sections can render before the network answers; entries
+// restored from disk are marked stale until a refresh reconciles them.
+//
+// Must only be used from the UI thread.
+class LibraryCache {
+public:
+    struct Section {
+        std::vector<EntityRef> items;
+        int totalSize = 0;
+        bool stale = false;
+
+        // Set by LibrarySync once items hold the whole section; syncedAt is
+        // the highest updatedAt/addedAt seen, used for the next delta query
+        bool complete = false;
+        int64_t syncedAt = 0;
+    };
+
+    static LibraryCache* getInstance();
+
+    // Switches to the given server, saving the previous one and loading the
+    // new one from disk
+    void setServer(const std::string& machineId);
+    const std::string& getMachineId() const { return m_machineId; }
+
+    const Section* get(int sectionKey);
+    void put(int sectionKey, std::vector<EntityRef> items, int totalSize);
+    void append(int sectionKey, const std::vector<EntityRef>& items);
+    void markFresh(int sectionKey);
+    void setSyncState(int sectionKey, int64_t syncedAt, bool complete);
+    void clear();
+
+    const std::vector<plex::Library>& getLibraries() const { return m_libraries; }
+    void setLibraries(const std::vector<plex::Library>& libraries);
+
+    bool isWarm() const { return m_loadedFromDisk; }
+    size_t getBytes() const { return m_bytes; }
+
+    // Serializes on the calling thread and writes the file in the background
+    void save();
+
+    // Saves and waits until the file is on disk; for the exit path, where
+    // the thread pool stops before a background write would run
+    void flush();
+
+private:
+    LibraryCache() = default;
+
+    struct Entry {
+        Section section;
+        size_t bytes = 0;
+        std::list<int>::iterator lruPos;
+    };
+
+    void load();
+    void touch(Entry& entry);
+    void evict();
+    // Section listings and the library list, as plex::codec archives
+    std::string getFilePath() const;
+    std::string getLibrariesPath() const;
+    static size_t estimateBytes(const std::vector<EntityRef>& items);
+
+    std::string m_machineId;
+    std::vector<plex::Library> m_libraries;
+    std::unordered_map<int, Entry> m_entries;
+    std::list<int> m_lru;
+    size_t m_bytes = 0;
+    bool m_loadedFromDisk = false;
+    bool m_dirty = false;
+    DeferredWriter m_writer;
+
+    static constexpr const char* CACHE_DIR = "sdmc:/switch/saffron/cache";
+    static constexpr size_t MAX_BYTES = 4 * 1024 * 1024;
+};
+
+#endif
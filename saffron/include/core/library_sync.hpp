@@ -0,0 +1,90 @@
+#ifndef SAFFRON_LIBRARY_SYNC_HPP
+#define SAFFRON_LIBRARY_SYNC_HPP
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "core/plex_api.hpp"
+#include "core/entity_store.hpp"
+
+class PlexServer;
+
+// Keeps a complete local copy of each library section in LibraryCache.
+// The first sync pages through the whole section; later syncs only ask for
+// items whose updatedAt/addedAt is past the stored high-water mark, and use
+// the section size plus a ratingKey-only listing to find deletions.
+//
+// Section ids are per server, so jobs are tracked by (machineId, sectionId).
+// A job whose server is no longer LibraryCache's current one is dropped at
+// its next response instead of writing into the new server's cache.
+//
+// Must only be used from the UI thread.
+class LibrarySync {
+public:
+    struct Result {
+        bool full = false;
+        bool membershipChanged = false;
+        size_t changed = 0;
+        size_t added = 0;
+        size_t removed = 0;
+        uint64_t bytes = 0;
+    };
+
+    using OnComplete = std::function<void(const Result&)>;
+
+    static LibrarySync* getInstance();
+
+    // Returns false if the section is already syncing, or the server is not
+    // the one LibraryCache holds
+    bool sync(PlexServer* server, int sectionId, OnComplete onComplete, PlexApi::OnError onError);
+
+    bool isSyncing(PlexServer* server, int sectionId) const;
+    bool needsSync(PlexServer* server, int sectionId);
+
+private:
+    LibrarySync() = default;
+
+    using SectionKey = std::pair<std::string, int>;  // machineId, sectionId
+
+    struct Job {
+        PlexServer* server = nullptr;
+        std::string machineId;
+        int sectionId = 0;
+        uint64_t bytesAtStart = 0;
+        int64_t since = 0;
+        int64_t highWater = 0;
+        int totalSize = 0;
+        std::vector<EntityRef> items;
+        std::unordered_set<int> applied;
+        Result result;
+        OnComplete onComplete;
+        PlexApi::OnError onError;
+    };
+    using JobPtr = std::shared_ptr<Job>;
+
+    void fetchFullPage(JobPtr job, int start);
+    void fetchChanges(JobPtr job, const std::string& field, int start);
+    void checkDeletions(JobPtr job);
+    void applyChanges(JobPtr job, const std::vector<plex::MediaItem>& items);
+    void finish(JobPtr job, bool complete);
+    void fail(JobPtr job, const std::string& error);
+    // True (and the job dropped) once the app has switched to another server
+    bool abandonIfServerChanged(JobPtr job);
+
+    static void trackHighWater(JobPtr job, const std::vector<plex::MediaItem>& items);
+
+    std::set<SectionKey> m_inProgress;
+    std::map<SectionKey, std::chrono::steady_clock::time_point> m_lastSync;
+
+    static constexpr int FULL_SYNC_PAGE_SIZE = 500;
+    static constexpr int RESYNC_INTERVAL_SECONDS = 300;
+};
+
+#endif
@@ -4,6 +4,8 @@
 #include <borealis.hpp>
 #include <mpv/client.h>
 
+#include "core/playback_telemetry.hpp"
+
 #ifdef BOREALIS_USE_DEKO3D
 #include <mpv/render_dk3d.h>
 #else
@@ -13,6 +15,10 @@
 #include <functional>
 #include <string>
 #include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 enum class PlaybackState {
     Stopped,
@@ -21,12 +27,22 @@ enum class PlaybackState {
     Buffering
 };
 
+// Playback state as last published by the event thread
+struct PlaybackSnapshot {
+    PlaybackState state = PlaybackState::Stopped;
+    int64_t position = 0;
+    int64_t duration = 0;
+    double cacheSeconds = 0.0;
+};
+
 class MPVCore {
 public:
     using StateCallback = std::function<void(PlaybackState)>;
     using ProgressCallback = std::function<void(int64_t position, int64_t duration)>;
     using ErrorCallback = std::function<void(const std::string&)>;
     using EndFileCallback = std::function<void(bool reachedEof)>;
+    using PlaybackRestartCallback = std::function<void()>;
+    using FileLoadedCallback = std::function<void()>;
 
     static MPVCore* getInstance();
     static void destroyInstance();
@@ -35,6 +51,8 @@ public:
     void cleanup();
 
     void play(const std::string& url, bool isDirectPlay = false, int bitrateKbps = 0);
+    // Appends to the playlist so mpv can open it early and switch without a reload
+    void queueNext(const std::string& url, bool isDirectPlay = false);
     void stop();
     void pause();
     void resume();
@@ -42,6 +60,10 @@ public:
     void seek(int64_t positionMs);
     void seekRelative(int64_t deltaMs);
 
+    // True if the stream position is inside one of the demuxer's seekable
+    // cached ranges, so a seek there needs no network
+    bool isPositionCached(int64_t positionMs);
+
     void setVolume(int volume);
     int getVolume() const;
 
@@ -51,6 +73,8 @@ public:
     void setSubtitleTrack(int trackId);
     int getSubtitleTrack() const;
     void cycleSubtitles();
+    // Loads an external subtitle file into the current file's track list
+    void addSubtitle(const std::string& path, const std::string& title, const std::string& lang, bool select);
 
     void setAudioTrack(int trackId);
     int getAudioTrack() const;
@@ -60,17 +84,35 @@ public:
     int64_t getInt(const std::string& key, int64_t defaultValue = 0);
     double getDouble(const std::string& key);
 
-    PlaybackState getState() const { return m_state; }
-    int64_t getPosition() const { return m_position; }
-    int64_t getDuration() const { return m_duration; }
-    bool isPlaying() const { return m_state == PlaybackState::Playing; }
-    bool isPaused() const { return m_state == PlaybackState::Paused; }
-    bool isStopped() const { return m_state == PlaybackState::Stopped; }
+    // Consistent view of the fields below without taking a lock; read it
+    // once per frame rather than calling the getters one by one
+    PlaybackSnapshot getSnapshot() const;
+
+    PlaybackState getState() const { return m_state.load(std::memory_order_acquire); }
+    int64_t getPosition() const { return m_position.load(std::memory_order_acquire); }
+    int64_t getDuration() const { return m_duration.load(std::memory_order_acquire); }
+    double getCacheSeconds() const { return m_cacheSeconds.load(std::memory_order_acquire); }
+    bool isPlaying() const { return getState() == PlaybackState::Playing; }
+    bool isPaused() const { return getState() == PlaybackState::Paused; }
+    bool isStopped() const { return getState() == PlaybackState::Stopped; }
+    // Stalled on an empty cache; mpv leaves pause (and so the state) alone
+    // when it waits for the cache mid-stream
+    bool isPausedForCache() const { return m_pausedForCache.load(); }
+
+    // Session statistics sampled on the event thread
+    PlaybackTelemetry* getTelemetry() { return &m_telemetry; }
+    // Records a marked sample right away
+    void markTelemetry(PlaybackTelemetry::Mark mark);
 
     void setOnStateChanged(StateCallback callback);
     void setOnProgress(ProgressCallback callback);
     void setOnError(ErrorCallback callback);
     void setOnEndFile(EndFileCallback callback);
+    // Fired once playback resumes after a seek or a new file starts
+    void setOnPlaybackRestart(PlaybackRestartCallback callback);
+    // Fired once a file (or the next playlist entry) is open and accepts
+    // track changes
+    void setOnFileLoaded(FileLoadedCallback callback);
     void clearCallbacks();
 
     void disableSyncCallbacks();
@@ -88,23 +130,72 @@ private:
     MPVCore(const MPVCore&) = delete;
     MPVCore& operator=(const MPVCore&) = delete;
 
+    // Sets up RangeStream's SD card ring within the card's free space
+    void configureDiskCache(int sizeMb);
+    void applyMemoryCache();
+    static void clearDiskCache();
+
+    // The URL mpv should open for a stream: direct play goes through
+    // RangeStream when parallel connections or the SD card cache are enabled
+    static std::string streamUrl(const std::string& url, bool isDirectPlay);
+
+    // mpv events are drained on their own thread so a burst of property
+    // changes never costs the UI a frame; only the snapshot is written
+    // there, callbacks are posted back to the UI thread
+    void startEventThread();
+    void stopEventThread();
     void eventLoop();
+    void handleEvent(mpv_event* event);
     void handlePropertyChange(mpv_event_property* prop);
+    // Forwards a message requested with mpv_request_log_messages to the LOG macros
+    void handleLogMessage(mpv_event_log_message* msg);
+
+    template <typename T>
+    void publish(std::atomic<T>& field, T value);
+    void publishState(PlaybackState state);
+    void post(std::function<void()> task);
+    void dispatchProgress();
+    void sampleTelemetry(PlaybackTelemetry::Mark mark);
 
-    static void onWakeup(void* ctx);
     static void onUpdate(void* ctx);
 
+    void recordDrawTime(std::chrono::steady_clock::duration elapsed);
+
     static MPVCore* s_instance;
 
     mpv_handle* m_mpv = nullptr;
     mpv_render_context* m_mpvContext = nullptr;
 
-    PlaybackState m_state = PlaybackState::Stopped;
-    int64_t m_position = 0;
-    int64_t m_duration = 0;
-    int m_volume = 100;
-    double m_speed = 1.0;
+    // Snapshot fields; written under m_publishMutex and bracketed by
+    // m_snapshotSeq so readers can detect a torn read and retry
+    std::atomic<PlaybackState> m_state{PlaybackState::Stopped};
+    std::atomic<int64_t> m_position{0};
+    std::atomic<int64_t> m_duration{0};
+    std::atomic<double> m_cacheSeconds{0.0};
+    std::atomic<uint32_t> m_snapshotSeq{0};
+    std::mutex m_publishMutex;
+
+    std::atomic<bool> m_pausedForCache{false};
+    PlaybackTelemetry m_telemetry;
+
+    std::atomic<int> m_volume{100};
+    std::atomic<double> m_speed{1.0};
+
+    std::thread m_eventThread;
+    std::atomic<bool> m_eventThreadRunning{false};
+
+    // Progress callbacks only fire at the OSD refresh rate, from the UI
+    // thread, and only when the position moved
+    brls::RepeatingTask* m_progressTask = nullptr;
+    int64_t m_lastProgressPosition = -1;
+    int64_t m_lastProgressDuration = -1;
+    static constexpr int PROGRESS_INTERVAL_MS = 250;
     std::atomic<bool> m_videoStopped{true};
+    int64_t m_diskCacheBytes = 0;
+
+    static constexpr const char* CACHE_ROOT = "sdmc:/switch/saffron/cache";
+    static constexpr const char* DISK_CACHE_DIR = "sdmc:/switch/saffron/cache/playback";
+    static constexpr int64_t MIN_DISK_CACHE_BYTES = 256LL * 1024 * 1024;
 
     brls::Rect m_rect = {0, 0, 1280, 720};
 
@@ -112,6 +203,8 @@ private:
     ProgressCallback m_onProgress;
     ErrorCallback m_onError;
     EndFileCallback m_onEndFile;
+    PlaybackRestartCallback m_onPlaybackRestart;
+    FileLoadedCallback m_onFileLoaded;
 
     brls::Event<bool>::Subscription m_focusSubscription;
     brls::VoidEvent::Subscription m_exitSubscription;
@@ -119,9 +212,24 @@ private:
     std::shared_ptr<bool> m_alive;
     std::mutex m_syncMutex;
 
+    // Per-frame cost of draw(), logged every DRAW_STATS_FRAMES frames to
+    // compare the pipelined and synchronous paths
+    bool m_pipelinedRender = true;
+    bool m_frameReady = false;  // mpv has a new frame for the next draw()
+    int m_drawFrames = 0;
+    int64_t m_drawTotalUs = 0;
+    int64_t m_drawMaxUs = 0;
+    static constexpr int DRAW_STATS_FRAMES = 600;
+
 #ifdef BOREALIS_USE_DEKO3D
-    DkFence m_doneFence;
-    DkFence m_readyFence;
+    // One fence pair per framebuffer: mpv renders into frame N while the
+    // GPU still composites frame N-1, and the CPU only waits when a pair
+    // comes around again with its render unfinished
+    static constexpr int MAX_FRAMEBUFFERS = 4;
+    DkFence m_doneFences[MAX_FRAMEBUFFERS];
+    DkFence m_readyFences[MAX_FRAMEBUFFERS];
+    bool m_fencePending[MAX_FRAMEBUFFERS] = {};
+    int m_frameSlot = 0;
     mpv_deko3d_fbo m_mpvFbo;
     mpv_render_param m_mpvParams[3];
 #else
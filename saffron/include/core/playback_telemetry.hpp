@@ -0,0 +1,86 @@
+#ifndef SAFFRON_PLAYBACK_TELEMETRY_HPP
+#define SAFFRON_PLAYBACK_TELEMETRY_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// mpv playback statistics sampled at a fixed interval for the whole
+// session, so a stutter can be diagnosed after the fact. Buffering, seeks
+// and file changes are recorded as marked samples in the same stream.
+// Sessions can be exported to the SD card as CSV and JSON for plotting.
+//
+// Samples are recorded from the mpv event thread; everything else is
+// called from the UI thread.
+class PlaybackTelemetry {
+public:
+    enum class Mark {
+        None,
+        FileStart,
+        FileLoaded,
+        FileEnd,
+        BufferingStart,
+        BufferingEnd,
+        Seek,
+        Restart,
+        QualitySwitch
+    };
+
+    struct Sample {
+        int64_t timeMs = 0;  // since the session began
+        Mark mark = Mark::None;
+        int64_t positionMs = 0;
+        int64_t decoderDrops = 0;
+        int64_t outputDrops = 0;
+        double avsync = 0.0;
+        double cacheSeconds = 0.0;
+        int64_t videoBitrateKbps = 0;
+        int64_t cacheSpeedKbps = 0;
+        bool pausedForCache = false;
+    };
+
+    static const char* markName(Mark mark);
+
+    // Clears the buffer and starts accepting samples
+    void beginSession(int ratingKey, const std::string& title);
+    void endSession();
+    bool isActive() const;
+
+    // Milliseconds since the session began, for stamping a sample
+    int64_t elapsedMs() const;
+    void record(const Sample& sample);
+
+    // Oldest first
+    std::vector<Sample> getSamples() const;
+
+    // Writes the session as <dir>/<time>_<ratingKey>.csv and .json in the
+    // background and keeps only the newest MAX_EXPORTS sessions
+    void exportSession();
+
+    static constexpr int SAMPLE_INTERVAL_MS = 1000;
+    // Two hours at one sample per second, plus room for marks
+    static constexpr size_t CAPACITY = 8192;
+
+private:
+    static bool writeCsv(const std::string& path, const std::vector<Sample>& samples);
+    static bool writeJson(const std::string& path, const std::vector<Sample>& samples, int ratingKey,
+                          const std::string& title, int64_t startedAt);
+    static void trimExports();
+
+    mutable std::mutex m_mutex;
+    std::vector<Sample> m_samples;
+    size_t m_head = 0;
+    size_t m_count = 0;
+    bool m_active = false;
+    int m_ratingKey = 0;
+    std::string m_title;
+    int64_t m_startedAt = 0;  // wall clock, for the export file name
+    std::chrono::steady_clock::time_point m_start;
+
+    static constexpr const char* EXPORT_DIR = "sdmc:/switch/saffron/telemetry";
+    static constexpr int MAX_EXPORTS = 20;
+};
+
+#endif
@@ -14,13 +14,13 @@ struct PlexHeaders {
     std::string clientIdentifier;
     std::string product = "Saffron";
     std::string version = "0.1.0";
-    std::string platform = "Android";
-    std::string platformVersion = "11";
-    std::string device = "SHIELD Android TV";
-    std::string model = "SHIELD Android TV";
+    std::string platform = "Nintendo Switch";
+    std::string device = "Switch";
+    std::string model = "Switch";
     std::string token;
     std::string sessionIdentifier;
-    std::string clientProfileName = "SHIELD Android TV";
+    // Neutral base; ClientProfile's augmentation states what we can play
+    std::string clientProfileName = "Generic";
     std::string clientProfileExtra;
 
     std::vector<std::string> toHeaderList() const;
@@ -45,6 +45,34 @@ public:
         OnError onError
     );
 
+    // One page of the items in a section whose `field` (updatedAt or
+    // addedAt) is >= since; totalSize counts all matching items
+    static void getLibraryChanges(
+        PlexServer* server,
+        int sectionId,
+        const std::string& field,
+        int64_t since,
+        int start,
+        int count,
+        std::function<void(std::vector<plex::MediaItem>, int totalSize)> onSuccess,
+        OnError onError
+    );
+
+    // ratingKey-only listing of a whole section, used to detect deletions
+    static void getLibraryKeys(
+        PlexServer* server,
+        int sectionId,
+        std::function<void(std::vector<int>)> onSuccess,
+        OnError onError
+    );
+
+    static void getLibrarySize(
+        PlexServer* server,
+        int sectionId,
+        std::function<void(int totalSize)> onSuccess,
+        OnError onError
+    );
+
     static void getRecentlyAdded(
         PlexServer* server,
         int sectionId,
@@ -157,6 +185,9 @@ public:
         OnError onError
     );
 
+    // Total response body bytes received by all requests so far
+    static uint64_t getBytesReceived();
+
 private:
     static PlexHeaders buildHeaders();
     static std::string buildUrl(PlexServer* server, const std::string& path);
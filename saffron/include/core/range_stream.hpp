@@ -0,0 +1,127 @@
+#ifndef SAFFRON_RANGE_STREAM_HPP
+#define SAFFRON_RANGE_STREAM_HPP
+
+#include <curl/curl.h>
+#include <mpv/client.h>
+#include <mpv/stream_cb.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ChunkRing;
+
+// mpv stream backend for direct play. Instead of one HTTP connection the
+// file is fetched as fixed-size chunks by several workers issuing range
+// requests, always working on the lowest missing chunk in the window ahead
+// of the read position. A seek moves that window, so the next requests go
+// out for the new position straight away and chunks that fell out of it
+// are dropped (in-flight ones are aborted).
+//
+// With an SD card cache set, every fetched chunk is also written to a
+// ChunkRing and workers look there first, so a rewind past what mpv keeps
+// in memory is read back from the card instead of the network.
+//
+// Registered as the "saffron://" protocol; the wrapped URL follows the
+// scheme, e.g. saffron://http://host:32400/library/parts/...
+class RangeStream {
+public:
+    static constexpr const char* PROTOCOL = "saffron";
+
+    static void registerProtocol(mpv_handle* mpv);
+    static std::string wrapUrl(const std::string& url);
+
+    // Applies to streams opened afterwards
+    static void setConnectionCount(int count);
+    // A ring of bytes (rounded down to whole chunks) in dir; 0 turns the
+    // card tier off and removes the ring's files once no stream uses them
+    static void setDiskCache(const std::string& dir, int64_t bytes);
+    static std::shared_ptr<ChunkRing> getDiskCache();
+
+    ~RangeStream();
+
+private:
+    explicit RangeStream(const std::string& url);
+
+    struct Chunk {
+        enum class State { Loading, Ready, Failed };
+        State state = State::Loading;
+        int attempts = 0;
+        std::chrono::steady_clock::time_point retryAt;  // when Failed
+        std::string data;
+    };
+
+    bool open();
+    int64_t read(char* buf, uint64_t nbytes);
+    int64_t seek(int64_t offset);
+    void cancel();
+    void close();
+
+    void workerLoop();
+    bool fetchChunk(CURL* curl, int64_t index, std::string& data);
+    // Lowest chunk in the window that is missing or due for a retry; -1 if
+    // none, with nextRetry set to when the earliest failed one is due
+    int64_t nextWantedChunk(std::chrono::steady_clock::time_point now,
+                            std::chrono::steady_clock::time_point& nextRetry) const;
+    bool isWanted(int64_t index) const;
+    void evictOutsideWindow();
+    int64_t chunkCount() const { return (m_size + CHUNK_SIZE - 1) / CHUNK_SIZE; }
+    int64_t chunkLength(int64_t index) const { return std::min(CHUNK_SIZE, m_size - index * CHUNK_SIZE); }
+    // Reads a chunk back from the card tier; called without m_mutex
+    bool loadChunk(int64_t index, std::string& data);
+    void beginFetch();
+    void endFetch(size_t bytes, bool fromDisk);
+
+    static int openCallback(void* userData, char* uri, mpv_stream_cb_info* info);
+    static int64_t readCallback(void* cookie, char* buf, uint64_t nbytes);
+    static int64_t seekCallback(void* cookie, int64_t offset);
+    static int64_t sizeCallback(void* cookie);
+    static void closeCallback(void* cookie);
+    static void cancelCallback(void* cookie);
+
+    std::string m_url;
+    std::shared_ptr<ChunkRing> m_diskCache;
+    int64_t m_size = 0;
+    int64_t m_position = 0;
+    std::atomic<int64_t> m_readChunk{0};
+
+    std::map<int64_t, Chunk> m_chunks;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_dataReady;
+    std::condition_variable m_workAvailable;
+    std::vector<std::thread> m_workers;
+    std::atomic<bool> m_closing{false};
+    std::atomic<bool> m_cancelled{false};
+
+    // Throughput is measured over the time at least one fetch was running,
+    // so a full window waiting on the reader does not count against it
+    int m_activeFetches = 0;
+    std::chrono::steady_clock::time_point m_busySince;
+    std::chrono::steady_clock::duration m_busyTime{};
+    std::chrono::steady_clock::duration m_stallTime{};
+    uint64_t m_bytesFetched = 0;
+    uint64_t m_bytesFromDisk = 0;
+    int m_connections = 0;
+
+    inline static std::atomic<int> s_connectionCount{4};
+    inline static std::mutex s_diskCacheMutex;
+    inline static std::shared_ptr<ChunkRing> s_diskCache;
+
+    static constexpr int64_t CHUNK_SIZE = 1024 * 1024;
+    static constexpr int64_t WINDOW_CHUNKS = 16;
+    static constexpr int64_t BACK_CHUNKS = 4;
+    // A failed chunk is retried after RETRY_DELAY_MS, doubling per attempt,
+    // and the read fails once it has failed MAX_ATTEMPTS times
+    static constexpr int MAX_ATTEMPTS = 4;
+    static constexpr int RETRY_DELAY_MS = 250;
+};
+
+#endif
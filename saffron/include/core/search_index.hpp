@@ -0,0 +1,110 @@
+#ifndef SAFFRON_SEARCH_INDEX_HPP
+#define SAFFRON_SEARCH_INDEX_HPP
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "models/plex_types.hpp"
+#include "util/deferred_writer.hpp"
+
+// Local inverted index over synced library metadata (title, titleSort,
+// originalTitle, year, cast and genres) so search works offline and can
+// answer while the server request is still in flight.
+//
+// Every query word must match a term either as a prefix (binary search
+// over the sorted term list) or, from three characters, as a substring
+// (trigram lookup over distinct terms). Documents are never rewritten in
+// place: updates tombstone the old entry and the file is written compacted.
+//
+// Must only be used from the UI thread.
+class SearchIndex {
+public:
+    static SearchIndex* getInstance();
+
+    // Switches to the given server, saving the previous one and loading the
+    // new one from disk
+    void setServer(const std::string& machineId);
+
+    void add(const plex::MediaItem& item);
+    void addAll(const std::vector<plex::MediaItem>& items);
+    void remove(int ratingKey);
+
+    // Drops every document of the section whose key is not in keys
+    void retainSection(int sectionId, const std::unordered_set<int>& keys);
+
+    // Returns up to limit matches, best first, as lightweight items that
+    // only carry what a card needs
+    std::vector<plex::MediaItem> search(const std::string& query, size_t limit);
+
+    size_t size() const { return m_docByKey.size(); }
+
+    // Whether anything changed since the last save or load
+    bool isDirty() const { return m_dirty; }
+
+    // Serializes on the calling thread and writes the file in the background
+    void save();
+
+    // Saves and waits until the file is on disk; for the exit path
+    void flush();
+
+private:
+    SearchIndex() = default;
+
+    struct Doc {
+        int ratingKey = 0;  // 0 once removed
+        int librarySectionId = 0;
+        plex::MediaType mediaType = plex::MediaType::Movie;
+        uint16_t year = 0;
+        std::string title;
+        std::string thumb;
+        // Of everything indexed, so re-adding an unchanged item is a no-op
+        uint64_t contentHash = 0;
+    };
+
+    uint32_t internTerm(const std::string& term);
+    void addTerms(uint32_t docId, const std::vector<std::string>& titleTerms,
+                  std::vector<std::string>& otherTerms);
+    void sortTerms();
+    void matchWord(const std::string& word, uint8_t pass);
+    void clear();
+    void load();
+    std::string getFilePath() const;
+
+    static bool isWordChar(unsigned char c);
+    static void tokenize(const std::string& text, std::vector<std::string>& out);
+    static bool titleStartsWith(const std::string& title, const std::string& phrase);
+    static uint32_t trigram(const char* p);
+
+    std::string m_machineId;
+    std::vector<Doc> m_docs;
+    std::unordered_map<int, uint32_t> m_docByKey;
+
+    // Deque keeps term storage stable so the lookup map can key on views
+    std::deque<std::string> m_terms;
+    std::unordered_map<std::string_view, uint32_t> m_termIds;
+    std::vector<std::vector<uint32_t>> m_postings;                 // term -> docs (see posting())
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_trigrams; // trigram -> terms
+    std::vector<uint32_t> m_sortedTerms;
+    bool m_termsSorted = true;
+
+    // Per-document count of query words matched so far (any field / title
+    // only), reused across queries
+    std::vector<uint8_t> m_marks;
+    std::vector<uint8_t> m_titleMarks;
+    bool m_dirty = false;
+    DeferredWriter m_writer;
+
+    static constexpr const char* CACHE_DIR = "sdmc:/switch/saffron/cache";
+    static constexpr uint32_t FILE_MAGIC = 0x31495353;  // "SSI1"
+    static constexpr uint16_t FILE_VERSION = 2;
+    // Smallest serialized document (empty strings) and term (empty postings)
+    static constexpr size_t MIN_DOC_BYTES = 4 + 4 + 2 + 2 + 2 + 2 + 8;
+    static constexpr size_t MIN_TERM_BYTES = 2 + 4;
+};
+
+#endif
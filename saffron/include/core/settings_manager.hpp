@@ -31,13 +31,21 @@ private:
     int64_t m_tokenExpiresAt = 0;
 
     bool m_autoPlayNext = true;
+    int m_preloadNextSeconds = 30;
+    bool m_autoQuality = true;
+    bool m_remuxOnly = false;
     bool m_overclockEnabled = false;
     int m_seekIncrement = 10;
     int m_inMemoryCache = 50;
+    int m_diskCache = 0;
     bool m_powerUserMenuUnlocked = false;
     std::string m_videoSyncMode = "audio";
     int m_framebufferCount = 3;
+    bool m_pipelinedRender = true;
     bool m_bufferBeforePlay = false;
+    int m_directPlayConnections = 4;
+    bool m_telemetryExport = false;
+    bool m_networkRecording = false;
 
     std::function<void()> m_onServerChanged;
 
@@ -83,6 +91,19 @@ public:
     bool isAutoPlayNextEnabled() const;
     void setAutoPlayNext(bool enabled);
 
+    // How long before the end of an episode the next one is prepared; 0 disables
+    int getPreloadNextSeconds() const;
+    void setPreloadNextSeconds(int seconds);
+
+    // Play at the quality the measured bandwidth sustains instead of asking
+    bool isAutoQualityEnabled() const;
+    void setAutoQuality(bool enabled);
+
+    // Never re-encode video at original quality; the server only remuxes
+    // and converts incompatible audio
+    bool isRemuxOnlyEnabled() const;
+    void setRemuxOnly(bool enabled);
+
     bool isOverclockEnabled() const;
     void setOverclockEnabled(bool enabled);
 
@@ -92,6 +113,10 @@ public:
     int getInMemoryCache() const;
     void setInMemoryCache(int mb);
 
+    // Playback cache on the SD card in MB, used instead of the memory cache; 0 disables
+    int getDiskCache() const;
+    void setDiskCache(int mb);
+
     bool isPowerUserMenuUnlocked() const;
     void setPowerUserMenuUnlocked(bool unlocked);
 
@@ -101,9 +126,26 @@ public:
     int getFramebufferCount() const;
     void setFramebufferCount(int count);
 
+    // Let mpv render the next frame while the UI composites the last one;
+    // off falls back to waiting for every video frame on the CPU
+    bool isPipelinedRenderEnabled() const;
+    void setPipelinedRender(bool enabled);
+
     bool isBufferBeforePlayEnabled() const;
     void setBufferBeforePlay(bool enabled);
 
+    // Parallel range requests used for direct play; 1 hands the URL to mpv as-is
+    int getDirectPlayConnections() const;
+    void setDirectPlayConnections(int count);
+
+    // Write each playback session's telemetry to the SD card when it ends
+    bool isTelemetryExportEnabled() const;
+    void setTelemetryExport(bool enabled);
+
+    // Record API and image responses for replay on a desktop (HttpRecorder)
+    bool isNetworkRecordingEnabled() const;
+    void setNetworkRecording(bool enabled);
+
     static int loadEarlyFramebufferCount();
 
     void setOnServerChanged(std::function<void()> callback);
@@ -0,0 +1,63 @@
+#ifndef SAFFRON_SUBTITLE_CACHE_HPP
+#define SAFFRON_SUBTITLE_CACHE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "models/plex_types.hpp"
+
+class PlexServer;
+
+// Sidecar subtitle files (external streams, the ones Plex gives a key;
+// VobSub excepted, see isSidecar)
+// downloaded to the SD card so mpv can render them itself via sub-add
+// instead of the server burning them into the video. Files are kept across
+// sessions and trimmed oldest first once the directory grows too large.
+//
+// Must only be used from the UI thread; downloads run in the background.
+class SubtitleCache {
+public:
+    using OnReady = std::function<void(const std::string& path)>;
+
+    static SubtitleCache* getInstance();
+
+    static bool isSidecar(const plex::Stream& stream);
+
+    // Starts downloading every sidecar stream of the part that is not
+    // cached yet
+    void prefetch(PlexServer* server, const plex::Part& part);
+
+    // Calls onReady with the local path once the file is on the card;
+    // not called if the download fails
+    void fetch(PlexServer* server, const plex::Stream& stream, OnReady onReady);
+
+private:
+    SubtitleCache() = default;
+
+    std::string getPath(PlexServer* server, const plex::Stream& stream) const;
+    // Removes the oldest files once the directory is over its budget, except
+    // those in use this session; runs on a worker
+    void trim();
+    void markInUse(const std::string& path);
+
+    static std::string extensionFor(const std::string& codec);
+    static bool download(const std::string& url, const std::string& path);
+
+    // Callbacks waiting on a download, by local path
+    std::unordered_map<std::string, std::vector<OnReady>> m_pending;
+    bool m_trimmed = false;
+
+    // Files reported or being downloaded this session; read by trim()
+    std::mutex m_inUseMutex;
+    std::unordered_set<std::string> m_inUse;
+
+    static constexpr const char* CACHE_DIR = "sdmc:/switch/saffron/cache/subtitles";
+    static constexpr int64_t MAX_CACHE_BYTES = 64LL * 1024 * 1024;
+};
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef SAFFRON_CARD_ITEM_HPP
+#define SAFFRON_CARD_ITEM_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "models/plex_types.hpp"
+
+namespace plex {
+
+// Process-wide table of deduplicated strings. Content ratings, studios,
+// edition titles and show names repeat across thousands of grid items, so
+// each distinct value is stored once and cards hold a pointer into the pool.
+// Entries are never removed, which keeps the pointers stable.
+class StringPool {
+public:
+    static StringPool& instance();
+
+    const std::string* intern(const std::string& value);
+
+    size_t size() const;
+    size_t memoryUsage() const;
+
+private:
+    StringPool() = default;
+
+    mutable std::mutex m_mutex;
+    std::unordered_set<std::string> m_strings;
+};
+
+class InternedString {
+public:
+    InternedString() = default;
+    InternedString(const std::string& value);
+
+    const std::string& str() const;
+    bool empty() const { return m_value == nullptr; }
+
+    bool operator==(const InternedString& other) const { return m_value == other.m_value; }
+    bool operator!=(const InternedString& other) const { return m_value != other.m_value; }
+
+private:
+    const std::string* m_value = nullptr;
+};
+
+enum class VideoCodec : uint8_t {
+    Unknown = 0,
+    H264,
+    HEVC,
+    VP9,
+    AV1,
+    MPEG2,
+    MPEG4,
+    VC1,
+    Other
+};
+
+enum ResolutionFlags : uint8_t {
+    RESOLUTION_SD = 1 << 0,
+    RESOLUTION_720 = 1 << 1,
+    RESOLUTION_1080 = 1 << 2,
+    RESOLUTION_4K = 1 << 3
+};
+
+VideoCodec parseVideoCodec(const std::string& codec);
+uint8_t parseResolution(const std::string& videoResolution);
+
+// Compact representation of a MediaItem used by list and grid data sources.
+// Only the fields needed to render a card and open its detail view are kept;
+// detail views fetch full metadata on their own.
+struct CardItem {
+    int ratingKey = 0;
+    int librarySectionId = 0;
+    int64_t duration = 0;
+    int64_t viewOffset = 0;
+    int64_t updatedAt = 0;
+    int64_t lastViewedAt = 0;
+
+    std::string title;
+    std::string titleSort;  // empty when it equals title
+    std::string thumb;
+
+    InternedString editionTitle;
+    InternedString contentRating;
+    InternedString studio;
+    InternedString grandparentTitle;
+    InternedString parentTitle;
+
+    MediaType mediaType = MediaType::Movie;
+    uint16_t year = 0;
+    uint16_t index = 0;
+    uint16_t parentIndex = 0;
+    uint16_t childCount = 0;
+    uint16_t leafCount = 0;
+    uint16_t viewedLeafCount = 0;
+    uint16_t viewCount = 0;
+    VideoCodec videoCodec = VideoCodec::Unknown;
+    uint8_t resolutions = 0;
+
+    // The key the server sorts section listings by
+    const std::string& sortTitle() const { return titleSort.empty() ? title : titleSort; }
+
+    static CardItem fromMediaItem(const MediaItem& item);
+    MediaItem toMediaItem() const;
+};
+
+std::vector<CardItem> toCardItems(const std::vector<MediaItem>& items);
+
+// Approximate bytes owned by an item, including heap allocations of its
+// strings and nested vectors. Interned strings are accounted for by the pool.
+size_t memoryFootprint(const MediaItem& item);
+size_t memoryFootprint(const CardItem& item);
+
+}
+
+#endif
@@ -0,0 +1,330 @@
+#ifndef SAFFRON_PLEX_CODEC_HPP
+#define SAFFRON_PLEX_CODEC_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "models/card_item.hpp"
+#include "models/plex_types.hpp"
+#include "util/binary_io.hpp"
+
+// Compact binary encoding of the Plex models for on-disk caches.
+//
+// A record is a run of tagged fields: a varint key (field id << 3 | wire
+// type) followed by a zigzag varint, a fixed 64-bit double, or a varint
+// length and that many bytes (a string or a nested record). Fields at their
+// default value are left out and readers skip ids they do not know, so
+// fields can be added without a version bump; renumbering one needs one.
+//
+// An archive holds records of one kind behind a header and an offset table,
+// so opening it reads only the header and any record's fields can be read
+// in place without decoding the rest:
+//
+//   u32 magic | u16 version | u16 kind | u32 count | u32 offsets[count + 1] | records
+namespace plex::codec {
+
+enum class Kind : uint16_t {
+    MediaItem = 1,
+    Hub = 2,
+    Library = 3,
+    Collection = 4,
+    Playlist = 5,
+    Card = 6,
+    Section = 7  // LibraryCache listings
+};
+
+enum class Wire : uint8_t {
+    Varint = 0,
+    Fixed64 = 1,
+    Bytes = 2
+};
+
+// Field ids are part of the format
+enum class StreamField : uint32_t {
+    Id = 1, StreamType, Codec, Language, LanguageCode, DisplayTitle, Selected, IsDefault, Decision, Key,
+    Index, Channels, Bitrate, Profile, AudioChannelLayout, BitDepth, ColorSpace, ColorRange, ColorPrimaries,
+    Width, Height, FrameRate
+};
+
+enum class PartField : uint32_t {
+    Id = 1, Key, Duration, File, Size, Container, VideoProfile, AudioProfile, Streams
+};
+
+enum class MediaField : uint32_t {
+    Id = 1, Duration, Bitrate, Width, Height, AspectRatio, AudioChannels, AudioCodec, VideoCodec,
+    VideoResolution, Container, VideoFrameRate, VideoProfile, AudioProfile, EditionTitle,
+    OptimizedForStreaming, Parts
+};
+
+enum class TagField : uint32_t {
+    Id = 1, Tag, Role, Thumb
+};
+
+enum class ItemField : uint32_t {
+    RatingKey = 1, Key, Guid, Type, MediaType, Title, TitleSort, EditionTitle, Summary, Thumb, Art, Banner,
+    Duration, AddedAt, UpdatedAt, Year, ContentRating, Rating, AudienceRating, AudienceRatingImage, Studio,
+    Tagline, OriginalTitle, OriginallyAvailableAt, ViewOffset, ViewCount, LastViewedAt, ParentRatingKey,
+    GrandparentRatingKey, Index, ParentIndex, GrandparentTitle, ParentTitle, GrandparentThumb, ParentThumb,
+    LeafCount, ViewedLeafCount, ChildCount, LibrarySectionId, Media, Genres, Countries, Directors, Writers,
+    Cast
+};
+
+enum class LibraryField : uint32_t {
+    Key = 1, Uuid, Type, Title, Art, Thumb, Composite, AllowSync, UpdatedAt, ScannedAt
+};
+
+enum class HubField : uint32_t {
+    HubKey = 1, Key, Title, Type, HubIdentifier, Context, Size, More, Style, Promoted, Items
+};
+
+enum class CollectionField : uint32_t {
+    RatingKey = 1, Key, Guid, Type, Title, Summary, Thumb, Art, ChildCount, AddedAt, UpdatedAt
+};
+
+enum class PlaylistField : uint32_t {
+    RatingKey = 1, Key, Guid, Type, Title, Summary, Thumb, Composite, LeafCount, Duration, Smart,
+    PlaylistType, AddedAt, UpdatedAt
+};
+
+enum class CardField : uint32_t {
+    RatingKey = 1, LibrarySectionId, Duration, ViewOffset, UpdatedAt, LastViewedAt, Title, TitleSort, Thumb,
+    EditionTitle, ContentRating, Studio, GrandparentTitle, ParentTitle, MediaType, Year, Index, ParentIndex,
+    ChildCount, LeafCount, ViewedLeafCount, ViewCount, VideoCodec, Resolutions
+};
+
+// One cached section listing; Items are nested Card records in listing order
+enum class SectionField : uint32_t {
+    Key = 1, TotalSize, SyncedAt, Complete, Items
+};
+
+// Appends tagged fields; values at their default are not written
+class Encoder {
+public:
+    template <typename F>
+    void putInt(F field, int64_t value) {
+        if (value == 0) return;
+        putKey(static_cast<uint32_t>(field), Wire::Varint);
+        m_writer.putVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    template <typename F>
+    void putBool(F field, bool value) {
+        putInt(field, value ? 1 : 0);
+    }
+
+    template <typename F>
+    void putDouble(F field, double value) {
+        if (value == 0.0) return;
+        putKey(static_cast<uint32_t>(field), Wire::Fixed64);
+        m_writer.put(value);
+    }
+
+    template <typename F>
+    void putString(F field, std::string_view value) {
+        if (value.empty()) return;
+        putKey(static_cast<uint32_t>(field), Wire::Bytes);
+        m_writer.putVarint(value.size());
+        m_writer.buffer().append(value.data(), value.size());
+    }
+
+    // A nested record is written between these; returns the mark to end it with
+    template <typename F>
+    size_t beginRecord(F field) {
+        putKey(static_cast<uint32_t>(field), Wire::Bytes);
+        return beginLength();
+    }
+    void endRecord(size_t mark);
+
+    size_t size() const { return m_writer.size(); }
+    std::string& buffer() { return m_writer.buffer(); }
+
+private:
+    void putKey(uint32_t id, Wire wire) { m_writer.putVarint((static_cast<uint64_t>(id) << 3) | static_cast<uint8_t>(wire)); }
+    size_t beginLength();
+
+    BinaryWriter m_writer;
+};
+
+// Steps through the fields of one record
+class FieldCursor {
+public:
+    explicit FieldCursor(std::string_view record) : m_reader(record) {}
+
+    // False at the end of the record or on malformed data; see ok()
+    bool next();
+    bool ok() const { return m_ok; }
+
+    uint32_t id() const { return m_id; }
+    Wire wire() const { return m_wire; }
+
+    // Values read as their type's default when the wire type does not match
+    int64_t asInt() const;
+    bool asBool() const { return asInt() != 0; }
+    double asDouble() const;
+    std::string_view asBytes() const { return m_wire == Wire::Bytes ? m_bytes : std::string_view(); }
+
+private:
+    BinaryReader m_reader;
+    uint32_t m_id = 0;
+    Wire m_wire = Wire::Varint;
+    uint64_t m_value = 0;
+    std::string_view m_bytes;
+    bool m_ok = true;
+};
+
+// Reads single fields of a record in place, without decoding the rest;
+// each lookup scans the record's keys
+class RecordView {
+public:
+    RecordView() = default;
+    explicit RecordView(std::string_view data) : m_data(data) {}
+
+    template <typename F>
+    int64_t getInt(F field) const { return find(static_cast<uint32_t>(field)).asInt(); }
+    template <typename F>
+    bool getBool(F field) const { return find(static_cast<uint32_t>(field)).asBool(); }
+    template <typename F>
+    double getDouble(F field) const { return find(static_cast<uint32_t>(field)).asDouble(); }
+    template <typename F>
+    std::string_view getString(F field) const { return find(static_cast<uint32_t>(field)).asBytes(); }
+
+    // Calls fn(RecordView) for each nested record in a repeated field
+    template <typename F, typename Fn>
+    void forEach(F field, Fn&& fn) const {
+        FieldCursor cursor(m_data);
+        while (cursor.next()) {
+            if (cursor.id() == static_cast<uint32_t>(field) && cursor.wire() == Wire::Bytes) {
+                fn(RecordView(cursor.asBytes()));
+            }
+        }
+    }
+
+    std::string_view data() const { return m_data; }
+
+private:
+    // Scalar fields are written once, so the first match is the value
+    FieldCursor find(uint32_t id) const;
+
+    std::string_view m_data;
+};
+
+void encode(Encoder& encoder, const Stream& stream);
+void encode(Encoder& encoder, const Part& part);
+void encode(Encoder& encoder, const Media& media);
+void encode(Encoder& encoder, const Tag& tag);
+void encode(Encoder& encoder, const MediaItem& item);
+void encode(Encoder& encoder, const Library& library);
+void encode(Encoder& encoder, const Hub& hub);
+void encode(Encoder& encoder, const Collection& collection);
+void encode(Encoder& encoder, const Playlist& playlist);
+void encode(Encoder& encoder, const CardItem& card);
+
+// Decode into a default-constructed value; false if the record is malformed
+bool decode(std::string_view record, Stream& stream);
+bool decode(std::string_view record, Part& part);
+bool decode(std::string_view record, Media& media);
+bool decode(std::string_view record, Tag& tag);
+bool decode(std::string_view record, MediaItem& item);
+bool decode(std::string_view record, Library& library);
+bool decode(std::string_view record, Hub& hub);
+bool decode(std::string_view record, Collection& collection);
+bool decode(std::string_view record, Playlist& playlist);
+bool decode(std::string_view record, CardItem& card);
+
+template <typename T> struct KindOf;
+template <> struct KindOf<MediaItem> { static constexpr Kind value = Kind::MediaItem; };
+template <> struct KindOf<Hub> { static constexpr Kind value = Kind::Hub; };
+template <> struct KindOf<Library> { static constexpr Kind value = Kind::Library; };
+template <> struct KindOf<Collection> { static constexpr Kind value = Kind::Collection; };
+template <> struct KindOf<Playlist> { static constexpr Kind value = Kind::Playlist; };
+template <> struct KindOf<CardItem> { static constexpr Kind value = Kind::Card; };
+
+std::string encodeArchive(const std::vector<MediaItem>& items);
+std::string encodeArchive(const std::vector<Hub>& hubs);
+std::string encodeArchive(const std::vector<Library>& libraries);
+std::string encodeArchive(const std::vector<Collection>& collections);
+std::string encodeArchive(const std::vector<Playlist>& playlists);
+std::string encodeArchive(const std::vector<CardItem>& cards);
+
+// Builds an archive one record at a time, for records that are not held as
+// a vector of one model (LibraryCache sections)
+class ArchiveWriter {
+public:
+    explicit ArchiveWriter(Kind kind) : m_kind(kind) {}
+
+    // Encoder to write the next record's fields into
+    Encoder& nextRecord();
+    std::string finish();
+
+private:
+    Kind m_kind;
+    Encoder m_body;
+    std::vector<uint32_t> m_offsets;
+};
+
+// Read-only view of an encoded archive; the data must outlive it
+class Archive {
+public:
+    // Checks the header and offset table; records are not touched
+    bool open(std::string_view data);
+
+    Kind kind() const { return m_kind; }
+    size_t size() const { return m_count; }
+    RecordView operator[](size_t index) const { return RecordView(record(index)); }
+
+    template <typename T>
+    bool decode(size_t index, T& out) const {
+        return m_kind == KindOf<T>::value && index < m_count && codec::decode(record(index), out);
+    }
+
+    template <typename T>
+    bool decodeAll(std::vector<T>& out) const {
+        out.clear();
+        out.resize(m_count);
+        for (size_t i = 0; i < m_count; i++) {
+            if (!decode(i, out[i])) return false;
+        }
+        return true;
+    }
+
+    static constexpr uint32_t MAGIC = 0x41585053;  // "SPXA"
+    static constexpr uint16_t VERSION = 1;
+
+private:
+    std::string_view record(size_t index) const;
+
+    std::string_view m_records;
+    const char* m_offsets = nullptr;
+    size_t m_count = 0;
+    Kind m_kind = Kind::MediaItem;
+};
+
+// A file mapped read-only into memory, or read in one go where mmap is not
+// available (Switch)
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    std::string_view data() const { return std::string_view(m_data, m_size); }
+
+private:
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_mapped = false;
+    std::string m_buffer;
+};
+
+// Writes through a temporary file so an interrupted save never leaves a
+// truncated archive behind
+bool writeArchive(const std::string& path, const std::string& data);
+
+}  // namespace plex::codec
+
+#endif
@@ -39,6 +39,7 @@ struct Stream {
     bool selected = false;
     bool isDefault = false;
     std::string decision;
+    std::string key;  // set for sidecar subtitle files
     int index = 0;
     int channels = 0;
     int bitrate = 0;
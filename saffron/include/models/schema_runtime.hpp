@@ -0,0 +1,284 @@
+#ifndef SAFFRON_SCHEMA_RUNTIME_HPP
+#define SAFFRON_SCHEMA_RUNTIME_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Support code for the models generated from the Plex OpenAPI spec
+// (scripts/generate_models.py). Generated structs hold string_views into the
+// response body and lists in an arena owned by the Document, so parsing a
+// response does no per-field allocation.
+namespace plex::schema {
+
+// FNV-1a, shared with the generated field dispatch
+constexpr uint32_t fieldHash(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+template <typename T>
+struct List {
+    const T* data = nullptr;
+    uint32_t count = 0;
+
+    const T* begin() const { return data; }
+    const T* end() const { return data + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T& operator[](size_t i) const { return data[i]; }
+};
+
+// Outcome of reading a field: values of the wrong shape are skipped and
+// leave the field unset
+enum class Read : uint8_t {
+    Error,
+    Skipped,
+    Value
+};
+
+// Bump allocator for list storage; reset() keeps the first block so a
+// reused Document stops allocating once warm
+class Arena {
+public:
+    template <typename T>
+    T* allocate(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destructed");
+        return static_cast<T*>(allocateBytes(count * sizeof(T), alignof(T)));
+    }
+
+    void reset();
+    size_t capacity() const;
+
+private:
+    void* allocateBytes(size_t size, size_t align);
+
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_used = 0;  // within the last block
+
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+};
+
+// Pull parser over a mutable, NUL-terminated JSON buffer. Strings are
+// unescaped in place, so views into the buffer stay valid as long as it.
+// Number and string coercion follows plex::from_json, except that numbers
+// read as text keep their original spelling.
+class Reader {
+public:
+    Reader(char* begin, char* end, std::vector<std::vector<unsigned char>>& scratch)
+        : m_pos(begin), m_end(end), m_begin(begin), m_scratch(scratch) {}
+
+    bool ok() const { return m_error == nullptr; }
+    const char* error() const { return m_error; }
+    size_t offset() const { return static_cast<size_t>(m_pos - m_begin); }
+
+    // Consumes a null; true if the value was null
+    bool consumeNull();
+
+    Read readText(std::string_view& out);
+    Read readInt(int32_t& out);
+    Read readInt(int64_t& out);
+    Read readDouble(double& out);
+    Read readBool(bool& out);
+    bool skipValue();
+
+    // Calls onField(key) with the reader on each member's value; onField
+    // must consume the value and return false on error
+    template <typename F>
+    Read readObject(F&& onField);
+
+    // Parses each element with parseElement(T&), which returns a Read, and
+    // copies them into the arena
+    template <typename T, typename F>
+    Read readList(Arena& arena, List<T>& out, F&& parseElement);
+
+    void fail(const char* message);
+
+private:
+    void skipWhitespace() {
+        while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\n' || *m_pos == '\r' || *m_pos == '\t')) m_pos++;
+    }
+    char peek() {
+        skipWhitespace();
+        return m_pos < m_end ? *m_pos : '\0';
+    }
+    bool consume(char c) {
+        if (peek() != c) return false;
+        m_pos++;
+        return true;
+    }
+    bool readString(std::string_view& out);
+    bool readNumberToken(std::string_view& token, bool& integer);
+    bool skipArray();
+    bool skipString();
+    bool skipLiteral(const char* literal, size_t length);
+
+    char* m_pos;
+    char* m_end;
+    char* m_begin;
+    const char* m_error = nullptr;
+    int m_nesting = 0;
+    size_t m_listDepth = 0;
+    std::vector<std::vector<unsigned char>>& m_scratch;
+
+    static constexpr int MAX_NESTING = 128;
+};
+
+template <typename F>
+Read Reader::readObject(F&& onField) {
+    if (!consume('{')) {
+        return skipValue() ? Read::Skipped : Read::Error;
+    }
+    if (++m_nesting > MAX_NESTING) {
+        fail("nesting too deep");
+        return Read::Error;
+    }
+    if (!consume('}')) {
+        while (true) {
+            std::string_view key;
+            if (peek() != '"' || !readString(key)) {
+                fail("expected member name");
+                return Read::Error;
+            }
+            if (!consume(':')) {
+                fail("expected ':'");
+                return Read::Error;
+            }
+            if (!onField(key) || !ok()) return Read::Error;
+            if (consume(',')) continue;
+            if (consume('}')) break;
+            fail("expected ',' or '}'");
+            return Read::Error;
+        }
+    }
+    m_nesting--;
+    return Read::Value;
+}
+
+template <typename T, typename F>
+Read Reader::readList(Arena& arena, List<T>& out, F&& parseElement) {
+    static_assert(std::is_trivially_copyable<T>::value, "list elements are copied as bytes");
+    if (!consume('[')) {
+        return skipValue() ? Read::Skipped : Read::Error;
+    }
+    if (++m_nesting > MAX_NESTING) {
+        fail("nesting too deep");
+        return Read::Error;
+    }
+
+    // Elements collect in a per-depth scratch buffer (nested lists are
+    // parsed while this one is open) and move to the arena in one piece
+    size_t depth = m_listDepth++;
+    if (m_scratch.size() <= depth) m_scratch.resize(depth + 1);
+    m_scratch[depth].clear();
+
+    uint32_t count = 0;
+    if (!consume(']')) {
+        while (true) {
+            T element{};
+            if (parseElement(element) == Read::Error || !ok()) return Read::Error;
+            auto& scratch = m_scratch[depth];
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&element);
+            scratch.insert(scratch.end(), bytes, bytes + sizeof(T));
+            count++;
+            if (consume(',')) continue;
+            if (consume(']')) break;
+            fail("expected ',' or ']'");
+            return Read::Error;
+        }
+    }
+
+    if (count > 0) {
+        T* data = arena.allocate<T>(count);
+        memcpy(static_cast<void*>(data), m_scratch[depth].data(), count * sizeof(T));
+        out.data = data;
+        out.count = count;
+    }
+    m_listDepth--;
+    m_nesting--;
+    return Read::Value;
+}
+
+// Marks `field` present on `target` when a value was read; false on error
+template <typename S>
+bool store(Read result, S& target, typename S::Field field) {
+    if (result == Read::Value) target.mark(field);
+    return result != Read::Error;
+}
+
+// Appends compact JSON to a string
+class Writer {
+public:
+    explicit Writer(std::string& out) : m_out(out) {}
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    void key(std::string_view name);
+
+    void value(std::string_view text);
+    void value(int32_t number) { value(static_cast<int64_t>(number)); }
+    void value(int64_t number);
+    void value(double number);
+    void value(bool flag);
+
+private:
+    void separate();
+
+    std::string& m_out;
+    uint64_t m_first = 1;  // bit per nesting level: no member written yet
+    int m_depth = 0;
+    bool m_afterKey = false;
+};
+
+// Owns a response body and the models parsed from it
+template <typename T>
+class Document {
+public:
+    // Takes the body by value; move it in to avoid a copy
+    bool parse(std::string body) {
+        m_body = std::move(body);
+        m_arena.reset();
+        m_root = T{};
+        m_error.clear();
+
+        static thread_local std::vector<std::vector<unsigned char>> scratch;
+        Reader reader(&m_body[0], &m_body[0] + m_body.size(), scratch);
+        // read() is found by argument-dependent lookup among the generated models
+        if (read(reader, m_arena, m_root) != Read::Value || !reader.ok()) {
+            m_error = std::string(reader.error() ? reader.error() : "invalid document") + " at offset " +
+                      std::to_string(reader.offset());
+            m_root = T{};
+            return false;
+        }
+        return true;
+    }
+
+    const T& root() const { return m_root; }
+    const std::string& error() const { return m_error; }
+
+private:
+    std::string m_body;
+    Arena m_arena;
+    T m_root{};
+    std::string m_error;
+};
+
+}  // namespace plex::schema
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef SAFFRON_BINARY_IO_HPP
+#define SAFFRON_BINARY_IO_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// Little helpers for the on-disk caches: fixed-width values are copied
+// as-is and strings are prefixed with a 16-bit length. Varints are LEB128,
+// seven bits per byte, low bits first.
+class BinaryWriter {
+public:
+    template<typename T>
+    void put(T value) {
+        m_buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void putString(const std::string& s) {
+        uint16_t len = static_cast<uint16_t>(std::min<size_t>(s.size(), UINT16_MAX));
+        put(len);
+        m_buffer.append(s.data(), len);
+    }
+
+    void putVarint(uint64_t value) {
+        while (value >= 0x80) {
+            m_buffer += static_cast<char>((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+        m_buffer += static_cast<char>(value);
+    }
+
+    std::string& buffer() { return m_buffer; }
+    size_t size() const { return m_buffer.size(); }
+
+private:
+    std::string m_buffer;
+};
+
+class BinaryReader {
+public:
+    explicit BinaryReader(std::string_view data) : m_data(data) {}
+
+    template<typename T>
+    bool get(T& value) {
+        if (m_pos + sizeof(T) > m_data.size()) return false;
+        memcpy(&value, m_data.data() + m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string& s) {
+        uint16_t len = 0;
+        if (!get(len) || m_pos + len > m_data.size()) return false;
+        s.assign(m_data.data() + m_pos, len);
+        m_pos += len;
+        return true;
+    }
+
+    bool getVarint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && m_pos < m_data.size(); shift += 7) {
+            uint8_t byte = static_cast<uint8_t>(m_data[m_pos++]);
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    // A view of the next `length` bytes, which stays valid as long as the data
+    bool getBytes(size_t length, std::string_view& bytes) {
+        if (length > m_data.size() - m_pos) return false;
+        bytes = m_data.substr(m_pos, length);
+        m_pos += length;
+        return true;
+    }
+
+    bool atEnd() const { return m_pos >= m_data.size(); }
+    size_t remaining() const { return m_data.size() - m_pos; }
+
+private:
+    std::string_view m_data;
+    size_t m_pos = 0;
+};
+
+#endif
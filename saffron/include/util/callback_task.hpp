@@ -0,0 +1,23 @@
+#ifndef SAFFRON_CALLBACK_TASK_HPP
+#define SAFFRON_CALLBACK_TASK_HPP
+
+#include <borealis.hpp>
+
+#include <functional>
+#include <utility>
+
+// brls::RepeatingTask that runs a callback every period, on the UI thread
+class CallbackTask : public brls::RepeatingTask {
+public:
+    CallbackTask(brls::Time period, std::function<void()> callback)
+        : brls::RepeatingTask(period), m_callback(std::move(callback)) {}
+
+    void run() override {
+        if (m_callback) m_callback();
+    }
+
+private:
+    std::function<void()> m_callback;
+};
+
+#endif
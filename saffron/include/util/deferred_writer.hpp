@@ -0,0 +1,33 @@
+#ifndef SAFFRON_DEFERRED_WRITER_HPP
+#define SAFFRON_DEFERRED_WRITER_HPP
+
+#include <map>
+#include <mutex>
+#include <string>
+
+// Writes cache files off the UI thread. Only the newest contents of each
+// path are kept: a write that has not started yet is replaced by a later
+// one for the same path. flush() writes whatever is still queued on the
+// calling thread, after any write already in progress, so the exit path
+// can persist the last save before the thread pool stops.
+class DeferredWriter {
+public:
+    // Queues data for path and schedules a background write
+    void write(const std::string& path, std::string data);
+
+    // Writes everything still queued; returns false if a write failed
+    bool flush();
+
+    // Writes through a temporary file so an interrupted write never leaves a
+    // truncated file behind; creates the parent directory
+    static bool writeFile(const std::string& path, const std::string& data);
+
+private:
+    std::mutex m_queueMutex;
+    std::map<std::string, std::string> m_queue;
+
+    // Held for the whole write so writes of one path land in order
+    std::mutex m_writeMutex;
+};
+
+#endif
@@ -8,6 +8,12 @@
 #include <nanovg.h>
 #include <borealis/extern/nanovg/stb_image.h>
 
+#include "core/bandwidth_estimator.hpp"
+#include "core/http_recorder.hpp"
+#include "util/launch_metrics.hpp"
+#include "util/log.hpp"
+#include "util/trace.hpp"
+
 #include <string>
 #include <vector>
 #include <list>
@@ -16,6 +22,7 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <functional>
 
@@ -73,7 +80,7 @@ private:
             m_queue.pop();
             m_activeCount++;
         }
-        brls::async(std::move(task));
+        trace::async("ImageLoader::doRequest", std::move(task));
     }
 
     std::queue<std::function<void()>> m_queue;
@@ -271,38 +278,56 @@ private:
             return;
         }
 
-        CURL* curl = CurlPool::instance().acquire();
-        if (!curl) {
-            clear(imagePtr, self);
-            ImageQueue::instance().onTaskComplete();
-            return;
-        }
-
         std::string data;
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &data);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 15L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        long httpCode = 0;
+        std::string transferError;
+        HttpRecorder* recorder = HttpRecorder::getInstance();
+
+        if (recorder->isReplaying()) {
+            HttpRecorder::Exchange exchange = recorder->replay("GET", url);
+            data = std::move(exchange.body);
+            httpCode = exchange.status;
+            transferError = exchange.error;
+        } else {
+            CURL* curl = CurlPool::instance().acquire();
+            if (!curl) {
+                clear(imagePtr, self);
+                ImageQueue::instance().onTaskComplete();
+                return;
+            }
 
-        CURLcode res = curl_easy_perform(curl);
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &data);
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 15L);
+            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+            curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+            curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+
+            auto started = std::chrono::steady_clock::now();
+            CURLcode res;
+            {
+                TRACE_SCOPE("curl_easy_perform");
+                res = curl_easy_perform(curl);
+            }
 
-        long httpCode = 0;
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-        CurlPool::instance().release(curl);
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+            if (res == CURLE_OK) BandwidthEstimator::getInstance()->record(curl);
+            else transferError = curl_easy_strerror(res);
+            CurlPool::instance().release(curl);
+            recorder->record("GET", url, started, httpCode, data, transferError);
+        }
 
-        if (res != CURLE_OK) {
-            brls::Logger::error("ImageLoader: curl failed for {} - {}", url, curl_easy_strerror(res));
+        if (!transferError.empty()) {
+            LOGE("ImageLoader: curl failed for {} - {}", url, transferError);
             clear(imagePtr, self);
             ImageQueue::instance().onTaskComplete();
             return;
         }
 
         if (httpCode != 200) {
-            brls::Logger::debug("ImageLoader: HTTP {} for {}", httpCode, url);
+            LOGD("ImageLoader: HTTP {} for {}", httpCode, url);
             clear(imagePtr, self);
             ImageQueue::instance().onTaskComplete();
             return;
@@ -315,11 +340,15 @@ private:
         }
 
         int imageW = 0, imageH = 0, n = 0;
-        uint8_t* imageData = stbi_load_from_memory(
-            (unsigned char*)data.c_str(), data.size(), &imageW, &imageH, &n, 4);
+        uint8_t* imageData;
+        {
+            TRACE_SCOPE("stbi decode");
+            imageData = stbi_load_from_memory(
+                (unsigned char*)data.c_str(), data.size(), &imageW, &imageH, &n, 4);
+        }
 
         if (!imageData) {
-            brls::Logger::error("ImageLoader: stbi decode failed for {}", url);
+            LOGE("ImageLoader: stbi decode failed for {}", url);
             clear(imagePtr, self);
             ImageQueue::instance().onTaskComplete();
             return;
@@ -331,7 +360,7 @@ private:
             ImageQueue::instance().onTaskComplete();
             return;
         }
-        brls::sync([imageData, imageW, imageH, cancelFlag, imagePtr, url, self]() {
+        trace::sync("ImageLoader upload", [imageData, imageW, imageH, cancelFlag, imagePtr, url, self]() {
             if (!cancelFlag->load() && imagePtr && !s_paused.load()) {
                 int tex = brls::TextureCache::instance().getCache(url);
                 if (tex == 0) {
@@ -340,10 +369,11 @@ private:
                     brls::TextureCache::instance().addCache(url, tex);
                 }
                 if (tex > 0) {
-                    brls::Logger::debug("ImageLoader: Loaded {} ({}x{})", url, imageW, imageH);
+                    LOGV("ImageLoader: Loaded {} ({}x{})", url, imageW, imageH);
                     imagePtr->innerSetImage(tex);
+                    LaunchMetrics::markFirstPoster();
                 } else {
-                    brls::Logger::error("ImageLoader: nvgCreateImageRGBA failed for {}", url);
+                    LOGE("ImageLoader: nvgCreateImageRGBA failed for {}", url);
                 }
                 clear(imagePtr, self);
             }
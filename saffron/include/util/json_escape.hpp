@@ -0,0 +1,10 @@
+#ifndef SAFFRON_JSON_ESCAPE_HPP
+#define SAFFRON_JSON_ESCAPE_HPP
+
+#include <string>
+
+// Escapes a value for a JSON string literal, for the exports written with
+// printf rather than through nlohmann::json
+std::string escapeJson(const std::string& value);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef SAFFRON_LAUNCH_METRICS_HPP
+#define SAFFRON_LAUNCH_METRICS_HPP
+
+#include "util/log.hpp"
+
+#include <atomic>
+#include <chrono>
+
+// One-shot timings from process start, used to compare cold launches with
+// launches served from the on-disk library cache.
+class LaunchMetrics {
+public:
+    static void markStart() {
+        s_start = std::chrono::steady_clock::now();
+    }
+
+    static void setWarmStart(bool warm) { s_warm.store(warm); }
+
+    static void markFirstSectionRender(const char* source) {
+        if (s_sectionReported.exchange(true)) return;
+        LOGI("LaunchMetrics: first library section rendered from {} after {} ms",
+             source, elapsedMs());
+    }
+
+    static void markFirstPoster() {
+        if (s_posterReported.exchange(true)) return;
+        LOGI("LaunchMetrics: time-to-first-poster {} ms ({} launch)",
+             elapsedMs(), s_warm.load() ? "warm" : "cold");
+    }
+
+private:
+    static long long elapsedMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - s_start).count();
+    }
+
+    inline static std::chrono::steady_clock::time_point s_start = std::chrono::steady_clock::now();
+    inline static std::atomic<bool> s_warm{false};
+    inline static std::atomic<bool> s_sectionReported{false};
+    inline static std::atomic<bool> s_posterReported{false};
+};
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef SAFFRON_LOG_HPP
+#define SAFFRON_LOG_HPP
+
+#include <borealis.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Logging for hot paths. LOGE/LOGW/LOGI/LOGD/LOGV take brls::Logger's
+// arguments, but:
+//
+// - Levels above SAFFRON_LOG_LEVEL are compiled out, arguments and all, so
+//   a release build does not even evaluate a filtered call's arguments.
+//   CMake sets the level: verbose for Debug builds, info otherwise.
+// - Messages that pass are formatted straight into a slot of a fixed ring
+//   and written to brls::Logger (stdout/nxlink) by a background thread, so
+//   the caller never blocks on output. When the ring is full, messages are
+//   dropped and counted rather than waited for.
+//
+// brls::Logger's runtime level still applies, and is checked before any
+// formatting.
+
+#define SAFFRON_LOG_LEVEL_ERROR 0
+#define SAFFRON_LOG_LEVEL_WARNING 1
+#define SAFFRON_LOG_LEVEL_INFO 2
+#define SAFFRON_LOG_LEVEL_DEBUG 3
+#define SAFFRON_LOG_LEVEL_VERBOSE 4
+
+#ifndef SAFFRON_LOG_LEVEL
+#define SAFFRON_LOG_LEVEL SAFFRON_LOG_LEVEL_INFO
+#endif
+
+#define SAFFRON_LOG_AT(threshold, level, ...)                                   \
+    do {                                                                        \
+        if constexpr ((threshold) <= SAFFRON_LOG_LEVEL) {                       \
+            if (AsyncLog::isEnabled(level)) AsyncLog::write(level, __VA_ARGS__); \
+        }                                                                       \
+    } while (0)
+
+#define LOGE(...) SAFFRON_LOG_AT(SAFFRON_LOG_LEVEL_ERROR, brls::LogLevel::LOG_ERROR, __VA_ARGS__)
+#define LOGW(...) SAFFRON_LOG_AT(SAFFRON_LOG_LEVEL_WARNING, brls::LogLevel::LOG_WARNING, __VA_ARGS__)
+#define LOGI(...) SAFFRON_LOG_AT(SAFFRON_LOG_LEVEL_INFO, brls::LogLevel::LOG_INFO, __VA_ARGS__)
+#define LOGD(...) SAFFRON_LOG_AT(SAFFRON_LOG_LEVEL_DEBUG, brls::LogLevel::LOG_DEBUG, __VA_ARGS__)
+#define LOGV(...) SAFFRON_LOG_AT(SAFFRON_LOG_LEVEL_VERBOSE, brls::LogLevel::LOG_VERBOSE, __VA_ARGS__)
+
+class AsyncLog {
+public:
+    static AsyncLog* getInstance();
+
+    static bool isEnabled(brls::LogLevel level) { return level <= brls::Logger::getLogLevel(); }
+
+    template <typename... Args>
+    static void write(brls::LogLevel level, fmt::format_string<Args...> format, Args&&... args) {
+        AsyncLog* log = getInstance();
+        // Counted before the flag is read, so shutdown() sees every producer
+        // that may still commit into the ring
+        log->m_writers.fetch_add(1);
+        if (!log->m_running.load()) {
+            log->m_writers.fetch_sub(1, std::memory_order_release);
+            char text[MAX_LINE];
+            auto result = fmt::format_to_n(text, MAX_LINE - 1, format, std::forward<Args>(args)...);
+            text[std::min<size_t>(result.size, MAX_LINE - 1)] = '\0';
+            output(level, text);
+            return;
+        }
+
+        size_t ticket;
+        char* text = log->claim(ticket);
+        if (text) {
+            auto result = fmt::format_to_n(text, MAX_LINE - 1, format, std::forward<Args>(args)...);
+            log->commit(ticket, level, std::min<size_t>(result.size, MAX_LINE - 1));
+        }
+        log->m_writers.fetch_sub(1, std::memory_order_release);
+    }
+
+    // Writes out everything queued so far and stops the writer thread;
+    // later messages are written synchronously
+    void shutdown();
+
+    // Messages lost because the ring was full
+    uint64_t getDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // Longer messages are cut off
+    static constexpr size_t MAX_LINE = 512;
+    static constexpr size_t CAPACITY = 256;  // a power of two
+
+private:
+    AsyncLog();
+    ~AsyncLog();
+
+    // A free slot's text buffer, or null when the ring is full
+    char* claim(size_t& ticket);
+    void commit(size_t ticket, brls::LogLevel level, size_t length);
+
+    void run();
+    bool drain();
+    static void output(brls::LogLevel level, const char* text);
+
+    // Bounded multi-producer ring (Vyukov): a slot is free for the producer
+    // holding ticket t when its sequence is t, and ready for the writer when
+    // it is t + 1
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        brls::LogLevel level = brls::LogLevel::LOG_INFO;
+        size_t length = 0;
+        char text[MAX_LINE];
+    };
+
+    Slot m_slots[CAPACITY];
+    std::atomic<size_t> m_tail{0};
+    size_t m_head = 0;  // writer thread only
+    std::atomic<uint64_t> m_dropped{0};
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::atomic<bool> m_waiting{false};
+    std::atomic<bool> m_running{true};
+    std::atomic<int> m_writers{0};  // producers between the flag check and commit
+    std::thread m_thread;
+};
+
+#endif
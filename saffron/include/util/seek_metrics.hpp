@@ -0,0 +1,59 @@
+#ifndef SAFFRON_SEEK_METRICS_HPP
+#define SAFFRON_SEEK_METRICS_HPP
+
+#include "util/log.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+// Seek-to-first-frame latency of transcoded seeks, split by how the seek
+// was served, so the cheap paths can be compared with a full restart.
+// Only touched from the UI thread.
+class SeekMetrics {
+public:
+    enum class Path {
+        Cache,    // target already in mpv's demuxer cache
+        Session,  // seek inside the current HLS stream / transcode session
+        Restart,  // new playback decision and a fresh transcode
+        Count
+    };
+
+    static const char* pathName(Path path) {
+        switch (path) {
+            case Path::Cache: return "cache";
+            case Path::Session: return "session";
+            case Path::Restart: return "restart";
+            default: return "unknown";
+        }
+    }
+
+    static void record(Path path, int64_t latencyMs) {
+        Stats& stats = s_stats[static_cast<int>(path)];
+        stats.count++;
+        stats.totalMs += latencyMs;
+        stats.maxMs = std::max(stats.maxMs, latencyMs);
+        LOGI("SeekMetrics: {} seek took {} ms (avg {} ms over {})",
+             pathName(path), latencyMs, stats.totalMs / stats.count, stats.count);
+    }
+
+    static void logSummary() {
+        for (int i = 0; i < static_cast<int>(Path::Count); i++) {
+            const Stats& stats = s_stats[i];
+            if (stats.count == 0) continue;
+            LOGI("SeekMetrics: {} - {} seeks, avg {} ms, max {} ms",
+                 pathName(static_cast<Path>(i)), stats.count,
+                 stats.totalMs / stats.count, stats.maxMs);
+        }
+    }
+
+private:
+    struct Stats {
+        int64_t count = 0;
+        int64_t totalMs = 0;
+        int64_t maxMs = 0;
+    };
+
+    inline static Stats s_stats[static_cast<int>(Path::Count)];
+};
+
+#endif
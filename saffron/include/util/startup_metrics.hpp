@@ -0,0 +1,91 @@
+#ifndef SAFFRON_STARTUP_METRICS_HPP
+#define SAFFRON_STARTUP_METRICS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "util/deferred_writer.hpp"
+
+// Time-to-first-frame of a play request, split into the stages between
+// pressing Play and the first rendered video frame. Each finished run is
+// appended to the SD card so p50/p95 per server and route (direct play or
+// HLS) survive restarts and startup regressions show up over time. The file
+// is read in the background at launch and rewritten with the newest
+// MAX_HISTORY runs after each one, never on the frame being measured.
+// Only touched from the UI thread.
+class StartupMetrics {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Marks in pipeline order; each one ends the span named after it
+    enum class Stage {
+        Begin,           // Play pressed
+        OptionsChecked,  // decision for the quality menu returned
+        QualityChosen,   // user picked a quality (waiting on the user)
+        PlayerOpened,    // PlayerView created
+        DecisionReady,   // PlayerView's playback decision returned
+        LoadFile,        // loadfile sent to mpv
+        FileLoaded,      // mpv opened the stream
+        FirstFrame,      // first video frame rendered
+        Count
+    };
+
+    struct Result {
+        bool valid = false;
+        bool directPlay = false;
+        std::string server;
+        int64_t totalMs = 0;  // excludes time spent in the quality menu
+        int64_t spanMs[static_cast<int>(Stage::Count)] = {};  // -1 when skipped
+    };
+
+    struct Summary {
+        int count = 0;
+        int64_t p50Ms = 0;
+        int64_t p95Ms = 0;
+    };
+
+    static const char* stageName(Stage stage);
+
+    // Reads the saved runs in the background; call once at startup. Runs
+    // finished before it completes are kept after the saved ones
+    static void loadHistory();
+
+    static void begin();
+    // Later marks of a stage already seen are ignored
+    static void mark(Stage stage, Clock::time_point at = Clock::now());
+    static void setRoute(bool directPlay, const std::string& server);
+
+    static const Result& getLast() { return s_last; }
+    static Summary getSummary(bool directPlay, const std::string& server);
+
+private:
+    struct Record {
+        std::string server;
+        bool directPlay;
+        int64_t totalMs;
+        std::string line;  // the CSV row, written back when the file is trimmed
+    };
+
+    static void finish();
+    static std::vector<Record> readHistory();
+    static void saveHistory();
+    static std::string sanitize(const std::string& value);
+
+    static bool s_active;
+    static bool s_marked[static_cast<int>(Stage::Count)];
+    static Clock::time_point s_marks[static_cast<int>(Stage::Count)];
+    static bool s_directPlay;
+    static std::string s_server;
+    static Result s_last;
+
+    static bool s_historyLoaded;
+    static std::vector<Record> s_history;
+    static DeferredWriter s_writer;
+
+    static constexpr const char* HISTORY_FILE = "sdmc:/switch/saffron/ttff.csv";
+    static constexpr size_t MAX_HISTORY = 500;
+};
+
+#endif
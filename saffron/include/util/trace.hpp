@@ -0,0 +1,90 @@
+#ifndef SAFFRON_TRACE_HPP
+#define SAFFRON_TRACE_HPP
+
+#include <borealis.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Scoped trace events for seeing where time goes as work hops between the
+// main thread and brls::async workers. Each thread appends to its own ring
+// buffer without locking; a dump writes every buffer out in Chrome trace
+// format (chrome://tracing, ui.perfetto.dev).
+//
+// trace::async and trace::sync stand in for brls::async and brls::sync and
+// link a submission to the task it starts with a flow arrow. A sync posted
+// from inside a traced async task continues that task's flow, so a request
+// shows up as one chain from the view that made it to the callback that
+// fills the view in.
+//
+// Only built with SAFFRON_TRACE defined (cmake -DSAFFRON_TRACE=ON). Without
+// it the macros expand to nothing and async/sync forward straight to
+// borealis, so the calls cost nothing.
+//
+// Names must be string literals: only the pointer is stored.
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef SAFFRON_TRACE
+
+// Times the rest of the enclosing block
+#define TRACE_SCOPE(name) trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_INSTANT(name) trace::instant(name)
+
+namespace trace {
+
+class Scope {
+public:
+    explicit Scope(const char* name);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t m_startUs;
+};
+
+void instant(const char* name);
+
+void async(const char* name, std::function<void()> task, bool dedicated = false);
+void sync(const char* name, std::function<void()> task);
+
+// Shown instead of "thread N" in the viewer
+void setThreadName(const char* name);
+
+// Writes everything still in the buffers; buffers are not cleared
+bool dump(const std::string& path);
+
+// Dumps to DUMP_DIR/<time>.json; the path written, or empty on failure
+std::string dumpToCard();
+
+constexpr const char* DUMP_DIR = "sdmc:/switch/saffron/traces";
+
+// Events kept per thread; older ones are overwritten
+constexpr size_t BUFFER_EVENTS = 8192;
+
+}  // namespace trace
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_INSTANT(name) ((void)0)
+
+namespace trace {
+
+inline void async(const char*, std::function<void()> task, bool dedicated = false) {
+    brls::async(std::move(task), dedicated);
+}
+inline void sync(const char*, std::function<void()> task) { brls::sync(std::move(task)); }
+inline void setThreadName(const char*) {}
+inline bool dump(const std::string&) { return false; }
+inline std::string dumpToCard() { return ""; }
+
+}  // namespace trace
+
+#endif
+
+#endif
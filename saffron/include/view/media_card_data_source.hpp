@@ -5,6 +5,7 @@
 
 #include "view/recycling_grid.hpp"
 #include "models/plex_types.hpp"
+#include "core/entity_store.hpp"
 
 class PlexServer;
 
@@ -18,13 +19,15 @@ public:
     void clearData() override;
 
     void setData(const std::vector<plex::MediaItem>& items);
+    void setData(const std::vector<EntityRef>& items);
     void appendData(const std::vector<plex::MediaItem>& items);
-    const plex::MediaItem& getItem(size_t index) const;
+    void appendData(const std::vector<EntityRef>& items);
+    const EntityRef& getItem(size_t index) const;
 
     void setOnItemClick(std::function<void(const plex::MediaItem&)> callback);
 
 private:
     PlexServer* m_server = nullptr;
-    std::vector<plex::MediaItem> m_items;
+    std::vector<EntityRef> m_items;
     std::function<void(const plex::MediaItem&)> m_onItemClick;
 };
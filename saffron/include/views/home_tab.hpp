@@ -6,6 +6,7 @@
 #include <memory>
 
 #include "models/plex_types.hpp"
+#include "core/entity_store.hpp"
 
 class PlexServer;
 class SettingsManager;
@@ -46,7 +47,7 @@ public:
 
 private:
     PlexServer* m_server = nullptr;
-    plex::Hub m_hub;
+    std::vector<EntityRef> m_items;
 
     brls::Label* m_titleLabel = nullptr;
     brls::HScrollingFrame* m_scrollFrame = nullptr;
@@ -59,11 +60,12 @@ private:
 
 class HubItemView : public brls::Box {
 public:
-    HubItemView(PlexServer* server, const plex::MediaItem& item);
+    HubItemView(PlexServer* server, const EntityRef& item);
+    ~HubItemView() override;
 
     void setOnClick(std::function<void()> callback);
     void cancelPendingImage();
-    const plex::MediaItem& getItem() const { return m_item; }
+    const EntityRef& getItem() const { return m_item; }
 
     brls::View* getNextFocus(brls::FocusDirection direction, brls::View* currentView) override;
     void onFocusGained() override;
@@ -71,7 +73,8 @@ public:
 
 private:
     PlexServer* m_server = nullptr;
-    plex::MediaItem m_item;
+    EntityRef m_item;
+    EntityStore::ChangeEvent::Subscription m_changeSubscription;
 
     brls::Image* m_image = nullptr;
     brls::Label* m_titleLabel = nullptr;
@@ -79,6 +82,7 @@ private:
     NVGcolor m_originalTitleColor;
     NVGcolor m_originalSubtitleColor;
 
+    void applyItem();
     void loadImage();
 };
 
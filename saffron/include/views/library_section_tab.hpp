@@ -2,18 +2,12 @@
 #define SAFFRON_LIBRARY_SECTION_TAB_HPP
 
 #include <borealis.hpp>
-#include <unordered_map>
 #include "models/plex_types.hpp"
 
 class PlexServer;
 class RecyclingGrid;
 class MediaCardDataSource;
 
-struct LibraryCacheEntry {
-    std::vector<plex::MediaItem> items;
-    int totalSize = 0;
-};
-
 class LibrarySectionTab : public brls::Box {
 public:
     LibrarySectionTab(PlexServer* server, const plex::Library& library);
@@ -38,9 +32,10 @@ private:
 
     void loadItems();
     void loadMoreItems();
-    void restoreFromCache();
+    void restoreFromCache(bool fromDisk);
+    void startSync();
+    void attachDataSource();
 
-    static std::unordered_map<int, LibraryCacheEntry> s_cache;
     static LibrarySectionTab* s_currentInstance;
     static bool s_isActive;
 };
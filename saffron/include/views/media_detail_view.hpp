@@ -4,6 +4,7 @@
 #include <borealis.hpp>
 #include <memory>
 #include "models/plex_types.hpp"
+#include "core/entity_store.hpp"
 
 class PlexServer;
 class RecyclingGrid;
@@ -22,9 +23,11 @@ private:
     void setupUI();
     void updateUI();
     void updateTechnicalInfo();
-    void playMedia();
-    void showResumeDialog();
-    void startPlaybackFlow();
+    // askQuality opens the quality menu even with auto quality enabled
+    void playMedia(bool askQuality);
+    void showResumeDialog(bool askQuality);
+    void startPlaybackFlow(bool askQuality);
+    void playWithAutoQuality();
     void showQualityMenu(const plex::PlaybackInfo& info);
     void showSourceSelector();
     void showMediaInfo();
@@ -62,6 +65,7 @@ private:
     bool m_metadataLoaded = false;
     bool m_isVisible = false;
     int m_requestId = 0;
+    EntityStore::ChangeEvent::Subscription m_changeSubscription;
 
     static MediaDetailView* s_instance;
 };
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "models/plex_types.hpp"
+#include "core/entity_store.hpp"
 #include "view/focusable_card.hpp"
 
 class PlexServer;
@@ -55,20 +56,24 @@ private:
 class MediaCardView : public FocusableCard {
 public:
     MediaCardView();
+    ~MediaCardView() override;
 
     void setData(PlexServer* server, const plex::MediaItem& item);
+    void setData(PlexServer* server, const EntityRef& item);
     void prepareForReuse() override;
     void cacheForReuse() override;
     void cancelPendingRequests() override;
 
     void setOnClick(std::function<void()> callback);
-    const plex::MediaItem& getItem() const { return m_item; }
+    const EntityRef& getItem() const { return m_item; }
 
     static RecyclingGridItem* create();
 
 private:
     PlexServer* m_server = nullptr;
-    plex::MediaItem m_item;
+    EntityRef m_item;
+    EntityStore::ChangeEvent::Subscription m_changeSubscription;
+    std::string m_loadedThumb;
 
     brls::Image* m_posterImage = nullptr;
     brls::Label* m_titleLabel = nullptr;
@@ -77,6 +82,7 @@ private:
     brls::Box* m_progressBar = nullptr;
     brls::Box* m_progressFill = nullptr;
 
+    void applyItem();
     void loadPosterImage();
     std::string buildImageUrl();
 };
@@ -10,7 +10,7 @@ class PlayerActivity : public brls::Activity {
 public:
     PlayerActivity(PlexServer* server, const plex::MediaItem& item,
                    int bitrate = 0, const std::string& resolution = "",
-                   int mediaIndex = 0);
+                   int mediaIndex = 0, bool adaptive = false);
 
     brls::View* createContentView() override;
 
@@ -20,6 +20,7 @@ private:
     int m_bitrate;
     std::string m_resolution;
     int m_mediaIndex;
+    bool m_adaptive;
 };
 
 #endif
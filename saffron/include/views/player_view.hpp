@@ -6,6 +6,10 @@
 #include "core/mpv_core.hpp"
 #include "core/plex_server.hpp"
 #include "models/plex_types.hpp"
+#include "core/abr_controller.hpp"
+#include "util/seek_metrics.hpp"
+
+#include <chrono>
 
 class VideoProfile;
 
@@ -13,7 +17,7 @@ class PlayerView : public brls::Box {
 public:
     PlayerView(PlexServer* server, const plex::MediaItem& item,
                int bitrate = 0, const std::string& resolution = "",
-               int mediaIndex = 0);
+               int mediaIndex = 0, bool adaptive = false);
     ~PlayerView() override;
 
     static brls::View* create();
@@ -36,15 +40,25 @@ private:
     void onProgress(int64_t position, int64_t duration);
     void onError(const std::string& error);
     void onEndFile(bool reachedEof);
+    void onPlaybackRestart();
 
     std::string formatTime(int64_t ms);
     void startPlayback();
     void startPlaybackWithOffset(int64_t offsetMs);
     void seekRelative(int64_t deltaMs);
     void executeSeek();
+    void beginSeek(SeekMetrics::Path path, int64_t targetMs);
+    void fallBackToRestart();
     void reportTimeline();
     void reportStopped();
     void playNextEpisode();
+    void prepareNextEpisode();
+    void handOverToNext(bool alreadyQueued);
+    void updateTitleLabel();
+    void startAbr();
+    void sampleAbr();
+    void setSidecarSubtitles(const plex::PlaybackInfo& info);
+    void loadSidecarSubtitles();
     bool isEpisode() const;
 
     PlexServer* m_server;
@@ -52,6 +66,7 @@ private:
     int m_bitrate;
     std::string m_resolution;
     int m_mediaIndex;
+    bool m_adaptive;
     int64_t m_startOffset = 0;
     bool m_isDirectPlay = false;
     std::string m_sessionId;
@@ -60,6 +75,36 @@ private:
     int64_t m_pendingSeekDelta = 0;
     bool m_seekDebounceActive = false;
 
+    // The transcoded seek in flight, timed until mpv shows the first frame
+    struct SeekInFlight {
+        bool active = false;
+        int id = 0;
+        SeekMetrics::Path path = SeekMetrics::Path::Cache;
+        int64_t targetMs = 0;
+        std::chrono::steady_clock::time_point start;
+    };
+    SeekInFlight m_seek;
+
+    // Next episode, resolved and decided a little before the current one
+    // ends so the switch does not wait on the network
+    struct NextEpisode {
+        enum class State { Idle, Resolving, Ready, Queued, Failed };
+        State state = State::Idle;
+        int forRatingKey = 0;
+        plex::MediaItem item;
+        plex::PlaybackInfo info;
+    };
+    NextEpisode m_next;
+
+    // Steps the transcode bitrate with the network when playing at
+    // automatic quality
+    AbrController m_abr;
+
+    // External subtitle files of the playing item, added to mpv on every
+    // file load; the generation drops downloads that finish too late
+    std::vector<plex::Stream> m_sidecarSubs;
+    int m_sidecarGeneration = 0;
+
     VideoView* m_videoView = nullptr;
     VideoProfile* m_profile = nullptr;
     brls::Box* m_osdContainer = nullptr;
@@ -73,9 +118,11 @@ private:
     bool m_osdVisible = true;
     brls::RepeatingTask* m_osdTimer = nullptr;
     brls::RepeatingTask* m_timelineTimer = nullptr;
+    brls::RepeatingTask* m_abrTimer = nullptr;
     int m_osdTimeout = 0;
 
     static constexpr int OSD_TIMEOUT_SECONDS = 5;
+    static constexpr int SESSION_SEEK_TIMEOUT_MS = 12000;
 
     static PlayerView* s_currentInstance;
     static bool s_isActive;
@@ -26,6 +26,7 @@ private:
     void init(bool isPopup);
     void openKeyboard();
     void performSearch(const std::string& query);
+    void searchLocal(const std::string& query);
     void displayResults(const std::vector<plex::Hub>& hubs);
     void clearResults();
     void cancelPendingImages();
@@ -40,10 +41,13 @@ private:
     SettingsManager* m_settings = nullptr;
     std::string m_currentQuery;
     std::vector<HubRowView*> m_hubRows;
+    plex::Hub m_localHub;
 
     brls::RepeatingTask* m_debounceTimer = nullptr;
     int m_searchRequestId = 0;
 
+    static constexpr size_t LOCAL_RESULT_LIMIT = 30;
+
     static SearchView* s_currentInstance;
     static bool s_isActive;
 };
@@ -23,10 +23,18 @@ private:
     brls::BooleanCell* m_autoPlayCell = nullptr;
     brls::BooleanCell* m_overclockCell = nullptr;
     brls::BooleanCell* m_bufferBeforePlayCell = nullptr;
+    brls::SelectorCell* m_preloadSelector = nullptr;
+    brls::BooleanCell* m_autoQualityCell = nullptr;
+    brls::BooleanCell* m_remuxOnlyCell = nullptr;
     brls::SelectorCell* m_seekSelector = nullptr;
     brls::SelectorCell* m_cacheSelector = nullptr;
+    brls::SelectorCell* m_diskCacheSelector = nullptr;
     brls::SelectorCell* m_videoSyncSelector = nullptr;
     brls::SelectorCell* m_framebufferSelector = nullptr;
+    brls::BooleanCell* m_pipelinedRenderCell = nullptr;
+    brls::SelectorCell* m_connectionsSelector = nullptr;
+    brls::BooleanCell* m_telemetryExportCell = nullptr;
+    brls::BooleanCell* m_networkRecordingCell = nullptr;
 
     brls::Box* m_powerUserSection = nullptr;
     brls::Label* m_versionLabel = nullptr;
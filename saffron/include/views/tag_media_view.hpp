@@ -6,6 +6,7 @@
 #include <string>
 
 #include "models/plex_types.hpp"
+#include "core/entity_store.hpp"
 #include "view/recycling_grid.hpp"
 
 class PlexServer;
@@ -76,7 +77,7 @@ public:
 
 private:
     PlexServer* m_server;
-    std::vector<plex::MediaItem> m_items;
+    std::vector<EntityRef> m_items;
     std::function<void(const plex::MediaItem&)> m_onItemClick;
 };
 
@@ -25,6 +25,9 @@ private:
     BRLS_BIND(brls::Label, labelAudioCodec, "profile/audio/codec");
     BRLS_BIND(brls::Label, labelAudioChannel, "profile/audio/channel");
     BRLS_BIND(brls::Label, labelCache, "profile/cache");
+    BRLS_BIND(brls::Label, labelStartupTotal, "profile/startup/total");
+    BRLS_BIND(brls::Label, labelStartupStages, "profile/startup/stages");
+    BRLS_BIND(brls::Label, labelStartupHistory, "profile/startup/history");
 };
 
 #endif
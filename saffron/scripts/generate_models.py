@@ -0,0 +1,414 @@
+#!/usr/bin/env python3
+"""Generates C++ models for Plex responses from the bundled OpenAPI spec.
+
+Usage: generate_models.py <spec.json> <config.json> <out.hpp> <out.cpp>
+
+The config names the root schemas to generate (JSON pointers into the spec),
+properties the spec leaves out of a component, the integer fields that need
+64 bits and per-field type overrides. Every object reachable from a root
+becomes a struct in plex::schema with a read() and write() overload; see
+include/models/schema_runtime.hpp for the types they use.
+
+Field types follow the spec: untyped and string fields are string_views into
+the response, integers are int32_t (int64_t for *At timestamps and the
+configured names), numbers are double, arrays are arena-backed Lists. Each
+struct carries a presence bit per field, so absent fields cost nothing beyond
+their default value.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+CPP_KEYWORDS = {
+    "alignas", "alignof", "and", "asm", "auto", "bool", "break", "case", "catch", "char", "class",
+    "const", "constexpr", "continue", "decltype", "default", "delete", "do", "double", "else", "enum",
+    "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if", "inline", "int",
+    "long", "mutable", "namespace", "new", "noexcept", "not", "nullptr", "operator", "or", "private",
+    "protected", "public", "register", "return", "short", "signed", "sizeof", "static", "struct",
+    "switch", "template", "this", "throw", "true", "try", "typedef", "typeid", "typename", "union",
+    "unsigned", "using", "virtual", "void", "volatile", "while", "xor",
+}
+
+# Members every generated struct already has
+RESERVED_MEMBERS = {"present", "has", "mark", "Field", "FIELD_COUNT"}
+
+SCALAR_TYPES = {
+    "text": "std::string_view",
+    "int32": "int32_t",
+    "int64": "int64_t",
+    "double": "double",
+    "bool": "bool",
+}
+
+SCALAR_READERS = {
+    "text": "readText",
+    "int32": "readInt",
+    "int64": "readInt",
+    "double": "readDouble",
+    "bool": "readBool",
+}
+
+# Declaration order within a struct, widest first, to keep padding down
+LAYOUT_ORDER = {"object": 0, "list": 1, "text": 1, "int64": 2, "double": 2, "int32": 3, "bool": 4}
+
+
+def fnv1a(name):
+    value = 2166136261
+    for byte in name.encode("utf-8"):
+        value ^= byte
+        value = (value * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def pascal(name):
+    parts = re.split(r"[^0-9A-Za-z]+", name)
+    return "".join(part[:1].upper() + part[1:] for part in parts if part)
+
+
+def cpp_string(text):
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+class Field:
+    def __init__(self, json_name, member, kind, element=None):
+        self.json_name = json_name
+        self.member = member
+        self.kind = kind  # text, int32, int64, double, bool, object, list
+        self.element = element  # struct name for objects; struct name or scalar kind for lists
+
+    def cpp_type(self):
+        if self.kind == "object":
+            return self.element
+        if self.kind == "list":
+            return "List<%s>" % SCALAR_TYPES.get(self.element, self.element)
+        return SCALAR_TYPES[self.kind]
+
+
+class Struct:
+    def __init__(self, name, prefix):
+        self.name = name
+        self.prefix = prefix  # name root for inline objects nested in this one
+        self.fields = []
+        self.skipped = []
+
+
+class Generator:
+    def __init__(self, spec, config):
+        self.spec = spec
+        self.int64_names = set(config.get("int64", []))
+        self.overrides = config.get("overrides", {})
+        self.structs = {}
+        self.order = []
+        self.by_component = {}
+        self.by_schema = {}
+
+    def pointer(self, ref):
+        if not ref.startswith("#/"):
+            raise ValueError("unsupported reference %s" % ref)
+        node = self.spec
+        for token in ref[2:].split("/"):
+            token = token.replace("~1", "/").replace("~0", "~")
+            node = node[token]
+        return node
+
+    def deref(self, schema):
+        """Follows $ref chains; returns the schema and the last component name on the way."""
+        component = None
+        while "$ref" in schema:
+            ref = schema["$ref"]
+            if ref.startswith("#/components/schemas/"):
+                component = ref[len("#/components/schemas/"):]
+            schema = self.pointer(ref)
+        return schema, component
+
+    def properties(self, schema):
+        schema, _ = self.deref(schema)
+        merged = {}
+        for part in schema.get("allOf", []):
+            merged.update(self.properties(part))
+        merged.update(schema.get("properties", {}))
+        return merged
+
+    def is_object(self, schema):
+        schema, _ = self.deref(schema)
+        return "properties" in schema or "allOf" in schema
+
+    def unique_name(self, candidates):
+        for name in candidates:
+            if name not in self.structs:
+                return name
+        base = candidates[-1]
+        n = 2
+        while "%s%d" % (base, n) in self.structs:
+            n += 1
+        return "%s%d" % (base, n)
+
+    def struct_for(self, schema, owner, property_name):
+        target, component = self.deref(schema)
+        if "$ref" in schema and component is not None:
+            if component not in self.by_component:
+                name = self.unique_name([pascal(component)])
+                self.by_component[component] = name
+                self.build(name, target, name)
+            return self.by_component[component]
+
+        # The same inline schema can be reached through several owners
+        # (allOf bases), so inline structs are keyed by identity
+        key = id(schema)
+        if key not in self.by_schema:
+            name = self.unique_name([owner.prefix + pascal(property_name), owner.name + pascal(property_name)])
+            self.by_schema[key] = name
+            self.build(name, schema, owner.prefix)
+        return self.by_schema[key]
+
+    def add_root(self, name, ref):
+        schema = self.pointer(ref)
+        if not self.is_object(schema):
+            raise ValueError("root %s is not an object" % name)
+        self.build(name, schema, name[:-4] if name.endswith("Page") else name)
+
+    def scalar_kind(self, name, schema_type):
+        if isinstance(schema_type, list):
+            schema_type = next((t for t in schema_type if t != "null"), None)
+        if schema_type == "integer":
+            return "int64" if name.endswith("At") or name in self.int64_names else "int32"
+        if schema_type == "number":
+            return "double"
+        if schema_type == "boolean":
+            return "bool"
+        if schema_type in (None, "string"):
+            return "text"
+        return None
+
+    def field_kind(self, struct, name, schema):
+        """Returns (kind, element) or (None, reason)."""
+        resolved, _ = self.deref(schema)
+        if name in self.overrides:
+            return self.overrides_kind(name)
+        if self.is_object(schema):
+            return "object", self.struct_for(schema, struct, name)
+        schema_type = resolved.get("type")
+        if schema_type == "array":
+            items = resolved.get("items")
+            if items is None:
+                return None, "array without items"
+            if self.is_object(items):
+                return "list", self.struct_for(items, struct, name)
+            item_type = self.deref(items)[0].get("type")
+            if item_type in ("array", "object"):
+                return None, "nested %s" % item_type
+            return "list", self.scalar_kind(name, item_type)
+        if schema_type == "object":
+            return None, "free-form object"
+        kind = self.scalar_kind(name, schema_type)
+        if kind is None:
+            return None, "type %s" % schema_type
+        return kind, None
+
+    def overrides_kind(self, name):
+        kind = self.scalar_kind(name, self.overrides[name])
+        if kind is None:
+            raise ValueError("override for %s is not a scalar type" % name)
+        return kind, None
+
+    def build(self, name, schema, prefix):
+        struct = Struct(name, prefix)
+        self.structs[name] = struct
+        members = set()
+        for json_name, property_schema in self.properties(schema).items():
+            kind, element = self.field_kind(struct, json_name, property_schema)
+            if kind is None:
+                struct.skipped.append((json_name, element))
+                continue
+            member = re.sub(r"[^0-9A-Za-z_]", "_", json_name)
+            member = member[:1].lower() + member[1:]
+            if member[:1].isdigit():
+                member = "_" + member
+            if member in CPP_KEYWORDS:
+                member += "_"
+            suffix = "List" if kind == "list" else "Value"
+            while member in members or member in RESERVED_MEMBERS:
+                member += suffix
+            members.add(member)
+            struct.fields.append(Field(json_name, member, kind, element))
+        # Dependencies are appended first, so by-value members are complete
+        # by the time their owner is declared
+        self.order.append(name)
+
+
+def emit_header(gen, spec_name):
+    out = []
+    out.append("// Generated by scripts/generate_models.py from %s; do not edit." % spec_name)
+    out.append("#ifndef SAFFRON_PLEX_SCHEMA_HPP")
+    out.append("#define SAFFRON_PLEX_SCHEMA_HPP")
+    out.append("")
+    out.append('#include "models/schema_runtime.hpp"')
+    out.append("")
+    out.append("namespace plex::schema {")
+    out.append("")
+    for name in gen.order:
+        out.append("struct %s;" % name)
+    out.append("")
+
+    for name in gen.order:
+        struct = gen.structs[name]
+        words = max(1, (len(struct.fields) + 63) // 64)
+        for json_name, reason in struct.skipped:
+            out.append("// %s: not generated (%s)" % (json_name, reason))
+        out.append("struct %s {" % name)
+        out.append("    enum class Field : uint16_t {")
+        for field in struct.fields:
+            out.append("        %s," % field.member)
+        out.append("    };")
+        out.append("    static constexpr size_t FIELD_COUNT = %d;" % len(struct.fields))
+        out.append("")
+        out.append("    uint64_t present[%d] = {};" % words)
+        for field in sorted(struct.fields, key=lambda f: LAYOUT_ORDER[f.kind]):
+            initializer = ""
+            if field.kind in ("int32", "int64", "double"):
+                initializer = " = 0"
+            elif field.kind == "bool":
+                initializer = " = false"
+            out.append("    %s %s%s;" % (field.cpp_type(), field.member, initializer))
+        out.append("")
+        out.append("    bool has(Field field) const {")
+        out.append("        auto i = static_cast<size_t>(field);")
+        out.append("        return (present[i / 64] >> (i % 64)) & 1;")
+        out.append("    }")
+        out.append("    void mark(Field field) {")
+        out.append("        auto i = static_cast<size_t>(field);")
+        out.append("        present[i / 64] |= uint64_t(1) << (i % 64);")
+        out.append("    }")
+        out.append("};")
+        out.append("")
+
+    for name in gen.order:
+        out.append("Read read(Reader& reader, Arena& arena, %s& out);" % name)
+    out.append("")
+    for name in gen.order:
+        out.append("void write(Writer& writer, const %s& in);" % name)
+    out.append("")
+    out.append("}  // namespace plex::schema")
+    out.append("")
+    out.append("#endif")
+    out.append("")
+    return "\n".join(out)
+
+
+def read_expression(field):
+    target = "out." + field.member
+    if field.kind == "object":
+        return "read(reader, arena, %s)" % target
+    if field.kind == "list":
+        if field.element in SCALAR_TYPES:
+            return "reader.readList(arena, %s, [&](%s& element) { return reader.%s(element); })" % (
+                target, SCALAR_TYPES[field.element], SCALAR_READERS[field.element])
+        return "reader.readList(arena, %s, [&](%s& element) { return read(reader, arena, element); })" % (
+            target, field.element)
+    return "reader.%s(%s)" % (SCALAR_READERS[field.kind], target)
+
+
+def emit_read(struct, out):
+    uses_arena = any(f.kind in ("object", "list") for f in struct.fields)
+    out.append("Read read(Reader& reader, Arena& %s, %s& out) {" % ("arena" if uses_arena else "/*arena*/", struct.name))
+    out.append("    return reader.readObject([&](std::string_view key) {")
+    out.append("        // null leaves the field unset")
+    out.append("        if (reader.consumeNull()) return true;")
+    if struct.fields:
+        # Fields are grouped by hash so colliding names share a label
+        groups = {}
+        for field in struct.fields:
+            groups.setdefault(fnv1a(field.json_name), []).append(field)
+        out.append("        switch (fieldHash(key)) {")
+        for fields in groups.values():
+            out.append("            case fieldHash(%s):" % cpp_string(fields[0].json_name))
+            for field in fields:
+                out.append("                if (key == %s)" % cpp_string(field.json_name))
+                out.append("                    return store(%s, out, %s::Field::%s);" % (
+                    read_expression(field), struct.name, field.member))
+            out.append("                break;")
+        out.append("        }")
+    out.append("        return reader.skipValue();")
+    out.append("    });")
+    out.append("}")
+    out.append("")
+
+
+def emit_write(struct, out):
+    out.append("void write(Writer& writer, const %s& in) {" % struct.name)
+    out.append("    writer.beginObject();")
+    for field in struct.fields:
+        out.append("    if (in.has(%s::Field::%s)) {" % (struct.name, field.member))
+        out.append("        writer.key(%s);" % cpp_string(field.json_name))
+        if field.kind == "object":
+            out.append("        write(writer, in.%s);" % field.member)
+        elif field.kind == "list":
+            call = "writer.value(element)" if field.element in SCALAR_TYPES else "write(writer, element)"
+            out.append("        writer.beginArray();")
+            out.append("        for (const auto& element : in.%s) %s;" % (field.member, call))
+            out.append("        writer.endArray();")
+        else:
+            out.append("        writer.value(in.%s);" % field.member)
+        out.append("    }")
+    out.append("    writer.endObject();")
+    out.append("}")
+    out.append("")
+
+
+def emit_source(gen, spec_name):
+    out = []
+    out.append("// Generated by scripts/generate_models.py from %s; do not edit." % spec_name)
+    out.append('#include "models/plex_schema.hpp"')
+    out.append("")
+    out.append("namespace plex::schema {")
+    out.append("")
+    for name in gen.order:
+        emit_read(gen.structs[name], out)
+    for name in gen.order:
+        emit_write(gen.structs[name], out)
+    out.append("}  // namespace plex::schema")
+    out.append("")
+    return "\n".join(out)
+
+
+def write_file(path, text):
+    os.makedirs(os.path.dirname(path) or ".", exist_ok=True)
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate Plex models from the OpenAPI spec")
+    parser.add_argument("spec")
+    parser.add_argument("config")
+    parser.add_argument("header")
+    parser.add_argument("source")
+    args = parser.parse_args()
+
+    with open(args.spec, encoding="utf-8") as f:
+        spec = json.load(f)
+    with open(args.config, encoding="utf-8") as f:
+        config = json.load(f)
+
+    # Properties servers send that the spec does not document
+    components = spec["components"]["schemas"]
+    for component, properties in config.get("extend", {}).items():
+        components[component].setdefault("properties", {}).update(properties)
+
+    gen = Generator(spec, config)
+    try:
+        for root in config["roots"]:
+            gen.add_root(root["name"], root["schema"])
+    except (KeyError, ValueError) as e:
+        sys.exit("generate_models: %s" % e)
+
+    spec_name = os.path.basename(args.spec)
+    write_file(args.header, emit_header(gen, spec_name))
+    write_file(args.source, emit_source(gen, spec_name))
+
+
+if __name__ == "__main__":
+    main()
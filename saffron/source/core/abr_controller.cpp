@@ -0,0 +1,131 @@
+#include "core/abr_controller.hpp"
+#include "util/log.hpp"
+
+#include <borealis.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+bool AbrController::start(int ratingKey, int bitrateKbps, int sourceBitrate, int sourceHeight, const std::string& serverUrl) {
+    m_steps.clear();
+    for (const auto& step : BandwidthEstimator::qualityLadder()) {
+        if (sourceHeight > 0 && step.height > sourceHeight) continue;
+        if (sourceBitrate > 0 && step.bitrate >= sourceBitrate && step.bitrate != bitrateKbps) continue;
+        m_steps.push_back(step);
+    }
+
+    // Nearest rung at or below the bitrate playback started with
+    auto it = std::find_if(m_steps.begin(), m_steps.end(),
+        [bitrateKbps](const QualityStep& step) { return step.bitrate <= bitrateKbps; });
+    if (it == m_steps.end() || m_steps.size() < 2) {
+        m_active = false;
+        return false;
+    }
+
+    Clock::time_point now = Clock::now();
+    m_current = static_cast<size_t>(it - m_steps.begin());
+    m_active = true;
+    m_ratingKey = ratingKey;
+    m_serverUrl = serverUrl;
+    m_wasBuffering = false;
+    m_lowSamples = 0;
+    m_highSamples = 0;
+    m_downloadKbps = 0;
+    m_restartAt = now;
+    m_lastUpAt = now - std::chrono::hours(1);
+    m_lastDownAt = now - std::chrono::hours(1);
+    m_upDelay = std::chrono::seconds(UP_DELAY_MIN_SECONDS);
+
+    LOGI("ABR: Started at {} ({} steps)", m_steps[m_current].label, m_steps.size());
+    return true;
+}
+
+void AbrController::onRestart(Clock::time_point now) {
+    m_restartAt = now;
+    m_wasBuffering = false;
+    m_lowSamples = 0;
+    m_highSamples = 0;
+}
+
+bool AbrController::update(const Sample& sample, Clock::time_point now) {
+    if (!m_active) return false;
+
+    // mpv reads in bursts once the cache is full, so idle samples say
+    // nothing about the link
+    if (sample.downloadKbps > 0) {
+        if (m_downloadKbps == 0) {
+            m_downloadKbps = sample.downloadKbps;
+        } else {
+            m_downloadKbps += DOWNLOAD_ALPHA * (sample.downloadKbps - m_downloadKbps);
+        }
+    }
+
+    bool stallStarted = sample.buffering && !m_wasBuffering;
+    m_wasBuffering = sample.buffering;
+    if (now - m_restartAt < std::chrono::seconds(STARTUP_GRACE_SECONDS)) {
+        m_lowSamples = 0;
+        m_highSamples = 0;
+        return false;
+    }
+
+    if (m_current + 1 < m_steps.size()) {
+        if (stallStarted) {
+            switchTo(m_current + 1, sample, "stall", now);
+            return true;
+        }
+        m_lowSamples = (sample.cacheSeconds < LOW_CACHE_SECONDS) ? m_lowSamples + 1 : 0;
+        if (m_lowSamples >= LOW_CACHE_SAMPLES) {
+            switchTo(m_current + 1, sample, "low_cache", now);
+            return true;
+        }
+    }
+
+    if (m_current > 0) {
+        bool full = sample.cacheSeconds >= HIGH_CACHE_SECONDS && !sample.buffering;
+        m_highSamples = full ? m_highSamples + 1 : 0;
+
+        double linkKbps = std::max(m_downloadKbps,
+            static_cast<double>(BandwidthEstimator::getInstance()->getThroughputKbps(m_serverUrl)));
+        double neededKbps = m_steps[m_current - 1].bitrate * UP_HEADROOM;
+        if (m_highSamples >= HIGH_CACHE_SAMPLES && linkKbps >= neededKbps && now - m_lastDownAt >= m_upDelay) {
+            switchTo(m_current - 1, sample, "headroom", now);
+            return true;
+        }
+    }
+    return false;
+}
+
+void AbrController::switchTo(size_t index, const Sample& sample, const char* reason, Clock::time_point now) {
+    int fromKbps = m_steps[m_current].bitrate;
+    if (index < m_current) {
+        m_lastUpAt = now;
+    } else {
+        // Stepping straight back down means the last step up was too eager
+        if (now - m_lastUpAt < std::chrono::seconds(FAILED_UP_WINDOW_SECONDS)) {
+            m_upDelay = std::min(m_upDelay * 2, std::chrono::seconds(UP_DELAY_MAX_SECONDS));
+        }
+        m_lastDownAt = now;
+    }
+
+    m_current = index;
+    logDecision(sample, fromKbps, m_steps[m_current].bitrate, reason);
+    onRestart(now);
+}
+
+void AbrController::logDecision(const Sample& sample, int fromKbps, int toKbps, const char* reason) {
+    int linkKbps = BandwidthEstimator::getInstance()->getThroughputKbps(m_serverUrl);
+    LOGI("ABR: {} -> {} kbps ({}) at {}ms, cache {:.1f}s, download {:.0f} kbps, link {} kbps, next up after {}s",
+         fromKbps, toKbps, reason, sample.positionMs, sample.cacheSeconds, m_downloadKbps, linkKbps,
+         m_upDelay.count());
+
+    FILE* file = fopen(LOG_PATH, "a");
+    if (!file) return;
+    if (ftell(file) == 0) {
+        fprintf(file, "time,rating_key,position_ms,cache_s,download_kbps,link_kbps,buffering,from_kbps,to_kbps,reason\n");
+    }
+    fprintf(file, "%lld,%d,%lld,%.1f,%.0f,%d,%d,%d,%d,%s\n",
+            static_cast<long long>(time(nullptr)), m_ratingKey, static_cast<long long>(sample.positionMs),
+            sample.cacheSeconds, m_downloadKbps, linkKbps, sample.buffering ? 1 : 0, fromKbps, toKbps, reason);
+    fclose(file);
+}
@@ -0,0 +1,114 @@
+#include "core/bandwidth_estimator.hpp"
+
+BandwidthEstimator* BandwidthEstimator::getInstance() {
+    static BandwidthEstimator instance;
+    return &instance;
+}
+
+void BandwidthEstimator::record(CURL* curl) {
+    char* url = nullptr;
+    curl_off_t bytes = 0, nameLookup = 0, connect = 0, preTransfer = 0, startTransfer = 0, total = 0;
+    curl_easy_getinfo(curl, CURLINFO_EFFECTIVE_URL, &url);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &bytes);
+    curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &nameLookup);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(curl, CURLINFO_PRETRANSFER_TIME_T, &preTransfer);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &startTransfer);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+    if (!url || total <= 0) return;
+
+    // A fresh TCP handshake is one clean round trip; on a reused connection
+    // the time to first byte is the closest we get (it includes server time)
+    if (connect > nameLookup) {
+        addRttSample(url, (connect - nameLookup) / 1e6);
+    } else if (startTransfer > preTransfer) {
+        addRttSample(url, (startTransfer - preTransfer) / 1e6);
+    }
+
+    if (bytes > 0 && total > startTransfer) {
+        addThroughputSample(url, static_cast<uint64_t>(bytes), (total - startTransfer) / 1e6);
+    }
+}
+
+void BandwidthEstimator::addThroughputSample(const std::string& url, uint64_t bytes, double seconds) {
+    if (bytes < MIN_SAMPLE_BYTES || seconds < MIN_SAMPLE_SECONDS) return;
+
+    double kbps = bytes * 8.0 / 1000.0 / seconds;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats& stats = m_stats[originOf(url)];
+    if (stats.throughputSamples == 0) {
+        stats.throughputKbps = kbps;
+    } else {
+        stats.throughputKbps += THROUGHPUT_ALPHA * (kbps - stats.throughputKbps);
+    }
+    stats.throughputSamples++;
+}
+
+void BandwidthEstimator::addRttSample(const std::string& url, double seconds) {
+    double ms = seconds * 1000.0;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats& stats = m_stats[originOf(url)];
+    if (stats.rttSamples == 0) {
+        stats.rttMs = ms;
+    } else {
+        stats.rttMs += RTT_ALPHA * (ms - stats.rttMs);
+    }
+    stats.rttSamples++;
+}
+
+int BandwidthEstimator::getThroughputKbps(const std::string& url) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_stats.find(originOf(url));
+    if (it == m_stats.end() || it->second.throughputSamples < MIN_SAMPLES) return 0;
+    return static_cast<int>(it->second.throughputKbps);
+}
+
+int BandwidthEstimator::getRttMs(const std::string& url) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_stats.find(originOf(url));
+    if (it == m_stats.end() || it->second.rttSamples < MIN_SAMPLES) return 0;
+    return static_cast<int>(it->second.rttMs);
+}
+
+int BandwidthEstimator::getSustainableKbps(const std::string& url) const {
+    return static_cast<int>(getThroughputKbps(url) * HEADROOM);
+}
+
+const std::vector<QualityStep>& BandwidthEstimator::qualityLadder() {
+    static const std::vector<QualityStep> ladder = {
+        {20000, 1080, "20 Mbps 1080p"},
+        {12000, 1080, "12 Mbps 1080p"},
+        {10000, 1080, "10 Mbps 1080p"},
+        {8000, 1080, "8 Mbps 1080p"},
+        {4000, 720, "4 Mbps 720p"},
+        {3000, 720, "3 Mbps 720p"},
+        {2000, 480, "2 Mbps 480p"},
+        {1500, 480, "1.5 Mbps 480p"},
+        {720, 360, "720 Kbps 360p"},
+    };
+    return ladder;
+}
+
+QualityStep BandwidthEstimator::chooseQuality(const std::string& url, int sourceBitrate, int sourceHeight) const {
+    const QualityStep original = {0, 0, "Original"};
+    int sustainable = getSustainableKbps(url);
+    if (sustainable == 0 || (sourceBitrate > 0 && sourceBitrate <= sustainable)) {
+        return original;
+    }
+
+    const QualityStep* lowest = nullptr;
+    for (const auto& step : qualityLadder()) {
+        if (sourceHeight > 0 && step.height > sourceHeight) continue;
+        if (sourceBitrate > 0 && step.bitrate >= sourceBitrate) continue;
+        if (step.bitrate <= sustainable) return step;
+        lowest = &step;
+    }
+    return lowest ? *lowest : original;
+}
+
+std::string BandwidthEstimator::originOf(const std::string& url) {
+    size_t start = url.find("://");
+    start = (start == std::string::npos) ? 0 : start + 3;
+    size_t end = url.find_first_of("/?", start);
+    return url.substr(0, end);
+}
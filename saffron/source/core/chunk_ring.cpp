@@ -0,0 +1,80 @@
+#include "core/chunk_ring.hpp"
+#include "util/log.hpp"
+
+#include <borealis.hpp>
+#include <algorithm>
+
+ChunkRing::ChunkRing(const std::string& dir, int64_t capacityBytes, int64_t chunkBytes, int64_t segmentBytes)
+    : m_dir(dir),
+      m_chunkBytes(chunkBytes),
+      m_slotsPerSegment(static_cast<size_t>(std::max<int64_t>(1, segmentBytes / chunkBytes))) {
+    size_t slots = static_cast<size_t>(std::max<int64_t>(0, capacityBytes / chunkBytes));
+    m_slots.resize(slots);
+    m_segments.assign((slots + m_slotsPerSegment - 1) / m_slotsPerSegment, nullptr);
+}
+
+ChunkRing::~ChunkRing() {
+    for (size_t i = 0; i < m_segments.size(); i++) {
+        if (!m_segments[i]) continue;
+        fclose(m_segments[i]);
+        remove(segmentPath(i).c_str());
+    }
+}
+
+bool ChunkRing::load(const std::string& stream, int64_t index, std::string& data) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(Key(stream, index));
+    if (it == m_index.end()) return false;
+
+    size_t slot = it->second;
+    FILE* file = m_segments[slot / m_slotsPerSegment];
+    long offset = static_cast<long>((slot % m_slotsPerSegment) * m_chunkBytes);
+    data.resize(static_cast<size_t>(m_slots[slot].size));
+    if (fseek(file, offset, SEEK_SET) != 0 || fread(&data[0], 1, data.size(), file) != data.size()) {
+        LOGW("ChunkRing: Read of slot {} failed", slot);
+        m_index.erase(it);
+        m_slots[slot] = Slot();
+        data.clear();
+        return false;
+    }
+    m_hits++;
+    return true;
+}
+
+void ChunkRing::store(const std::string& stream, int64_t index, const std::string& data) {
+    if (m_slots.empty() || data.empty() || static_cast<int64_t>(data.size()) > m_chunkBytes) return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Key key(stream, index);
+    if (m_index.count(key)) return;
+
+    size_t slot = m_next;
+    m_next = (m_next + 1) % m_slots.size();
+    if (m_slots[slot].key.second >= 0) m_index.erase(m_slots[slot].key);
+    m_slots[slot] = Slot();
+
+    FILE* file = segmentFor(slot);
+    long offset = static_cast<long>((slot % m_slotsPerSegment) * m_chunkBytes);
+    if (!file || fseek(file, offset, SEEK_SET) != 0 || fwrite(data.data(), 1, data.size(), file) != data.size()) {
+        // Most likely the card filled up; the slot stays empty
+        LOGW("ChunkRing: Write of slot {} failed", slot);
+        return;
+    }
+    m_slots[slot].key = key;
+    m_slots[slot].size = static_cast<int64_t>(data.size());
+    m_index[key] = slot;
+}
+
+FILE* ChunkRing::segmentFor(size_t slot) {
+    size_t segment = slot / m_slotsPerSegment;
+    if (!m_segments[segment]) {
+        // Truncates whatever an earlier run left behind
+        m_segments[segment] = fopen(segmentPath(segment).c_str(), "w+b");
+        if (!m_segments[segment]) LOGW("ChunkRing: Cannot create {}", segmentPath(segment));
+    }
+    return m_segments[segment];
+}
+
+std::string ChunkRing::segmentPath(size_t segment) const {
+    return m_dir + "/ring" + std::to_string(segment) + ".bin";
+}
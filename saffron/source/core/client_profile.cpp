@@ -0,0 +1,180 @@
+#include "core/client_profile.hpp"
+#include "util/log.hpp"
+
+#include <borealis.hpp>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+namespace {
+
+struct CodecName {
+    const char* plex;
+    AVCodecID id;
+};
+
+struct ContainerName {
+    const char* plex;
+    const char* demuxer;
+};
+
+const CodecName VIDEO_CODECS[] = {
+    {"h264", AV_CODEC_ID_H264},
+    {"hevc", AV_CODEC_ID_HEVC},
+    {"vp9", AV_CODEC_ID_VP9},
+    {"vp8", AV_CODEC_ID_VP8},
+    {"av1", AV_CODEC_ID_AV1},
+    {"mpeg2video", AV_CODEC_ID_MPEG2VIDEO},
+    {"mpeg1video", AV_CODEC_ID_MPEG1VIDEO},
+    {"mpeg4", AV_CODEC_ID_MPEG4},
+    {"vc1", AV_CODEC_ID_VC1},
+    {"wmv3", AV_CODEC_ID_WMV3},
+    {"msmpeg4v3", AV_CODEC_ID_MSMPEG4V3},
+    {"h263", AV_CODEC_ID_H263},
+};
+
+const CodecName AUDIO_CODECS[] = {
+    {"aac", AV_CODEC_ID_AAC},
+    {"ac3", AV_CODEC_ID_AC3},
+    {"eac3", AV_CODEC_ID_EAC3},
+    {"dca", AV_CODEC_ID_DTS},
+    {"truehd", AV_CODEC_ID_TRUEHD},
+    {"flac", AV_CODEC_ID_FLAC},
+    {"alac", AV_CODEC_ID_ALAC},
+    {"mp3", AV_CODEC_ID_MP3},
+    {"mp2", AV_CODEC_ID_MP2},
+    {"opus", AV_CODEC_ID_OPUS},
+    {"vorbis", AV_CODEC_ID_VORBIS},
+    {"pcm", AV_CODEC_ID_PCM_S16LE},
+    {"wmav2", AV_CODEC_ID_WMAV2},
+    {"wmapro", AV_CODEC_ID_WMAPRO},
+};
+
+const ContainerName CONTAINERS[] = {
+    {"mkv", "matroska"},
+    {"webm", "matroska"},
+    {"mp4", "mp4"},
+    {"mov", "mov"},
+    {"avi", "avi"},
+    {"mpegts", "mpegts"},
+    {"ts", "mpegts"},
+    {"m2ts", "mpegts"},
+    {"mpeg", "mpeg"},
+    {"asf", "asf"},
+    {"wmv", "asf"},
+    {"flv", "flv"},
+    {"ogg", "ogg"},
+};
+
+// Codecs our HLS (MPEG-TS) target carries, in the server's order of
+// preference when it has to encode: the first entry is what it converts to,
+// the rest are kept as they are in a remux
+const char* const HLS_VIDEO_CODECS[] = {"h264", "hevc"};
+const char* const HLS_AUDIO_CODECS[] = {"aac", "ac3", "eac3", "mp3"};
+
+// Codecs that show up above 4K
+const char* const LARGE_VIDEO_CODECS[] = {"h264", "hevc", "vp9", "av1"};
+
+template <size_t N>
+std::vector<std::string> decodable(const CodecName (&codecs)[N]) {
+    std::vector<std::string> names;
+    for (const auto& codec : codecs) {
+        if (avcodec_find_decoder(codec.id)) names.push_back(codec.plex);
+    }
+    return names;
+}
+
+bool contains(const std::vector<std::string>& values, const std::string& value) {
+    for (const auto& v : values) {
+        if (v == value) return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+std::vector<std::string> ClientProfile::getVideoCodecs() {
+    return decodable(VIDEO_CODECS);
+}
+
+std::vector<std::string> ClientProfile::getAudioCodecs() {
+    return decodable(AUDIO_CODECS);
+}
+
+std::vector<std::string> ClientProfile::getContainers() {
+    std::vector<std::string> names;
+    for (const auto& container : CONTAINERS) {
+        if (av_find_input_format(container.demuxer)) names.push_back(container.plex);
+    }
+    return names;
+}
+
+const std::string& ClientProfile::getExtra() {
+    static const std::string extra = build();
+    return extra;
+}
+
+std::string ClientProfile::build() {
+    std::vector<std::string> video = getVideoCodecs();
+    std::vector<std::string> audio = getAudioCodecs();
+    std::vector<std::string> containers = getContainers();
+    if (video.empty() || audio.empty() || containers.empty()) {
+        LOGW("ClientProfile: FFmpeg reports no decoders, using the base profile");
+        return "";
+    }
+
+    std::vector<std::string> directives;
+    directives.push_back("add-direct-play-profile(type=videoProfile&container=" + join(containers) +
+                         "&videoCodec=" + join(video) + "&audioCodec=" + join(audio) + "&subtitleCodec=*)");
+
+    // Replaces the base profile's HLS target, so a remux keeps the original
+    // video and surround audio and a transcode only produces what we decode
+    std::vector<std::string> hlsVideo, hlsAudio;
+    for (const char* codec : HLS_VIDEO_CODECS) {
+        if (contains(video, codec)) hlsVideo.push_back(codec);
+    }
+    for (const char* codec : HLS_AUDIO_CODECS) {
+        if (contains(audio, codec)) hlsAudio.push_back(codec);
+    }
+    if (!hlsVideo.empty() && !hlsAudio.empty()) {
+        std::string target = "add-transcode-target(type=videoProfile&context=streaming&protocol=hls&container=mpegts"
+                             "&videoCodec=" + join(hlsVideo) + "&audioCodec=" + join(hlsAudio);
+        if (avcodec_find_decoder(AV_CODEC_ID_WEBVTT)) target += "&subtitleCodec=webvtt";
+        directives.push_back(target + "&replace=true)");
+    }
+
+    // Other codecs never come in sizes that matter; mpv downmixes any
+    // channel layout, so audio needs no limits
+    for (const char* codec : LARGE_VIDEO_CODECS) {
+        if (!contains(video, codec)) continue;
+        directives.push_back(std::string("add-limitation(scope=videoCodec&scopeName=") + codec +
+                             "&type=upperBound&name=video.width&value=" + std::to_string(MAX_WIDTH) + ")");
+        directives.push_back(std::string("add-limitation(scope=videoCodec&scopeName=") + codec +
+                             "&type=upperBound&name=video.height&value=" + std::to_string(MAX_HEIGHT) + ")");
+    }
+    if (contains(video, "h264")) {
+        directives.push_back("add-limitation(scope=videoCodec&scopeName=h264&type=upperBound&name=video.level&value=" +
+                             std::to_string(MAX_H264_LEVEL) + "&isRequired=true)");
+        directives.push_back("add-limitation(scope=videoCodec&scopeName=h264&type=upperBound&name=video.bitDepth&value=" +
+                             std::to_string(MAX_H264_BIT_DEPTH) + "&isRequired=true)");
+    }
+
+    std::string extra;
+    for (const auto& directive : directives) {
+        if (!extra.empty()) extra += "+";
+        extra += directive;
+    }
+    LOGI("ClientProfile: video [{}], audio [{}], containers [{}]", join(video), join(audio), join(containers));
+    return extra;
+}
+
+std::string ClientProfile::join(const std::vector<std::string>& values) {
+    std::string result;
+    for (const auto& value : values) {
+        if (!result.empty()) result += ",";
+        result += value;
+    }
+    return result;
+}
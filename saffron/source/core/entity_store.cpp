@@ -0,0 +1,167 @@
+#include "core/entity_store.hpp"
+
+namespace {
+
+template<typename T>
+void assignIfChanged(T& target, const T& value, bool& changed) {
+    if (target != value) {
+        target = value;
+        changed = true;
+    }
+}
+
+}
+
+EntityStore* EntityStore::getInstance() {
+    static EntityStore store;
+    return &store;
+}
+
+EntityRef EntityStore::merge(const plex::MediaItem& item) {
+    return merge(plex::CardItem::fromMediaItem(item));
+}
+
+EntityRef EntityStore::merge(const plex::CardItem& incoming) {
+    if (++m_mergesSincePrune >= PRUNE_INTERVAL) {
+        pruneExpired();
+    }
+
+    auto it = m_entities.find(incoming.ratingKey);
+    if (it != m_entities.end()) {
+        if (auto existing = it->second.lock()) {
+            if (mergeInto(*existing, incoming)) {
+                m_changeEvent.fire(incoming.ratingKey);
+            }
+            return existing;
+        }
+    }
+
+    auto entity = std::make_shared<plex::CardItem>(incoming);
+    m_entities[entity->ratingKey] = entity;
+    return entity;
+}
+
+std::vector<EntityRef> EntityStore::mergeAll(const std::vector<plex::MediaItem>& items) {
+    std::vector<EntityRef> refs;
+    refs.reserve(items.size());
+    for (const auto& item : items) {
+        refs.push_back(merge(item));
+    }
+    return refs;
+}
+
+EntityRef EntityStore::find(int ratingKey) const {
+    auto it = m_entities.find(ratingKey);
+    if (it == m_entities.end()) return nullptr;
+    return it->second.lock();
+}
+
+void EntityStore::updateProgress(int ratingKey, int64_t viewOffset) {
+    auto it = m_entities.find(ratingKey);
+    if (it == m_entities.end()) return;
+    auto entity = it->second.lock();
+    if (!entity) return;
+
+    if (entity->viewOffset != viewOffset) {
+        entity->viewOffset = viewOffset;
+        setPendingWatch(*entity);
+        m_changeEvent.fire(ratingKey);
+    }
+}
+
+void EntityStore::markWatched(int ratingKey) {
+    auto it = m_entities.find(ratingKey);
+    if (it == m_entities.end()) return;
+    auto entity = it->second.lock();
+    if (!entity) return;
+
+    entity->viewOffset = 0;
+    entity->viewCount++;
+    setPendingWatch(*entity);
+    m_changeEvent.fire(ratingKey);
+}
+
+void EntityStore::clear() {
+    m_entities.clear();
+    m_pendingWatch.clear();
+    m_mergesSincePrune = 0;
+}
+
+void EntityStore::setPendingWatch(const plex::CardItem& entity) {
+    PendingWatch& pending = m_pendingWatch[entity.ratingKey];
+    pending.viewOffset = entity.viewOffset;
+    pending.viewCount = entity.viewCount;
+    pending.since = std::chrono::steady_clock::now();
+}
+
+bool EntityStore::isWatchPending(const plex::CardItem& existing, const plex::CardItem& incoming) {
+    auto it = m_pendingWatch.find(existing.ratingKey);
+    if (it == m_pendingWatch.end()) return false;
+
+    // The server has caught up with what we reported, or gave up waiting
+    const PendingWatch& pending = it->second;
+    bool acknowledged = incoming.viewOffset == pending.viewOffset && incoming.viewCount >= pending.viewCount;
+    bool expired = std::chrono::steady_clock::now() - pending.since > std::chrono::seconds(PENDING_WATCH_SECONDS);
+    if (acknowledged || expired) {
+        m_pendingWatch.erase(it);
+        return false;
+    }
+    return true;
+}
+
+bool EntityStore::mergeInto(plex::CardItem& existing, const plex::CardItem& incoming) {
+    bool changed = false;
+
+    // Metadata: skip responses older than what we already hold, and never
+    // let a sparse payload (e.g. a hub entry without media) blank out fields
+    bool metadataFresh = incoming.updatedAt == 0 || incoming.updatedAt >= existing.updatedAt;
+    if (metadataFresh) {
+        if (incoming.updatedAt) assignIfChanged(existing.updatedAt, incoming.updatedAt, changed);
+        if (incoming.librarySectionId) assignIfChanged(existing.librarySectionId, incoming.librarySectionId, changed);
+        if (incoming.duration) assignIfChanged(existing.duration, incoming.duration, changed);
+        // An empty titleSort means "same as title", so it travels with the title
+        if (!incoming.title.empty()) {
+            assignIfChanged(existing.title, incoming.title, changed);
+            assignIfChanged(existing.titleSort, incoming.titleSort, changed);
+        }
+        if (!incoming.thumb.empty()) assignIfChanged(existing.thumb, incoming.thumb, changed);
+        if (!incoming.editionTitle.empty()) assignIfChanged(existing.editionTitle, incoming.editionTitle, changed);
+        if (!incoming.contentRating.empty()) assignIfChanged(existing.contentRating, incoming.contentRating, changed);
+        if (!incoming.studio.empty()) assignIfChanged(existing.studio, incoming.studio, changed);
+        if (!incoming.grandparentTitle.empty()) assignIfChanged(existing.grandparentTitle, incoming.grandparentTitle, changed);
+        if (!incoming.parentTitle.empty()) assignIfChanged(existing.parentTitle, incoming.parentTitle, changed);
+        if (incoming.year) assignIfChanged(existing.year, incoming.year, changed);
+        if (incoming.index) assignIfChanged(existing.index, incoming.index, changed);
+        if (incoming.parentIndex) assignIfChanged(existing.parentIndex, incoming.parentIndex, changed);
+        if (incoming.childCount) assignIfChanged(existing.childCount, incoming.childCount, changed);
+        if (incoming.leafCount) assignIfChanged(existing.leafCount, incoming.leafCount, changed);
+        if (incoming.videoCodec != plex::VideoCodec::Unknown) assignIfChanged(existing.videoCodec, incoming.videoCodec, changed);
+        if (incoming.resolutions) assignIfChanged(existing.resolutions, incoming.resolutions, changed);
+        assignIfChanged(existing.mediaType, incoming.mediaType, changed);
+    }
+
+    // Watch state: the server's is current, except that a local progress
+    // update is not rolled back by a page fetched before it reached the
+    // server. lastViewedAt is not compared: the console clock need not agree
+    // with the server's, and marking unwatched elsewhere does not bump it
+    if (!isWatchPending(existing, incoming)) {
+        assignIfChanged(existing.lastViewedAt, incoming.lastViewedAt, changed);
+        assignIfChanged(existing.viewOffset, incoming.viewOffset, changed);
+        assignIfChanged(existing.viewCount, incoming.viewCount, changed);
+        assignIfChanged(existing.viewedLeafCount, incoming.viewedLeafCount, changed);
+    }
+
+    return changed;
+}
+
+void EntityStore::pruneExpired() {
+    m_mergesSincePrune = 0;
+    for (auto it = m_entities.begin(); it != m_entities.end();) {
+        if (it->second.expired()) {
+            m_pendingWatch.erase(it->first);
+            it = m_entities.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
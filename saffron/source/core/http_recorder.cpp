@@ -0,0 +1,272 @@
+#include "core/http_recorder.hpp"
+#include "models/plex_codec.hpp"
+#include "util/binary_io.hpp"
+#include "util/log.hpp"
+
+#include <borealis.hpp>
+
+#include <algorithm>
+#include <ctime>
+#include <sys/stat.h>
+#include <thread>
+
+namespace {
+
+// Query parameters that differ between two runs of the same navigation
+const char* const VOLATILE_PARAMS[] = {
+    "X-Plex-Token",
+    "X-Plex-Session-Identifier",
+    "transcodeSessionId",
+    "session",
+    "peakBitrate",
+    "_",  // cache buster on metadata requests
+};
+
+bool isVolatile(std::string_view param) {
+    std::string_view name = param.substr(0, param.find('='));
+    for (const char* p : VOLATILE_PARAMS) {
+        if (name == p) return true;
+    }
+    return false;
+}
+
+void putBytes(BinaryWriter& writer, const std::string& value) {
+    writer.putVarint(value.size());
+    writer.buffer().append(value);
+}
+
+bool getBytes(BinaryReader& reader, std::string& value) {
+    uint64_t length = 0;
+    std::string_view bytes;
+    if (!reader.getVarint(length) || !reader.getBytes(length, bytes)) return false;
+    value.assign(bytes.data(), bytes.size());
+    return true;
+}
+
+}  // namespace
+
+HttpRecorder* HttpRecorder::getInstance() {
+    static HttpRecorder instance;
+    return &instance;
+}
+
+bool HttpRecorder::startRecording(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_mode != Mode::Off) return false;
+    m_mode = Mode::Record;
+    m_path = path;
+    m_exchanges.clear();
+    m_queues.clear();
+    m_recordedBytes = 0;
+    m_full = false;
+    m_start = std::chrono::steady_clock::now();
+    LOGI("HttpRecorder: Recording to {}", path);
+    return true;
+}
+
+bool HttpRecorder::startRecordingSession() {
+    mkdir(RECORD_DIR, 0755);
+    char stamp[32];
+    time_t now = time(nullptr);
+    strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", localtime(&now));
+    return startRecording(std::string(RECORD_DIR) + "/" + stamp + ".spxr");
+}
+
+bool HttpRecorder::startReplay(const std::string& path, Latency latency, double scale) {
+    std::vector<Exchange> exchanges;
+    if (!readArchive(path, exchanges)) {
+        LOGE("HttpRecorder: Cannot read {}", path);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_mode != Mode::Off) return false;
+    m_mode = Mode::Replay;
+    m_path = path;
+    m_exchanges = std::move(exchanges);
+    m_queues.clear();
+    for (size_t i = 0; i < m_exchanges.size(); i++) {
+        m_queues[key(m_exchanges[i].method, m_exchanges[i].url)].indices.push_back(i);
+    }
+    m_latency = latency;
+    m_scale = std::max(0.0, scale);
+    m_misses = 0;
+    LOGI("HttpRecorder: Replaying {} exchanges from {}", m_exchanges.size(), path);
+    return true;
+}
+
+bool HttpRecorder::stop() {
+    std::vector<Exchange> exchanges;
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Mode mode = m_mode;
+        m_mode = Mode::Off;
+        m_queues.clear();
+        if (mode != Mode::Record) {
+            m_exchanges.clear();
+            return true;
+        }
+        exchanges.swap(m_exchanges);
+        path = m_path;
+    }
+
+    if (!writeArchive(path, exchanges)) {
+        LOGE("HttpRecorder: Failed to write {}", path);
+        return false;
+    }
+    LOGI("HttpRecorder: Wrote {} exchanges to {}", exchanges.size(), path);
+    return true;
+}
+
+HttpRecorder::Mode HttpRecorder::getMode() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_mode;
+}
+
+size_t HttpRecorder::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_exchanges.size();
+}
+
+size_t HttpRecorder::getMisses() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+}
+
+void HttpRecorder::record(const std::string& method, const std::string& url,
+                          std::chrono::steady_clock::time_point started, long status, const std::string& body,
+                          const std::string& error) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_mode != Mode::Record || m_full) return;
+
+    if (m_recordedBytes + body.size() > MAX_RECORD_BYTES) {
+        m_full = true;
+        LOGW("HttpRecorder: Recording reached {} MB, later requests are not recorded",
+             MAX_RECORD_BYTES / (1024 * 1024));
+        return;
+    }
+    m_recordedBytes += body.size();
+
+    Exchange exchange;
+    exchange.method = method;
+    exchange.url = normalizeUrl(url);
+    exchange.status = status;
+    exchange.error = error;
+    exchange.body = body;
+    exchange.startUs = std::chrono::duration_cast<std::chrono::microseconds>(started - m_start).count();
+    exchange.elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(now - started).count();
+    m_exchanges.push_back(std::move(exchange));
+}
+
+HttpRecorder::Exchange HttpRecorder::replay(const std::string& method, const std::string& url) {
+    Exchange exchange;
+    int64_t waitUs = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_queues.find(key(method, url));
+        if (it == m_queues.end()) {
+            m_misses++;
+            exchange.method = method;
+            exchange.url = normalizeUrl(url);
+            exchange.error = "No recorded response for " + method + " " + exchange.url;
+            return exchange;
+        }
+
+        Queue& queue = it->second;
+        exchange = m_exchanges[queue.indices[queue.next]];
+        if (queue.next + 1 < queue.indices.size()) queue.next++;
+
+        if (m_latency == Latency::Original) {
+            waitUs = exchange.elapsedUs;
+        } else if (m_latency == Latency::Scaled) {
+            waitUs = static_cast<int64_t>(exchange.elapsedUs * m_scale);
+        }
+    }
+
+    if (waitUs > 0) std::this_thread::sleep_for(std::chrono::microseconds(waitUs));
+    return exchange;
+}
+
+std::string HttpRecorder::normalizeUrl(const std::string& url) {
+    std::string_view rest = url;
+    size_t scheme = rest.find("://");
+    if (scheme != std::string_view::npos) {
+        size_t pathStart = rest.find('/', scheme + 3);
+        rest = pathStart == std::string_view::npos ? std::string_view("/") : rest.substr(pathStart);
+    }
+
+    size_t queryStart = rest.find('?');
+    std::string result(rest.substr(0, queryStart));
+    if (queryStart == std::string_view::npos) return result;
+
+    std::string_view query = rest.substr(queryStart + 1);
+    char separator = '?';
+    while (!query.empty()) {
+        size_t end = query.find('&');
+        std::string_view param = query.substr(0, end);
+        if (!param.empty() && !isVolatile(param)) {
+            result += separator;
+            result.append(param.data(), param.size());
+            separator = '&';
+        }
+        if (end == std::string_view::npos) break;
+        query = query.substr(end + 1);
+    }
+    return result;
+}
+
+std::string HttpRecorder::key(const std::string& method, const std::string& url) {
+    return method + " " + normalizeUrl(url);
+}
+
+// u32 magic | u16 version | u32 count | exchanges, each:
+//   method | url | varint status | error | body | varint startUs | varint elapsedUs
+// with strings as a varint length and the bytes
+bool HttpRecorder::writeArchive(const std::string& path, const std::vector<Exchange>& exchanges) {
+    BinaryWriter writer;
+    writer.put(MAGIC);
+    writer.put(VERSION);
+    writer.put(static_cast<uint32_t>(exchanges.size()));
+    for (const auto& exchange : exchanges) {
+        putBytes(writer, exchange.method);
+        putBytes(writer, exchange.url);
+        writer.putVarint(static_cast<uint64_t>(std::max<long>(exchange.status, 0)));
+        putBytes(writer, exchange.error);
+        putBytes(writer, exchange.body);
+        writer.putVarint(static_cast<uint64_t>(std::max<int64_t>(exchange.startUs, 0)));
+        writer.putVarint(static_cast<uint64_t>(std::max<int64_t>(exchange.elapsedUs, 0)));
+    }
+    return plex::codec::writeArchive(path, writer.buffer());
+}
+
+bool HttpRecorder::readArchive(const std::string& path, std::vector<Exchange>& exchanges) {
+    plex::codec::MappedFile file;
+    if (!file.open(path)) return false;
+
+    BinaryReader reader(file.data());
+    uint32_t magic = 0, count = 0;
+    uint16_t version = 0;
+    if (!reader.get(magic) || !reader.get(version) || !reader.get(count)) return false;
+    if (magic != MAGIC || version != VERSION) return false;
+
+    exchanges.clear();
+    // Seven bytes is the smallest exchange, so a corrupt count cannot
+    // reserve more than the file could hold
+    exchanges.reserve(std::min<size_t>(count, file.data().size() / 7));
+    for (uint32_t i = 0; i < count; i++) {
+        Exchange exchange;
+        uint64_t status = 0, startUs = 0, elapsedUs = 0;
+        if (!getBytes(reader, exchange.method) || !getBytes(reader, exchange.url) || !reader.getVarint(status) ||
+            !getBytes(reader, exchange.error) || !getBytes(reader, exchange.body) || !reader.getVarint(startUs) ||
+            !reader.getVarint(elapsedUs)) {
+            return false;
+        }
+        exchange.status = static_cast<long>(status);
+        exchange.startUs = static_cast<int64_t>(startUs);
+        exchange.elapsedUs = static_cast<int64_t>(elapsedUs);
+        exchanges.push_back(std::move(exchange));
+    }
+    return reader.atEnd();
+}
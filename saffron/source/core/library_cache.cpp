@@ -0,0 +1,240 @@
+#include "core/library_cache.hpp"
+#include "models/plex_codec.hpp"
+#include "util/log.hpp"
+
+#include <borealis.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+using plex::codec::SectionField;
+
+LibraryCache* LibraryCache::getInstance() {
+    static LibraryCache cache;
+    return &cache;
+}
+
+void LibraryCache::setServer(const std::string& machineId) {
+    if (machineId == m_machineId) return;
+
+    if (!m_machineId.empty()) {
+        save();
+    }
+    clear();
+    m_libraries.clear();
+    // ratingKeys only mean something on the server that issued them
+    EntityStore::getInstance()->clear();
+    m_machineId = machineId;
+    m_loadedFromDisk = false;
+
+    if (!m_machineId.empty()) {
+        load();
+    }
+}
+
+const LibraryCache::Section* LibraryCache::get(int sectionKey) {
+    auto it = m_entries.find(sectionKey);
+    if (it == m_entries.end()) return nullptr;
+    touch(it->second);
+    return &it->second.section;
+}
+
+void LibraryCache::put(int sectionKey, std::vector<EntityRef> items, int totalSize) {
+    auto it = m_entries.find(sectionKey);
+    if (it == m_entries.end()) {
+        m_lru.push_front(sectionKey);
+        it = m_entries.emplace(sectionKey, Entry()).first;
+        it->second.lruPos = m_lru.begin();
+    } else {
+        touch(it->second);
+        m_bytes -= it->second.bytes;
+    }
+
+    Entry& entry = it->second;
+    entry.section.items = std::move(items);
+    entry.section.totalSize = totalSize;
+    entry.section.stale = false;
+    entry.section.complete = false;
+    entry.bytes = estimateBytes(entry.section.items);
+    m_bytes += entry.bytes;
+    m_dirty = true;
+
+    evict();
+}
+
+void LibraryCache::append(int sectionKey, const std::vector<EntityRef>& items) {
+    auto it = m_entries.find(sectionKey);
+    if (it == m_entries.end()) return;
+
+    Entry& entry = it->second;
+    touch(entry);
+    entry.section.items.insert(entry.section.items.end(), items.begin(), items.end());
+    size_t added = estimateBytes(items);
+    entry.bytes += added;
+    m_bytes += added;
+    m_dirty = true;
+
+    evict();
+}
+
+void LibraryCache::markFresh(int sectionKey) {
+    auto it = m_entries.find(sectionKey);
+    if (it != m_entries.end()) {
+        it->second.section.stale = false;
+    }
+}
+
+void LibraryCache::setSyncState(int sectionKey, int64_t syncedAt, bool complete) {
+    auto it = m_entries.find(sectionKey);
+    if (it == m_entries.end()) return;
+    it->second.section.syncedAt = syncedAt;
+    it->second.section.complete = complete;
+    m_dirty = true;
+}
+
+void LibraryCache::clear() {
+    m_entries.clear();
+    m_lru.clear();
+    m_bytes = 0;
+}
+
+void LibraryCache::setLibraries(const std::vector<plex::Library>& libraries) {
+    m_libraries = libraries;
+    m_dirty = true;
+}
+
+void LibraryCache::touch(Entry& entry) {
+    m_lru.splice(m_lru.begin(), m_lru, entry.lruPos);
+}
+
+void LibraryCache::evict() {
+    // Always keep the most recently used section, even if it alone is over budget
+    while (m_bytes > MAX_BYTES && m_lru.size() > 1) {
+        int victim = m_lru.back();
+        auto it = m_entries.find(victim);
+        if (it != m_entries.end()) {
+            LOGD("LibraryCache: Evicting section {} ({} KB)", victim, it->second.bytes / 1024);
+            m_bytes -= it->second.bytes;
+            m_entries.erase(it);
+        }
+        m_lru.pop_back();
+    }
+}
+
+size_t LibraryCache::estimateBytes(const std::vector<EntityRef>& items) {
+    // Reference plus the make_shared control block around each card
+    size_t bytes = 0;
+    for (const auto& item : items) {
+        bytes += sizeof(EntityRef) + 2 * sizeof(void*);
+        if (item) bytes += plex::memoryFootprint(*item);
+    }
+    return bytes;
+}
+
+std::string LibraryCache::getFilePath() const {
+    return std::string(CACHE_DIR) + "/library_" + m_machineId + ".bin";
+}
+
+std::string LibraryCache::getLibrariesPath() const {
+    return std::string(CACHE_DIR) + "/libraries_" + m_machineId + ".bin";
+}
+
+void LibraryCache::save() {
+    if (m_machineId.empty() || !m_dirty) return;
+    m_dirty = false;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Most recently used first so a load restores the LRU order
+    plex::codec::ArchiveWriter sections(plex::codec::Kind::Section);
+    for (int key : m_lru) {
+        const Section& section = m_entries[key].section;
+        plex::codec::Encoder& e = sections.nextRecord();
+        e.putInt(SectionField::Key, key);
+        e.putInt(SectionField::TotalSize, section.totalSize);
+        e.putInt(SectionField::SyncedAt, section.syncedAt);
+        e.putBool(SectionField::Complete, section.complete);
+        for (const auto& item : section.items) {
+            size_t mark = e.beginRecord(SectionField::Items);
+            plex::codec::encode(e, *item);
+            e.endRecord(mark);
+        }
+    }
+    std::string sectionData = sections.finish();
+    std::string libraryData = plex::codec::encodeArchive(m_libraries);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    LOGD("LibraryCache: Serialized {} sections ({} bytes) in {} us",
+         m_lru.size(), sectionData.size() + libraryData.size(), elapsed);
+
+    m_writer.write(getLibrariesPath(), std::move(libraryData));
+    m_writer.write(getFilePath(), std::move(sectionData));
+}
+
+void LibraryCache::flush() {
+    save();
+    m_writer.flush();
+}
+
+void LibraryCache::load() {
+    auto start = std::chrono::steady_clock::now();
+
+    plex::codec::MappedFile libraryFile, sectionFile;
+    if (!libraryFile.open(getLibrariesPath()) || !sectionFile.open(getFilePath())) return;
+
+    plex::codec::Archive libraryArchive, sectionArchive;
+    if (!libraryArchive.open(libraryFile.data()) || libraryArchive.kind() != plex::codec::Kind::Library ||
+        !sectionArchive.open(sectionFile.data()) || sectionArchive.kind() != plex::codec::Kind::Section) {
+        LOGW("LibraryCache: Ignoring cache files with unknown format");
+        return;
+    }
+
+    std::vector<plex::Library> libraries;
+    if (!libraryArchive.decodeAll(libraries)) return;
+
+    auto* store = EntityStore::getInstance();
+    std::vector<std::pair<int, Section>> sections;
+    sections.reserve(sectionArchive.size());
+    for (size_t i = 0; i < sectionArchive.size(); i++) {
+        int key = 0;
+        Section section;
+        section.stale = true;
+        plex::codec::FieldCursor c(sectionArchive[i].data());
+        while (c.next()) {
+            switch (static_cast<SectionField>(c.id())) {
+                case SectionField::Key: key = static_cast<int>(c.asInt()); break;
+                case SectionField::TotalSize: section.totalSize = static_cast<int>(c.asInt()); break;
+                case SectionField::SyncedAt: section.syncedAt = c.asInt(); break;
+                case SectionField::Complete: section.complete = c.asBool(); break;
+                case SectionField::Items: {
+                    plex::CardItem card;
+                    if (!plex::codec::decode(c.asBytes(), card)) return;
+                    section.items.push_back(store->merge(card));
+                    break;
+                }
+                default: break;
+            }
+        }
+        if (!c.ok()) return;
+        sections.emplace_back(key, std::move(section));
+    }
+
+    // Only adopt the files once they parsed completely; insert least recent
+    // first so the LRU order matches what was saved
+    m_libraries = std::move(libraries);
+    for (auto it = sections.rbegin(); it != sections.rend(); ++it) {
+        put(it->first, std::move(it->second.items), it->second.totalSize);
+        setSyncState(it->first, it->second.syncedAt, it->second.complete);
+    }
+    for (auto& [key, entry] : m_entries) {
+        entry.section.stale = true;
+    }
+    m_dirty = false;
+    m_loadedFromDisk = true;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    LOGI("LibraryCache: Loaded {} libraries, {} sections ({} KB in memory) from disk in {} ms",
+         m_libraries.size(), m_entries.size(), m_bytes / 1024, elapsed);
+}
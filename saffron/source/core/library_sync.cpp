@@ -0,0 +1,236 @@
+#include "core/library_sync.hpp"
+#include "core/library_cache.hpp"
+#include "core/plex_server.hpp"
+#include "core/search_index.hpp"
+#include "util/log.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+bool titleLess(const std::string& a, const std::string& b) {
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(),
+        [](unsigned char x, unsigned char y) { return std::tolower(x) < std::tolower(y); });
+}
+
+}
+
+LibrarySync* LibrarySync::getInstance() {
+    static LibrarySync sync;
+    return &sync;
+}
+
+bool LibrarySync::isSyncing(PlexServer* server, int sectionId) const {
+    return server && m_inProgress.count({server->getMachineId(), sectionId}) > 0;
+}
+
+bool LibrarySync::needsSync(PlexServer* server, int sectionId) {
+    if (!server || isSyncing(server, sectionId)) return false;
+
+    const LibraryCache::Section* section = LibraryCache::getInstance()->get(sectionId);
+    if (!section || !section->complete || section->stale) return true;
+
+    auto it = m_lastSync.find({server->getMachineId(), sectionId});
+    if (it == m_lastSync.end()) return true;
+    return std::chrono::steady_clock::now() - it->second > std::chrono::seconds(RESYNC_INTERVAL_SECONDS);
+}
+
+bool LibrarySync::sync(PlexServer* server, int sectionId, OnComplete onComplete, PlexApi::OnError onError) {
+    if (!server || isSyncing(server, sectionId)) return false;
+    if (server->getMachineId() != LibraryCache::getInstance()->getMachineId()) return false;
+    m_inProgress.insert({server->getMachineId(), sectionId});
+
+    auto job = std::make_shared<Job>();
+    job->server = server;
+    job->machineId = server->getMachineId();
+    job->sectionId = sectionId;
+    job->bytesAtStart = PlexApi::getBytesReceived();
+    job->onComplete = onComplete;
+    job->onError = onError;
+
+    const LibraryCache::Section* section = LibraryCache::getInstance()->get(sectionId);
+    if (section && section->complete) {
+        job->items = section->items;
+        job->totalSize = section->totalSize;
+        job->since = section->syncedAt;
+        job->highWater = section->syncedAt;
+        LOGI("LibrarySync: Delta sync of section {} since {}", sectionId, job->since);
+        fetchChanges(job, "updatedAt", 0);
+    } else {
+        job->result.full = true;
+        job->result.membershipChanged = true;
+        LOGI("LibrarySync: Full sync of section {}", sectionId);
+        fetchFullPage(job, 0);
+    }
+    return true;
+}
+
+void LibrarySync::fetchFullPage(JobPtr job, int start) {
+    PlexApi::getLibraryItems(job->server, job->sectionId, start, FULL_SYNC_PAGE_SIZE,
+        [this, job, start](std::vector<plex::MediaItem> items, int totalSize) {
+            if (abandonIfServerChanged(job)) return;
+            trackHighWater(job, items);
+            SearchIndex::getInstance()->addAll(items);
+            auto refs = EntityStore::getInstance()->mergeAll(items);
+            job->items.insert(job->items.end(), refs.begin(), refs.end());
+            job->totalSize = totalSize;
+            job->result.added += refs.size();
+
+            if (items.empty() || static_cast<int>(job->items.size()) >= totalSize) {
+                finish(job, true);
+            } else {
+                fetchFullPage(job, start + static_cast<int>(items.size()));
+            }
+        },
+        [this, job](const std::string& error) {
+            fail(job, error);
+        }
+    );
+}
+
+void LibrarySync::fetchChanges(JobPtr job, const std::string& field, int start) {
+    PlexApi::getLibraryChanges(job->server, job->sectionId, field, job->since, start, FULL_SYNC_PAGE_SIZE,
+        [this, job, field, start](std::vector<plex::MediaItem> items, int totalSize) {
+            if (abandonIfServerChanged(job)) return;
+            applyChanges(job, items);
+            int next = start + static_cast<int>(items.size());
+            if (!items.empty() && next < totalSize) {
+                fetchChanges(job, field, next);
+            } else if (field == "updatedAt") {
+                fetchChanges(job, "addedAt", 0);
+            } else {
+                checkDeletions(job);
+            }
+        },
+        [this, job](const std::string& error) {
+            fail(job, error);
+        }
+    );
+}
+
+void LibrarySync::applyChanges(JobPtr job, const std::vector<plex::MediaItem>& items) {
+    if (items.empty()) return;
+    trackHighWater(job, items);
+
+    std::unordered_set<int> localKeys;
+    localKeys.reserve(job->items.size());
+    for (const auto& ref : job->items) {
+        localKeys.insert(ref->ratingKey);
+    }
+
+    auto* store = EntityStore::getInstance();
+    auto* index = SearchIndex::getInstance();
+    for (const auto& item : items) {
+        // Items touched since the mark usually match both filters
+        if (!job->applied.insert(item.ratingKey).second) continue;
+        index->add(item);
+
+        // Merging fires change events, so visible cells update in place
+        EntityRef ref = store->merge(item);
+        if (localKeys.count(ref->ratingKey)) {
+            job->result.changed++;
+            continue;
+        }
+
+        // New item: keep the listing in titleSort order like the server's default sort
+        auto pos = std::upper_bound(job->items.begin(), job->items.end(), ref,
+            [](const EntityRef& a, const EntityRef& b) { return titleLess(a->sortTitle(), b->sortTitle()); });
+        job->items.insert(pos, ref);
+        localKeys.insert(ref->ratingKey);
+        job->result.added++;
+        job->result.membershipChanged = true;
+    }
+}
+
+void LibrarySync::checkDeletions(JobPtr job) {
+    PlexApi::getLibrarySize(job->server, job->sectionId,
+        [this, job](int totalSize) {
+            if (abandonIfServerChanged(job)) return;
+            job->totalSize = totalSize;
+            if (totalSize == static_cast<int>(job->items.size())) {
+                finish(job, true);
+                return;
+            }
+
+            // Counts disagree: fetch the key listing to find what is gone
+            PlexApi::getLibraryKeys(job->server, job->sectionId,
+                [this, job](std::vector<int> keys) {
+                    if (abandonIfServerChanged(job)) return;
+                    std::unordered_set<int> serverKeys(keys.begin(), keys.end());
+                    size_t before = job->items.size();
+                    job->items.erase(std::remove_if(job->items.begin(), job->items.end(),
+                        [&serverKeys](const EntityRef& ref) { return serverKeys.count(ref->ratingKey) == 0; }),
+                        job->items.end());
+                    job->result.removed = before - job->items.size();
+                    if (job->result.removed > 0) {
+                        job->result.membershipChanged = true;
+                    }
+
+                    // Items we never saw (e.g. moved in with an old addedAt)
+                    // can only be picked up by a full listing next time
+                    bool complete = job->items.size() == serverKeys.size();
+                    if (!complete) {
+                        LOGW("LibrarySync: Section {} is missing {} items, next sync is full",
+                             job->sectionId, serverKeys.size() - job->items.size());
+                    }
+                    finish(job, complete);
+                },
+                [this, job](const std::string& error) {
+                    fail(job, error);
+                }
+            );
+        },
+        [this, job](const std::string& error) {
+            fail(job, error);
+        }
+    );
+}
+
+void LibrarySync::finish(JobPtr job, bool complete) {
+    auto* cache = LibraryCache::getInstance();
+    cache->put(job->sectionId, job->items, job->totalSize);
+    cache->setSyncState(job->sectionId, job->highWater, complete);
+
+    if (complete) {
+        std::unordered_set<int> keys;
+        keys.reserve(job->items.size());
+        for (const auto& ref : job->items) {
+            keys.insert(ref->ratingKey);
+        }
+        SearchIndex::getInstance()->retainSection(job->sectionId, keys);
+    }
+
+    m_inProgress.erase({job->machineId, job->sectionId});
+    m_lastSync[{job->machineId, job->sectionId}] = std::chrono::steady_clock::now();
+
+    job->result.bytes = PlexApi::getBytesReceived() - job->bytesAtStart;
+    LOGI("LibrarySync: Section {} {} sync done - {} items, {} changed, {} added, {} removed, {} KB",
+         job->sectionId, job->result.full ? "full" : "delta", job->items.size(),
+         job->result.changed, job->result.added, job->result.removed,
+         job->result.bytes / 1024);
+
+    if (job->onComplete) job->onComplete(job->result);
+}
+
+void LibrarySync::fail(JobPtr job, const std::string& error) {
+    m_inProgress.erase({job->machineId, job->sectionId});
+    LOGE("LibrarySync: Section {} sync failed: {}", job->sectionId, error);
+    if (job->onError) job->onError(error);
+}
+
+bool LibrarySync::abandonIfServerChanged(JobPtr job) {
+    if (job->machineId == LibraryCache::getInstance()->getMachineId()) return false;
+
+    // The cache, index and entity store now hold another server's items,
+    // and this section id may name a different section there
+    m_inProgress.erase({job->machineId, job->sectionId});
+    LOGI("LibrarySync: Dropping sync of section {}, server changed", job->sectionId);
+    return true;
+}
+
+void LibrarySync::trackHighWater(JobPtr job, const std::vector<plex::MediaItem>& items) {
+    for (const auto& item : items) {
+        job->highWater = std::max({job->highWater, item.updatedAt, item.addedAt});
+    }
+}
@@ -1,7 +1,15 @@
 #include "core/mpv_core.hpp"
 #include "core/settings_manager.hpp"
+#include "core/range_stream.hpp"
+#include "util/callback_task.hpp"
+#include "util/log.hpp"
+#include "util/startup_metrics.hpp"
 
+#include <algorithm>
 #include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
 
 #ifdef BOREALIS_USE_DEKO3D
 #include <borealis/platforms/switch/switch_video.hpp>
@@ -11,7 +19,7 @@ MPVCore* MPVCore::s_instance = nullptr;
 
 static inline void checkError(int status) {
     if (status < 0) {
-        brls::Logger::error("MPV error: {}", mpv_error_string(status));
+        LOGE("MPV error: {}", mpv_error_string(status));
     }
 }
 
@@ -31,12 +39,12 @@ void MPVCore::destroyInstance() {
 
 MPVCore::MPVCore() {
 #ifdef BOREALIS_USE_DEKO3D
-    memset(&m_doneFence, 0, sizeof(m_doneFence));
-    memset(&m_readyFence, 0, sizeof(m_readyFence));
+    memset(m_doneFences, 0, sizeof(m_doneFences));
+    memset(m_readyFences, 0, sizeof(m_readyFences));
     m_mpvFbo = {
         .tex = nullptr,
-        .ready_fence = &m_readyFence,
-        .done_fence = &m_doneFence,
+        .ready_fence = &m_readyFences[0],
+        .done_fence = &m_doneFences[0],
         .w = 1280,
         .h = 720,
         .format = DkImageFormat_RGBA8_Unorm,
@@ -63,7 +71,7 @@ void MPVCore::init() {
 
     m_mpv = mpv_create();
     if (!m_mpv) {
-        brls::Logger::error("Failed to create MPV handle");
+        LOGE("Failed to create MPV handle");
         return;
     }
 
@@ -76,24 +84,20 @@ void MPVCore::init() {
     mpv_set_option_string(m_mpv, "keep-open", "yes");
     mpv_set_option_string(m_mpv, "idle", "yes");
     mpv_set_option_string(m_mpv, "ytdl", "no");
+    mpv_set_option_string(m_mpv, "prefetch-playlist", "yes");
 
-    int cacheSize = SettingsManager::getInstance()->getInMemoryCache();
-    if (cacheSize > 0) {
-        std::string cacheStr = std::to_string(cacheSize) + "MiB";
-        std::string backCacheStr = std::to_string(cacheSize / 2) + "MiB";
-        brls::Logger::info("MPV cache: {} forward, {} back", cacheStr, backCacheStr);
-        mpv_set_option_string(m_mpv, "demuxer-max-bytes", cacheStr.c_str());
-        mpv_set_option_string(m_mpv, "demuxer-max-back-bytes", backCacheStr.c_str());
-        mpv_set_option_string(m_mpv, "demuxer-readahead-secs", "600");
-        mpv_set_option_string(m_mpv, "cache", "yes");
-    } else {
-        mpv_set_option_string(m_mpv, "cache", "no");
-    }
+    // mpv only ever caches in memory; the SD card tier sits below it, in
+    // RangeStream
+    applyMemoryCache();
+    int diskCacheSize = SettingsManager::getInstance()->getDiskCache();
+    if (diskCacheSize > 0) configureDiskCache(diskCacheSize);
 
     mpv_set_option_string(m_mpv, "network-timeout", "30");
 
-    mpv_set_option_string(m_mpv, "terminal", "yes");
-    mpv_set_option_string(m_mpv, "msg-level", "all=v");
+    // Left to itself mpv writes to stdout synchronously from its own
+    // threads, the decoder's included. Its messages come through the event
+    // loop instead (see handleLogMessage), into the async log
+    mpv_set_option_string(m_mpv, "terminal", "no");
 
 #ifdef __SWITCH__
     mpv_set_option_string(m_mpv, "vd-lavc-dr", "yes");
@@ -103,18 +107,29 @@ void MPVCore::init() {
 #endif
 
     if (mpv_initialize(m_mpv) < 0) {
-        brls::Logger::error("Failed to initialize MPV");
+        LOGE("Failed to initialize MPV");
         mpv_terminate_destroy(m_mpv);
         m_mpv = nullptr;
         return;
     }
 
+    RangeStream::registerProtocol(m_mpv);
+
+    // Only what the LOG macros would keep anyway is sent over
+#if SAFFRON_LOG_LEVEL >= SAFFRON_LOG_LEVEL_VERBOSE
+    checkError(mpv_request_log_messages(m_mpv, "v"));
+#else
+    checkError(mpv_request_log_messages(m_mpv, "warn"));
+#endif
+
     checkError(mpv_observe_property(m_mpv, 1, "core-idle", MPV_FORMAT_FLAG));
     checkError(mpv_observe_property(m_mpv, 2, "pause", MPV_FORMAT_FLAG));
     checkError(mpv_observe_property(m_mpv, 3, "duration", MPV_FORMAT_INT64));
     checkError(mpv_observe_property(m_mpv, 4, "playback-time", MPV_FORMAT_DOUBLE));
     checkError(mpv_observe_property(m_mpv, 5, "volume", MPV_FORMAT_INT64));
     checkError(mpv_observe_property(m_mpv, 6, "speed", MPV_FORMAT_DOUBLE));
+    checkError(mpv_observe_property(m_mpv, 7, "demuxer-cache-duration", MPV_FORMAT_DOUBLE));
+    checkError(mpv_observe_property(m_mpv, 8, "paused-for-cache", MPV_FORMAT_FLAG));
 
 #ifdef BOREALIS_USE_DEKO3D
     auto* videoContext = dynamic_cast<brls::SwitchVideoContext*>(
@@ -136,18 +151,24 @@ void MPVCore::init() {
 #endif
 
     if (mpv_render_context_create(&m_mpvContext, m_mpv, params) < 0) {
-        brls::Logger::error("Failed to create MPV render context");
+        LOGE("Failed to create MPV render context");
         mpv_terminate_destroy(m_mpv);
         m_mpv = nullptr;
         return;
     }
 
-    mpv_set_wakeup_callback(m_mpv, onWakeup, this);
     mpv_render_context_set_update_callback(m_mpvContext, onUpdate, this);
+    startEventThread();
+
+    m_pipelinedRender = SettingsManager::getInstance()->isPipelinedRenderEnabled();
+    LOGI("MPV rendering: {}", m_pipelinedRender ? "pipelined" : "synchronous");
+
+    m_progressTask = new CallbackTask(PROGRESS_INTERVAL_MS, [this]() { dispatchProgress(); });
+    m_progressTask->start();
 
     m_focusSubscription = brls::Application::getWindowFocusChangedEvent()->subscribe(
         [this](bool focus) {
-            if (!focus && m_state == PlaybackState::Playing) {
+            if (!focus && isPlaying()) {
                 pause();
             }
         }
@@ -157,21 +178,90 @@ void MPVCore::init() {
         cleanup();
     });
 
-    brls::Logger::info("MPV initialized: {}",
+    LOGI("MPV initialized: {}",
         mpv_get_property_string(m_mpv, "mpv-version"));
 }
 
+void MPVCore::applyMemoryCache() {
+    int cacheSize = SettingsManager::getInstance()->getInMemoryCache();
+    if (cacheSize > 0) {
+        std::string cacheStr = std::to_string(cacheSize) + "MiB";
+        std::string backCacheStr = std::to_string(cacheSize / 2) + "MiB";
+        LOGI("MPV cache: {} forward, {} back", cacheStr, backCacheStr);
+        mpv_set_option_string(m_mpv, "cache", "yes");
+        mpv_set_option_string(m_mpv, "cache-on-disk", "no");
+        mpv_set_option_string(m_mpv, "demuxer-max-bytes", cacheStr.c_str());
+        mpv_set_option_string(m_mpv, "demuxer-max-back-bytes", backCacheStr.c_str());
+        mpv_set_option_string(m_mpv, "demuxer-readahead-secs", "600");
+    } else {
+        mpv_set_option_string(m_mpv, "cache", "no");
+        mpv_set_option_string(m_mpv, "cache-on-disk", "no");
+    }
+}
+
+void MPVCore::configureDiskCache(int sizeMb) {
+    mkdir(CACHE_ROOT, 0755);
+    mkdir(DISK_CACHE_DIR, 0755);
+    clearDiskCache();
+
+    int64_t budget = static_cast<int64_t>(sizeMb) * 1024 * 1024;
+
+    // Never take the last of the card's free space
+    struct statvfs fs;
+    if (statvfs(DISK_CACHE_DIR, &fs) == 0) {
+        int64_t freeBytes = static_cast<int64_t>(fs.f_bavail) * static_cast<int64_t>(fs.f_frsize);
+        budget = std::min<int64_t>(budget, freeBytes * 9 / 10);
+    }
+    if (budget < MIN_DISK_CACHE_BYTES) {
+        LOGW("MPV disk cache: Not enough free space ({} MB), using memory cache only", budget / (1024 * 1024));
+        return;
+    }
+
+    // The ring's segment files stay under FAT32's file size limit, and it
+    // never grows past the budget however long a stream plays
+    RangeStream::setDiskCache(DISK_CACHE_DIR, budget);
+    m_diskCacheBytes = budget;
+    LOGI("MPV disk cache: {} MB ring in {}", budget / (1024 * 1024), DISK_CACHE_DIR);
+}
+
+void MPVCore::clearDiskCache() {
+    // Catches files left behind by a crash or a forced exit
+    DIR* dir = opendir(DISK_CACHE_DIR);
+    if (!dir) return;
+    while (struct dirent* entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        std::string path = std::string(DISK_CACHE_DIR) + "/" + entry->d_name;
+        remove(path.c_str());
+    }
+    closedir(dir);
+}
+
 void MPVCore::cleanup() {
     m_videoStopped.store(true);
     disableSyncCallbacks();
     clearCallbacks();
 
+    if (m_progressTask) {
+        m_progressTask->stop();
+        delete m_progressTask;
+        m_progressTask = nullptr;
+    }
+
     if (m_mpv) {
         mpv_command_string(m_mpv, "quit");
     }
+    stopEventThread();
 
     brls::Application::getWindowFocusChangedEvent()->unsubscribe(m_focusSubscription);
 
+#ifdef BOREALIS_USE_DEKO3D
+    // mpv may still be drawing into a framebuffer we handed it
+    for (int i = 0; i < MAX_FRAMEBUFFERS; i++) {
+        if (m_fencePending[i]) dkFenceWait(&m_doneFences[i], -1);
+        m_fencePending[i] = false;
+    }
+#endif
+
     if (m_mpvContext) {
         mpv_render_context_free(m_mpvContext);
         m_mpvContext = nullptr;
@@ -181,28 +271,26 @@ void MPVCore::cleanup() {
         mpv_terminate_destroy(m_mpv);
         m_mpv = nullptr;
     }
+    if (m_diskCacheBytes > 0) {
+        // The streams are closed with mpv, so this drops the last reference
+        // and the ring removes its files
+        RangeStream::setDiskCache("", 0);
+        m_diskCacheBytes = 0;
+    }
 
-    m_state = PlaybackState::Stopped;
-    m_position = 0;
-    m_duration = 0;
-}
-
-void MPVCore::onWakeup(void* ctx) {
-    MPVCore* core = static_cast<MPVCore*>(ctx);
-    if (!core || !core->m_mpv) return;
-    brls::sync([core]() {
-        if (core->m_mpv) {
-            core->eventLoop();
-        }
-    });
+    publishState(PlaybackState::Stopped);
+    publish(m_position, int64_t{0});
+    publish(m_duration, int64_t{0});
+    publish(m_cacheSeconds, 0.0);
 }
 
 void MPVCore::onUpdate(void* ctx) {
     MPVCore* core = static_cast<MPVCore*>(ctx);
     if (!core || !core->m_mpvContext) return;
     brls::sync([core]() {
-        if (core->m_mpvContext) {
-            mpv_render_context_update(core->m_mpvContext);
+        if (core->m_mpvContext &&
+            (mpv_render_context_update(core->m_mpvContext) & MPV_RENDER_UPDATE_FRAME)) {
+            core->m_frameReady = true;
         }
     });
 }
@@ -217,74 +305,227 @@ void MPVCore::disableSyncCallbacks() {
     m_alive.reset();
 }
 
+void MPVCore::startEventThread() {
+    if (m_eventThread.joinable()) return;
+    m_eventThreadRunning.store(true);
+    m_eventThread = std::thread([this]() { eventLoop(); });
+}
+
+void MPVCore::stopEventThread() {
+    if (!m_eventThread.joinable()) return;
+    m_eventThreadRunning.store(false);
+    if (m_mpv) mpv_wakeup(m_mpv);
+    m_eventThread.join();
+}
+
 void MPVCore::eventLoop() {
-    while (m_mpv) {
-        mpv_event* event = mpv_wait_event(m_mpv, 0);
-        if (event->event_id == MPV_EVENT_NONE) break;
-
-        switch (event->event_id) {
-            case MPV_EVENT_PROPERTY_CHANGE:
-                handlePropertyChange(static_cast<mpv_event_property*>(event->data));
-                break;
-
-            case MPV_EVENT_START_FILE:
-                m_state = PlaybackState::Buffering;
-                if (m_onStateChanged) m_onStateChanged(m_state);
-                break;
-
-            case MPV_EVENT_FILE_LOADED:
-                m_videoStopped.store(false);
-                m_state = PlaybackState::Playing;
-                if (m_onStateChanged) m_onStateChanged(m_state);
-                break;
-
-            case MPV_EVENT_END_FILE: {
-                m_videoStopped.store(true);
-                auto* endFile = static_cast<mpv_event_end_file*>(event->data);
-                bool reachedEof = (endFile->reason == MPV_END_FILE_REASON_EOF);
-
-                if (endFile->reason == MPV_END_FILE_REASON_ERROR) {
-                    std::string error = mpv_error_string(endFile->error);
-                    if (m_onError) m_onError(error);
-                }
+    // Waking up for the telemetry interval doubles as the sampling clock
+    const auto interval = std::chrono::milliseconds(PlaybackTelemetry::SAMPLE_INTERVAL_MS);
+    auto nextSample = std::chrono::steady_clock::now() + interval;
+
+    while (m_eventThreadRunning.load()) {
+        double timeout = std::chrono::duration<double>(nextSample - std::chrono::steady_clock::now()).count();
+        mpv_event* event = mpv_wait_event(m_mpv, std::max(0.0, timeout));
+        if (event->event_id != MPV_EVENT_NONE) {
+            handleEvent(event);
+            if (event->event_id == MPV_EVENT_SHUTDOWN) break;
+        }
 
-                m_state = PlaybackState::Stopped;
-                if (m_onStateChanged) m_onStateChanged(m_state);
-                if (m_onEndFile) m_onEndFile(reachedEof);
-                break;
-            }
+        auto now = std::chrono::steady_clock::now();
+        if (now >= nextSample) {
+            if (m_telemetry.isActive() && !isStopped()) sampleTelemetry(PlaybackTelemetry::Mark::None);
+            nextSample = now + interval;
+        }
+    }
+}
 
-            case MPV_EVENT_SHUTDOWN:
-                m_videoStopped.store(true);
-                m_state = PlaybackState::Stopped;
-                if (m_onStateChanged) m_onStateChanged(m_state);
-                break;
+void MPVCore::handleEvent(mpv_event* event) {
+    switch (event->event_id) {
+        case MPV_EVENT_PROPERTY_CHANGE:
+            handlePropertyChange(static_cast<mpv_event_property*>(event->data));
+            break;
+
+        case MPV_EVENT_START_FILE:
+            sampleTelemetry(PlaybackTelemetry::Mark::FileStart);
+            publishState(PlaybackState::Buffering);
+            post([this]() {
+                if (m_onStateChanged) m_onStateChanged(PlaybackState::Buffering);
+            });
+            break;
+
+        case MPV_EVENT_FILE_LOADED:
+            m_videoStopped.store(false);
+            publishState(PlaybackState::Playing);
+            sampleTelemetry(PlaybackTelemetry::Mark::FileLoaded);
+            post([this, loadedAt = StartupMetrics::Clock::now()]() {
+                StartupMetrics::mark(StartupMetrics::Stage::FileLoaded, loadedAt);
+                if (m_onStateChanged) m_onStateChanged(PlaybackState::Playing);
+                if (m_onFileLoaded) m_onFileLoaded();
+            });
+            break;
+
+        case MPV_EVENT_END_FILE: {
+            auto* endFile = static_cast<mpv_event_end_file*>(event->data);
+            m_videoStopped.store(true);
+            bool reachedEof = (endFile->reason == MPV_END_FILE_REASON_EOF);
+            std::string error;
+            if (endFile->reason == MPV_END_FILE_REASON_ERROR) {
+                error = mpv_error_string(endFile->error);
+            }
 
-            default:
-                break;
+            sampleTelemetry(PlaybackTelemetry::Mark::FileEnd);
+            publishState(PlaybackState::Stopped);
+            post([this, reachedEof, error]() {
+                if (!error.empty() && m_onError) m_onError(error);
+                if (m_onStateChanged) m_onStateChanged(PlaybackState::Stopped);
+                if (m_onEndFile) m_onEndFile(reachedEof);
+            });
+            break;
         }
+
+        case MPV_EVENT_SEEK:
+            sampleTelemetry(PlaybackTelemetry::Mark::Seek);
+            break;
+
+        case MPV_EVENT_PLAYBACK_RESTART:
+            sampleTelemetry(PlaybackTelemetry::Mark::Restart);
+            post([this]() {
+                if (m_onPlaybackRestart) m_onPlaybackRestart();
+            });
+            break;
+
+        case MPV_EVENT_LOG_MESSAGE:
+            handleLogMessage(static_cast<mpv_event_log_message*>(event->data));
+            break;
+
+        case MPV_EVENT_SHUTDOWN:
+            m_videoStopped.store(true);
+            publishState(PlaybackState::Stopped);
+            post([this]() {
+                if (m_onStateChanged) m_onStateChanged(PlaybackState::Stopped);
+            });
+            break;
+
+        default:
+            break;
+    }
+}
+
+void MPVCore::handleLogMessage(mpv_event_log_message* msg) {
+    // Each message is one line ending in a newline
+    std::string text = msg->text;
+    if (!text.empty() && text.back() == '\n') text.pop_back();
+
+    if (msg->log_level <= MPV_LOG_LEVEL_ERROR) {
+        LOGE("mpv/{}: {}", msg->prefix, text);
+    } else if (msg->log_level <= MPV_LOG_LEVEL_WARN) {
+        LOGW("mpv/{}: {}", msg->prefix, text);
+    } else if (msg->log_level <= MPV_LOG_LEVEL_INFO) {
+        LOGI("mpv/{}: {}", msg->prefix, text);
+    } else {
+        LOGV("mpv/{}: {}", msg->prefix, text);
     }
 }
 
 void MPVCore::handlePropertyChange(mpv_event_property* prop) {
     if (strcmp(prop->name, "pause") == 0 && prop->format == MPV_FORMAT_FLAG) {
         bool paused = *static_cast<int*>(prop->data);
-        if (m_state != PlaybackState::Stopped) {
-            m_state = paused ? PlaybackState::Paused : PlaybackState::Playing;
-            if (m_onStateChanged) m_onStateChanged(m_state);
+        if (getState() != PlaybackState::Stopped) {
+            PlaybackState state = paused ? PlaybackState::Paused : PlaybackState::Playing;
+            publishState(state);
+            post([this, state]() {
+                if (m_onStateChanged) m_onStateChanged(state);
+            });
         }
     } else if (strcmp(prop->name, "duration") == 0 && prop->format == MPV_FORMAT_INT64) {
-        m_duration = *static_cast<int64_t*>(prop->data) * 1000;
+        publish(m_duration, *static_cast<int64_t*>(prop->data) * 1000);
     } else if (strcmp(prop->name, "playback-time") == 0 && prop->format == MPV_FORMAT_DOUBLE) {
-        m_position = static_cast<int64_t>(*static_cast<double*>(prop->data) * 1000);
-        if (m_onProgress) m_onProgress(m_position, m_duration);
+        publish(m_position, static_cast<int64_t>(*static_cast<double*>(prop->data) * 1000));
+    } else if (strcmp(prop->name, "demuxer-cache-duration") == 0 && prop->format == MPV_FORMAT_DOUBLE) {
+        publish(m_cacheSeconds, *static_cast<double*>(prop->data));
+    } else if (strcmp(prop->name, "paused-for-cache") == 0 && prop->format == MPV_FORMAT_FLAG) {
+        bool paused = *static_cast<int*>(prop->data);
+        if (paused != m_pausedForCache.exchange(paused)) {
+            sampleTelemetry(paused ? PlaybackTelemetry::Mark::BufferingStart : PlaybackTelemetry::Mark::BufferingEnd);
+        }
     } else if (strcmp(prop->name, "volume") == 0 && prop->format == MPV_FORMAT_INT64) {
-        m_volume = static_cast<int>(*static_cast<int64_t*>(prop->data));
+        m_volume.store(static_cast<int>(*static_cast<int64_t*>(prop->data)));
     } else if (strcmp(prop->name, "speed") == 0 && prop->format == MPV_FORMAT_DOUBLE) {
-        m_speed = *static_cast<double*>(prop->data);
+        m_speed.store(*static_cast<double*>(prop->data));
     }
 }
 
+template <typename T>
+void MPVCore::publish(std::atomic<T>& field, T value) {
+    std::lock_guard<std::mutex> lock(m_publishMutex);
+    uint32_t seq = m_snapshotSeq.load(std::memory_order_relaxed);
+    m_snapshotSeq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    field.store(value, std::memory_order_relaxed);
+    m_snapshotSeq.store(seq + 2, std::memory_order_release);
+}
+
+void MPVCore::publishState(PlaybackState state) {
+    publish(m_state, state);
+}
+
+PlaybackSnapshot MPVCore::getSnapshot() const {
+    PlaybackSnapshot snapshot;
+    uint32_t before, after;
+    do {
+        before = m_snapshotSeq.load(std::memory_order_acquire);
+        snapshot.state = m_state.load(std::memory_order_relaxed);
+        snapshot.position = m_position.load(std::memory_order_relaxed);
+        snapshot.duration = m_duration.load(std::memory_order_relaxed);
+        snapshot.cacheSeconds = m_cacheSeconds.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = m_snapshotSeq.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    return snapshot;
+}
+
+void MPVCore::post(std::function<void()> task) {
+    std::weak_ptr<bool> alive;
+    {
+        std::lock_guard<std::mutex> lock(m_syncMutex);
+        alive = m_alive;
+    }
+    brls::sync([alive, task]() {
+        if (alive.lock()) task();
+    });
+}
+
+void MPVCore::markTelemetry(PlaybackTelemetry::Mark mark) {
+    sampleTelemetry(mark);
+}
+
+void MPVCore::sampleTelemetry(PlaybackTelemetry::Mark mark) {
+    if (!m_mpv || !m_telemetry.isActive()) return;
+
+    PlaybackTelemetry::Sample sample;
+    sample.timeMs = m_telemetry.elapsedMs();
+    sample.mark = mark;
+    sample.positionMs = getPosition();
+    sample.decoderDrops = getInt("decoder-frame-drop-count");
+    sample.outputDrops = getInt("frame-drop-count");
+    sample.avsync = getDouble("avsync");
+    sample.cacheSeconds = getCacheSeconds();
+    sample.videoBitrateKbps = getInt("video-bitrate") / 1000;
+    sample.cacheSpeedKbps = getInt("cache-speed") * 8 / 1000;
+    sample.pausedForCache = m_pausedForCache.load();
+    m_telemetry.record(sample);
+}
+
+void MPVCore::dispatchProgress() {
+    if (!m_onProgress) return;
+
+    PlaybackSnapshot snapshot = getSnapshot();
+    if (snapshot.position == m_lastProgressPosition && snapshot.duration == m_lastProgressDuration) return;
+    m_lastProgressPosition = snapshot.position;
+    m_lastProgressDuration = snapshot.duration;
+    m_onProgress(snapshot.position, snapshot.duration);
+}
+
 void MPVCore::play(const std::string& url, bool isDirectPlay, int bitrateKbps) {
     if (!m_mpv) {
         init();
@@ -298,17 +539,46 @@ void MPVCore::play(const std::string& url, bool isDirectPlay, int bitrateKbps) {
     if (isDirectPlay) {
         mpv_set_property_string(m_mpv, "stream-lavf-o", "reconnect=1,reconnect_streamed=1");
         mpv_set_property_string(m_mpv, "cache-pause-wait", "2");
-        brls::Logger::info("Direct play: {}kbps", bitrateKbps);
+        LOGI("Direct play: {}kbps", bitrateKbps);
+        if (m_diskCacheBytes > 0 && bitrateKbps > 0) {
+            int64_t rewindSec = m_diskCacheBytes * 8 / (static_cast<int64_t>(bitrateKbps) * 1000);
+            LOGI("Disk cache keeps about {} minutes for rewinding", rewindSec / 60);
+        }
     } else {
         mpv_set_property_string(m_mpv, "stream-lavf-o",
             "reconnect=1,reconnect_streamed=1,reconnect_delay_max=2,seekable=0");
     }
 
+    std::string playUrl = streamUrl(url, isDirectPlay);
+
     m_videoStopped.store(false);
-    brls::Logger::info("Playing ({}): {}", isDirectPlay ? "direct" : "transcode", url);
+    LOGD("Playing ({}): {}", isDirectPlay ? "direct" : "transcode", url);
 
-    const char* cmd[] = {"loadfile", url.c_str(), nullptr};
+    const char* cmd[] = {"loadfile", playUrl.c_str(), nullptr};
     mpv_command_async(m_mpv, 0, cmd);
+    StartupMetrics::mark(StartupMetrics::Stage::LoadFile);
+}
+
+void MPVCore::queueNext(const std::string& url, bool isDirectPlay) {
+    if (!m_mpv) return;
+
+    std::string playUrl = streamUrl(url, isDirectPlay);
+    LOGD("Queueing next ({}): {}", isDirectPlay ? "direct" : "transcode", url);
+    const char* cmd[] = {"loadfile", playUrl.c_str(), "append", nullptr};
+    mpv_command_async(m_mpv, 0, cmd);
+}
+
+std::string MPVCore::streamUrl(const std::string& url, bool isDirectPlay) {
+    // High-bitrate files stall on a single connection; read them through
+    // parallel range requests instead. The SD card tier lives in
+    // RangeStream too, so it is used even with a single connection
+    int connections = SettingsManager::getInstance()->getDirectPlayConnections();
+    bool ranged = connections > 1 || RangeStream::getDiskCache() != nullptr;
+    if (isDirectPlay && ranged && url.compare(0, 4, "http") == 0) {
+        RangeStream::setConnectionCount(connections);
+        return RangeStream::wrapUrl(url);
+    }
+    return url;
 }
 
 void MPVCore::stop() {
@@ -319,9 +589,9 @@ void MPVCore::stop() {
     const char* cmd[] = {"stop", nullptr};
     mpv_command_async(m_mpv, 0, cmd);
 
-    m_state = PlaybackState::Stopped;
-    m_position = 0;
-    if (m_onStateChanged) m_onStateChanged(m_state);
+    publishState(PlaybackState::Stopped);
+    publish(m_position, int64_t{0});
+    if (m_onStateChanged) m_onStateChanged(PlaybackState::Stopped);
 }
 
 void MPVCore::pause() {
@@ -337,9 +607,10 @@ void MPVCore::resume() {
 }
 
 void MPVCore::togglePlay() {
-    if (m_state == PlaybackState::Playing) {
+    PlaybackState state = getState();
+    if (state == PlaybackState::Playing) {
         pause();
-    } else if (m_state == PlaybackState::Paused) {
+    } else if (state == PlaybackState::Paused) {
         resume();
     }
 }
@@ -362,11 +633,45 @@ void MPVCore::seekRelative(int64_t deltaMs) {
     mpv_command_async(m_mpv, 0, cmd);
 }
 
+bool MPVCore::isPositionCached(int64_t positionMs) {
+    if (!m_mpv) return false;
+
+    mpv_node state;
+    if (mpv_get_property(m_mpv, "demuxer-cache-state", MPV_FORMAT_NODE, &state) < 0) return false;
+
+    // Keep clear of the very end of a range, where the next packet may
+    // still be on the wire
+    double position = positionMs / 1000.0;
+    bool cached = false;
+    if (state.format == MPV_FORMAT_NODE_MAP) {
+        for (int i = 0; i < state.u.list->num && !cached; i++) {
+            if (strcmp(state.u.list->keys[i], "seekable-ranges") != 0) continue;
+            mpv_node& ranges = state.u.list->values[i];
+            if (ranges.format != MPV_FORMAT_NODE_ARRAY) break;
+
+            for (int r = 0; r < ranges.u.list->num && !cached; r++) {
+                mpv_node& range = ranges.u.list->values[r];
+                if (range.format != MPV_FORMAT_NODE_MAP) continue;
+                double start = -1.0, end = -1.0;
+                for (int k = 0; k < range.u.list->num; k++) {
+                    const mpv_node& value = range.u.list->values[k];
+                    if (value.format != MPV_FORMAT_DOUBLE) continue;
+                    if (strcmp(range.u.list->keys[k], "start") == 0) start = value.u.double_;
+                    else if (strcmp(range.u.list->keys[k], "end") == 0) end = value.u.double_;
+                }
+                cached = start >= 0.0 && position >= start && position <= end - 1.0;
+            }
+        }
+    }
+    mpv_free_node_contents(&state);
+    return cached;
+}
+
 void MPVCore::setVolume(int volume) {
     if (!m_mpv) return;
 
-    m_volume = std::max(0, std::min(100, volume));
-    int64_t vol = m_volume;
+    m_volume.store(std::max(0, std::min(100, volume)));
+    int64_t vol = m_volume.load();
     mpv_set_property(m_mpv, "volume", MPV_FORMAT_INT64, &vol);
 }
 
@@ -377,8 +682,9 @@ int MPVCore::getVolume() const {
 void MPVCore::setSpeed(double speed) {
     if (!m_mpv) return;
 
-    m_speed = std::max(0.25, std::min(4.0, speed));
-    mpv_set_property(m_mpv, "speed", MPV_FORMAT_DOUBLE, &m_speed);
+    double clamped = std::max(0.25, std::min(4.0, speed));
+    m_speed.store(clamped);
+    mpv_set_property(m_mpv, "speed", MPV_FORMAT_DOUBLE, &clamped);
 }
 
 double MPVCore::getSpeed() const {
@@ -407,6 +713,14 @@ void MPVCore::cycleSubtitles() {
     mpv_command_async(m_mpv, 0, cmd);
 }
 
+void MPVCore::addSubtitle(const std::string& path, const std::string& title, const std::string& lang, bool select) {
+    if (!m_mpv) return;
+
+    // "auto" adds the track without switching to it
+    const char* cmd[] = {"sub-add", path.c_str(), select ? "select" : "auto", title.c_str(), lang.c_str(), nullptr};
+    mpv_command_async(m_mpv, 0, cmd);
+}
+
 void MPVCore::setAudioTrack(int trackId) {
     if (!m_mpv) return;
 
@@ -459,6 +773,8 @@ void MPVCore::setOnStateChanged(StateCallback callback) {
 
 void MPVCore::setOnProgress(ProgressCallback callback) {
     m_onProgress = callback;
+    m_lastProgressPosition = -1;
+    m_lastProgressDuration = -1;
 }
 
 void MPVCore::setOnError(ErrorCallback callback) {
@@ -469,11 +785,21 @@ void MPVCore::setOnEndFile(EndFileCallback callback) {
     m_onEndFile = callback;
 }
 
+void MPVCore::setOnPlaybackRestart(PlaybackRestartCallback callback) {
+    m_onPlaybackRestart = callback;
+}
+
+void MPVCore::setOnFileLoaded(FileLoadedCallback callback) {
+    m_onFileLoaded = callback;
+}
+
 void MPVCore::clearCallbacks() {
     m_onStateChanged = nullptr;
     m_onProgress = nullptr;
     m_onError = nullptr;
     m_onEndFile = nullptr;
+    m_onPlaybackRestart = nullptr;
+    m_onFileLoaded = nullptr;
 }
 
 void MPVCore::setFrameSize(brls::Rect rect) {
@@ -493,6 +819,7 @@ void MPVCore::draw(brls::Rect rect, float alpha) {
     if (m_videoStopped.load()) return;
     if (alpha < 1.0f) return;
 
+    auto drawStart = std::chrono::steady_clock::now();
     setFrameSize(rect);
 
 #ifdef BOREALIS_USE_DEKO3D
@@ -504,17 +831,56 @@ void MPVCore::draw(brls::Rect rect, float alpha) {
     m_mpvFbo.tex = videoContext->getFramebuffer();
     if (!m_mpvFbo.tex) return;
 
-    videoContext->queueSignalFence(&m_readyFence);
+    // The synchronous path keeps using a single pair and drains it below
+    int slot = 0;
+    if (m_pipelinedRender) {
+        int slots = std::max(1, std::min(static_cast<int>(VideoContext::framebufferCount), MAX_FRAMEBUFFERS));
+        m_frameSlot = (m_frameSlot + 1) % slots;
+        slot = m_frameSlot;
+        // Normally signalled long ago; only blocks if the GPU is a full
+        // swapchain behind
+        if (m_fencePending[slot]) dkFenceWait(&m_doneFences[slot], -1);
+    }
+    m_mpvFbo.ready_fence = &m_readyFences[slot];
+    m_mpvFbo.done_fence = &m_doneFences[slot];
+
+    videoContext->queueSignalFence(&m_readyFences[slot]);
     videoContext->queueFlush();
 #endif
 
     mpv_render_context_render(m_mpvContext, m_mpvParams);
 
 #ifdef BOREALIS_USE_DEKO3D
-    videoContext->queueWaitFence(&m_doneFence);
+    // The UI queue waits for mpv on the GPU either way; only the fallback
+    // also stalls the CPU until the frame is finished
+    videoContext->queueWaitFence(&m_doneFences[slot]);
     videoContext->queueFlush();
-    dkFenceWait(&m_doneFence, -1);  // CPU wait for MPV render to complete
+    if (m_pipelinedRender) {
+        m_fencePending[slot] = true;
+    } else {
+        dkFenceWait(&m_doneFences[slot], -1);
+    }
 #endif
 
     mpv_render_context_report_swap(m_mpvContext);
+    if (m_frameReady) {
+        m_frameReady = false;
+        StartupMetrics::mark(StartupMetrics::Stage::FirstFrame);
+    }
+    recordDrawTime(std::chrono::steady_clock::now() - drawStart);
+}
+
+void MPVCore::recordDrawTime(std::chrono::steady_clock::duration elapsed) {
+    int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    m_drawFrames++;
+    m_drawTotalUs += us;
+    m_drawMaxUs = std::max(m_drawMaxUs, us);
+    if (m_drawFrames < DRAW_STATS_FRAMES) return;
+
+    LOGD("MPV draw ({}): avg {:.2f} ms, max {:.2f} ms over {} frames",
+        m_pipelinedRender ? "pipelined" : "synchronous",
+        m_drawTotalUs / 1000.0 / m_drawFrames, m_drawMaxUs / 1000.0, m_drawFrames);
+    m_drawFrames = 0;
+    m_drawTotalUs = 0;
+    m_drawMaxUs = 0;
 }
@@ -0,0 +1,171 @@
+#include "core/playback_telemetry.hpp"
+#include "util/json_escape.hpp"
+#include "util/log.hpp"
+
+#include <borealis.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <sys/stat.h>
+
+const char* PlaybackTelemetry::markName(Mark mark) {
+    switch (mark) {
+        case Mark::None: return "";
+        case Mark::FileStart: return "file_start";
+        case Mark::FileLoaded: return "file_loaded";
+        case Mark::FileEnd: return "file_end";
+        case Mark::BufferingStart: return "buffering_start";
+        case Mark::BufferingEnd: return "buffering_end";
+        case Mark::Seek: return "seek";
+        case Mark::Restart: return "restart";
+        case Mark::QualitySwitch: return "quality_switch";
+        default: return "unknown";
+    }
+}
+
+void PlaybackTelemetry::beginSession(int ratingKey, const std::string& title) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_samples.size() != CAPACITY) m_samples.resize(CAPACITY);
+    m_head = 0;
+    m_count = 0;
+    m_active = true;
+    m_ratingKey = ratingKey;
+    m_title = title;
+    m_startedAt = static_cast<int64_t>(time(nullptr));
+    m_start = std::chrono::steady_clock::now();
+}
+
+void PlaybackTelemetry::endSession() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_active = false;
+}
+
+bool PlaybackTelemetry::isActive() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_active;
+}
+
+int64_t PlaybackTelemetry::elapsedMs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - m_start).count();
+}
+
+void PlaybackTelemetry::record(const Sample& sample) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_active) return;
+
+    // Overwrites the oldest sample once full
+    m_samples[(m_head + m_count) % CAPACITY] = sample;
+    if (m_count < CAPACITY) {
+        m_count++;
+    } else {
+        m_head = (m_head + 1) % CAPACITY;
+    }
+}
+
+std::vector<PlaybackTelemetry::Sample> PlaybackTelemetry::getSamples() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Sample> samples;
+    samples.reserve(m_count);
+    for (size_t i = 0; i < m_count; i++) {
+        samples.push_back(m_samples[(m_head + i) % CAPACITY]);
+    }
+    return samples;
+}
+
+void PlaybackTelemetry::exportSession() {
+    std::vector<Sample> samples = getSamples();
+    if (samples.empty()) return;
+
+    int ratingKey;
+    std::string title;
+    int64_t startedAt;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ratingKey = m_ratingKey;
+        title = m_title;
+        startedAt = m_startedAt;
+    }
+
+    brls::async([samples = std::move(samples), ratingKey, title, startedAt]() {
+        mkdir(EXPORT_DIR, 0755);
+
+        char stamp[32];
+        time_t started = static_cast<time_t>(startedAt);
+        strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", localtime(&started));
+        std::string base = std::string(EXPORT_DIR) + "/" + stamp + "_" + std::to_string(ratingKey);
+
+        bool ok = writeCsv(base + ".csv", samples) &&
+                  writeJson(base + ".json", samples, ratingKey, title, startedAt);
+        if (!ok) {
+            LOGW("PlaybackTelemetry: Failed to export {}", base);
+            return;
+        }
+        LOGI("PlaybackTelemetry: Exported {} samples to {}.csv/.json", samples.size(), base);
+        trimExports();
+    });
+}
+
+bool PlaybackTelemetry::writeCsv(const std::string& path, const std::vector<Sample>& samples) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) return false;
+
+    fprintf(file, "time_ms,event,position_ms,decoder_drops,output_drops,avsync,cache_s,"
+                  "video_kbps,cache_speed_kbps,paused_for_cache\n");
+    for (const auto& s : samples) {
+        fprintf(file, "%lld,%s,%lld,%lld,%lld,%.4f,%.2f,%lld,%lld,%d\n",
+                static_cast<long long>(s.timeMs), markName(s.mark), static_cast<long long>(s.positionMs),
+                static_cast<long long>(s.decoderDrops), static_cast<long long>(s.outputDrops), s.avsync,
+                s.cacheSeconds, static_cast<long long>(s.videoBitrateKbps),
+                static_cast<long long>(s.cacheSpeedKbps), s.pausedForCache ? 1 : 0);
+    }
+    return fclose(file) == 0;
+}
+
+bool PlaybackTelemetry::writeJson(const std::string& path, const std::vector<Sample>& samples, int ratingKey,
+                                  const std::string& title, int64_t startedAt) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) return false;
+
+    fprintf(file, "{\"rating_key\":%d,\"title\":\"%s\",\"started_at\":%lld,\"interval_ms\":%d,\"samples\":[",
+            ratingKey, escapeJson(title).c_str(), static_cast<long long>(startedAt), SAMPLE_INTERVAL_MS);
+    for (size_t i = 0; i < samples.size(); i++) {
+        const Sample& s = samples[i];
+        fprintf(file, "%s\n{\"time_ms\":%lld,\"event\":\"%s\",\"position_ms\":%lld,\"decoder_drops\":%lld,"
+                      "\"output_drops\":%lld,\"avsync\":%.4f,\"cache_s\":%.2f,\"video_kbps\":%lld,"
+                      "\"cache_speed_kbps\":%lld,\"paused_for_cache\":%s}",
+                i == 0 ? "" : ",", static_cast<long long>(s.timeMs), markName(s.mark),
+                static_cast<long long>(s.positionMs), static_cast<long long>(s.decoderDrops),
+                static_cast<long long>(s.outputDrops), s.avsync, s.cacheSeconds,
+                static_cast<long long>(s.videoBitrateKbps), static_cast<long long>(s.cacheSpeedKbps),
+                s.pausedForCache ? "true" : "false");
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
+
+void PlaybackTelemetry::trimExports() {
+    // File names start with the session time, so name order is age order
+    std::vector<std::string> names;
+    DIR* dir = opendir(EXPORT_DIR);
+    if (!dir) return;
+    while (struct dirent* entry = readdir(dir)) {
+        const char* ext = strrchr(entry->d_name, '.');
+        if (ext && strcmp(ext, ".csv") == 0) {
+            names.emplace_back(entry->d_name, ext - entry->d_name);
+        }
+    }
+    closedir(dir);
+
+    if (names.size() <= static_cast<size_t>(MAX_EXPORTS)) return;
+    std::sort(names.begin(), names.end());
+    for (size_t i = 0; i + MAX_EXPORTS < names.size(); i++) {
+        std::string base = std::string(EXPORT_DIR) + "/" + names[i];
+        remove((base + ".csv").c_str());
+        remove((base + ".json").c_str());
+    }
+}
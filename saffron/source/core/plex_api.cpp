@@ -1,13 +1,22 @@
 #include "core/plex_api.hpp"
+#include "core/bandwidth_estimator.hpp"
+#include "core/client_profile.hpp"
+#include "core/http_recorder.hpp"
 #include "core/plex_server.hpp"
 #include "core/settings_manager.hpp"
+#include "util/log.hpp"
+#include "util/trace.hpp"
 
 #include <borealis.hpp>
 #include <curl/curl.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <sstream>
 
+static std::atomic<uint64_t> s_bytesReceived{0};
+
 static size_t writeCallback(char* ptr, size_t size, size_t nmemb, void* userdata) {
     std::string* response = reinterpret_cast<std::string*>(userdata);
     size_t count = size * nmemb;
@@ -28,7 +37,7 @@ static std::string urlEncode(const std::string& value) {
 std::vector<std::string> PlexHeaders::toHeaderList() const {
     std::vector<std::string> headers;
     headers.push_back("Accept: application/json");
-    headers.push_back("User-Agent: SHIELD Android TV");
+    headers.push_back("User-Agent: " + product + "/" + version);
     headers.push_back("X-Plex-Client-Identifier: " + clientIdentifier);
     headers.push_back("X-Plex-Product: " + product);
     headers.push_back("X-Plex-Version: " + version);
@@ -72,66 +81,84 @@ void PlexApi::get(
     std::function<void(const nlohmann::json&)> onSuccess,
     OnError onError
 ) {
-    brls::async([url, headers, onSuccess, onError]() {
-        CURL* curl = curl_easy_init();
-        if (!curl) {
-            if (onError) brls::sync([onError]() { onError("Failed to init curl"); });
-            return;
-        }
-
+    trace::async("PlexApi::get", [url, headers, onSuccess, onError]() {
+        HttpRecorder* recorder = HttpRecorder::getInstance();
         std::string response;
-        struct curl_slist* headerList = nullptr;
+        long httpCode = 0;
+        std::string transferError;
 
-        for (const auto& h : headers.toHeaderList()) {
-            headerList = curl_slist_append(headerList, h.c_str());
-        }
+        if (recorder->isReplaying()) {
+            HttpRecorder::Exchange exchange = recorder->replay("GET", url);
+            response = std::move(exchange.body);
+            httpCode = exchange.status;
+            transferError = exchange.error;
+        } else {
+            CURL* curl = curl_easy_init();
+            if (!curl) {
+                if (onError) brls::sync([onError]() { onError("Failed to init curl"); });
+                return;
+            }
 
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerList);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(curl, CURLOPT_FORBID_REUSE, 1L);
-        curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1L);
+            struct curl_slist* headerList = nullptr;
 
-        CURLcode res = curl_easy_perform(curl);
+            for (const auto& h : headers.toHeaderList()) {
+                headerList = curl_slist_append(headerList, h.c_str());
+            }
 
-        long httpCode = 0;
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerList);
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
+            curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
+            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+            curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+            curl_easy_setopt(curl, CURLOPT_FORBID_REUSE, 1L);
+            curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1L);
+
+            auto started = std::chrono::steady_clock::now();
+            CURLcode res;
+            {
+                TRACE_SCOPE("curl_easy_perform");
+                res = curl_easy_perform(curl);
+            }
 
-        curl_slist_free_all(headerList);
-        curl_easy_cleanup(curl);
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+            if (res == CURLE_OK) BandwidthEstimator::getInstance()->record(curl);
+            else transferError = curl_easy_strerror(res);
 
-        if (res != CURLE_OK) {
-            std::string error = curl_easy_strerror(res);
-            if (onError) brls::sync([onError, error]() { onError(error); });
+            curl_slist_free_all(headerList);
+            curl_easy_cleanup(curl);
+            recorder->record("GET", url, started, httpCode, response, transferError);
+        }
+        s_bytesReceived += response.size();
+
+        if (!transferError.empty()) {
+            if (onError) trace::sync("PlexApi::get onError", [onError, transferError]() { onError(transferError); });
             return;
         }
 
         if (httpCode >= 400) {
             std::string error = "HTTP " + std::to_string(httpCode);
-            brls::sync([error, response, url]() {
-                brls::Logger::error("HTTP error {} for URL: {}", error, url);
-                brls::Logger::error("Response body: {}", response.substr(0, 500));
-            });
-            if (onError) brls::sync([onError, error]() { onError(error); });
+            LOGE("{} for URL: {}", error, url);
+            LOGD("Response body: {:.500}", response);
+            if (onError) trace::sync("PlexApi::get onError", [onError, error]() { onError(error); });
             return;
         }
 
         try {
-            auto json = nlohmann::json::parse(response);
-            brls::sync([onSuccess, json]() { onSuccess(json); });
+            nlohmann::json json;
+            {
+                TRACE_SCOPE("json parse");
+                json = nlohmann::json::parse(response);
+            }
+            trace::sync("PlexApi::get onSuccess", [onSuccess, json]() { onSuccess(json); });
         } catch (const std::exception& e) {
             std::string error = e.what();
-            brls::sync([error, response, url, httpCode]() {
-                brls::Logger::error("JSON parse error for URL: {} (HTTP {})", url, httpCode);
-                brls::Logger::error("Response body: {}", response.substr(0, 500));
-            });
-            if (onError) brls::sync([onError, error]() { onError(error); });
+            LOGE("JSON parse error for URL: {} (HTTP {})", url, httpCode);
+            LOGD("Response body: {:.500}", response);
+            if (onError) trace::sync("PlexApi::get onError", [onError, error]() { onError(error); });
         }
     });
 }
@@ -142,7 +169,7 @@ void PlexApi::getLibrarySections(
     OnError onError
 ) {
     std::string url = buildUrl(server, "/library/sections");
-    brls::Logger::info("PlexApi::getLibrarySections - URL: {}", url);
+    LOGD("PlexApi::getLibrarySections - URL: {}", url);
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
         headers.token = server->getAccessToken();
@@ -177,8 +204,8 @@ void PlexApi::getLibraryItems(
     url += "?X-Plex-Container-Start=" + std::to_string(start);
     url += "&X-Plex-Container-Size=" + std::to_string(count);
 
-    brls::Logger::info("PlexApi::getLibraryItems - sectionId={} start={} count={}", sectionId, start, count);
-    brls::Logger::info("PlexApi::getLibraryItems - URL: {}", url);
+    LOGD("PlexApi::getLibraryItems - sectionId={} start={} count={}", sectionId, start, count);
+    LOGD("PlexApi::getLibraryItems - URL: {}", url);
 
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
@@ -195,7 +222,7 @@ void PlexApi::getLibraryItems(
                 if (mc.contains("totalSize")) {
                     totalSize = mc["totalSize"].get<int>();
                 }
-                brls::Logger::info("PlexApi::getLibraryItems - sectionId={} totalSize={}", sectionId, totalSize);
+                LOGD("PlexApi::getLibraryItems - sectionId={} totalSize={}", sectionId, totalSize);
 
                 if (mc.contains("Metadata")) {
                     for (const auto& meta : mc["Metadata"]) {
@@ -204,18 +231,140 @@ void PlexApi::getLibraryItems(
                         items.push_back(item);
                     }
                 }
-                brls::Logger::info("PlexApi::getLibraryItems - parsed {} items", items.size());
+                LOGD("PlexApi::getLibraryItems - parsed {} items", items.size());
             } else {
-                brls::Logger::warning("PlexApi::getLibraryItems - No MediaContainer in response");
+                LOGW("PlexApi::getLibraryItems - No MediaContainer in response");
             }
             if (onSuccess) onSuccess(items, totalSize);
         } catch (const std::exception& e) {
-            brls::Logger::error("PlexApi::getLibraryItems - Parse error: {}", e.what());
+            LOGE("PlexApi::getLibraryItems - Parse error: {}", e.what());
+            if (onError) onError(e.what());
+        }
+    }, onError);
+}
+
+void PlexApi::getLibraryChanges(
+    PlexServer* server,
+    int sectionId,
+    const std::string& field,
+    int64_t since,
+    int start,
+    int count,
+    std::function<void(std::vector<plex::MediaItem>, int totalSize)> onSuccess,
+    OnError onError
+) {
+    // Dates only have strict comparisons ("field>>=value"), so ask for
+    // anything after since - 1; the '>' characters are encoded so they
+    // survive query parsing
+    std::string url = buildUrl(server, "/library/sections/" + std::to_string(sectionId) + "/all");
+    url += "?" + field + "%3E%3E=" + std::to_string(since - 1);
+    url += "&X-Plex-Container-Start=" + std::to_string(start);
+    url += "&X-Plex-Container-Size=" + std::to_string(count);
+
+    LOGD("PlexApi::getLibraryChanges - sectionId={} {}>>={} start={}", sectionId, field, since - 1, start);
+
+    PlexHeaders headers = buildHeaders();
+    if (!server->getAccessToken().empty()) {
+        headers.token = server->getAccessToken();
+    }
+
+    get(url, headers, [onSuccess, onError](const nlohmann::json& json) {
+        try {
+            std::vector<plex::MediaItem> items;
+            int totalSize = 0;
+            if (json.contains("MediaContainer")) {
+                auto& mc = json["MediaContainer"];
+                if (mc.contains("Metadata")) {
+                    for (const auto& meta : mc["Metadata"]) {
+                        plex::MediaItem item;
+                        plex::from_json(meta, item);
+                        items.push_back(item);
+                    }
+                }
+                // Servers that ignore the paging parameters send everything at once
+                totalSize = mc.contains("totalSize") ? mc["totalSize"].get<int>() : static_cast<int>(items.size());
+            }
+            if (onSuccess) onSuccess(items, totalSize);
+        } catch (const std::exception& e) {
+            LOGE("PlexApi::getLibraryChanges - Parse error: {}", e.what());
+            if (onError) onError(e.what());
+        }
+    }, onError);
+}
+
+void PlexApi::getLibraryKeys(
+    PlexServer* server,
+    int sectionId,
+    std::function<void(std::vector<int>)> onSuccess,
+    OnError onError
+) {
+    // Strip nested elements and long fields; servers that ignore these
+    // parameters still return a valid (just larger) listing
+    std::string url = buildUrl(server, "/library/sections/" + std::to_string(sectionId) + "/all");
+    url += "?includeFields=ratingKey";
+    url += "&excludeElements=Media,Genre,Country,Director,Writer,Role,Image,Guid,Collection,Label";
+    url += "&excludeFields=summary,tagline,thumb,art,banner,theme,titleSort";
+
+    LOGD("PlexApi::getLibraryKeys - sectionId={}", sectionId);
+
+    PlexHeaders headers = buildHeaders();
+    if (!server->getAccessToken().empty()) {
+        headers.token = server->getAccessToken();
+    }
+
+    get(url, headers, [onSuccess, onError](const nlohmann::json& json) {
+        try {
+            std::vector<int> keys;
+            if (json.contains("MediaContainer") && json["MediaContainer"].contains("Metadata")) {
+                const auto& metadata = json["MediaContainer"]["Metadata"];
+                keys.reserve(metadata.size());
+                for (const auto& meta : metadata) {
+                    if (!meta.contains("ratingKey")) continue;
+                    const auto& key = meta["ratingKey"];
+                    keys.push_back(key.is_string() ? std::stoi(key.get<std::string>()) : key.get<int>());
+                }
+            }
+            if (onSuccess) onSuccess(keys);
+        } catch (const std::exception& e) {
+            LOGE("PlexApi::getLibraryKeys - Parse error: {}", e.what());
             if (onError) onError(e.what());
         }
     }, onError);
 }
 
+void PlexApi::getLibrarySize(
+    PlexServer* server,
+    int sectionId,
+    std::function<void(int totalSize)> onSuccess,
+    OnError onError
+) {
+    std::string url = buildUrl(server, "/library/sections/" + std::to_string(sectionId) + "/all");
+    url += "?X-Plex-Container-Start=0&X-Plex-Container-Size=0";
+
+    PlexHeaders headers = buildHeaders();
+    if (!server->getAccessToken().empty()) {
+        headers.token = server->getAccessToken();
+    }
+
+    get(url, headers, [onSuccess, onError](const nlohmann::json& json) {
+        try {
+            if (!json.contains("MediaContainer") || !json["MediaContainer"].contains("totalSize")) {
+                if (onError) onError("Response has no totalSize");
+                return;
+            }
+            int totalSize = json["MediaContainer"]["totalSize"].get<int>();
+            if (onSuccess) onSuccess(totalSize);
+        } catch (const std::exception& e) {
+            LOGE("PlexApi::getLibrarySize - Parse error: {}", e.what());
+            if (onError) onError(e.what());
+        }
+    }, onError);
+}
+
+uint64_t PlexApi::getBytesReceived() {
+    return s_bytesReceived.load();
+}
+
 void PlexApi::getRecentlyAdded(
     PlexServer* server,
     int sectionId,
@@ -223,7 +372,7 @@ void PlexApi::getRecentlyAdded(
     OnError onError
 ) {
     std::string url = buildUrl(server, "/library/sections/" + std::to_string(sectionId) + "/recentlyAdded");
-    brls::Logger::info("PlexApi::getRecentlyAdded - sectionId={} URL: {}", sectionId, url);
+    LOGD("PlexApi::getRecentlyAdded - sectionId={} URL: {}", sectionId, url);
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
         headers.token = server->getAccessToken();
@@ -255,8 +404,8 @@ void PlexApi::getMetadata(
     auto now = std::chrono::system_clock::now().time_since_epoch();
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
     std::string url = buildUrl(server, "/library/metadata/" + std::to_string(ratingKey) + "?_=" + std::to_string(ms));
-    brls::Logger::info("PlexApi::getMetadata - ratingKey={}", ratingKey);
-    brls::Logger::info("PlexApi::getMetadata - URL: {}", url);
+    LOGD("PlexApi::getMetadata - ratingKey={}", ratingKey);
+    LOGD("PlexApi::getMetadata - URL: {}", url);
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
         headers.token = server->getAccessToken();
@@ -269,13 +418,13 @@ void PlexApi::getMetadata(
                 auto& metaArray = json["MediaContainer"]["Metadata"];
                 if (!metaArray.empty()) {
                     plex::from_json(metaArray[0], item);
-                    brls::Logger::info("PlexApi::getMetadata - parsed item '{}', cast={}, directors={}",
+                    LOGD("PlexApi::getMetadata - parsed item '{}', cast={}, directors={}",
                         item.title, item.cast.size(), item.directors.size());
                 }
             }
             if (onSuccess) onSuccess(item);
         } catch (const std::exception& e) {
-            brls::Logger::error("PlexApi::getMetadata - error: {}", e.what());
+            LOGE("PlexApi::getMetadata - error: {}", e.what());
             if (onError) onError(e.what());
         }
     }, onError);
@@ -288,7 +437,7 @@ void PlexApi::getChildren(
     OnError onError
 ) {
     std::string url = buildUrl(server, "/library/metadata/" + std::to_string(ratingKey) + "/children");
-    brls::Logger::info("PlexApi::getChildren - ratingKey={} URL: {}", ratingKey, url);
+    LOGD("PlexApi::getChildren - ratingKey={} URL: {}", ratingKey, url);
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
         headers.token = server->getAccessToken();
@@ -317,7 +466,7 @@ void PlexApi::getHubs(
     OnError onError
 ) {
     std::string url = buildUrl(server, "/hubs");
-    brls::Logger::info("PlexApi::getHubs - URL: {}", url);
+    LOGD("PlexApi::getHubs - URL: {}", url);
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
         headers.token = server->getAccessToken();
@@ -346,7 +495,7 @@ void PlexApi::getContinueWatching(
     OnError onError
 ) {
     std::string url = buildUrl(server, "/hubs/continueWatching");
-    brls::Logger::info("PlexApi::getContinueWatching - URL: {}", url);
+    LOGD("PlexApi::getContinueWatching - URL: {}", url);
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
         headers.token = server->getAccessToken();
@@ -374,7 +523,7 @@ void PlexApi::getOnDeck(
     OnError onError
 ) {
     std::string url = buildUrl(server, "/library/onDeck");
-    brls::Logger::info("PlexApi::getOnDeck - URL: {}", url);
+    LOGD("PlexApi::getOnDeck - URL: {}", url);
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
         headers.token = server->getAccessToken();
@@ -404,7 +553,7 @@ void PlexApi::getCollections(
     OnError onError
 ) {
     std::string url = buildUrl(server, "/library/sections/" + std::to_string(sectionId) + "/collections");
-    brls::Logger::info("PlexApi::getCollections - sectionId={} URL: {}", sectionId, url);
+    LOGD("PlexApi::getCollections - sectionId={} URL: {}", sectionId, url);
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
         headers.token = server->getAccessToken();
@@ -413,22 +562,24 @@ void PlexApi::getCollections(
     get(url, headers, [onSuccess, onError](const nlohmann::json& json) {
         try {
             std::vector<plex::Collection> collections;
-            brls::Logger::debug("PlexApi::getCollections - response keys:");
-            if (json.contains("MediaContainer")) {
-                auto& mc = json["MediaContainer"];
-                for (auto& [key, val] : mc.items()) {
-                    brls::Logger::debug("  MediaContainer.{}", key);
+            if constexpr (SAFFRON_LOG_LEVEL >= SAFFRON_LOG_LEVEL_DEBUG) {
+                LOGD("PlexApi::getCollections - response keys:");
+                if (json.contains("MediaContainer")) {
+                    auto& mc = json["MediaContainer"];
+                    for (auto& [key, val] : mc.items()) {
+                        LOGD("  MediaContainer.{}", key);
+                    }
                 }
             }
             if (json.contains("MediaContainer") && json["MediaContainer"].contains("Metadata")) {
                 for (const auto& meta : json["MediaContainer"]["Metadata"]) {
                     plex::Collection col;
                     plex::from_json(meta, col);
-                    brls::Logger::debug("PlexApi::getCollections - found: {}", col.title);
+                    LOGD("PlexApi::getCollections - found: {}", col.title);
                     collections.push_back(col);
                 }
             }
-            brls::Logger::info("PlexApi::getCollections - returning {} collections", collections.size());
+            LOGD("PlexApi::getCollections - returning {} collections", collections.size());
             if (onSuccess) onSuccess(collections);
         } catch (const std::exception& e) {
             if (onError) onError(e.what());
@@ -443,7 +594,7 @@ void PlexApi::getCollectionItems(
     OnError onError
 ) {
     std::string url = buildUrl(server, "/library/collections/" + std::to_string(collectionId) + "/children");
-    brls::Logger::info("PlexApi::getCollectionItems - collectionId={} URL: {}", collectionId, url);
+    LOGD("PlexApi::getCollectionItems - collectionId={} URL: {}", collectionId, url);
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
         headers.token = server->getAccessToken();
@@ -472,7 +623,7 @@ void PlexApi::getPlaylists(
     OnError onError
 ) {
     std::string url = buildUrl(server, "/playlists");
-    brls::Logger::info("PlexApi::getPlaylists - URL: {}", url);
+    LOGD("PlexApi::getPlaylists - URL: {}", url);
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
         headers.token = server->getAccessToken();
@@ -502,7 +653,7 @@ void PlexApi::getPlaylistItems(
     OnError onError
 ) {
     std::string url = buildUrl(server, "/playlists/" + std::to_string(playlistId) + "/items");
-    brls::Logger::info("PlexApi::getPlaylistItems - playlistId={} URL: {}", playlistId, url);
+    LOGD("PlexApi::getPlaylistItems - playlistId={} URL: {}", playlistId, url);
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
         headers.token = server->getAccessToken();
@@ -537,6 +688,9 @@ void PlexApi::getPlaybackDecision(
     OnError onError
 ) {
     std::string sessionId = SettingsManager::getInstance()->generateUuid();
+    bool remuxOnly = !forceTranscode && SettingsManager::getInstance()->isRemuxOnlyEnabled();
+    // Raw for the header, encoded where it goes into a query string
+    std::string profileExtra = ClientProfile::getExtra();
 
     std::stringstream ss;
     ss << "/video/:/transcode/universal/decision";
@@ -552,34 +706,57 @@ void PlexApi::getPlaybackDecision(
         ss << "&directStream=1";
     }
     ss << "&directStreamAudio=1";
-    ss << "&autoAdjustQuality=1";
-    ss << "&location=lan";
+    // directStream only permits a copy; remux also removes every reason the
+    // server has to re-encode (quality caps, adaptive quality) and asks for
+    // the original quality
+    if (remuxOnly) {
+        ss << "&autoAdjustQuality=0";
+        ss << "&videoQuality=100";
+    } else {
+        ss << "&autoAdjustQuality=1";
+    }
+    ss << "&location=" << (server->isRemote() ? "wan" : "lan");
     ss << "&mediaBufferSize=102400";
     ss << "&transcodeSessionId=" << sessionId;
+    // Sidecar files are rendered by mpv. A forced transcode re-encodes the
+    // video anyway, so the selected embedded track may still be burned in
+    // there, but styled text is converted rather than burned
     if (forceTranscode) {
         ss << "&subtitles=auto";
-        ss << "&advancedSubtitles=burn";
+        ss << "&advancedSubtitles=text";
         ss << "&subtitleSize=100";
     } else {
         ss << "&subtitles=none";
     }
     ss << "&audioBoost=100";
 
-    if (maxBitrate > 0) {
-        ss << "&videoBitrate=" << maxBitrate;
+    // A quality pick would force a re-encode, so remux ignores it
+    int videoBitrate = remuxOnly ? 0 : maxBitrate;
+    std::string videoResolution = remuxOnly ? "" : resolution;
+    if (videoBitrate > 0) {
+        ss << "&videoBitrate=" << videoBitrate;
+        ss << "&maxVideoBitrate=" << videoBitrate;
     }
-    if (!resolution.empty()) {
-        ss << "&videoResolution=" << resolution;
+    if (!videoResolution.empty()) {
+        ss << "&videoResolution=" << videoResolution;
+    }
+
+    // Lets the server size its own quality adjustments to the measured link
+    int sustainableKbps = BandwidthEstimator::getInstance()->getSustainableKbps(server->getBaseUrl());
+    int peakBitrate = std::max(sustainableKbps, videoBitrate);
+    if (!remuxOnly && peakBitrate > 0) {
+        ss << "&peakBitrate=" << peakBitrate;
     }
 
     std::string url = buildUrl(server, ss.str());
-    brls::Logger::info("PlexApi::getPlaybackDecision URL: {}", url);
+    LOGD("PlexApi::getPlaybackDecision URL: {}", url);
 
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
         headers.token = server->getAccessToken();
     }
     headers.sessionIdentifier = sessionId;
+    headers.clientProfileExtra = profileExtra;
 
     std::string baseUrl = server->getBaseUrl();
     std::string token = server->getAccessToken();
@@ -587,9 +764,9 @@ void PlexApi::getPlaybackDecision(
     std::string clientId = SettingsManager::getInstance()->getClientId();
 
     int64_t offsetSec = offsetMs / 1000;
-    get(url, headers, [onSuccess, onError, baseUrl, token, forceTranscode, maxBitrate, resolution, offsetSec, ratingKey, sessionId, mediaIndex](const nlohmann::json& json) {
+    get(url, headers, [onSuccess, onError, headers, baseUrl, token, forceTranscode, remuxOnly, profileExtra, videoBitrate, videoResolution, offsetSec, ratingKey, sessionId, mediaIndex](const nlohmann::json& json) {
         try {
-            brls::Logger::info("Decision response: {}", json.dump());
+            LOGV("Decision response: {}", json.dump());
             plex::PlaybackInfo info;
             if (json.contains("MediaContainer")) {
                 auto& mc = json["MediaContainer"];
@@ -616,39 +793,70 @@ void PlexApi::getPlaybackDecision(
                     !info.metadata.media[0].parts.empty() &&
                     !info.metadata.media[0].parts[0].key.empty();
 
-                if (!forceTranscode && hasDirectUrl) {
+                // Remux only trusts the server's verdict; otherwise mpv is
+                // assumed to handle whatever the file contains
+                if (!forceTranscode && hasDirectUrl && (!remuxOnly || info.directPlayable)) {
                     std::string partKey = info.metadata.media[0].parts[0].key;
                     info.playbackUrl = baseUrl + partKey + "?X-Plex-Token=" + token;
                     info.protocol = "http";
-                    brls::Logger::info("Direct play URL: {}", info.playbackUrl);
+                    LOGD("Direct play URL: {}", info.playbackUrl);
                 } else {
+                    // The decision lists what happens to each stream; a
+                    // remux must not turn into a video transcode
+                    if (remuxOnly && !info.metadata.media.empty()) {
+                        for (const auto& part : info.metadata.media[0].parts) {
+                            for (const auto& stream : part.streams) {
+                                if (stream.streamType == 1 && stream.decision == "transcode") {
+                                    LOGW("Remux only: server would re-encode {} video: {}", stream.codec, info.transcodeDecisionText);
+                                    if (onError) onError("Remux Only is on, but the server would re-encode this video");
+                                    return;
+                                }
+                            }
+                        }
+                    }
+
                     std::stringstream startUrl;
                     startUrl << "/video/:/transcode/universal/start.m3u8";
                     startUrl << "?path=" << urlEncode("/library/metadata/" + std::to_string(ratingKey));
                     startUrl << "&mediaIndex=" << mediaIndex << "&partIndex=0";
                     startUrl << "&fastSeek=1&copyts=1&offset=" << offsetSec;
-                    startUrl << "&X-Plex-Platform=Chrome";
+                    // mpv fetches the playlist without our headers, so the
+                    // session is identified from the query string
+                    startUrl << "&X-Plex-Client-Identifier=" << urlEncode(headers.clientIdentifier);
+                    startUrl << "&X-Plex-Product=" << urlEncode(headers.product);
+                    startUrl << "&X-Plex-Version=" << urlEncode(headers.version);
+                    startUrl << "&X-Plex-Platform=" << urlEncode(headers.platform);
+                    startUrl << "&X-Plex-Device=" << urlEncode(headers.device);
+                    startUrl << "&X-Plex-Client-Profile-Name=" << urlEncode(headers.clientProfileName);
                     startUrl << "&X-Plex-Token=" << token;
                     startUrl << "&session=" << sessionId;
-                    startUrl << "&directStream=0";
+                    // Direct stream keeps the original video and converts
+                    // only the streams the profile rules out
+                    startUrl << "&directStream=" << (forceTranscode ? 0 : 1);
+                    startUrl << "&directStreamAudio=1";
+                    if (remuxOnly) startUrl << "&autoAdjustQuality=0&videoQuality=100";
+                    startUrl << (forceTranscode ? "&subtitles=auto&advancedSubtitles=text" : "&subtitles=none");
                     startUrl << "&protocol=hls";
-                    if (maxBitrate > 0) {
-                        startUrl << "&maxVideoBitrate=" << maxBitrate;
+                    if (!profileExtra.empty()) {
+                        startUrl << "&X-Plex-Client-Profile-Extra=" << urlEncode(profileExtra);
+                    }
+                    if (videoBitrate > 0) {
+                        startUrl << "&maxVideoBitrate=" << videoBitrate;
                     }
-                    if (!resolution.empty()) {
+                    if (!videoResolution.empty()) {
                         std::string videoRes;
-                        if (resolution == "1080p") videoRes = "1920x1080";
-                        else if (resolution == "720p") videoRes = "1280x720";
-                        else if (resolution == "480p") videoRes = "854x480";
-                        else if (resolution == "360p") videoRes = "640x360";
-                        else if (resolution == "320p") videoRes = "480x320";
-                        else videoRes = resolution;
+                        if (videoResolution == "1080p") videoRes = "1920x1080";
+                        else if (videoResolution == "720p") videoRes = "1280x720";
+                        else if (videoResolution == "480p") videoRes = "854x480";
+                        else if (videoResolution == "360p") videoRes = "640x360";
+                        else if (videoResolution == "320p") videoRes = "480x320";
+                        else videoRes = videoResolution;
                         startUrl << "&videoResolution=" << videoRes;
                     }
                     info.playbackUrl = baseUrl + startUrl.str();
                     info.protocol = "hls";
                     info.sessionId = sessionId;
-                    brls::Logger::info("HLS transcode URL: {}", info.playbackUrl);
+                    LOGD("HLS transcode URL: {}", info.playbackUrl);
                 }
             }
             if (onSuccess) onSuccess(info);
@@ -677,7 +885,7 @@ void PlexApi::reportTimeline(
     ss << "&playbackTime=" << time;
 
     std::string url = buildUrl(server, ss.str());
-    brls::Logger::info("PlexApi::reportTimeline - ratingKey={} time={} state={} sessionId={}", ratingKey, time, state, sessionId);
+    LOGD("PlexApi::reportTimeline - ratingKey={} time={} state={} sessionId={}", ratingKey, time, state, sessionId);
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
         headers.token = server->getAccessToken();
@@ -686,55 +894,60 @@ void PlexApi::reportTimeline(
         headers.sessionIdentifier = sessionId;
     }
 
-    brls::async([url, headers, onError]() {
-        CURL* curl = curl_easy_init();
-        if (!curl) {
-            if (onError) brls::sync([onError]() { onError("Failed to init curl"); });
-            return;
-        }
-
-        std::string response;
-        struct curl_slist* headerList = nullptr;
-
-        for (const auto& h : headers.toHeaderList()) {
-            headerList = curl_slist_append(headerList, h.c_str());
-        }
+    trace::async("PlexApi::reportTimeline", [url, headers, onError]() {
+        HttpRecorder* recorder = HttpRecorder::getInstance();
+        long httpCode = 0;
+        std::string transferError;
 
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerList);
-        curl_easy_setopt(curl, CURLOPT_POST, 1L);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, 0L);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+        if (recorder->isReplaying()) {
+            HttpRecorder::Exchange exchange = recorder->replay("POST", url);
+            httpCode = exchange.status;
+            transferError = exchange.error;
+        } else {
+            CURL* curl = curl_easy_init();
+            if (!curl) {
+                if (onError) brls::sync([onError]() { onError("Failed to init curl"); });
+                return;
+            }
 
-        CURLcode res = curl_easy_perform(curl);
+            std::string response;
+            struct curl_slist* headerList = nullptr;
 
-        long httpCode = 0;
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+            for (const auto& h : headers.toHeaderList()) {
+                headerList = curl_slist_append(headerList, h.c_str());
+            }
 
-        curl_slist_free_all(headerList);
-        curl_easy_cleanup(curl);
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerList);
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, 0L);
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L);
+            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+
+            auto started = std::chrono::steady_clock::now();
+            CURLcode res = curl_easy_perform(curl);
+
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+            if (res != CURLE_OK) transferError = curl_easy_strerror(res);
+
+            curl_slist_free_all(headerList);
+            curl_easy_cleanup(curl);
+            recorder->record("POST", url, started, httpCode, response, transferError);
+        }
 
-        if (res != CURLE_OK) {
-            std::string error = curl_easy_strerror(res);
-            brls::sync([error]() {
-                brls::Logger::error("Timeline report failed: {}", error);
-            });
-            if (onError) brls::sync([onError, error]() { onError(error); });
+        if (!transferError.empty()) {
+            LOGE("Timeline report failed: {}", transferError);
+            if (onError) brls::sync([onError, transferError]() { onError(transferError); });
             return;
         }
 
         if (httpCode >= 400) {
-            brls::sync([httpCode]() {
-                brls::Logger::error("Timeline report HTTP error: {}", httpCode);
-            });
+            LOGE("Timeline report HTTP error: {}", httpCode);
         } else {
-            brls::sync([httpCode]() {
-                brls::Logger::debug("Timeline reported successfully (HTTP {})", httpCode);
-            });
+            LOGD("Timeline reported successfully (HTTP {})", httpCode);
         }
     });
 }
@@ -747,7 +960,7 @@ void PlexApi::search(
     OnError onError
 ) {
     std::string url = buildUrl(server, "/hubs/search?query=" + urlEncode(query) + "&limit=" + std::to_string(limit));
-    brls::Logger::info("PlexApi::search - query='{}' limit={}", query, limit);
+    LOGD("PlexApi::search - query='{}' limit={}", query, limit);
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
         headers.token = server->getAccessToken();
@@ -777,7 +990,7 @@ void PlexApi::getPersonMedia(
     OnError onError
 ) {
     std::string url = buildUrl(server, "/library/people/" + std::to_string(personId) + "/media");
-    brls::Logger::info("PlexApi::getPersonMedia - personId={}", personId);
+    LOGD("PlexApi::getPersonMedia - personId={}", personId);
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
         headers.token = server->getAccessToken();
@@ -814,7 +1027,7 @@ void PlexApi::getTagMedia(
     url += "X-Plex-Container-Start=" + std::to_string(start);
     url += "&X-Plex-Container-Size=" + std::to_string(count);
 
-    brls::Logger::info("PlexApi::getTagMedia - endpoint={} start={} count={}", endpoint, start, count);
+    LOGD("PlexApi::getTagMedia - endpoint={} start={} count={}", endpoint, start, count);
 
     PlexHeaders headers = buildHeaders();
     if (!server->getAccessToken().empty()) {
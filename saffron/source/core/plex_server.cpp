@@ -1,4 +1,5 @@
 #include "core/plex_server.hpp"
+#include "util/log.hpp"
 
 #include <borealis.hpp>
 #include <curl/curl.h>
@@ -28,7 +29,7 @@ void PlexServer::testConnection(
     std::function<void()> onSuccess,
     std::function<void(const std::string&)> onError
 ) {
-    brls::Logger::info("Testing connection to {}", getBaseUrl());
+    LOGI("Testing connection to {}", getBaseUrl());
 
     brls::async([this, onSuccess, onError]() {
         brls::sync([this, onSuccess]() {
@@ -0,0 +1,412 @@
+#include "core/range_stream.hpp"
+#include "core/bandwidth_estimator.hpp"
+#include "core/chunk_ring.hpp"
+#include "util/log.hpp"
+
+#include <borealis.hpp>
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+struct RangeResponse {
+    std::string* data = nullptr;
+    int64_t totalSize = -1;
+};
+
+size_t writeCallback(char* ptr, size_t size, size_t nmemb, void* userdata) {
+    auto* response = static_cast<RangeResponse*>(userdata);
+    response->data->append(ptr, size * nmemb);
+    return size * nmemb;
+}
+
+size_t headerCallback(char* buffer, size_t size, size_t nitems, void* userdata) {
+    // "Content-Range: bytes 0-1048575/3221225472"
+    auto* response = static_cast<RangeResponse*>(userdata);
+    size_t length = size * nitems;
+    const char* prefix = "content-range:";
+    if (length > strlen(prefix) && strncasecmp(buffer, prefix, strlen(prefix)) == 0) {
+        std::string header(buffer, length);
+        size_t slash = header.rfind('/');
+        if (slash != std::string::npos && header.compare(slash + 1, 1, "*") != 0) {
+            response->totalSize = std::strtoll(header.c_str() + slash + 1, nullptr, 10);
+        }
+    }
+    return length;
+}
+
+double toSeconds(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double>(d).count();
+}
+
+}
+
+void RangeStream::registerProtocol(mpv_handle* mpv) {
+    int result = mpv_stream_cb_add_ro(mpv, PROTOCOL, nullptr, openCallback);
+    if (result < 0) {
+        LOGE("RangeStream: Failed to register {}:// ({})", PROTOCOL, result);
+    }
+}
+
+std::string RangeStream::wrapUrl(const std::string& url) {
+    return std::string(PROTOCOL) + "://" + url;
+}
+
+void RangeStream::setConnectionCount(int count) {
+    s_connectionCount.store(std::max(1, count));
+}
+
+void RangeStream::setDiskCache(const std::string& dir, int64_t bytes) {
+    std::shared_ptr<ChunkRing> ring;
+    if (bytes >= CHUNK_SIZE) ring = std::make_shared<ChunkRing>(dir, bytes, CHUNK_SIZE);
+    std::lock_guard<std::mutex> lock(s_diskCacheMutex);
+    s_diskCache = std::move(ring);
+}
+
+std::shared_ptr<ChunkRing> RangeStream::getDiskCache() {
+    std::lock_guard<std::mutex> lock(s_diskCacheMutex);
+    return s_diskCache;
+}
+
+RangeStream::RangeStream(const std::string& url) : m_url(url), m_diskCache(getDiskCache()) {}
+
+RangeStream::~RangeStream() {
+    close();
+}
+
+int RangeStream::openCallback(void*, char* uri, mpv_stream_cb_info* info) {
+    std::string prefix = std::string(PROTOCOL) + "://";
+    std::string url(uri);
+    if (url.compare(0, prefix.size(), prefix) != 0) return MPV_ERROR_LOADING_FAILED;
+
+    auto* stream = new RangeStream(url.substr(prefix.size()));
+    if (!stream->open()) {
+        delete stream;
+        return MPV_ERROR_LOADING_FAILED;
+    }
+
+    info->cookie = stream;
+    info->read_fn = readCallback;
+    info->seek_fn = seekCallback;
+    info->size_fn = sizeCallback;
+    info->close_fn = closeCallback;
+    info->cancel_fn = cancelCallback;
+    return 0;
+}
+
+int64_t RangeStream::readCallback(void* cookie, char* buf, uint64_t nbytes) {
+    return static_cast<RangeStream*>(cookie)->read(buf, nbytes);
+}
+
+int64_t RangeStream::seekCallback(void* cookie, int64_t offset) {
+    return static_cast<RangeStream*>(cookie)->seek(offset);
+}
+
+int64_t RangeStream::sizeCallback(void* cookie) {
+    return static_cast<RangeStream*>(cookie)->m_size;
+}
+
+void RangeStream::closeCallback(void* cookie) {
+    delete static_cast<RangeStream*>(cookie);
+}
+
+void RangeStream::cancelCallback(void* cookie) {
+    static_cast<RangeStream*>(cookie)->cancel();
+}
+
+bool RangeStream::open() {
+    // The first chunk doubles as the probe for range support and file size
+    CURL* curl = curl_easy_init();
+    if (!curl) return false;
+
+    std::string data;
+    int64_t totalSize = -1;
+    std::string range = "0-" + std::to_string(CHUNK_SIZE - 1);
+    for (int attempt = 1;; attempt++) {
+        data.clear();
+        RangeResponse response;
+        response.data = &data;
+        curl_easy_reset(curl);
+        curl_easy_setopt(curl, CURLOPT_URL, m_url.c_str());
+        curl_easy_setopt(curl, CURLOPT_RANGE, range.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+
+        CURLcode res = curl_easy_perform(curl);
+        long httpCode = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+        if (res == CURLE_OK && httpCode == 206 && response.totalSize > 0) {
+            totalSize = response.totalSize;
+            break;
+        }
+
+        // A full 200 response means no range support; only transport errors
+        // and server errors are worth another try
+        bool transient = res != CURLE_OK || httpCode >= 500;
+        if (!transient || attempt >= MAX_ATTEMPTS) {
+            LOGE("RangeStream: Server did not accept range requests (curl {}, HTTP {})",
+                 static_cast<int>(res), httpCode);
+            curl_easy_cleanup(curl);
+            return false;
+        }
+        LOGW("RangeStream: Probe failed (curl {}, HTTP {}, attempt {} of {})",
+             static_cast<int>(res), httpCode, attempt, MAX_ATTEMPTS);
+        std::this_thread::sleep_for(std::chrono::milliseconds(RETRY_DELAY_MS << (attempt - 1)));
+    }
+    curl_easy_cleanup(curl);
+
+    m_size = totalSize;
+    Chunk& first = m_chunks[0];
+    first.state = Chunk::State::Ready;
+    first.data = std::move(data);
+    m_bytesFetched = first.data.size();
+    if (m_diskCache) m_diskCache->store(m_url, 0, first.data);
+
+    m_connections = s_connectionCount.load();
+    LOGI("RangeStream: Opened {} MB with {} connections", m_size / (1024 * 1024), m_connections);
+    for (int i = 0; i < m_connections; i++) {
+        m_workers.emplace_back(&RangeStream::workerLoop, this);
+    }
+    return true;
+}
+
+int64_t RangeStream::read(char* buf, uint64_t nbytes) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_position >= m_size) return 0;
+
+    int64_t index = m_position / CHUNK_SIZE;
+    if (m_readChunk.load() != index) {
+        m_readChunk.store(index);
+        evictOutsideWindow();
+        m_workAvailable.notify_all();
+    }
+
+    auto it = m_chunks.find(index);
+    if (it == m_chunks.end() || it->second.state != Chunk::State::Ready) {
+        auto waitStart = std::chrono::steady_clock::now();
+        m_dataReady.wait(lock, [this, index, &it]() {
+            if (m_cancelled || m_closing) return true;
+            it = m_chunks.find(index);
+            if (it == m_chunks.end()) return false;
+            return it->second.state == Chunk::State::Ready ||
+                   (it->second.state == Chunk::State::Failed && it->second.attempts >= MAX_ATTEMPTS);
+        });
+        m_stallTime += std::chrono::steady_clock::now() - waitStart;
+
+        if (m_cancelled || m_closing) return -1;
+        if (it->second.state != Chunk::State::Ready) {
+            LOGE("RangeStream: Giving up on chunk {} after {} attempts", index, MAX_ATTEMPTS);
+            return -1;
+        }
+    }
+
+    const std::string& data = it->second.data;
+    int64_t offset = m_position - index * CHUNK_SIZE;
+    int64_t available = static_cast<int64_t>(data.size()) - offset;
+    if (available <= 0) return -1;
+
+    int64_t count = std::min<int64_t>(available, static_cast<int64_t>(nbytes));
+    memcpy(buf, data.data() + offset, count);
+    m_position += count;
+    return count;
+}
+
+int64_t RangeStream::seek(int64_t offset) {
+    if (offset < 0 || offset > m_size) return MPV_ERROR_GENERIC;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_position = offset;
+    int64_t index = offset / CHUNK_SIZE;
+    if (m_readChunk.exchange(index) != index) {
+        // Workers pick the lowest missing chunk, so the new position is fetched next
+        evictOutsideWindow();
+        m_workAvailable.notify_all();
+    }
+    return offset;
+}
+
+void RangeStream::cancel() {
+    m_cancelled = true;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dataReady.notify_all();
+}
+
+void RangeStream::close() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_closing) return;
+        m_closing = true;
+        m_workAvailable.notify_all();
+        m_dataReady.notify_all();
+    }
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) worker.join();
+    }
+    m_workers.clear();
+
+    double busy = toSeconds(m_busyTime);
+    double mbits = busy > 0 ? (m_bytesFetched * 8.0 / 1e6) / busy : 0.0;
+    LOGI("RangeStream: Fetched {} MB at {:.1f} Mbit/s over {} connections, {} MB from the SD card, reader stalled {:.2f} s",
+         m_bytesFetched / (1024 * 1024), mbits, m_connections, m_bytesFromDisk / (1024 * 1024), toSeconds(m_stallTime));
+}
+
+bool RangeStream::isWanted(int64_t index) const {
+    int64_t current = m_readChunk.load();
+    return index >= current - BACK_CHUNKS && index < current + WINDOW_CHUNKS;
+}
+
+int64_t RangeStream::nextWantedChunk(std::chrono::steady_clock::time_point now,
+                                     std::chrono::steady_clock::time_point& nextRetry) const {
+    nextRetry = std::chrono::steady_clock::time_point::max();
+    int64_t current = m_readChunk.load();
+    int64_t end = std::min(current + WINDOW_CHUNKS, chunkCount());
+    for (int64_t index = current; index < end; index++) {
+        auto it = m_chunks.find(index);
+        if (it == m_chunks.end()) return index;
+        const Chunk& chunk = it->second;
+        if (chunk.state != Chunk::State::Failed || chunk.attempts >= MAX_ATTEMPTS) continue;
+        if (chunk.retryAt <= now) return index;
+        nextRetry = std::min(nextRetry, chunk.retryAt);
+    }
+    return -1;
+}
+
+void RangeStream::evictOutsideWindow() {
+    // In-flight chunks are left to their worker, which aborts and drops them
+    for (auto it = m_chunks.begin(); it != m_chunks.end();) {
+        if (it->second.state != Chunk::State::Loading && !isWanted(it->first)) {
+            it = m_chunks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void RangeStream::beginFetch() {
+    if (m_activeFetches++ == 0) {
+        m_busySince = std::chrono::steady_clock::now();
+    }
+}
+
+void RangeStream::endFetch(size_t bytes, bool fromDisk) {
+    (fromDisk ? m_bytesFromDisk : m_bytesFetched) += bytes;
+    if (--m_activeFetches == 0) {
+        m_busyTime += std::chrono::steady_clock::now() - m_busySince;
+    }
+}
+
+void RangeStream::workerLoop() {
+    // One handle per worker keeps its connection alive across chunks
+    CURL* curl = curl_easy_init();
+    if (!curl) return;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_closing) {
+        std::chrono::steady_clock::time_point nextRetry;
+        int64_t index = nextWantedChunk(std::chrono::steady_clock::now(), nextRetry);
+        if (index < 0) {
+            if (nextRetry == std::chrono::steady_clock::time_point::max()) {
+                m_workAvailable.wait(lock);
+            } else {
+                m_workAvailable.wait_until(lock, nextRetry);
+            }
+            continue;
+        }
+
+        Chunk& chunk = m_chunks[index];
+        chunk.state = Chunk::State::Loading;
+        chunk.attempts++;
+        beginFetch();
+        lock.unlock();
+
+        std::string data;
+        bool fromDisk = loadChunk(index, data);
+        bool ok = fromDisk || fetchChunk(curl, index, data);
+        if (ok && !fromDisk && m_diskCache) m_diskCache->store(m_url, index, data);
+
+        lock.lock();
+        endFetch(data.size(), fromDisk);
+        auto it = m_chunks.find(index);
+        if (it == m_chunks.end()) continue;
+
+        if (m_closing || !isWanted(index)) {
+            m_chunks.erase(it);
+        } else if (ok) {
+            it->second.state = Chunk::State::Ready;
+            it->second.data = std::move(data);
+        } else {
+            // Back off so a server that refuses connections is not hammered
+            // by every worker at once
+            int attempts = it->second.attempts;
+            it->second.state = Chunk::State::Failed;
+            it->second.retryAt = std::chrono::steady_clock::now() +
+                                 std::chrono::milliseconds(RETRY_DELAY_MS << (attempts - 1));
+            LOGW("RangeStream: Chunk {} failed (attempt {} of {})", index, attempts, MAX_ATTEMPTS);
+        }
+        m_dataReady.notify_all();
+    }
+    lock.unlock();
+
+    curl_easy_cleanup(curl);
+}
+
+bool RangeStream::loadChunk(int64_t index, std::string& data) {
+    if (!m_diskCache || !m_diskCache->load(m_url, index, data)) return false;
+    // A ring entry from an older copy of the file is fetched again
+    if (static_cast<int64_t>(data.size()) == chunkLength(index)) return true;
+    data.clear();
+    return false;
+}
+
+bool RangeStream::fetchChunk(CURL* curl, int64_t index, std::string& data) {
+    int64_t start = index * CHUNK_SIZE;
+    int64_t end = std::min(start + CHUNK_SIZE, m_size) - 1;
+    char range[64];
+    snprintf(range, sizeof(range), "%" PRId64 "-%" PRId64, start, end);
+
+    data.reserve(static_cast<size_t>(end - start + 1));
+    RangeResponse response;
+    response.data = &data;
+
+    struct Progress {
+        RangeStream* stream;
+        int64_t index;
+    } progress{this, index};
+
+    // Abort once the chunk falls out of the window (seek) or the stream closes
+    auto onProgress = [](void* clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t) -> int {
+        auto* p = static_cast<Progress*>(clientp);
+        return (p->stream->m_closing || !p->stream->isWanted(p->index)) ? 1 : 0;
+    };
+
+    curl_easy_reset(curl);
+    curl_easy_setopt(curl, CURLOPT_URL, m_url.c_str());
+    curl_easy_setopt(curl, CURLOPT_RANGE, range);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, static_cast<curl_xferinfo_callback>(onProgress));
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &progress);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1024L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 10L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+
+    CURLcode res = curl_easy_perform(curl);
+    long httpCode = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+
+    bool complete = res == CURLE_OK && httpCode == 206 && static_cast<int64_t>(data.size()) == end - start + 1;
+    if (complete) BandwidthEstimator::getInstance()->record(curl);
+    return complete;
+}
@@ -0,0 +1,481 @@
+#include "core/search_index.hpp"
+#include "util/binary_io.hpp"
+#include "util/log.hpp"
+
+#include <borealis.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+constexpr uint32_t DEAD_DOC = UINT32_MAX;
+
+bool startsWith(const std::string& s, const std::string& prefix) {
+    return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+// Postings carry a flag in the low bit for terms that came from the title
+constexpr uint32_t TITLE_BIT = 1;
+
+uint32_t posting(uint32_t docId, bool fromTitle) {
+    return (docId << 1) | (fromTitle ? TITLE_BIT : 0);
+}
+
+// FNV-1a over the fields add() reads; strings are length-prefixed so
+// adjacent fields cannot run into each other
+class ContentHash {
+public:
+    void add(const std::string& s) {
+        add(static_cast<uint64_t>(s.size()));
+        for (char c : s) mix(static_cast<uint8_t>(c));
+    }
+
+    void add(uint64_t value) {
+        for (int i = 0; i < 8; i++) mix(static_cast<uint8_t>(value >> (i * 8)));
+    }
+
+    uint64_t value() const { return m_hash; }
+
+private:
+    void mix(uint8_t byte) {
+        m_hash ^= byte;
+        m_hash *= 1099511628211ull;
+    }
+
+    uint64_t m_hash = 14695981039346656037ull;
+};
+
+uint64_t contentHash(const plex::MediaItem& item) {
+    ContentHash hash;
+    hash.add(static_cast<uint64_t>(item.librarySectionId));
+    hash.add(static_cast<uint64_t>(item.mediaType));
+    hash.add(static_cast<uint64_t>(item.year));
+    hash.add(item.title);
+    hash.add(item.titleSort);
+    hash.add(item.originalTitle);
+    hash.add(item.thumb);
+    for (const auto& tag : item.genres) hash.add(tag.tag);
+    hash.add(uint64_t{0});
+    for (const auto& tag : item.cast) hash.add(tag.tag);
+    return hash.value();
+}
+
+}
+
+SearchIndex* SearchIndex::getInstance() {
+    static SearchIndex index;
+    return &index;
+}
+
+void SearchIndex::setServer(const std::string& machineId) {
+    if (machineId == m_machineId) return;
+
+    if (!m_machineId.empty()) {
+        save();
+    }
+    clear();
+    m_machineId = machineId;
+
+    if (!m_machineId.empty()) {
+        load();
+    }
+}
+
+void SearchIndex::clear() {
+    m_docs.clear();
+    m_docByKey.clear();
+    m_termIds.clear();
+    m_terms.clear();
+    m_postings.clear();
+    m_trigrams.clear();
+    m_sortedTerms.clear();
+    m_termsSorted = true;
+    m_marks.clear();
+    m_titleMarks.clear();
+    m_dirty = false;
+}
+
+bool SearchIndex::isWordChar(unsigned char c) {
+    // UTF-8 sequences are kept whole so non-Latin titles match byte for byte
+    return std::isalnum(c) || c >= 0x80;
+}
+
+void SearchIndex::tokenize(const std::string& text, std::vector<std::string>& out) {
+    std::string word;
+    for (unsigned char c : text) {
+        if (c == '\'') continue;  // "Schindler's" -> "schindlers"
+        if (isWordChar(c)) {
+            word += static_cast<char>(std::tolower(c));
+        } else if (!word.empty()) {
+            out.push_back(std::move(word));
+            word.clear();
+        }
+    }
+    if (!word.empty()) out.push_back(std::move(word));
+}
+
+bool SearchIndex::titleStartsWith(const std::string& title, const std::string& phrase) {
+    // Same folding as tokenize(), compared in place to keep ranking allocation-free
+    size_t pos = 0;
+    bool pendingSpace = false;
+    for (unsigned char c : title) {
+        if (pos == phrase.size()) return true;
+        if (c == '\'') continue;
+        if (!isWordChar(c)) {
+            pendingSpace = pos > 0;
+            continue;
+        }
+        if (pendingSpace) {
+            if (phrase[pos++] != ' ') return false;
+            if (pos == phrase.size()) return true;
+            pendingSpace = false;
+        }
+        if (phrase[pos++] != static_cast<char>(std::tolower(c))) return false;
+    }
+    return pos == phrase.size();
+}
+
+uint32_t SearchIndex::trigram(const char* p) {
+    return static_cast<uint8_t>(p[0]) | (static_cast<uint8_t>(p[1]) << 8) | (static_cast<uint8_t>(p[2]) << 16);
+}
+
+uint32_t SearchIndex::internTerm(const std::string& term) {
+    auto it = m_termIds.find(term);
+    if (it != m_termIds.end()) return it->second;
+
+    uint32_t id = static_cast<uint32_t>(m_terms.size());
+    m_terms.push_back(term);
+    m_termIds.emplace(m_terms.back(), id);
+    m_postings.emplace_back();
+    m_sortedTerms.push_back(id);
+    m_termsSorted = false;
+
+    // Trigrams are per distinct term, not per document, which keeps them
+    // small; substring matches are confirmed against the term text
+    for (size_t i = 0; i + 3 <= term.size(); i++) {
+        std::vector<uint32_t>& terms = m_trigrams[trigram(term.data() + i)];
+        if (terms.empty() || terms.back() != id) terms.push_back(id);
+    }
+    return id;
+}
+
+void SearchIndex::addTerms(uint32_t docId, const std::vector<std::string>& titleTerms,
+                           std::vector<std::string>& otherTerms) {
+    std::vector<std::pair<std::string, bool>> terms;
+    terms.reserve(titleTerms.size() + otherTerms.size());
+    for (const auto& term : titleTerms) terms.emplace_back(term, true);
+    for (auto& term : otherTerms) terms.emplace_back(std::move(term), false);
+
+    // Title entries sort first, so unique() keeps the title flag
+    std::sort(terms.begin(), terms.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first < b.first : a.second > b.second;
+    });
+    terms.erase(std::unique(terms.begin(), terms.end(),
+        [](const auto& a, const auto& b) { return a.first == b.first; }), terms.end());
+    for (const auto& [term, fromTitle] : terms) {
+        m_postings[internTerm(term)].push_back(posting(docId, fromTitle));
+    }
+}
+
+void SearchIndex::add(const plex::MediaItem& item) {
+    if (item.ratingKey == 0) return;
+
+    uint64_t hash = contentHash(item);
+    auto existing = m_docByKey.find(item.ratingKey);
+    if (existing != m_docByKey.end() && m_docs[existing->second].contentHash == hash) return;
+    remove(item.ratingKey);
+
+    Doc doc;
+    doc.ratingKey = item.ratingKey;
+    doc.librarySectionId = item.librarySectionId;
+    doc.mediaType = item.mediaType;
+    doc.year = static_cast<uint16_t>(item.year);
+    doc.title = item.title;
+    doc.thumb = item.thumb;
+    doc.contentHash = hash;
+
+    std::vector<std::string> titleTerms, otherTerms;
+    tokenize(item.title, titleTerms);
+    tokenize(item.titleSort, otherTerms);
+    tokenize(item.originalTitle, otherTerms);
+    if (item.year > 0) otherTerms.push_back(std::to_string(item.year));
+    for (const auto& tag : item.genres) tokenize(tag.tag, otherTerms);
+    for (const auto& tag : item.cast) tokenize(tag.tag, otherTerms);
+
+    uint32_t docId = static_cast<uint32_t>(m_docs.size());
+    m_docs.push_back(std::move(doc));
+    m_docByKey[item.ratingKey] = docId;
+    addTerms(docId, titleTerms, otherTerms);
+    m_dirty = true;
+}
+
+void SearchIndex::addAll(const std::vector<plex::MediaItem>& items) {
+    for (const auto& item : items) {
+        add(item);
+    }
+}
+
+void SearchIndex::remove(int ratingKey) {
+    auto it = m_docByKey.find(ratingKey);
+    if (it == m_docByKey.end()) return;
+
+    // Postings still reference the slot; queries skip it and save() drops it
+    Doc& doc = m_docs[it->second];
+    doc.ratingKey = 0;
+    std::string().swap(doc.title);
+    std::string().swap(doc.thumb);
+    m_docByKey.erase(it);
+    m_dirty = true;
+}
+
+void SearchIndex::retainSection(int sectionId, const std::unordered_set<int>& keys) {
+    std::vector<int> gone;
+    for (const auto& [key, docId] : m_docByKey) {
+        if (m_docs[docId].librarySectionId == sectionId && keys.count(key) == 0) {
+            gone.push_back(key);
+        }
+    }
+    for (int key : gone) {
+        remove(key);
+    }
+    if (!gone.empty()) {
+        LOGD("SearchIndex: Dropped {} items no longer in section {}", gone.size(), sectionId);
+    }
+}
+
+void SearchIndex::sortTerms() {
+    if (m_termsSorted) return;
+    std::sort(m_sortedTerms.begin(), m_sortedTerms.end(),
+        [this](uint32_t a, uint32_t b) { return m_terms[a] < m_terms[b]; });
+    m_termsSorted = true;
+}
+
+void SearchIndex::matchWord(const std::string& word, uint8_t pass) {
+    auto mark = [this, pass](uint32_t termId) {
+        for (uint32_t entry : m_postings[termId]) {
+            uint32_t docId = entry >> 1;
+            if (m_marks[docId] == pass) m_marks[docId] = pass + 1;
+            if ((entry & TITLE_BIT) && m_titleMarks[docId] == pass) m_titleMarks[docId] = pass + 1;
+        }
+    };
+
+    // Prefix matches: a contiguous run of the sorted term list
+    auto it = std::lower_bound(m_sortedTerms.begin(), m_sortedTerms.end(), word,
+        [this](uint32_t id, const std::string& w) { return m_terms[id] < w; });
+    for (; it != m_sortedTerms.end() && startsWith(m_terms[*it], word); ++it) {
+        mark(*it);
+    }
+
+    if (word.size() < 3) return;
+
+    // Substring matches: walk the rarest trigram's terms and confirm each
+    const std::vector<uint32_t>* rarest = nullptr;
+    for (size_t i = 0; i + 3 <= word.size(); i++) {
+        auto tri = m_trigrams.find(trigram(word.data() + i));
+        if (tri == m_trigrams.end()) return;
+        if (!rarest || tri->second.size() < rarest->size()) rarest = &tri->second;
+    }
+    for (uint32_t termId : *rarest) {
+        const std::string& term = m_terms[termId];
+        if (term.size() > word.size() && term.find(word, 1) != std::string::npos) {
+            mark(termId);
+        }
+    }
+}
+
+std::vector<plex::MediaItem> SearchIndex::search(const std::string& query, size_t limit) {
+    std::vector<plex::MediaItem> results;
+    if (m_docByKey.empty() || limit == 0) return results;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::string> words;
+    tokenize(query, words);
+    if (words.empty()) return results;
+    if (words.size() > UINT8_MAX) words.resize(UINT8_MAX);
+
+    sortTerms();
+    m_marks.assign(m_docs.size(), 0);
+    m_titleMarks.assign(m_docs.size(), 0);
+    for (size_t i = 0; i < words.size(); i++) {
+        matchWord(words[i], static_cast<uint8_t>(i));
+    }
+
+    // Rank: whole query starts the title, then every word matched a title
+    // word, then matches that needed other fields (cast, genre, ...)
+    std::string phrase;
+    for (const auto& word : words) {
+        if (!phrase.empty()) phrase += ' ';
+        phrase += word;
+    }
+
+    struct Match {
+        int rank;
+        uint32_t docId;
+    };
+    std::vector<Match> matches;
+    const uint8_t full = static_cast<uint8_t>(words.size());
+    for (uint32_t docId = 0; docId < m_docs.size(); docId++) {
+        if (m_marks[docId] != full || m_docs[docId].ratingKey == 0) continue;
+
+        int rank = 2;
+        if (m_titleMarks[docId] == full) {
+            rank = titleStartsWith(m_docs[docId].title, phrase) ? 0 : 1;
+        }
+        matches.push_back({rank, docId});
+    }
+
+    size_t count = std::min(limit, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + count, matches.end(),
+        [this](const Match& a, const Match& b) {
+            if (a.rank != b.rank) return a.rank < b.rank;
+            return m_docs[a.docId].title < m_docs[b.docId].title;
+        });
+
+    results.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        const Doc& doc = m_docs[matches[i].docId];
+        plex::MediaItem item;
+        item.ratingKey = doc.ratingKey;
+        item.key = "/library/metadata/" + std::to_string(doc.ratingKey);
+        item.librarySectionId = doc.librarySectionId;
+        item.mediaType = doc.mediaType;
+        item.year = doc.year;
+        item.title = doc.title;
+        item.thumb = doc.thumb;
+        results.push_back(std::move(item));
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    LOGD("SearchIndex: '{}' matched {} of {} items in {} us",
+         query, matches.size(), m_docByKey.size(), elapsed);
+    return results;
+}
+
+std::string SearchIndex::getFilePath() const {
+    return std::string(CACHE_DIR) + "/search_" + m_machineId + ".bin";
+}
+
+void SearchIndex::save() {
+    if (m_machineId.empty() || !m_dirty) return;
+    m_dirty = false;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Written compacted: removed documents are dropped and live ones renumbered
+    std::vector<uint32_t> remap(m_docs.size(), DEAD_DOC);
+    uint32_t liveCount = 0;
+    for (uint32_t docId = 0; docId < m_docs.size(); docId++) {
+        if (m_docs[docId].ratingKey != 0) remap[docId] = liveCount++;
+    }
+
+    BinaryWriter file;
+    file.put<uint32_t>(FILE_MAGIC);
+    file.put<uint16_t>(FILE_VERSION);
+    file.put<uint32_t>(liveCount);
+    for (const Doc& doc : m_docs) {
+        if (doc.ratingKey == 0) continue;
+        file.put<int32_t>(doc.ratingKey);
+        file.put<int32_t>(doc.librarySectionId);
+        file.put<uint16_t>(static_cast<uint16_t>(doc.mediaType));
+        file.put<uint16_t>(doc.year);
+        file.putString(doc.title);
+        file.putString(doc.thumb);
+        file.put<uint64_t>(doc.contentHash);
+    }
+
+    BinaryWriter terms;
+    uint32_t termCount = 0;
+    std::vector<uint32_t> live;
+    for (uint32_t termId = 0; termId < m_terms.size(); termId++) {
+        live.clear();
+        for (uint32_t entry : m_postings[termId]) {
+            uint32_t docId = remap[entry >> 1];
+            if (docId != DEAD_DOC) live.push_back(posting(docId, entry & TITLE_BIT));
+        }
+        if (live.empty()) continue;
+
+        terms.putString(m_terms[termId]);
+        terms.put<uint32_t>(static_cast<uint32_t>(live.size()));
+        for (uint32_t entry : live) {
+            terms.put<uint32_t>(entry);
+        }
+        termCount++;
+    }
+    file.put<uint32_t>(termCount);
+    file.buffer() += terms.buffer();
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    LOGD("SearchIndex: Serialized {} items, {} terms ({} bytes) in {} us",
+         liveCount, termCount, file.buffer().size(), elapsed);
+
+    m_writer.write(getFilePath(), std::move(file.buffer()));
+}
+
+void SearchIndex::flush() {
+    save();
+    m_writer.flush();
+}
+
+void SearchIndex::load() {
+    auto start = std::chrono::steady_clock::now();
+
+    std::ifstream in(getFilePath(), std::ios::in | std::ios::binary);
+    if (!in.is_open()) return;
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    BinaryReader r(data);
+    uint32_t magic = 0;
+    uint16_t version = 0;
+    if (!r.get(magic) || !r.get(version) || magic != FILE_MAGIC || version != FILE_VERSION) {
+        LOGW("SearchIndex: Ignoring index file with unknown format");
+        return;
+    }
+
+    // Counts are checked against the bytes left before anything is sized
+    // from them, so a corrupt file is ignored instead of exhausting memory
+    uint32_t docCount = 0;
+    if (!r.get(docCount) || docCount > r.remaining() / MIN_DOC_BYTES) return;
+    std::vector<Doc> docs(docCount);
+    for (Doc& doc : docs) {
+        int32_t ratingKey = 0, sectionId = 0;
+        uint16_t mediaType = 0;
+        if (!r.get(ratingKey) || !r.get(sectionId) || !r.get(mediaType) || !r.get(doc.year) ||
+            !r.getString(doc.title) || !r.getString(doc.thumb) || !r.get(doc.contentHash)) return;
+        doc.ratingKey = ratingKey;
+        doc.librarySectionId = sectionId;
+        doc.mediaType = static_cast<plex::MediaType>(mediaType);
+    }
+
+    uint32_t termCount = 0;
+    if (!r.get(termCount) || termCount > r.remaining() / MIN_TERM_BYTES) return;
+    std::vector<std::pair<std::string, std::vector<uint32_t>>> terms(termCount);
+    for (auto& [term, postings] : terms) {
+        uint32_t count = 0;
+        if (!r.getString(term) || !r.get(count) || count > r.remaining() / sizeof(uint32_t)) return;
+        postings.resize(count);
+        for (uint32_t& entry : postings) {
+            if (!r.get(entry) || (entry >> 1) >= docCount) return;
+        }
+    }
+
+    // Only adopt the file once it parsed completely
+    m_docs = std::move(docs);
+    for (uint32_t docId = 0; docId < m_docs.size(); docId++) {
+        m_docByKey[m_docs[docId].ratingKey] = docId;
+    }
+    for (auto& [term, postings] : terms) {
+        m_postings[internTerm(term)] = std::move(postings);
+    }
+    m_dirty = false;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    LOGI("SearchIndex: Loaded {} items, {} terms from disk in {} ms",
+         m_docs.size(), m_terms.size(), elapsed);
+}
@@ -1,6 +1,7 @@
 #include "core/server_discovery.hpp"
 #include "core/plex_server.hpp"
 #include "core/settings_manager.hpp"
+#include "util/trace.hpp"
 
 #include <borealis.hpp>
 #include <curl/curl.h>
@@ -44,10 +45,10 @@ void ServerDiscovery::discoverLocalServersAsync(DiscoveryCompleteCallback onComp
 
     m_gdmRunning = true;
 
-    brls::async([this, onComplete]() {
+    trace::async("ServerDiscovery::local", [this, onComplete]() {
         doLocalDiscovery();
 
-        brls::sync([this, onComplete]() {
+        trace::sync("ServerDiscovery::local done", [this, onComplete]() {
             m_gdmRunning = false;
             if (onComplete) {
                 onComplete();
@@ -291,12 +292,12 @@ void ServerDiscovery::discoverRemoteServersAsync(
     RemoteSuccessCallback onSuccess,
     ErrorCallback onError
 ) {
-    brls::async([this, plexToken, onSuccess, onError]() {
+    trace::async("ServerDiscovery::remote", [this, plexToken, onSuccess, onError]() {
         std::vector<PlexServer*> servers;
         std::string error;
         bool success = doRemoteDiscovery(plexToken, servers, error);
 
-        brls::sync([success, servers, error, onSuccess, onError]() {
+        trace::sync("ServerDiscovery::remote done", [success, servers, error, onSuccess, onError]() {
             if (success) {
                 if (onSuccess) onSuccess(servers);
             } else {
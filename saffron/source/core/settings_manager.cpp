@@ -2,6 +2,7 @@
 #include "core/auth_manager.hpp"
 #include "core/plex_server.hpp"
 #include "core/server_discovery.hpp"
+#include "util/log.hpp"
 
 #include <borealis.hpp>
 #include <toml++/toml.hpp>
@@ -162,20 +163,36 @@ void SettingsManager::parseTomlFile() {
 
         if (auto val = config["auto_play_next"].value<bool>())
             m_autoPlayNext = *val;
+        if (auto val = config["preload_next_seconds"].value<int64_t>())
+            m_preloadNextSeconds = static_cast<int>(*val);
+        if (auto val = config["auto_quality"].value<bool>())
+            m_autoQuality = *val;
+        if (auto val = config["remux_only"].value<bool>())
+            m_remuxOnly = *val;
         if (auto val = config["overclock"].value<bool>())
             m_overclockEnabled = *val;
         if (auto val = config["seek_increment"].value<int64_t>())
             m_seekIncrement = static_cast<int>(*val);
         if (auto val = config["in_memory_cache"].value<int64_t>())
             m_inMemoryCache = static_cast<int>(*val);
+        if (auto val = config["disk_cache"].value<int64_t>())
+            m_diskCache = static_cast<int>(*val);
         if (auto val = config["power_user_menu_unlocked"].value<bool>())
             m_powerUserMenuUnlocked = *val;
         if (auto val = config["video_sync_mode"].value<std::string>())
             m_videoSyncMode = *val;
         if (auto val = config["framebuffer_count"].value<int64_t>())
             m_framebufferCount = static_cast<int>(*val);
+        if (auto val = config["pipelined_render"].value<bool>())
+            m_pipelinedRender = *val;
         if (auto val = config["buffer_before_play"].value<bool>())
             m_bufferBeforePlay = *val;
+        if (auto val = config["direct_play_connections"].value<int64_t>())
+            m_directPlayConnections = static_cast<int>(*val);
+        if (auto val = config["telemetry_export"].value<bool>())
+            m_telemetryExport = *val;
+        if (auto val = config["network_recording"].value<bool>())
+            m_networkRecording = *val;
         if (auto val = config["current_server_id"].value<std::string>())
             m_currentServerId = *val;
 
@@ -223,14 +240,22 @@ int SettingsManager::writeFile() {
         config.insert("token_expires_at", m_tokenExpiresAt);
 
     config.insert("auto_play_next", m_autoPlayNext);
+    config.insert("preload_next_seconds", m_preloadNextSeconds);
+    config.insert("auto_quality", m_autoQuality);
+    config.insert("remux_only", m_remuxOnly);
     config.insert("overclock", m_overclockEnabled);
     config.insert("seek_increment", m_seekIncrement);
     config.insert("in_memory_cache", m_inMemoryCache);
+    config.insert("disk_cache", m_diskCache);
     if (m_powerUserMenuUnlocked)
         config.insert("power_user_menu_unlocked", m_powerUserMenuUnlocked);
     config.insert("video_sync_mode", m_videoSyncMode);
     config.insert("framebuffer_count", m_framebufferCount);
+    config.insert("pipelined_render", m_pipelinedRender);
     config.insert("buffer_before_play", m_bufferBeforePlay);
+    config.insert("direct_play_connections", m_directPlayConnections);
+    config.insert("telemetry_export", m_telemetryExport);
+    config.insert("network_recording", m_networkRecording);
     if (!m_currentServerId.empty())
         config.insert("current_server_id", m_currentServerId);
 
@@ -297,7 +322,7 @@ void SettingsManager::clearTokenData() {
     m_plexToken.clear();
     m_username.clear();
     m_tokenExpiresAt = 0;
-    brls::Logger::info("Plex token data cleared");
+    LOGI("Plex token data cleared");
 }
 
 bool SettingsManager::isAutoPlayNextEnabled() const {
@@ -308,6 +333,30 @@ void SettingsManager::setAutoPlayNext(bool enabled) {
     m_autoPlayNext = enabled;
 }
 
+int SettingsManager::getPreloadNextSeconds() const {
+    return m_preloadNextSeconds;
+}
+
+void SettingsManager::setPreloadNextSeconds(int seconds) {
+    m_preloadNextSeconds = seconds;
+}
+
+bool SettingsManager::isAutoQualityEnabled() const {
+    return m_autoQuality;
+}
+
+void SettingsManager::setAutoQuality(bool enabled) {
+    m_autoQuality = enabled;
+}
+
+bool SettingsManager::isRemuxOnlyEnabled() const {
+    return m_remuxOnly;
+}
+
+void SettingsManager::setRemuxOnly(bool enabled) {
+    m_remuxOnly = enabled;
+}
+
 bool SettingsManager::isOverclockEnabled() const {
     return m_overclockEnabled;
 }
@@ -332,6 +381,14 @@ void SettingsManager::setInMemoryCache(int mb) {
     m_inMemoryCache = mb;
 }
 
+int SettingsManager::getDiskCache() const {
+    return m_diskCache;
+}
+
+void SettingsManager::setDiskCache(int mb) {
+    m_diskCache = mb;
+}
+
 bool SettingsManager::isPowerUserMenuUnlocked() const {
     return m_powerUserMenuUnlocked;
 }
@@ -358,6 +415,14 @@ void SettingsManager::setFramebufferCount(int count) {
     }
 }
 
+bool SettingsManager::isPipelinedRenderEnabled() const {
+    return m_pipelinedRender;
+}
+
+void SettingsManager::setPipelinedRender(bool enabled) {
+    m_pipelinedRender = enabled;
+}
+
 bool SettingsManager::isBufferBeforePlayEnabled() const {
     return m_bufferBeforePlay;
 }
@@ -366,6 +431,32 @@ void SettingsManager::setBufferBeforePlay(bool enabled) {
     m_bufferBeforePlay = enabled;
 }
 
+int SettingsManager::getDirectPlayConnections() const {
+    return m_directPlayConnections;
+}
+
+void SettingsManager::setDirectPlayConnections(int count) {
+    if (count >= 1 && count <= 8) {
+        m_directPlayConnections = count;
+    }
+}
+
+bool SettingsManager::isTelemetryExportEnabled() const {
+    return m_telemetryExport;
+}
+
+void SettingsManager::setTelemetryExport(bool enabled) {
+    m_telemetryExport = enabled;
+}
+
+bool SettingsManager::isNetworkRecordingEnabled() const {
+    return m_networkRecording;
+}
+
+void SettingsManager::setNetworkRecording(bool enabled) {
+    m_networkRecording = enabled;
+}
+
 int SettingsManager::loadEarlyFramebufferCount() {
     if (!fileExists(TOML_CONFIG_FILE)) {
         return 3;
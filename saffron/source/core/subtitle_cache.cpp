@@ -0,0 +1,182 @@
+#include "core/subtitle_cache.hpp"
+#include "core/bandwidth_estimator.hpp"
+#include "core/plex_server.hpp"
+#include "util/log.hpp"
+
+#include <borealis.hpp>
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+
+static size_t writeFileCallback(char* ptr, size_t size, size_t nmemb, void* userdata) {
+    return fwrite(ptr, size, nmemb, static_cast<FILE*>(userdata)) * size;
+}
+
+static bool fileExists(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && st.st_size > 0;
+}
+
+SubtitleCache* SubtitleCache::getInstance() {
+    static SubtitleCache instance;
+    return &instance;
+}
+
+bool SubtitleCache::isSidecar(const plex::Stream& stream) {
+    // VobSub is an idx/sub pair, but the stream's key only serves the idx
+    // and Plex has no endpoint for the sub half, so the server keeps those
+    if (stream.streamType != 3 || stream.key.empty()) return false;
+    return extensionFor(stream.codec) != "idx";
+}
+
+void SubtitleCache::prefetch(PlexServer* server, const plex::Part& part) {
+    for (const auto& stream : part.streams) {
+        if (isSidecar(stream)) fetch(server, stream, nullptr);
+    }
+}
+
+void SubtitleCache::fetch(PlexServer* server, const plex::Stream& stream, OnReady onReady) {
+    if (!server || !isSidecar(stream)) return;
+
+    // Claimed before the check, so a trim running now cannot remove the
+    // file between the check and mpv opening it
+    std::string path = getPath(server, stream);
+    markInUse(path);
+    if (fileExists(path)) {
+        if (onReady) onReady(path);
+        return;
+    }
+
+    auto it = m_pending.find(path);
+    if (it != m_pending.end()) {
+        if (onReady) it->second.push_back(onReady);
+        return;
+    }
+    auto& waiting = m_pending[path];
+    if (onReady) waiting.push_back(onReady);
+
+    // Listing the directory is slow on the card; the first download of the
+    // session trims it on the worker instead
+    bool trimFirst = !m_trimmed;
+    m_trimmed = true;
+
+    std::string url = server->getBaseUrl() + stream.key + "?X-Plex-Token=" + server->getAccessToken();
+
+    brls::async([this, url, path, trimFirst]() {
+        if (trimFirst) trim();
+        bool ok = download(url, path);
+
+        brls::sync([this, path, ok]() {
+            auto it = m_pending.find(path);
+            if (it == m_pending.end()) return;
+            std::vector<OnReady> callbacks = std::move(it->second);
+            m_pending.erase(it);
+
+            if (!ok) {
+                LOGW("SubtitleCache: Failed to download {}", path);
+                return;
+            }
+            LOGD("SubtitleCache: Cached {}", path);
+            for (auto& callback : callbacks) callback(path);
+        });
+    });
+}
+
+std::string SubtitleCache::getPath(PlexServer* server, const plex::Stream& stream) const {
+    return std::string(CACHE_DIR) + "/" + server->getMachineId() + "_" + std::to_string(stream.id) + "." +
+           extensionFor(stream.codec);
+}
+
+void SubtitleCache::markInUse(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_inUseMutex);
+    m_inUse.insert(path);
+}
+
+void SubtitleCache::trim() {
+    struct Entry {
+        std::string path;
+        int64_t size;
+        time_t mtime;
+    };
+    std::vector<Entry> entries;
+    int64_t total = 0;
+
+    DIR* dir = opendir(CACHE_DIR);
+    if (!dir) return;
+    while (struct dirent* entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        std::string path = std::string(CACHE_DIR) + "/" + entry->d_name;
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) continue;
+        total += st.st_size;
+        // Downloads may be running alongside; never remove one mid-write
+        if (path.size() > 5 && path.compare(path.size() - 5, 5, ".part") == 0) continue;
+        entries.push_back({path, static_cast<int64_t>(st.st_size), st.st_mtime});
+    }
+    closedir(dir);
+
+    if (total <= MAX_CACHE_BYTES) return;
+    std::sort(entries.begin(), entries.end(),
+        [](const Entry& a, const Entry& b) { return a.mtime < b.mtime; });
+    std::lock_guard<std::mutex> lock(m_inUseMutex);
+    for (const auto& entry : entries) {
+        if (total <= MAX_CACHE_BYTES / 2) break;
+        if (m_inUse.count(entry.path)) continue;
+        if (remove(entry.path.c_str()) == 0) total -= entry.size;
+    }
+    LOGI("SubtitleCache: Trimmed to {} KB", total / 1024);
+}
+
+std::string SubtitleCache::extensionFor(const std::string& codec) {
+    if (codec == "subrip") return "srt";
+    if (codec == "webvtt") return "vtt";
+    if (codec == "pgs" || codec == "hdmv_pgs_subtitle") return "sup";
+    if (codec == "vobsub" || codec == "dvd_subtitle") return "idx";
+    if (codec.empty()) return "srt";
+    return codec;
+}
+
+bool SubtitleCache::download(const std::string& url, const std::string& path) {
+    // Several downloads start at once on a fresh card, so each one makes
+    // sure the directory exists
+    mkdir("sdmc:/switch/saffron/cache", 0755);
+    mkdir(CACHE_DIR, 0755);
+
+    std::string tempPath = path + ".part";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) return false;
+
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        fclose(file);
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeFileCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, file);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+
+    CURLcode res = curl_easy_perform(curl);
+    long httpCode = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+    if (res == CURLE_OK) BandwidthEstimator::getInstance()->record(curl);
+    curl_easy_cleanup(curl);
+    fclose(file);
+
+    if (res != CURLE_OK || httpCode != 200 || !fileExists(tempPath)) {
+        remove(tempPath.c_str());
+        return false;
+    }
+    remove(path.c_str());
+    return rename(tempPath.c_str(), path.c_str()) == 0;
+}
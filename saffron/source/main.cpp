@@ -22,11 +22,18 @@ static void early_ssl_cleanup() {
 #include <fstream>
 
 #include "core/settings_manager.hpp"
+#include "core/http_recorder.hpp"
 #include "core/plex_api.hpp"
 #include "core/mpv_core.hpp"
 #include "core/plex_server.hpp"
+#include "core/library_cache.hpp"
+#include "core/search_index.hpp"
 #include "util/image_loader.hpp"
+#include "util/launch_metrics.hpp"
+#include "util/log.hpp"
 #include "util/overclock.hpp"
+#include "util/startup_metrics.hpp"
+#include "util/trace.hpp"
 #include "views/home_tab.hpp"
 #include "views/search_tab.hpp"
 #include "views/library_tab.hpp"
@@ -116,7 +123,7 @@ public:
     }
 
     void onContentAvailable() override {
-        brls::Logger::info("MainActivity: onContentAvailable");
+        LOGI("MainActivity: onContentAvailable");
         customizeHeader();
         loadLibraryTabs();
 
@@ -172,68 +179,103 @@ private:
     void loadLibraryTabs() {
         auto* appletFrame = dynamic_cast<brls::AppletFrame*>(this->getContentView());
         if (!appletFrame) {
-            brls::Logger::error("MainActivity: Failed to get AppletFrame");
+            LOGE("MainActivity: Failed to get AppletFrame");
             return;
         }
 
         m_tabFrame = dynamic_cast<brls::TabFrame*>(appletFrame->getContentView());
         if (!m_tabFrame) {
-            brls::Logger::error("MainActivity: Failed to get TabFrame");
+            LOGE("MainActivity: Failed to get TabFrame");
             return;
         }
 
         PlexServer* server = SettingsManager::getInstance()->getCurrentServer();
         if (!server) {
-            brls::Logger::info("MainActivity: No server selected, building static tabs only");
+            LOGI("MainActivity: No server selected, building static tabs only");
             buildStaticTabs();
             return;
         }
 
-        brls::Logger::info("MainActivity: Loading libraries from server '{}'", server->getName());
+        LOGI("MainActivity: Loading libraries from server '{}'", server->getName());
+
+        // Build tabs from the on-disk cache straight away; the network
+        // response only rebuilds them if the library list changed
+        auto* cache = LibraryCache::getInstance();
+        cache->setServer(server->getMachineId());
+        SearchIndex::getInstance()->setServer(server->getMachineId());
+        LaunchMetrics::setWarmStart(cache->isWarm());
+        bool builtFromCache = !cache->getLibraries().empty();
+        if (builtFromCache) {
+            LOGI("MainActivity: Using {} cached libraries", cache->getLibraries().size());
+            buildLibraryTabs(server, cache->getLibraries());
+        }
 
         PlexApi::getLibrarySections(
             server,
-            [this, server](std::vector<plex::Library> libraries) {
+            [this, server, builtFromCache](std::vector<plex::Library> libraries) {
                 if (!s_mainActivityActive || s_mainActivityInstance != this) return;
 
-                brls::Logger::info("MainActivity: Got {} libraries", libraries.size());
+                LOGI("MainActivity: Got {} libraries", libraries.size());
 
-                m_tabFrame->clearTabs();
+                auto* cache = LibraryCache::getInstance();
+                bool changed = !builtFromCache || !sameLibraries(cache->getLibraries(), libraries);
+                cache->setLibraries(libraries);
+                if (changed) {
+                    buildLibraryTabs(server, libraries);
+                }
+            },
+            [this, builtFromCache](const std::string& error) {
+                if (!s_mainActivityActive || s_mainActivityInstance != this) return;
 
-                m_tabFrame->addTab("Home", []() { return new HomeTab(); });
-                m_tabFrame->addTab("Search", []() { return new SearchTab(); });
+                LOGE("MainActivity: Failed to load libraries: {}", error);
+                if (!builtFromCache) {
+                    buildStaticTabs();
+                }
+            }
+        );
+    }
 
-                for (const auto& lib : libraries) {
-                    if (lib.type != "movie" && lib.type != "show") {
-                        continue;
-                    }
+    static bool sameLibraries(const std::vector<plex::Library>& a, const std::vector<plex::Library>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].key != b[i].key || a[i].title != b[i].title || a[i].type != b[i].type) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void buildLibraryTabs(PlexServer* server, const std::vector<plex::Library>& libraries) {
+        if (!m_tabFrame) return;
 
-                    brls::Logger::info("MainActivity: Adding tab for '{}'", lib.title);
+        m_tabFrame->clearTabs();
 
-                    plex::Library libCopy = lib;
-                    PlexServer* serverPtr = server;
+        m_tabFrame->addTab("Home", []() { return new HomeTab(); });
+        m_tabFrame->addTab("Search", []() { return new SearchTab(); });
 
-                    m_tabFrame->addTab(lib.title, [serverPtr, libCopy]() {
-                        return new LibrarySectionTab(serverPtr, libCopy);
-                    });
-                }
+        for (const auto& lib : libraries) {
+            if (lib.type != "movie" && lib.type != "show") {
+                continue;
+            }
 
-                m_tabFrame->addTab("Collections", []() { return new CollectionsTab(); });
+            LOGI("MainActivity: Adding tab for '{}'", lib.title);
 
-                m_tabFrame->addSeparator();
-                m_tabFrame->addTab("Servers", []() { return new ServerListTab(); });
-                m_tabFrame->addTab("Settings", []() { return new SettingsTab(); });
-                m_tabFrame->addTab("Config", []() { return new ConfigViewTab(); });
+            plex::Library libCopy = lib;
+            PlexServer* serverPtr = server;
 
-                m_tabFrame->focusTab(0);
-            },
-            [this](const std::string& error) {
-                if (!s_mainActivityActive || s_mainActivityInstance != this) return;
+            m_tabFrame->addTab(lib.title, [serverPtr, libCopy]() {
+                return new LibrarySectionTab(serverPtr, libCopy);
+            });
+        }
 
-                brls::Logger::error("MainActivity: Failed to load libraries: {}", error);
-                buildStaticTabs();
-            }
-        );
+        m_tabFrame->addTab("Collections", []() { return new CollectionsTab(); });
+
+        m_tabFrame->addSeparator();
+        m_tabFrame->addTab("Servers", []() { return new ServerListTab(); });
+        m_tabFrame->addTab("Settings", []() { return new SettingsTab(); });
+        m_tabFrame->addTab("Config", []() { return new ConfigViewTab(); });
+
+        m_tabFrame->focusTab(0);
     }
 
     void buildStaticTabs() {
@@ -252,6 +294,8 @@ private:
 };
 
 int main(int argc, char* argv[]) {
+    LaunchMetrics::markStart();
+    trace::setThreadName("main");
     brls::Logger::setLogLevel(brls::LogLevel::LOG_DEBUG);
 
     brls::Platform::APP_LOCALE_DEFAULT = brls::LOCALE_EN_US;
@@ -261,7 +305,7 @@ int main(int argc, char* argv[]) {
     initCustomTheme();
 
     if (!brls::Application::init()) {
-        brls::Logger::error("Unable to init Borealis application");
+        LOGE("Unable to init Borealis application");
         return EXIT_FAILURE;
     }
 
@@ -274,13 +318,18 @@ int main(int argc, char* argv[]) {
     brls::getStyle().addMetric("brls/sidebar/padding_right", 15.0f);
     brls::getStyle().addMetric("brls/sidebar/item_font_size", 18.0f);
 
-    brls::Logger::info("Borealis initialized successfully");
+    LOGI("Borealis initialized successfully");
 
     curl_global_init(CURL_GLOBAL_ALL);
-    brls::Logger::info("CURL initialized");
+    LOGI("CURL initialized");
 
     SettingsManager::getInstance();
-    brls::Logger::info("Settings loaded");
+    LOGI("Settings loaded");
+
+    if (SettingsManager::getInstance()->isNetworkRecordingEnabled()) {
+        HttpRecorder::getInstance()->startRecordingSession();
+    }
+    StartupMetrics::loadHistory();
 
     brls::Application::registerXMLView("HomeTab", HomeTab::create);
     brls::Application::registerXMLView("SearchTab", SearchTab::create);
@@ -294,19 +343,38 @@ int main(int argc, char* argv[]) {
     brls::Application::createWindow("Saffron");
     brls::Application::getPlatform()->setThemeVariant(brls::ThemeVariant::DARK);
     brls::Application::getPlatform()->exitToHomeMode(true);
-    brls::Logger::info("Window created");
+    LOGI("Window created");
 
     brls::Application::pushActivity(new MainActivity());
-    brls::Logger::info("Activity pushed");
+    LOGI("Activity pushed");
 
     brls::Application::getExitEvent()->subscribe([]() {
         ImageLoader::cancelAll();
+        // The thread pool stops right after this, so write on this thread
+        LibraryCache::getInstance()->flush();
+        SearchIndex::getInstance()->flush();
+        HttpRecorder::getInstance()->stop();
     });
 
-    while (brls::Application::mainLoop()) {
+#ifdef SAFFRON_TRACE
+    // ZL + ZR + Minus writes the trace buffers to the SD card
+    PadState tracePad;
+    padInitializeDefault(&tracePad);
+    const u64 traceHeld = HidNpadButton_ZL | HidNpadButton_ZR;
+#endif
+
+    while (true) {
+        TRACE_SCOPE("frame");
+        if (!brls::Application::mainLoop()) break;
+#ifdef SAFFRON_TRACE
+        padUpdate(&tracePad);
+        if ((padGetButtons(&tracePad) & traceHeld) == traceHeld && (padGetButtonsDown(&tracePad) & HidNpadButton_Minus)) {
+            brls::async([]() { trace::dumpToCard(); });
+        }
+#endif
     }
 
-    brls::Logger::info("Application exiting");
+    LOGI("Application exiting");
     SwitchSys::exit();
     MPVCore::destroyInstance();
     brls::ThreadPool::shutdown();
@@ -314,5 +382,6 @@ int main(int argc, char* argv[]) {
     ImageQueue::shutdown();
     CurlPool::shutdown();
     curl_global_cleanup();
+    AsyncLog::getInstance()->shutdown();
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,223 @@
+#include "models/card_item.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace plex {
+
+namespace {
+
+const std::string EMPTY_STRING;
+
+uint16_t clampU16(int value) {
+    if (value <= 0) return 0;
+    return static_cast<uint16_t>(std::min(value, static_cast<int>(std::numeric_limits<uint16_t>::max())));
+}
+
+size_t stringHeapBytes(const std::string& s) {
+    // Strings that fit the small-string buffer do not allocate
+    std::string empty;
+    if (s.capacity() <= empty.capacity()) return 0;
+    return s.capacity() + 1;
+}
+
+size_t tagHeapBytes(const std::vector<Tag>& tags) {
+    size_t bytes = tags.capacity() * sizeof(Tag);
+    for (const auto& t : tags) {
+        bytes += stringHeapBytes(t.tag) + stringHeapBytes(t.role) + stringHeapBytes(t.thumb);
+    }
+    return bytes;
+}
+
+size_t streamHeapBytes(const Stream& s) {
+    return stringHeapBytes(s.codec) + stringHeapBytes(s.language) +
+           stringHeapBytes(s.languageCode) + stringHeapBytes(s.displayTitle) +
+           stringHeapBytes(s.decision) + stringHeapBytes(s.profile) +
+           stringHeapBytes(s.audioChannelLayout) + stringHeapBytes(s.colorSpace) +
+           stringHeapBytes(s.colorRange) + stringHeapBytes(s.colorPrimaries);
+}
+
+size_t partHeapBytes(const Part& p) {
+    size_t bytes = stringHeapBytes(p.key) + stringHeapBytes(p.file) +
+                   stringHeapBytes(p.container) + stringHeapBytes(p.videoProfile) +
+                   stringHeapBytes(p.audioProfile);
+    bytes += p.streams.capacity() * sizeof(Stream);
+    for (const auto& s : p.streams) {
+        bytes += streamHeapBytes(s);
+    }
+    return bytes;
+}
+
+size_t mediaHeapBytes(const Media& m) {
+    size_t bytes = stringHeapBytes(m.aspectRatio) + stringHeapBytes(m.audioCodec) +
+                   stringHeapBytes(m.videoCodec) + stringHeapBytes(m.videoResolution) +
+                   stringHeapBytes(m.container) + stringHeapBytes(m.videoFrameRate) +
+                   stringHeapBytes(m.videoProfile) + stringHeapBytes(m.audioProfile) +
+                   stringHeapBytes(m.editionTitle);
+    bytes += m.parts.capacity() * sizeof(Part);
+    for (const auto& p : m.parts) {
+        bytes += partHeapBytes(p);
+    }
+    return bytes;
+}
+
+}
+
+StringPool& StringPool::instance() {
+    static StringPool pool;
+    return pool;
+}
+
+const std::string* StringPool::intern(const std::string& value) {
+    if (value.empty()) return nullptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_strings.insert(value).first;
+    return &(*it);
+}
+
+size_t StringPool::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_strings.size();
+}
+
+size_t StringPool::memoryUsage() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t bytes = m_strings.bucket_count() * sizeof(void*);
+    for (const auto& s : m_strings) {
+        // Node overhead: next pointer, cached hash and the string itself
+        bytes += sizeof(void*) + sizeof(size_t) + sizeof(std::string) + stringHeapBytes(s);
+    }
+    return bytes;
+}
+
+InternedString::InternedString(const std::string& value)
+    : m_value(StringPool::instance().intern(value)) {
+}
+
+const std::string& InternedString::str() const {
+    return m_value ? *m_value : EMPTY_STRING;
+}
+
+VideoCodec parseVideoCodec(const std::string& codec) {
+    if (codec.empty()) return VideoCodec::Unknown;
+    if (codec == "h264" || codec == "avc") return VideoCodec::H264;
+    if (codec == "hevc" || codec == "h265") return VideoCodec::HEVC;
+    if (codec == "vp9") return VideoCodec::VP9;
+    if (codec == "av1") return VideoCodec::AV1;
+    if (codec == "mpeg2video" || codec == "mpeg2") return VideoCodec::MPEG2;
+    if (codec == "mpeg4") return VideoCodec::MPEG4;
+    if (codec == "vc1") return VideoCodec::VC1;
+    return VideoCodec::Other;
+}
+
+uint8_t parseResolution(const std::string& videoResolution) {
+    if (videoResolution.empty()) return 0;
+    if (videoResolution == "4k" || videoResolution == "4K") return RESOLUTION_4K;
+    if (videoResolution == "1080" || videoResolution == "1080p") return RESOLUTION_1080;
+    if (videoResolution == "720" || videoResolution == "720p") return RESOLUTION_720;
+    return RESOLUTION_SD;
+}
+
+CardItem CardItem::fromMediaItem(const MediaItem& item) {
+    CardItem card;
+    card.ratingKey = item.ratingKey;
+    card.librarySectionId = item.librarySectionId;
+    card.duration = item.duration;
+    card.viewOffset = item.viewOffset;
+    card.updatedAt = item.updatedAt;
+    card.lastViewedAt = item.lastViewedAt;
+    card.title = item.title;
+    if (item.titleSort != item.title) {
+        card.titleSort = item.titleSort;
+    }
+    card.thumb = item.thumb;
+    if (card.thumb.empty()) {
+        card.thumb = !item.grandparentThumb.empty() ? item.grandparentThumb : item.parentThumb;
+    }
+    card.editionTitle = InternedString(item.editionTitle);
+    card.contentRating = InternedString(item.contentRating);
+    card.studio = InternedString(item.studio);
+    card.grandparentTitle = InternedString(item.grandparentTitle);
+    card.parentTitle = InternedString(item.parentTitle);
+    card.mediaType = item.mediaType;
+    card.year = clampU16(item.year);
+    card.index = clampU16(item.index);
+    card.parentIndex = clampU16(item.parentIndex);
+    card.childCount = clampU16(item.childCount);
+    card.leafCount = clampU16(item.leafCount);
+    card.viewedLeafCount = clampU16(item.viewedLeafCount);
+    card.viewCount = clampU16(item.viewCount);
+
+    for (const auto& m : item.media) {
+        if (card.videoCodec == VideoCodec::Unknown) {
+            card.videoCodec = parseVideoCodec(m.videoCodec);
+        }
+        card.resolutions |= parseResolution(m.videoResolution);
+    }
+    return card;
+}
+
+MediaItem CardItem::toMediaItem() const {
+    MediaItem item;
+    item.ratingKey = ratingKey;
+    item.librarySectionId = librarySectionId;
+    item.duration = duration;
+    item.viewOffset = viewOffset;
+    item.updatedAt = updatedAt;
+    item.lastViewedAt = lastViewedAt;
+    item.title = title;
+    item.titleSort = sortTitle();
+    item.thumb = thumb;
+    item.editionTitle = editionTitle.str();
+    item.contentRating = contentRating.str();
+    item.studio = studio.str();
+    item.grandparentTitle = grandparentTitle.str();
+    item.parentTitle = parentTitle.str();
+    item.mediaType = mediaType;
+    item.year = year;
+    item.index = index;
+    item.parentIndex = parentIndex;
+    item.childCount = childCount;
+    item.leafCount = leafCount;
+    item.viewedLeafCount = viewedLeafCount;
+    item.viewCount = viewCount;
+    return item;
+}
+
+std::vector<CardItem> toCardItems(const std::vector<MediaItem>& items) {
+    std::vector<CardItem> cards;
+    cards.reserve(items.size());
+    for (const auto& item : items) {
+        cards.push_back(CardItem::fromMediaItem(item));
+    }
+    return cards;
+}
+
+size_t memoryFootprint(const MediaItem& item) {
+    size_t bytes = sizeof(MediaItem);
+    for (const std::string* s : {&item.key, &item.guid, &item.type, &item.title, &item.titleSort,
+                                 &item.editionTitle, &item.summary, &item.thumb, &item.art,
+                                 &item.banner, &item.contentRating, &item.audienceRatingImage,
+                                 &item.studio, &item.tagline, &item.originalTitle,
+                                 &item.originallyAvailableAt, &item.grandparentTitle,
+                                 &item.parentTitle, &item.grandparentThumb, &item.parentThumb}) {
+        bytes += stringHeapBytes(*s);
+    }
+
+    bytes += item.media.capacity() * sizeof(Media);
+    for (const auto& m : item.media) {
+        bytes += mediaHeapBytes(m);
+    }
+    bytes += tagHeapBytes(item.genres) + tagHeapBytes(item.countries) +
+             tagHeapBytes(item.directors) + tagHeapBytes(item.writers) +
+             tagHeapBytes(item.cast);
+    return bytes;
+}
+
+size_t memoryFootprint(const CardItem& item) {
+    return sizeof(CardItem) + stringHeapBytes(item.title) + stringHeapBytes(item.titleSort) +
+           stringHeapBytes(item.thumb);
+}
+
+}
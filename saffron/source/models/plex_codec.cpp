@@ -0,0 +1,764 @@
+#include "models/plex_codec.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+#ifndef __SWITCH__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace plex::codec {
+
+size_t Encoder::beginLength() {
+    // One byte covers records under 128 bytes; endRecord widens it if not
+    m_writer.buffer() += '\0';
+    return m_writer.buffer().size();
+}
+
+void Encoder::endRecord(size_t mark) {
+    std::string& buffer = m_writer.buffer();
+    uint64_t length = buffer.size() - mark;
+    char bytes[10];
+    size_t count = 0;
+    do {
+        uint8_t byte = length & 0x7f;
+        length >>= 7;
+        if (length) byte |= 0x80;
+        bytes[count++] = static_cast<char>(byte);
+    } while (length);
+    if (count > 1) buffer.insert(mark, count - 1, '\0');
+    memcpy(&buffer[mark - 1], bytes, count);
+}
+
+bool FieldCursor::next() {
+    if (!m_ok || m_reader.atEnd()) return false;
+    uint64_t key = 0;
+    if (!m_reader.getVarint(key)) return m_ok = false;
+    m_id = static_cast<uint32_t>(key >> 3);
+    m_wire = static_cast<Wire>(key & 7);
+    switch (m_wire) {
+        case Wire::Varint:
+            m_ok = m_reader.getVarint(m_value);
+            break;
+        case Wire::Fixed64:
+            m_ok = m_reader.get(m_value);
+            break;
+        case Wire::Bytes: {
+            uint64_t length = 0;
+            m_ok = m_reader.getVarint(length) && m_reader.getBytes(length, m_bytes);
+            break;
+        }
+        default:
+            m_ok = false;
+    }
+    return m_ok;
+}
+
+int64_t FieldCursor::asInt() const {
+    if (m_wire != Wire::Varint) return 0;
+    return static_cast<int64_t>(m_value >> 1) ^ -static_cast<int64_t>(m_value & 1);
+}
+
+double FieldCursor::asDouble() const {
+    if (m_wire != Wire::Fixed64) return 0.0;
+    double value;
+    memcpy(&value, &m_value, sizeof(value));
+    return value;
+}
+
+FieldCursor RecordView::find(uint32_t id) const {
+    FieldCursor cursor(m_data);
+    while (cursor.next()) {
+        if (cursor.id() == id) return cursor;
+    }
+    return FieldCursor(std::string_view());
+}
+
+namespace {
+
+template <typename F, typename T>
+void putRecords(Encoder& encoder, F field, const std::vector<T>& records) {
+    for (const auto& record : records) {
+        size_t mark = encoder.beginRecord(field);
+        encode(encoder, record);
+        encoder.endRecord(mark);
+    }
+}
+
+template <typename T>
+bool decodeInto(const FieldCursor& cursor, std::vector<T>& records) {
+    return cursor.wire() == Wire::Bytes && decode(cursor.asBytes(), records.emplace_back());
+}
+
+std::string asString(const FieldCursor& cursor) {
+    std::string_view bytes = cursor.asBytes();
+    return std::string(bytes.data(), bytes.size());
+}
+
+int asInt32(const FieldCursor& cursor) {
+    return static_cast<int>(cursor.asInt());
+}
+
+}  // namespace
+
+void encode(Encoder& e, const Stream& s) {
+    e.putInt(StreamField::Id, s.id);
+    e.putInt(StreamField::StreamType, s.streamType);
+    e.putString(StreamField::Codec, s.codec);
+    e.putString(StreamField::Language, s.language);
+    e.putString(StreamField::LanguageCode, s.languageCode);
+    e.putString(StreamField::DisplayTitle, s.displayTitle);
+    e.putBool(StreamField::Selected, s.selected);
+    e.putBool(StreamField::IsDefault, s.isDefault);
+    e.putString(StreamField::Decision, s.decision);
+    e.putString(StreamField::Key, s.key);
+    e.putInt(StreamField::Index, s.index);
+    e.putInt(StreamField::Channels, s.channels);
+    e.putInt(StreamField::Bitrate, s.bitrate);
+    e.putString(StreamField::Profile, s.profile);
+    e.putString(StreamField::AudioChannelLayout, s.audioChannelLayout);
+    e.putInt(StreamField::BitDepth, s.bitDepth);
+    e.putString(StreamField::ColorSpace, s.colorSpace);
+    e.putString(StreamField::ColorRange, s.colorRange);
+    e.putString(StreamField::ColorPrimaries, s.colorPrimaries);
+    e.putInt(StreamField::Width, s.width);
+    e.putInt(StreamField::Height, s.height);
+    e.putDouble(StreamField::FrameRate, s.frameRate);
+}
+
+bool decode(std::string_view record, Stream& s) {
+    FieldCursor c(record);
+    while (c.next()) {
+        switch (static_cast<StreamField>(c.id())) {
+            case StreamField::Id: s.id = asInt32(c); break;
+            case StreamField::StreamType: s.streamType = asInt32(c); break;
+            case StreamField::Codec: s.codec = asString(c); break;
+            case StreamField::Language: s.language = asString(c); break;
+            case StreamField::LanguageCode: s.languageCode = asString(c); break;
+            case StreamField::DisplayTitle: s.displayTitle = asString(c); break;
+            case StreamField::Selected: s.selected = c.asBool(); break;
+            case StreamField::IsDefault: s.isDefault = c.asBool(); break;
+            case StreamField::Decision: s.decision = asString(c); break;
+            case StreamField::Key: s.key = asString(c); break;
+            case StreamField::Index: s.index = asInt32(c); break;
+            case StreamField::Channels: s.channels = asInt32(c); break;
+            case StreamField::Bitrate: s.bitrate = asInt32(c); break;
+            case StreamField::Profile: s.profile = asString(c); break;
+            case StreamField::AudioChannelLayout: s.audioChannelLayout = asString(c); break;
+            case StreamField::BitDepth: s.bitDepth = asInt32(c); break;
+            case StreamField::ColorSpace: s.colorSpace = asString(c); break;
+            case StreamField::ColorRange: s.colorRange = asString(c); break;
+            case StreamField::ColorPrimaries: s.colorPrimaries = asString(c); break;
+            case StreamField::Width: s.width = asInt32(c); break;
+            case StreamField::Height: s.height = asInt32(c); break;
+            case StreamField::FrameRate: s.frameRate = c.asDouble(); break;
+            default: break;  // written by a newer version
+        }
+    }
+    return c.ok();
+}
+
+void encode(Encoder& e, const Part& p) {
+    e.putInt(PartField::Id, p.id);
+    e.putString(PartField::Key, p.key);
+    e.putInt(PartField::Duration, p.duration);
+    e.putString(PartField::File, p.file);
+    e.putInt(PartField::Size, p.size);
+    e.putString(PartField::Container, p.container);
+    e.putString(PartField::VideoProfile, p.videoProfile);
+    e.putString(PartField::AudioProfile, p.audioProfile);
+    putRecords(e, PartField::Streams, p.streams);
+}
+
+bool decode(std::string_view record, Part& p) {
+    FieldCursor c(record);
+    while (c.next()) {
+        switch (static_cast<PartField>(c.id())) {
+            case PartField::Id: p.id = asInt32(c); break;
+            case PartField::Key: p.key = asString(c); break;
+            case PartField::Duration: p.duration = c.asInt(); break;
+            case PartField::File: p.file = asString(c); break;
+            case PartField::Size: p.size = c.asInt(); break;
+            case PartField::Container: p.container = asString(c); break;
+            case PartField::VideoProfile: p.videoProfile = asString(c); break;
+            case PartField::AudioProfile: p.audioProfile = asString(c); break;
+            case PartField::Streams:
+                if (!decodeInto(c, p.streams)) return false;
+                break;
+            default: break;
+        }
+    }
+    return c.ok();
+}
+
+void encode(Encoder& e, const Media& m) {
+    e.putInt(MediaField::Id, m.id);
+    e.putInt(MediaField::Duration, m.duration);
+    e.putInt(MediaField::Bitrate, m.bitrate);
+    e.putInt(MediaField::Width, m.width);
+    e.putInt(MediaField::Height, m.height);
+    e.putString(MediaField::AspectRatio, m.aspectRatio);
+    e.putInt(MediaField::AudioChannels, m.audioChannels);
+    e.putString(MediaField::AudioCodec, m.audioCodec);
+    e.putString(MediaField::VideoCodec, m.videoCodec);
+    e.putString(MediaField::VideoResolution, m.videoResolution);
+    e.putString(MediaField::Container, m.container);
+    e.putString(MediaField::VideoFrameRate, m.videoFrameRate);
+    e.putString(MediaField::VideoProfile, m.videoProfile);
+    e.putString(MediaField::AudioProfile, m.audioProfile);
+    e.putString(MediaField::EditionTitle, m.editionTitle);
+    e.putBool(MediaField::OptimizedForStreaming, m.optimizedForStreaming);
+    putRecords(e, MediaField::Parts, m.parts);
+}
+
+bool decode(std::string_view record, Media& m) {
+    FieldCursor c(record);
+    while (c.next()) {
+        switch (static_cast<MediaField>(c.id())) {
+            case MediaField::Id: m.id = asInt32(c); break;
+            case MediaField::Duration: m.duration = c.asInt(); break;
+            case MediaField::Bitrate: m.bitrate = asInt32(c); break;
+            case MediaField::Width: m.width = asInt32(c); break;
+            case MediaField::Height: m.height = asInt32(c); break;
+            case MediaField::AspectRatio: m.aspectRatio = asString(c); break;
+            case MediaField::AudioChannels: m.audioChannels = asInt32(c); break;
+            case MediaField::AudioCodec: m.audioCodec = asString(c); break;
+            case MediaField::VideoCodec: m.videoCodec = asString(c); break;
+            case MediaField::VideoResolution: m.videoResolution = asString(c); break;
+            case MediaField::Container: m.container = asString(c); break;
+            case MediaField::VideoFrameRate: m.videoFrameRate = asString(c); break;
+            case MediaField::VideoProfile: m.videoProfile = asString(c); break;
+            case MediaField::AudioProfile: m.audioProfile = asString(c); break;
+            case MediaField::EditionTitle: m.editionTitle = asString(c); break;
+            case MediaField::OptimizedForStreaming: m.optimizedForStreaming = c.asBool(); break;
+            case MediaField::Parts:
+                if (!decodeInto(c, m.parts)) return false;
+                break;
+            default: break;
+        }
+    }
+    return c.ok();
+}
+
+void encode(Encoder& e, const Tag& t) {
+    e.putInt(TagField::Id, t.id);
+    e.putString(TagField::Tag, t.tag);
+    e.putString(TagField::Role, t.role);
+    e.putString(TagField::Thumb, t.thumb);
+}
+
+bool decode(std::string_view record, Tag& t) {
+    FieldCursor c(record);
+    while (c.next()) {
+        switch (static_cast<TagField>(c.id())) {
+            case TagField::Id: t.id = asInt32(c); break;
+            case TagField::Tag: t.tag = asString(c); break;
+            case TagField::Role: t.role = asString(c); break;
+            case TagField::Thumb: t.thumb = asString(c); break;
+            default: break;
+        }
+    }
+    return c.ok();
+}
+
+void encode(Encoder& e, const MediaItem& item) {
+    e.putInt(ItemField::RatingKey, item.ratingKey);
+    e.putString(ItemField::Key, item.key);
+    e.putString(ItemField::Guid, item.guid);
+    e.putString(ItemField::Type, item.type);
+    e.putInt(ItemField::MediaType, static_cast<int>(item.mediaType));
+    e.putString(ItemField::Title, item.title);
+    e.putString(ItemField::TitleSort, item.titleSort);
+    e.putString(ItemField::EditionTitle, item.editionTitle);
+    e.putString(ItemField::Summary, item.summary);
+    e.putString(ItemField::Thumb, item.thumb);
+    e.putString(ItemField::Art, item.art);
+    e.putString(ItemField::Banner, item.banner);
+    e.putInt(ItemField::Duration, item.duration);
+    e.putInt(ItemField::AddedAt, item.addedAt);
+    e.putInt(ItemField::UpdatedAt, item.updatedAt);
+    e.putInt(ItemField::Year, item.year);
+    e.putString(ItemField::ContentRating, item.contentRating);
+    e.putDouble(ItemField::Rating, item.rating);
+    e.putDouble(ItemField::AudienceRating, item.audienceRating);
+    e.putString(ItemField::AudienceRatingImage, item.audienceRatingImage);
+    e.putString(ItemField::Studio, item.studio);
+    e.putString(ItemField::Tagline, item.tagline);
+    e.putString(ItemField::OriginalTitle, item.originalTitle);
+    e.putString(ItemField::OriginallyAvailableAt, item.originallyAvailableAt);
+    e.putInt(ItemField::ViewOffset, item.viewOffset);
+    e.putInt(ItemField::ViewCount, item.viewCount);
+    e.putInt(ItemField::LastViewedAt, item.lastViewedAt);
+    e.putInt(ItemField::ParentRatingKey, item.parentRatingKey);
+    e.putInt(ItemField::GrandparentRatingKey, item.grandparentRatingKey);
+    e.putInt(ItemField::Index, item.index);
+    e.putInt(ItemField::ParentIndex, item.parentIndex);
+    e.putString(ItemField::GrandparentTitle, item.grandparentTitle);
+    e.putString(ItemField::ParentTitle, item.parentTitle);
+    e.putString(ItemField::GrandparentThumb, item.grandparentThumb);
+    e.putString(ItemField::ParentThumb, item.parentThumb);
+    e.putInt(ItemField::LeafCount, item.leafCount);
+    e.putInt(ItemField::ViewedLeafCount, item.viewedLeafCount);
+    e.putInt(ItemField::ChildCount, item.childCount);
+    e.putInt(ItemField::LibrarySectionId, item.librarySectionId);
+    putRecords(e, ItemField::Media, item.media);
+    putRecords(e, ItemField::Genres, item.genres);
+    putRecords(e, ItemField::Countries, item.countries);
+    putRecords(e, ItemField::Directors, item.directors);
+    putRecords(e, ItemField::Writers, item.writers);
+    putRecords(e, ItemField::Cast, item.cast);
+}
+
+bool decode(std::string_view record, MediaItem& item) {
+    // MediaType has no zero; an item that never had one set stays a movie
+    item.mediaType = MediaType::Movie;
+    FieldCursor c(record);
+    while (c.next()) {
+        switch (static_cast<ItemField>(c.id())) {
+            case ItemField::RatingKey: item.ratingKey = asInt32(c); break;
+            case ItemField::Key: item.key = asString(c); break;
+            case ItemField::Guid: item.guid = asString(c); break;
+            case ItemField::Type: item.type = asString(c); break;
+            case ItemField::MediaType: item.mediaType = static_cast<MediaType>(asInt32(c)); break;
+            case ItemField::Title: item.title = asString(c); break;
+            case ItemField::TitleSort: item.titleSort = asString(c); break;
+            case ItemField::EditionTitle: item.editionTitle = asString(c); break;
+            case ItemField::Summary: item.summary = asString(c); break;
+            case ItemField::Thumb: item.thumb = asString(c); break;
+            case ItemField::Art: item.art = asString(c); break;
+            case ItemField::Banner: item.banner = asString(c); break;
+            case ItemField::Duration: item.duration = c.asInt(); break;
+            case ItemField::AddedAt: item.addedAt = c.asInt(); break;
+            case ItemField::UpdatedAt: item.updatedAt = c.asInt(); break;
+            case ItemField::Year: item.year = asInt32(c); break;
+            case ItemField::ContentRating: item.contentRating = asString(c); break;
+            case ItemField::Rating: item.rating = c.asDouble(); break;
+            case ItemField::AudienceRating: item.audienceRating = c.asDouble(); break;
+            case ItemField::AudienceRatingImage: item.audienceRatingImage = asString(c); break;
+            case ItemField::Studio: item.studio = asString(c); break;
+            case ItemField::Tagline: item.tagline = asString(c); break;
+            case ItemField::OriginalTitle: item.originalTitle = asString(c); break;
+            case ItemField::OriginallyAvailableAt: item.originallyAvailableAt = asString(c); break;
+            case ItemField::ViewOffset: item.viewOffset = c.asInt(); break;
+            case ItemField::ViewCount: item.viewCount = asInt32(c); break;
+            case ItemField::LastViewedAt: item.lastViewedAt = c.asInt(); break;
+            case ItemField::ParentRatingKey: item.parentRatingKey = asInt32(c); break;
+            case ItemField::GrandparentRatingKey: item.grandparentRatingKey = asInt32(c); break;
+            case ItemField::Index: item.index = asInt32(c); break;
+            case ItemField::ParentIndex: item.parentIndex = asInt32(c); break;
+            case ItemField::GrandparentTitle: item.grandparentTitle = asString(c); break;
+            case ItemField::ParentTitle: item.parentTitle = asString(c); break;
+            case ItemField::GrandparentThumb: item.grandparentThumb = asString(c); break;
+            case ItemField::ParentThumb: item.parentThumb = asString(c); break;
+            case ItemField::LeafCount: item.leafCount = asInt32(c); break;
+            case ItemField::ViewedLeafCount: item.viewedLeafCount = asInt32(c); break;
+            case ItemField::ChildCount: item.childCount = asInt32(c); break;
+            case ItemField::LibrarySectionId: item.librarySectionId = asInt32(c); break;
+            case ItemField::Media:
+                if (!decodeInto(c, item.media)) return false;
+                break;
+            case ItemField::Genres:
+                if (!decodeInto(c, item.genres)) return false;
+                break;
+            case ItemField::Countries:
+                if (!decodeInto(c, item.countries)) return false;
+                break;
+            case ItemField::Directors:
+                if (!decodeInto(c, item.directors)) return false;
+                break;
+            case ItemField::Writers:
+                if (!decodeInto(c, item.writers)) return false;
+                break;
+            case ItemField::Cast:
+                if (!decodeInto(c, item.cast)) return false;
+                break;
+            default: break;
+        }
+    }
+    return c.ok();
+}
+
+void encode(Encoder& e, const Library& lib) {
+    e.putInt(LibraryField::Key, lib.key);
+    e.putString(LibraryField::Uuid, lib.uuid);
+    e.putString(LibraryField::Type, lib.type);
+    e.putString(LibraryField::Title, lib.title);
+    e.putString(LibraryField::Art, lib.art);
+    e.putString(LibraryField::Thumb, lib.thumb);
+    e.putString(LibraryField::Composite, lib.composite);
+    e.putBool(LibraryField::AllowSync, lib.allowSync);
+    e.putInt(LibraryField::UpdatedAt, lib.updatedAt);
+    e.putInt(LibraryField::ScannedAt, lib.scannedAt);
+}
+
+bool decode(std::string_view record, Library& lib) {
+    FieldCursor c(record);
+    while (c.next()) {
+        switch (static_cast<LibraryField>(c.id())) {
+            case LibraryField::Key: lib.key = asInt32(c); break;
+            case LibraryField::Uuid: lib.uuid = asString(c); break;
+            case LibraryField::Type: lib.type = asString(c); break;
+            case LibraryField::Title: lib.title = asString(c); break;
+            case LibraryField::Art: lib.art = asString(c); break;
+            case LibraryField::Thumb: lib.thumb = asString(c); break;
+            case LibraryField::Composite: lib.composite = asString(c); break;
+            case LibraryField::AllowSync: lib.allowSync = c.asBool(); break;
+            case LibraryField::UpdatedAt: lib.updatedAt = c.asInt(); break;
+            case LibraryField::ScannedAt: lib.scannedAt = c.asInt(); break;
+            default: break;
+        }
+    }
+    return c.ok();
+}
+
+void encode(Encoder& e, const Hub& hub) {
+    e.putString(HubField::HubKey, hub.hubKey);
+    e.putString(HubField::Key, hub.key);
+    e.putString(HubField::Title, hub.title);
+    e.putString(HubField::Type, hub.type);
+    e.putString(HubField::HubIdentifier, hub.hubIdentifier);
+    e.putString(HubField::Context, hub.context);
+    e.putInt(HubField::Size, hub.size);
+    e.putBool(HubField::More, hub.more);
+    e.putString(HubField::Style, hub.style);
+    e.putBool(HubField::Promoted, hub.promoted);
+    putRecords(e, HubField::Items, hub.items);
+}
+
+bool decode(std::string_view record, Hub& hub) {
+    FieldCursor c(record);
+    while (c.next()) {
+        switch (static_cast<HubField>(c.id())) {
+            case HubField::HubKey: hub.hubKey = asString(c); break;
+            case HubField::Key: hub.key = asString(c); break;
+            case HubField::Title: hub.title = asString(c); break;
+            case HubField::Type: hub.type = asString(c); break;
+            case HubField::HubIdentifier: hub.hubIdentifier = asString(c); break;
+            case HubField::Context: hub.context = asString(c); break;
+            case HubField::Size: hub.size = asInt32(c); break;
+            case HubField::More: hub.more = c.asBool(); break;
+            case HubField::Style: hub.style = asString(c); break;
+            case HubField::Promoted: hub.promoted = c.asBool(); break;
+            case HubField::Items:
+                if (!decodeInto(c, hub.items)) return false;
+                break;
+            default: break;
+        }
+    }
+    return c.ok();
+}
+
+void encode(Encoder& e, const Collection& col) {
+    e.putInt(CollectionField::RatingKey, col.ratingKey);
+    e.putString(CollectionField::Key, col.key);
+    e.putString(CollectionField::Guid, col.guid);
+    e.putString(CollectionField::Type, col.type);
+    e.putString(CollectionField::Title, col.title);
+    e.putString(CollectionField::Summary, col.summary);
+    e.putString(CollectionField::Thumb, col.thumb);
+    e.putString(CollectionField::Art, col.art);
+    e.putInt(CollectionField::ChildCount, col.childCount);
+    e.putInt(CollectionField::AddedAt, col.addedAt);
+    e.putInt(CollectionField::UpdatedAt, col.updatedAt);
+}
+
+bool decode(std::string_view record, Collection& col) {
+    FieldCursor c(record);
+    while (c.next()) {
+        switch (static_cast<CollectionField>(c.id())) {
+            case CollectionField::RatingKey: col.ratingKey = asInt32(c); break;
+            case CollectionField::Key: col.key = asString(c); break;
+            case CollectionField::Guid: col.guid = asString(c); break;
+            case CollectionField::Type: col.type = asString(c); break;
+            case CollectionField::Title: col.title = asString(c); break;
+            case CollectionField::Summary: col.summary = asString(c); break;
+            case CollectionField::Thumb: col.thumb = asString(c); break;
+            case CollectionField::Art: col.art = asString(c); break;
+            case CollectionField::ChildCount: col.childCount = asInt32(c); break;
+            case CollectionField::AddedAt: col.addedAt = c.asInt(); break;
+            case CollectionField::UpdatedAt: col.updatedAt = c.asInt(); break;
+            default: break;
+        }
+    }
+    return c.ok();
+}
+
+void encode(Encoder& e, const Playlist& pl) {
+    e.putInt(PlaylistField::RatingKey, pl.ratingKey);
+    e.putString(PlaylistField::Key, pl.key);
+    e.putString(PlaylistField::Guid, pl.guid);
+    e.putString(PlaylistField::Type, pl.type);
+    e.putString(PlaylistField::Title, pl.title);
+    e.putString(PlaylistField::Summary, pl.summary);
+    e.putString(PlaylistField::Thumb, pl.thumb);
+    e.putString(PlaylistField::Composite, pl.composite);
+    e.putInt(PlaylistField::LeafCount, pl.leafCount);
+    e.putInt(PlaylistField::Duration, pl.duration);
+    e.putBool(PlaylistField::Smart, pl.smart);
+    e.putString(PlaylistField::PlaylistType, pl.playlistType);
+    e.putInt(PlaylistField::AddedAt, pl.addedAt);
+    e.putInt(PlaylistField::UpdatedAt, pl.updatedAt);
+}
+
+bool decode(std::string_view record, Playlist& pl) {
+    FieldCursor c(record);
+    while (c.next()) {
+        switch (static_cast<PlaylistField>(c.id())) {
+            case PlaylistField::RatingKey: pl.ratingKey = asInt32(c); break;
+            case PlaylistField::Key: pl.key = asString(c); break;
+            case PlaylistField::Guid: pl.guid = asString(c); break;
+            case PlaylistField::Type: pl.type = asString(c); break;
+            case PlaylistField::Title: pl.title = asString(c); break;
+            case PlaylistField::Summary: pl.summary = asString(c); break;
+            case PlaylistField::Thumb: pl.thumb = asString(c); break;
+            case PlaylistField::Composite: pl.composite = asString(c); break;
+            case PlaylistField::LeafCount: pl.leafCount = asInt32(c); break;
+            case PlaylistField::Duration: pl.duration = c.asInt(); break;
+            case PlaylistField::Smart: pl.smart = c.asBool(); break;
+            case PlaylistField::PlaylistType: pl.playlistType = asString(c); break;
+            case PlaylistField::AddedAt: pl.addedAt = c.asInt(); break;
+            case PlaylistField::UpdatedAt: pl.updatedAt = c.asInt(); break;
+            default: break;
+        }
+    }
+    return c.ok();
+}
+
+// Interned strings are written out in full; reading interns them again
+void encode(Encoder& e, const CardItem& card) {
+    e.putInt(CardField::RatingKey, card.ratingKey);
+    e.putInt(CardField::LibrarySectionId, card.librarySectionId);
+    e.putInt(CardField::Duration, card.duration);
+    e.putInt(CardField::ViewOffset, card.viewOffset);
+    e.putInt(CardField::UpdatedAt, card.updatedAt);
+    e.putInt(CardField::LastViewedAt, card.lastViewedAt);
+    e.putString(CardField::Title, card.title);
+    e.putString(CardField::TitleSort, card.titleSort);
+    e.putString(CardField::Thumb, card.thumb);
+    e.putString(CardField::EditionTitle, card.editionTitle.str());
+    e.putString(CardField::ContentRating, card.contentRating.str());
+    e.putString(CardField::Studio, card.studio.str());
+    e.putString(CardField::GrandparentTitle, card.grandparentTitle.str());
+    e.putString(CardField::ParentTitle, card.parentTitle.str());
+    e.putInt(CardField::MediaType, static_cast<int64_t>(card.mediaType));
+    e.putInt(CardField::Year, card.year);
+    e.putInt(CardField::Index, card.index);
+    e.putInt(CardField::ParentIndex, card.parentIndex);
+    e.putInt(CardField::ChildCount, card.childCount);
+    e.putInt(CardField::LeafCount, card.leafCount);
+    e.putInt(CardField::ViewedLeafCount, card.viewedLeafCount);
+    e.putInt(CardField::ViewCount, card.viewCount);
+    e.putInt(CardField::VideoCodec, static_cast<int64_t>(card.videoCodec));
+    e.putInt(CardField::Resolutions, card.resolutions);
+}
+
+bool decode(std::string_view record, CardItem& card) {
+    auto interned = [](const FieldCursor& c) { return InternedString(asString(c)); };
+    auto asU16 = [](const FieldCursor& c) { return static_cast<uint16_t>(c.asInt()); };
+    FieldCursor c(record);
+    while (c.next()) {
+        switch (static_cast<CardField>(c.id())) {
+            case CardField::RatingKey: card.ratingKey = asInt32(c); break;
+            case CardField::LibrarySectionId: card.librarySectionId = asInt32(c); break;
+            case CardField::Duration: card.duration = c.asInt(); break;
+            case CardField::ViewOffset: card.viewOffset = c.asInt(); break;
+            case CardField::UpdatedAt: card.updatedAt = c.asInt(); break;
+            case CardField::LastViewedAt: card.lastViewedAt = c.asInt(); break;
+            case CardField::Title: card.title = asString(c); break;
+            case CardField::TitleSort: card.titleSort = asString(c); break;
+            case CardField::Thumb: card.thumb = asString(c); break;
+            case CardField::EditionTitle: card.editionTitle = interned(c); break;
+            case CardField::ContentRating: card.contentRating = interned(c); break;
+            case CardField::Studio: card.studio = interned(c); break;
+            case CardField::GrandparentTitle: card.grandparentTitle = interned(c); break;
+            case CardField::ParentTitle: card.parentTitle = interned(c); break;
+            case CardField::MediaType: card.mediaType = static_cast<MediaType>(c.asInt()); break;
+            case CardField::Year: card.year = asU16(c); break;
+            case CardField::Index: card.index = asU16(c); break;
+            case CardField::ParentIndex: card.parentIndex = asU16(c); break;
+            case CardField::ChildCount: card.childCount = asU16(c); break;
+            case CardField::LeafCount: card.leafCount = asU16(c); break;
+            case CardField::ViewedLeafCount: card.viewedLeafCount = asU16(c); break;
+            case CardField::ViewCount: card.viewCount = asU16(c); break;
+            case CardField::VideoCodec: card.videoCodec = static_cast<VideoCodec>(c.asInt()); break;
+            case CardField::Resolutions: card.resolutions = static_cast<uint8_t>(c.asInt()); break;
+            default: break;
+        }
+    }
+    return c.ok();
+}
+
+Encoder& ArchiveWriter::nextRecord() {
+    m_offsets.push_back(static_cast<uint32_t>(m_body.size()));
+    return m_body;
+}
+
+std::string ArchiveWriter::finish() {
+    uint32_t count = static_cast<uint32_t>(m_offsets.size());
+    m_offsets.push_back(static_cast<uint32_t>(m_body.size()));
+
+    BinaryWriter file;
+    file.buffer().reserve(12 + m_offsets.size() * sizeof(uint32_t) + m_body.size());
+    file.put<uint32_t>(Archive::MAGIC);
+    file.put<uint16_t>(Archive::VERSION);
+    file.put<uint16_t>(static_cast<uint16_t>(m_kind));
+    file.put<uint32_t>(count);
+    for (uint32_t offset : m_offsets) {
+        file.put<uint32_t>(offset);
+    }
+    file.buffer() += m_body.buffer();
+    return std::move(file.buffer());
+}
+
+namespace {
+
+template <typename T>
+std::string encodeRecords(const std::vector<T>& records) {
+    ArchiveWriter writer(KindOf<T>::value);
+    for (const auto& record : records) {
+        encode(writer.nextRecord(), record);
+    }
+    return writer.finish();
+}
+
+}  // namespace
+
+std::string encodeArchive(const std::vector<MediaItem>& items) {
+    return encodeRecords(items);
+}
+
+std::string encodeArchive(const std::vector<Hub>& hubs) {
+    return encodeRecords(hubs);
+}
+
+std::string encodeArchive(const std::vector<Library>& libraries) {
+    return encodeRecords(libraries);
+}
+
+std::string encodeArchive(const std::vector<Collection>& collections) {
+    return encodeRecords(collections);
+}
+
+std::string encodeArchive(const std::vector<Playlist>& playlists) {
+    return encodeRecords(playlists);
+}
+
+std::string encodeArchive(const std::vector<CardItem>& cards) {
+    return encodeRecords(cards);
+}
+
+bool Archive::open(std::string_view data) {
+    m_count = 0;
+    BinaryReader r(data);
+    uint32_t magic = 0, count = 0;
+    uint16_t version = 0, kind = 0;
+    if (!r.get(magic) || !r.get(version) || !r.get(kind) || !r.get(count)) return false;
+    if (magic != MAGIC || version != VERSION) return false;
+    if (kind < static_cast<uint16_t>(Kind::MediaItem) || kind > static_cast<uint16_t>(Kind::Section)) return false;
+
+    const size_t headerSize = 12;
+    size_t tableSize = (static_cast<size_t>(count) + 1) * sizeof(uint32_t);
+    if (data.size() - headerSize < tableSize) return false;
+    std::string_view records = data.substr(headerSize + tableSize);
+
+    // Offsets must be ordered and in bounds for record() to skip the checks
+    const char* offsets = data.data() + headerSize;
+    uint32_t previous = 0;
+    for (size_t i = 0; i <= count; i++) {
+        uint32_t offset;
+        memcpy(&offset, offsets + i * sizeof(uint32_t), sizeof(offset));
+        if (offset < previous || offset > records.size()) return false;
+        previous = offset;
+    }
+
+    m_records = records;
+    m_offsets = offsets;
+    m_count = count;
+    m_kind = static_cast<Kind>(kind);
+    return true;
+}
+
+std::string_view Archive::record(size_t index) const {
+    uint32_t range[2];
+    memcpy(range, m_offsets + index * sizeof(uint32_t), sizeof(range));
+    return m_records.substr(range[0], range[1] - range[0]);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#ifdef __SWITCH__
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    bool ok = size >= 0;
+    if (ok) {
+        m_buffer.resize(static_cast<size_t>(size));
+        ok = fread(&m_buffer[0], 1, m_buffer.size(), file) == m_buffer.size();
+    }
+    fclose(file);
+    if (!ok) {
+        m_buffer.clear();
+        return false;
+    }
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    return true;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size == 0) {
+        ::close(fd);
+        m_data = "";
+        return true;
+    }
+    void* map = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        m_size = 0;
+        return false;
+    }
+    m_data = static_cast<const char*>(map);
+    m_mapped = true;
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#ifndef __SWITCH__
+    if (m_mapped) munmap(const_cast<char*>(m_data), m_size);
+#endif
+    m_mapped = false;
+    m_data = nullptr;
+    m_size = 0;
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+}
+
+bool writeArchive(const std::string& path, const std::string& data) {
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!out.good()) return false;
+    }
+    remove(path.c_str());
+    return rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+}  // namespace plex::codec
@@ -1,253 +1,285 @@
 #include "models/plex_types.hpp"
 
+#include <cstdint>
+#include <string_view>
+
 namespace plex {
 
-static std::string safeGetString(const nlohmann::json& j, const std::string& key) {
-    if (!j.contains(key)) return "";
-    const auto& val = j[key];
-    if (val.is_string()) return val.get<std::string>();
-    if (val.is_number_integer()) return std::to_string(val.get<int64_t>());
-    if (val.is_number_float()) return std::to_string(val.get<double>());
-    return "";
+// Mappers walk the object's members once and dispatch each key through a
+// switch on its hash, instead of searching the object for every field.
+// Two fields of one struct hashing alike would be duplicate case labels,
+// so the hash is collision-free over the known keys by construction; the
+// full name is still compared so unknown keys that collide are skipped.
+static constexpr uint32_t fieldHash(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+#define PLEX_FIELD(name) \
+    case fieldHash(name): \
+        if (key != name) break;
+
+static void readString(const nlohmann::json& val, std::string& out) {
+    if (val.is_string()) out = val.get_ref<const std::string&>();
+    else if (val.is_number_integer()) out = std::to_string(val.get<int64_t>());
+    else if (val.is_number_float()) out = std::to_string(val.get<double>());
+    else out.clear();
+}
+
+static void readInt(const nlohmann::json& val, int& out) {
+    out = 0;
+    if (val.is_number_integer()) out = val.get<int>();
+    else if (val.is_string()) {
+        try { out = std::stoi(val.get_ref<const std::string&>()); }
+        catch (...) { out = 0; }
+    }
 }
 
-static int safeGetInt(const nlohmann::json& j, const std::string& key) {
-    if (!j.contains(key)) return 0;
-    const auto& val = j[key];
-    if (val.is_number_integer()) return val.get<int>();
-    if (val.is_string()) {
-        try { return std::stoi(val.get<std::string>()); }
-        catch (...) { return 0; }
+static void readBool(const nlohmann::json& val, bool& out) {
+    out = false;
+    if (val.is_boolean()) out = val.get<bool>();
+    else if (val.is_number_integer()) out = val.get<int>() != 0;
+    else if (val.is_string()) {
+        const std::string& s = val.get_ref<const std::string&>();
+        out = s == "1" || s == "true";
     }
-    return 0;
 }
 
-static bool safeGetBool(const nlohmann::json& j, const std::string& key) {
-    if (!j.contains(key)) return false;
-    const auto& val = j[key];
-    if (val.is_boolean()) return val.get<bool>();
-    if (val.is_number_integer()) return val.get<int>() != 0;
-    if (val.is_string()) return val.get<std::string>() == "1" || val.get<std::string>() == "true";
-    return false;
+static void readDouble(const nlohmann::json& val, double& out) {
+    out = 0.0;
+    if (val.is_number()) out = val.get<double>();
+    else if (val.is_string()) {
+        try { out = std::stod(val.get_ref<const std::string&>()); }
+        catch (...) { out = 0.0; }
+    }
 }
 
-static double safeGetDouble(const nlohmann::json& j, const std::string& key) {
-    if (!j.contains(key)) return 0.0;
-    const auto& val = j[key];
-    if (val.is_number()) return val.get<double>();
-    if (val.is_string()) {
-        try { return std::stod(val.get<std::string>()); }
-        catch (...) { return 0.0; }
+template <typename T>
+static void readList(const nlohmann::json& val, std::vector<T>& out) {
+    out.reserve(out.size() + val.size());
+    for (const auto& element : val) {
+        out.emplace_back();
+        from_json(element, out.back());
     }
-    return 0.0;
 }
 
 void from_json(const nlohmann::json& j, Stream& s) {
-    s.id = safeGetInt(j, "id");
-    s.streamType = safeGetInt(j, "streamType");
-    s.codec = safeGetString(j, "codec");
-    s.language = safeGetString(j, "language");
-    s.languageCode = safeGetString(j, "languageCode");
-    s.displayTitle = safeGetString(j, "displayTitle");
-    s.selected = safeGetBool(j, "selected");
-    s.isDefault = safeGetBool(j, "default");
-    s.decision = safeGetString(j, "decision");
-    s.index = safeGetInt(j, "index");
-    s.channels = safeGetInt(j, "channels");
-    s.bitrate = safeGetInt(j, "bitrate");
-    s.profile = safeGetString(j, "profile");
-    s.audioChannelLayout = safeGetString(j, "audioChannelLayout");
-    s.bitDepth = safeGetInt(j, "bitDepth");
-    s.colorSpace = safeGetString(j, "colorSpace");
-    s.colorRange = safeGetString(j, "colorRange");
-    s.colorPrimaries = safeGetString(j, "colorPrimaries");
-    s.width = safeGetInt(j, "width");
-    s.height = safeGetInt(j, "height");
-    s.frameRate = safeGetDouble(j, "frameRate");
+    s = Stream();
+    if (!j.is_object()) return;
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        const std::string& key = it.key();
+        const nlohmann::json& val = it.value();
+        switch (fieldHash(key)) {
+            PLEX_FIELD("id") readInt(val, s.id); break;
+            PLEX_FIELD("streamType") readInt(val, s.streamType); break;
+            PLEX_FIELD("codec") readString(val, s.codec); break;
+            PLEX_FIELD("language") readString(val, s.language); break;
+            PLEX_FIELD("languageCode") readString(val, s.languageCode); break;
+            PLEX_FIELD("displayTitle") readString(val, s.displayTitle); break;
+            PLEX_FIELD("selected") readBool(val, s.selected); break;
+            PLEX_FIELD("default") readBool(val, s.isDefault); break;
+            PLEX_FIELD("decision") readString(val, s.decision); break;
+            PLEX_FIELD("key") readString(val, s.key); break;
+            PLEX_FIELD("index") readInt(val, s.index); break;
+            PLEX_FIELD("channels") readInt(val, s.channels); break;
+            PLEX_FIELD("bitrate") readInt(val, s.bitrate); break;
+            PLEX_FIELD("profile") readString(val, s.profile); break;
+            PLEX_FIELD("audioChannelLayout") readString(val, s.audioChannelLayout); break;
+            PLEX_FIELD("bitDepth") readInt(val, s.bitDepth); break;
+            PLEX_FIELD("colorSpace") readString(val, s.colorSpace); break;
+            PLEX_FIELD("colorRange") readString(val, s.colorRange); break;
+            PLEX_FIELD("colorPrimaries") readString(val, s.colorPrimaries); break;
+            PLEX_FIELD("width") readInt(val, s.width); break;
+            PLEX_FIELD("height") readInt(val, s.height); break;
+            PLEX_FIELD("frameRate") readDouble(val, s.frameRate); break;
+            default: break;
+        }
+    }
 }
 
 void from_json(const nlohmann::json& j, Part& p) {
-    p.id = safeGetInt(j, "id");
-    p.key = safeGetString(j, "key");
-    if (j.contains("duration")) p.duration = j["duration"].get<int64_t>();
-    p.file = safeGetString(j, "file");
-    if (j.contains("size")) p.size = j["size"].get<int64_t>();
-    p.container = safeGetString(j, "container");
-    p.videoProfile = safeGetString(j, "videoProfile");
-    p.audioProfile = safeGetString(j, "audioProfile");
-    if (j.contains("Stream")) {
-        for (const auto& stream : j["Stream"]) {
-            Stream s;
-            from_json(stream, s);
-            p.streams.push_back(s);
+    p = Part();
+    if (!j.is_object()) return;
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        const std::string& key = it.key();
+        const nlohmann::json& val = it.value();
+        switch (fieldHash(key)) {
+            PLEX_FIELD("id") readInt(val, p.id); break;
+            PLEX_FIELD("key") readString(val, p.key); break;
+            PLEX_FIELD("duration") p.duration = val.get<int64_t>(); break;
+            PLEX_FIELD("file") readString(val, p.file); break;
+            PLEX_FIELD("size") p.size = val.get<int64_t>(); break;
+            PLEX_FIELD("container") readString(val, p.container); break;
+            PLEX_FIELD("videoProfile") readString(val, p.videoProfile); break;
+            PLEX_FIELD("audioProfile") readString(val, p.audioProfile); break;
+            PLEX_FIELD("Stream") readList(val, p.streams); break;
+            default: break;
         }
     }
 }
 
 void from_json(const nlohmann::json& j, Media& m) {
-    m.id = safeGetInt(j, "id");
-    if (j.contains("duration")) m.duration = j["duration"].get<int64_t>();
-    m.bitrate = safeGetInt(j, "bitrate");
-    m.width = safeGetInt(j, "width");
-    m.height = safeGetInt(j, "height");
-    m.aspectRatio = safeGetString(j, "aspectRatio");
-    m.audioChannels = safeGetInt(j, "audioChannels");
-    m.audioCodec = safeGetString(j, "audioCodec");
-    m.videoCodec = safeGetString(j, "videoCodec");
-    m.videoResolution = safeGetString(j, "videoResolution");
-    m.container = safeGetString(j, "container");
-    m.videoFrameRate = safeGetString(j, "videoFrameRate");
-    m.videoProfile = safeGetString(j, "videoProfile");
-    m.audioProfile = safeGetString(j, "audioProfile");
-    m.editionTitle = safeGetString(j, "editionTitle");
-    m.optimizedForStreaming = safeGetBool(j, "optimizedForStreaming");
-    if (j.contains("Part")) {
-        for (const auto& part : j["Part"]) {
-            Part p;
-            from_json(part, p);
-            m.parts.push_back(p);
+    m = Media();
+    if (!j.is_object()) return;
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        const std::string& key = it.key();
+        const nlohmann::json& val = it.value();
+        switch (fieldHash(key)) {
+            PLEX_FIELD("id") readInt(val, m.id); break;
+            PLEX_FIELD("duration") m.duration = val.get<int64_t>(); break;
+            PLEX_FIELD("bitrate") readInt(val, m.bitrate); break;
+            PLEX_FIELD("width") readInt(val, m.width); break;
+            PLEX_FIELD("height") readInt(val, m.height); break;
+            PLEX_FIELD("aspectRatio") readString(val, m.aspectRatio); break;
+            PLEX_FIELD("audioChannels") readInt(val, m.audioChannels); break;
+            PLEX_FIELD("audioCodec") readString(val, m.audioCodec); break;
+            PLEX_FIELD("videoCodec") readString(val, m.videoCodec); break;
+            PLEX_FIELD("videoResolution") readString(val, m.videoResolution); break;
+            PLEX_FIELD("container") readString(val, m.container); break;
+            PLEX_FIELD("videoFrameRate") readString(val, m.videoFrameRate); break;
+            PLEX_FIELD("videoProfile") readString(val, m.videoProfile); break;
+            PLEX_FIELD("audioProfile") readString(val, m.audioProfile); break;
+            PLEX_FIELD("editionTitle") readString(val, m.editionTitle); break;
+            PLEX_FIELD("optimizedForStreaming") readBool(val, m.optimizedForStreaming); break;
+            PLEX_FIELD("Part") readList(val, m.parts); break;
+            default: break;
         }
     }
 }
 
 void from_json(const nlohmann::json& j, Tag& t) {
-    t.id = safeGetInt(j, "id");
-    t.tag = safeGetString(j, "tag");
-    t.role = safeGetString(j, "role");
-    t.thumb = safeGetString(j, "thumb");
+    t = Tag();
+    if (!j.is_object()) return;
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        const std::string& key = it.key();
+        const nlohmann::json& val = it.value();
+        switch (fieldHash(key)) {
+            PLEX_FIELD("id") readInt(val, t.id); break;
+            PLEX_FIELD("tag") readString(val, t.tag); break;
+            PLEX_FIELD("role") readString(val, t.role); break;
+            PLEX_FIELD("thumb") readString(val, t.thumb); break;
+            default: break;
+        }
+    }
 }
 
 void from_json(const nlohmann::json& j, MediaItem& item) {
-    item.ratingKey = safeGetInt(j, "ratingKey");
-    item.key = safeGetString(j, "key");
-    item.guid = safeGetString(j, "guid");
-    item.type = safeGetString(j, "type");
+    item = MediaItem();
+    if (!j.is_object()) return;
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        const std::string& key = it.key();
+        const nlohmann::json& val = it.value();
+        switch (fieldHash(key)) {
+            PLEX_FIELD("ratingKey") readInt(val, item.ratingKey); break;
+            PLEX_FIELD("key") readString(val, item.key); break;
+            PLEX_FIELD("guid") readString(val, item.guid); break;
+            PLEX_FIELD("type") readString(val, item.type); break;
+            PLEX_FIELD("title") readString(val, item.title); break;
+            PLEX_FIELD("titleSort") readString(val, item.titleSort); break;
+            PLEX_FIELD("editionTitle") readString(val, item.editionTitle); break;
+            PLEX_FIELD("summary") readString(val, item.summary); break;
+            PLEX_FIELD("thumb") readString(val, item.thumb); break;
+            PLEX_FIELD("art") readString(val, item.art); break;
+            PLEX_FIELD("banner") readString(val, item.banner); break;
+            PLEX_FIELD("duration") item.duration = val.get<int64_t>(); break;
+            PLEX_FIELD("addedAt") item.addedAt = val.get<int64_t>(); break;
+            PLEX_FIELD("updatedAt") item.updatedAt = val.get<int64_t>(); break;
+            PLEX_FIELD("year") readInt(val, item.year); break;
+            PLEX_FIELD("contentRating") readString(val, item.contentRating); break;
+            PLEX_FIELD("rating") item.rating = val.get<double>(); break;
+            PLEX_FIELD("audienceRating") item.audienceRating = val.get<double>(); break;
+            PLEX_FIELD("audienceRatingImage") readString(val, item.audienceRatingImage); break;
+            PLEX_FIELD("studio") readString(val, item.studio); break;
+            PLEX_FIELD("tagline") readString(val, item.tagline); break;
+            PLEX_FIELD("originalTitle") readString(val, item.originalTitle); break;
+            PLEX_FIELD("originallyAvailableAt") readString(val, item.originallyAvailableAt); break;
+            PLEX_FIELD("viewOffset") item.viewOffset = val.get<int64_t>(); break;
+            PLEX_FIELD("viewCount") readInt(val, item.viewCount); break;
+            PLEX_FIELD("lastViewedAt") item.lastViewedAt = val.get<int64_t>(); break;
+            PLEX_FIELD("parentRatingKey") readInt(val, item.parentRatingKey); break;
+            PLEX_FIELD("grandparentRatingKey") readInt(val, item.grandparentRatingKey); break;
+            PLEX_FIELD("index") readInt(val, item.index); break;
+            PLEX_FIELD("parentIndex") readInt(val, item.parentIndex); break;
+            PLEX_FIELD("grandparentTitle") readString(val, item.grandparentTitle); break;
+            PLEX_FIELD("parentTitle") readString(val, item.parentTitle); break;
+            PLEX_FIELD("grandparentThumb") readString(val, item.grandparentThumb); break;
+            PLEX_FIELD("parentThumb") readString(val, item.parentThumb); break;
+            PLEX_FIELD("leafCount") readInt(val, item.leafCount); break;
+            PLEX_FIELD("viewedLeafCount") readInt(val, item.viewedLeafCount); break;
+            PLEX_FIELD("childCount") readInt(val, item.childCount); break;
+            PLEX_FIELD("librarySectionID") readInt(val, item.librarySectionId); break;
+            PLEX_FIELD("Media") readList(val, item.media); break;
+            PLEX_FIELD("Genre") readList(val, item.genres); break;
+            PLEX_FIELD("Country") readList(val, item.countries); break;
+            PLEX_FIELD("Director") readList(val, item.directors); break;
+            PLEX_FIELD("Writer") readList(val, item.writers); break;
+            PLEX_FIELD("Role") readList(val, item.cast); break;
+            default: break;
+        }
+    }
 
     if (item.type == "movie") item.mediaType = MediaType::Movie;
     else if (item.type == "show") item.mediaType = MediaType::Show;
     else if (item.type == "season") item.mediaType = MediaType::Season;
     else if (item.type == "episode") item.mediaType = MediaType::Episode;
     else if (item.type == "person") item.mediaType = MediaType::Person;
-
-    item.title = safeGetString(j, "title");
-    item.titleSort = safeGetString(j, "titleSort");
-    item.editionTitle = safeGetString(j, "editionTitle");
-    item.summary = safeGetString(j, "summary");
-    item.thumb = safeGetString(j, "thumb");
-    item.art = safeGetString(j, "art");
-    item.banner = safeGetString(j, "banner");
-    if (j.contains("duration")) item.duration = j["duration"].get<int64_t>();
-    if (j.contains("addedAt")) item.addedAt = j["addedAt"].get<int64_t>();
-    if (j.contains("updatedAt")) item.updatedAt = j["updatedAt"].get<int64_t>();
-    item.year = safeGetInt(j, "year");
-    item.contentRating = safeGetString(j, "contentRating");
-    if (j.contains("rating")) item.rating = j["rating"].get<double>();
-    if (j.contains("audienceRating")) item.audienceRating = j["audienceRating"].get<double>();
-    item.audienceRatingImage = safeGetString(j, "audienceRatingImage");
-    item.studio = safeGetString(j, "studio");
-    item.tagline = safeGetString(j, "tagline");
-    item.originalTitle = safeGetString(j, "originalTitle");
-    item.originallyAvailableAt = safeGetString(j, "originallyAvailableAt");
-
-    if (j.contains("viewOffset")) item.viewOffset = j["viewOffset"].get<int64_t>();
-    item.viewCount = safeGetInt(j, "viewCount");
-    if (j.contains("lastViewedAt")) item.lastViewedAt = j["lastViewedAt"].get<int64_t>();
-
-    item.parentRatingKey = safeGetInt(j, "parentRatingKey");
-    item.grandparentRatingKey = safeGetInt(j, "grandparentRatingKey");
-    item.index = safeGetInt(j, "index");
-    item.parentIndex = safeGetInt(j, "parentIndex");
-    item.grandparentTitle = safeGetString(j, "grandparentTitle");
-    item.parentTitle = safeGetString(j, "parentTitle");
-    item.grandparentThumb = safeGetString(j, "grandparentThumb");
-    item.parentThumb = safeGetString(j, "parentThumb");
-
-    item.leafCount = safeGetInt(j, "leafCount");
-    item.viewedLeafCount = safeGetInt(j, "viewedLeafCount");
-    item.childCount = safeGetInt(j, "childCount");
-    item.librarySectionId = safeGetInt(j, "librarySectionID");
-
-    if (j.contains("Media")) {
-        for (const auto& media : j["Media"]) {
-            Media m;
-            from_json(media, m);
-            item.media.push_back(m);
-        }
-    }
-
-    if (j.contains("Genre")) {
-        for (const auto& tag : j["Genre"]) {
-            Tag t;
-            from_json(tag, t);
-            item.genres.push_back(t);
-        }
-    }
-
-    if (j.contains("Country")) {
-        for (const auto& tag : j["Country"]) {
-            Tag t;
-            from_json(tag, t);
-            item.countries.push_back(t);
-        }
-    }
-
-    if (j.contains("Director")) {
-        for (const auto& tag : j["Director"]) {
-            Tag t;
-            from_json(tag, t);
-            item.directors.push_back(t);
-        }
-    }
-
-    if (j.contains("Writer")) {
-        for (const auto& tag : j["Writer"]) {
-            Tag t;
-            from_json(tag, t);
-            item.writers.push_back(t);
-        }
-    }
-
-    if (j.contains("Role")) {
-        for (const auto& tag : j["Role"]) {
-            Tag t;
-            from_json(tag, t);
-            item.cast.push_back(t);
-        }
-    }
 }
 
 void from_json(const nlohmann::json& j, Library& lib) {
-    lib.key = safeGetInt(j, "key");
-    lib.uuid = safeGetString(j, "uuid");
-    lib.type = safeGetString(j, "type");
-    lib.title = safeGetString(j, "title");
-    lib.art = safeGetString(j, "art");
-    lib.thumb = safeGetString(j, "thumb");
-    lib.composite = safeGetString(j, "composite");
-    lib.allowSync = safeGetBool(j, "allowSync");
-    if (j.contains("updatedAt")) lib.updatedAt = j["updatedAt"].get<int64_t>();
-    if (j.contains("scannedAt")) lib.scannedAt = j["scannedAt"].get<int64_t>();
+    lib = Library();
+    if (!j.is_object()) return;
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        const std::string& key = it.key();
+        const nlohmann::json& val = it.value();
+        switch (fieldHash(key)) {
+            PLEX_FIELD("key") readInt(val, lib.key); break;
+            PLEX_FIELD("uuid") readString(val, lib.uuid); break;
+            PLEX_FIELD("type") readString(val, lib.type); break;
+            PLEX_FIELD("title") readString(val, lib.title); break;
+            PLEX_FIELD("art") readString(val, lib.art); break;
+            PLEX_FIELD("thumb") readString(val, lib.thumb); break;
+            PLEX_FIELD("composite") readString(val, lib.composite); break;
+            PLEX_FIELD("allowSync") readBool(val, lib.allowSync); break;
+            PLEX_FIELD("updatedAt") lib.updatedAt = val.get<int64_t>(); break;
+            PLEX_FIELD("scannedAt") lib.scannedAt = val.get<int64_t>(); break;
+            default: break;
+        }
+    }
 }
 
 void from_json(const nlohmann::json& j, Hub& hub) {
-    hub.hubKey = safeGetString(j, "hubKey");
-    hub.key = safeGetString(j, "key");
-    hub.title = safeGetString(j, "title");
-    hub.type = safeGetString(j, "type");
-    hub.hubIdentifier = safeGetString(j, "hubIdentifier");
-    hub.context = safeGetString(j, "context");
-    hub.size = safeGetInt(j, "size");
-    hub.more = safeGetBool(j, "more");
-    hub.style = safeGetString(j, "style");
-    hub.promoted = safeGetBool(j, "promoted");
-    if (j.contains("Metadata")) {
-        for (const auto& item : j["Metadata"]) {
-            MediaItem m;
-            from_json(item, m);
-            hub.items.push_back(m);
+    hub = Hub();
+    if (!j.is_object()) return;
+
+    // Directory entries are typed by hubIdentifier, which may come later
+    const nlohmann::json* metadata = nullptr;
+    const nlohmann::json* directories = nullptr;
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        const std::string& key = it.key();
+        const nlohmann::json& val = it.value();
+        switch (fieldHash(key)) {
+            PLEX_FIELD("hubKey") readString(val, hub.hubKey); break;
+            PLEX_FIELD("key") readString(val, hub.key); break;
+            PLEX_FIELD("title") readString(val, hub.title); break;
+            PLEX_FIELD("type") readString(val, hub.type); break;
+            PLEX_FIELD("hubIdentifier") readString(val, hub.hubIdentifier); break;
+            PLEX_FIELD("context") readString(val, hub.context); break;
+            PLEX_FIELD("size") readInt(val, hub.size); break;
+            PLEX_FIELD("more") readBool(val, hub.more); break;
+            PLEX_FIELD("style") readString(val, hub.style); break;
+            PLEX_FIELD("promoted") readBool(val, hub.promoted); break;
+            PLEX_FIELD("Metadata") metadata = &val; break;
+            PLEX_FIELD("Directory") directories = &val; break;
+            default: break;
         }
     }
-    if (j.contains("Directory")) {
+
+    if (metadata) readList(*metadata, hub.items);
+    if (directories) {
         MediaType dirType = MediaType::Person;
         std::string dirTypeStr = "person";
 
@@ -262,48 +294,77 @@ void from_json(const nlohmann::json& j, Hub& hub) {
             dirTypeStr = "writer";
         }
 
-        for (const auto& dir : j["Directory"]) {
-            MediaItem m;
-            m.ratingKey = safeGetInt(dir, "id");
-            m.title = safeGetString(dir, "tag");
-            m.thumb = safeGetString(dir, "thumb");
+        hub.items.reserve(hub.items.size() + directories->size());
+        for (const auto& dir : *directories) {
+            hub.items.emplace_back();
+            MediaItem& m = hub.items.back();
             m.type = dirTypeStr;
             m.mediaType = dirType;
-            m.librarySectionId = safeGetInt(dir, "librarySectionID");
-            hub.items.push_back(m);
+            if (!dir.is_object()) continue;
+            for (auto it = dir.begin(); it != dir.end(); ++it) {
+                const std::string& key = it.key();
+                const nlohmann::json& val = it.value();
+                switch (fieldHash(key)) {
+                    PLEX_FIELD("id") readInt(val, m.ratingKey); break;
+                    PLEX_FIELD("tag") readString(val, m.title); break;
+                    PLEX_FIELD("thumb") readString(val, m.thumb); break;
+                    PLEX_FIELD("librarySectionID") readInt(val, m.librarySectionId); break;
+                    default: break;
+                }
+            }
         }
     }
 }
 
 void from_json(const nlohmann::json& j, Collection& col) {
-    col.ratingKey = safeGetInt(j, "ratingKey");
-    col.key = safeGetString(j, "key");
-    col.guid = safeGetString(j, "guid");
-    col.type = safeGetString(j, "type");
-    col.title = safeGetString(j, "title");
-    col.summary = safeGetString(j, "summary");
-    col.thumb = safeGetString(j, "thumb");
-    col.art = safeGetString(j, "art");
-    col.childCount = safeGetInt(j, "childCount");
-    if (j.contains("addedAt")) col.addedAt = j["addedAt"].get<int64_t>();
-    if (j.contains("updatedAt")) col.updatedAt = j["updatedAt"].get<int64_t>();
+    col = Collection();
+    if (!j.is_object()) return;
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        const std::string& key = it.key();
+        const nlohmann::json& val = it.value();
+        switch (fieldHash(key)) {
+            PLEX_FIELD("ratingKey") readInt(val, col.ratingKey); break;
+            PLEX_FIELD("key") readString(val, col.key); break;
+            PLEX_FIELD("guid") readString(val, col.guid); break;
+            PLEX_FIELD("type") readString(val, col.type); break;
+            PLEX_FIELD("title") readString(val, col.title); break;
+            PLEX_FIELD("summary") readString(val, col.summary); break;
+            PLEX_FIELD("thumb") readString(val, col.thumb); break;
+            PLEX_FIELD("art") readString(val, col.art); break;
+            PLEX_FIELD("childCount") readInt(val, col.childCount); break;
+            PLEX_FIELD("addedAt") col.addedAt = val.get<int64_t>(); break;
+            PLEX_FIELD("updatedAt") col.updatedAt = val.get<int64_t>(); break;
+            default: break;
+        }
+    }
 }
 
 void from_json(const nlohmann::json& j, Playlist& pl) {
-    pl.ratingKey = safeGetInt(j, "ratingKey");
-    pl.key = safeGetString(j, "key");
-    pl.guid = safeGetString(j, "guid");
-    pl.type = safeGetString(j, "type");
-    pl.title = safeGetString(j, "title");
-    pl.summary = safeGetString(j, "summary");
-    pl.thumb = safeGetString(j, "thumb");
-    pl.composite = safeGetString(j, "composite");
-    pl.leafCount = safeGetInt(j, "leafCount");
-    if (j.contains("duration")) pl.duration = j["duration"].get<int64_t>();
-    pl.smart = safeGetBool(j, "smart");
-    pl.playlistType = safeGetString(j, "playlistType");
-    if (j.contains("addedAt")) pl.addedAt = j["addedAt"].get<int64_t>();
-    if (j.contains("updatedAt")) pl.updatedAt = j["updatedAt"].get<int64_t>();
+    pl = Playlist();
+    if (!j.is_object()) return;
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        const std::string& key = it.key();
+        const nlohmann::json& val = it.value();
+        switch (fieldHash(key)) {
+            PLEX_FIELD("ratingKey") readInt(val, pl.ratingKey); break;
+            PLEX_FIELD("key") readString(val, pl.key); break;
+            PLEX_FIELD("guid") readString(val, pl.guid); break;
+            PLEX_FIELD("type") readString(val, pl.type); break;
+            PLEX_FIELD("title") readString(val, pl.title); break;
+            PLEX_FIELD("summary") readString(val, pl.summary); break;
+            PLEX_FIELD("thumb") readString(val, pl.thumb); break;
+            PLEX_FIELD("composite") readString(val, pl.composite); break;
+            PLEX_FIELD("leafCount") readInt(val, pl.leafCount); break;
+            PLEX_FIELD("duration") pl.duration = val.get<int64_t>(); break;
+            PLEX_FIELD("smart") readBool(val, pl.smart); break;
+            PLEX_FIELD("playlistType") readString(val, pl.playlistType); break;
+            PLEX_FIELD("addedAt") pl.addedAt = val.get<int64_t>(); break;
+            PLEX_FIELD("updatedAt") pl.updatedAt = val.get<int64_t>(); break;
+            default: break;
+        }
+    }
 }
 
+#undef PLEX_FIELD
+
 }
@@ -0,0 +1,436 @@
+#include "models/schema_runtime.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+
+namespace plex::schema {
+
+void Arena::reset() {
+    if (m_blocks.size() > 1) m_blocks.erase(m_blocks.begin() + 1, m_blocks.end());
+    m_used = 0;
+}
+
+size_t Arena::capacity() const {
+    size_t total = 0;
+    for (const auto& block : m_blocks) total += block.size;
+    return total;
+}
+
+void* Arena::allocateBytes(size_t size, size_t align) {
+    if (!m_blocks.empty()) {
+        size_t start = (m_used + align - 1) & ~(align - 1);
+        if (start + size <= m_blocks.back().size) {
+            m_used = start + size;
+            return m_blocks.back().data.get() + start;
+        }
+    }
+    // new[] storage is aligned for any fundamental type
+    size_t blockSize = std::max(BLOCK_SIZE, size);
+    m_blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[blockSize]), blockSize});
+    m_used = size;
+    return m_blocks.back().data.get();
+}
+
+void Reader::fail(const char* message) {
+    if (!m_error) m_error = message;
+}
+
+bool Reader::consumeNull() {
+    if (peek() != 'n') return false;
+    return skipLiteral("null", 4);
+}
+
+bool Reader::skipLiteral(const char* literal, size_t length) {
+    if (static_cast<size_t>(m_end - m_pos) < length || memcmp(m_pos, literal, length) != 0) {
+        fail("invalid literal");
+        return false;
+    }
+    m_pos += length;
+    return true;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool readHex4(const char* p, uint32_t& out) {
+    out = 0;
+    for (int i = 0; i < 4; i++) {
+        int v = hexValue(p[i]);
+        if (v < 0) return false;
+        out = (out << 4) | static_cast<uint32_t>(v);
+    }
+    return true;
+}
+
+static char* writeUtf8(char* w, uint32_t cp) {
+    if (cp < 0x80) {
+        *w++ = static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        *w++ = static_cast<char>(0xC0 | (cp >> 6));
+        *w++ = static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        *w++ = static_cast<char>(0xE0 | (cp >> 12));
+        *w++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *w++ = static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        *w++ = static_cast<char>(0xF0 | (cp >> 18));
+        *w++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        *w++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        *w++ = static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    return w;
+}
+
+bool Reader::readString(std::string_view& out) {
+    if (!consume('"')) {
+        fail("expected string");
+        return false;
+    }
+    char* start = m_pos;
+
+    // Fast path: no escapes, the view is the raw bytes
+    char* p = m_pos;
+    while (p < m_end && *p != '"' && *p != '\\') p++;
+    if (p < m_end && *p == '"') {
+        out = std::string_view(start, static_cast<size_t>(p - start));
+        m_pos = p + 1;
+        return true;
+    }
+
+    // Unescape in place; the output never outruns the input
+    char* w = p;
+    while (p < m_end && *p != '"') {
+        if (*p != '\\') {
+            *w++ = *p++;
+            continue;
+        }
+        if (++p >= m_end) break;
+        switch (*p++) {
+            case '"': *w++ = '"'; break;
+            case '\\': *w++ = '\\'; break;
+            case '/': *w++ = '/'; break;
+            case 'b': *w++ = '\b'; break;
+            case 'f': *w++ = '\f'; break;
+            case 'n': *w++ = '\n'; break;
+            case 'r': *w++ = '\r'; break;
+            case 't': *w++ = '\t'; break;
+            case 'u': {
+                uint32_t cp;
+                if (m_end - p < 4 || !readHex4(p, cp)) {
+                    fail("invalid \\u escape");
+                    return false;
+                }
+                p += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF && m_end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                    uint32_t low;
+                    if (readHex4(p + 2, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        p += 6;
+                    }
+                }
+                w = writeUtf8(w, cp);
+                break;
+            }
+            default:
+                fail("invalid escape");
+                return false;
+        }
+    }
+    if (p >= m_end) {
+        fail("unterminated string");
+        return false;
+    }
+    out = std::string_view(start, static_cast<size_t>(w - start));
+    m_pos = p + 1;
+    return true;
+}
+
+bool Reader::skipString() {
+    m_pos++;  // opening quote
+    while (m_pos < m_end && *m_pos != '"') {
+        if (*m_pos == '\\') m_pos++;
+        m_pos++;
+    }
+    if (m_pos >= m_end) {
+        fail("unterminated string");
+        return false;
+    }
+    m_pos++;
+    return true;
+}
+
+bool Reader::readNumberToken(std::string_view& token, bool& integer) {
+    char* start = m_pos;
+    char* p = m_pos;
+    integer = true;
+    if (p < m_end && *p == '-') p++;
+    char* digits = p;
+    while (p < m_end && *p >= '0' && *p <= '9') p++;
+    if (p == digits) {
+        fail("invalid number");
+        return false;
+    }
+    if (p < m_end && *p == '.') {
+        integer = false;
+        p++;
+        while (p < m_end && *p >= '0' && *p <= '9') p++;
+    }
+    if (p < m_end && (*p == 'e' || *p == 'E')) {
+        integer = false;
+        p++;
+        if (p < m_end && (*p == '+' || *p == '-')) p++;
+        while (p < m_end && *p >= '0' && *p <= '9') p++;
+    }
+    token = std::string_view(start, static_cast<size_t>(p - start));
+    m_pos = p;
+    return true;
+}
+
+bool Reader::skipArray() {
+    m_pos++;
+    if (++m_nesting > MAX_NESTING) {
+        fail("nesting too deep");
+        return false;
+    }
+    if (!consume(']')) {
+        while (true) {
+            if (!skipValue()) return false;
+            if (consume(',')) continue;
+            if (consume(']')) break;
+            fail("expected ',' or ']'");
+            return false;
+        }
+    }
+    m_nesting--;
+    return true;
+}
+
+bool Reader::skipValue() {
+    char c = peek();
+    switch (c) {
+        case '"':
+            return skipString();
+        case '{':
+            return readObject([this](std::string_view) { return skipValue(); }) != Read::Error;
+        case '[':
+            return skipArray();
+        case 't':
+            return skipLiteral("true", 4);
+        case 'f':
+            return skipLiteral("false", 5);
+        case 'n':
+            return skipLiteral("null", 4);
+        default: {
+            std::string_view token;
+            bool integer;
+            return readNumberToken(token, integer);
+        }
+    }
+}
+
+static bool parseInteger(std::string_view text, int64_t& out) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), out);
+    return result.ec == std::errc();
+}
+
+static bool isNumberStart(char c) {
+    return c == '-' || (c >= '0' && c <= '9');
+}
+
+static Read skipped(bool ok) {
+    return ok ? Read::Skipped : Read::Error;
+}
+
+Read Reader::readText(std::string_view& out) {
+    char c = peek();
+    if (c == '"') return readString(out) ? Read::Value : Read::Error;
+    // Numbers keep their text rather than being reformatted
+    if (isNumberStart(c)) {
+        bool integer;
+        return readNumberToken(out, integer) ? Read::Value : Read::Error;
+    }
+    return skipped(skipValue());
+}
+
+Read Reader::readInt(int64_t& out) {
+    char c = peek();
+    if (c == '"') {
+        std::string_view text;
+        if (!readString(text)) return Read::Error;
+        // Like std::stoll: leading digits count, anything else is 0
+        if (!parseInteger(text, out)) out = 0;
+        return Read::Value;
+    }
+    if (isNumberStart(c)) {
+        std::string_view token;
+        bool integer;
+        if (!readNumberToken(token, integer)) return Read::Error;
+        if (!integer) {
+            out = static_cast<int64_t>(strtod(token.data(), nullptr));
+        } else if (!parseInteger(token, out)) {
+            out = 0;
+        }
+        return Read::Value;
+    }
+    return skipped(skipValue());
+}
+
+Read Reader::readInt(int32_t& out) {
+    // Fractions read as 0, as safeGetInt does
+    if (isNumberStart(peek())) {
+        std::string_view token;
+        bool integer;
+        if (!readNumberToken(token, integer)) return Read::Error;
+        int64_t value = 0;
+        if (integer) parseInteger(token, value);
+        out = static_cast<int32_t>(value);
+        return Read::Value;
+    }
+    int64_t value = 0;
+    Read result = readInt(value);
+    if (result == Read::Value) out = static_cast<int32_t>(value);
+    return result;
+}
+
+Read Reader::readDouble(double& out) {
+    char c = peek();
+    if (c == '"') {
+        std::string_view text;
+        if (!readString(text)) return Read::Error;
+        // The view is not terminated; numeric strings are short
+        char buffer[64];
+        size_t length = std::min(text.size(), sizeof(buffer) - 1);
+        memcpy(buffer, text.data(), length);
+        buffer[length] = '\0';
+        out = strtod(buffer, nullptr);
+        return Read::Value;
+    }
+    if (isNumberStart(c)) {
+        std::string_view token;
+        bool integer;
+        if (!readNumberToken(token, integer)) return Read::Error;
+        // The token is followed by a delimiter, so strtod stops at its end
+        out = strtod(token.data(), nullptr);
+        return Read::Value;
+    }
+    return skipped(skipValue());
+}
+
+Read Reader::readBool(bool& out) {
+    char c = peek();
+    if (c == 't' || c == 'f') {
+        out = c == 't';
+        return (out ? skipLiteral("true", 4) : skipLiteral("false", 5)) ? Read::Value : Read::Error;
+    }
+    if (c == '"') {
+        std::string_view text;
+        if (!readString(text)) return Read::Error;
+        out = text == "1" || text == "true";
+        return Read::Value;
+    }
+    if (isNumberStart(c)) {
+        std::string_view token;
+        bool integer;
+        if (!readNumberToken(token, integer)) return Read::Error;
+        int64_t value = 0;
+        if (integer) parseInteger(token, value);
+        out = value != 0;
+        return Read::Value;
+    }
+    return skipped(skipValue());
+}
+
+void Writer::separate() {
+    if (m_afterKey) {
+        m_afterKey = false;
+        return;
+    }
+    uint64_t bit = uint64_t(1) << m_depth;
+    if (m_first & bit) {
+        m_first &= ~bit;
+    } else {
+        m_out += ',';
+    }
+}
+
+void Writer::beginObject() {
+    separate();
+    m_out += '{';
+    m_depth++;
+    m_first |= uint64_t(1) << m_depth;
+}
+
+void Writer::endObject() {
+    m_depth--;
+    m_out += '}';
+}
+
+void Writer::beginArray() {
+    separate();
+    m_out += '[';
+    m_depth++;
+    m_first |= uint64_t(1) << m_depth;
+}
+
+void Writer::endArray() {
+    m_depth--;
+    m_out += ']';
+}
+
+void Writer::key(std::string_view name) {
+    value(name);
+    m_out += ':';
+    m_afterKey = true;
+}
+
+void Writer::value(std::string_view text) {
+    separate();
+    m_out += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': m_out += "\\\""; break;
+            case '\\': m_out += "\\\\"; break;
+            case '\n': m_out += "\\n"; break;
+            case '\r': m_out += "\\r"; break;
+            case '\t': m_out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    m_out += buf;
+                } else {
+                    m_out += c;
+                }
+        }
+    }
+    m_out += '"';
+}
+
+void Writer::value(int64_t number) {
+    separate();
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), number);
+    m_out.append(buf, result.ptr);
+}
+
+void Writer::value(double number) {
+    separate();
+    // Shortest of the two spellings that reads back to the same value
+    char buf[32];
+    int length = snprintf(buf, sizeof(buf), "%.15g", number);
+    if (strtod(buf, nullptr) != number) length = snprintf(buf, sizeof(buf), "%.17g", number);
+    m_out.append(buf, static_cast<size_t>(length));
+}
+
+void Writer::value(bool flag) {
+    separate();
+    m_out += flag ? "true" : "false";
+}
+
+}  // namespace plex::schema
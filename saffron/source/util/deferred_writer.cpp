@@ -0,0 +1,51 @@
+#include "util/deferred_writer.hpp"
+#include "util/log.hpp"
+
+#include <borealis.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sys/stat.h>
+
+void DeferredWriter::write(const std::string& path, std::string data) {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_queue[path] = std::move(data);
+    }
+    brls::async([this]() { flush(); });
+}
+
+bool DeferredWriter::flush() {
+    std::lock_guard<std::mutex> writeLock(m_writeMutex);
+
+    std::map<std::string, std::string> queued;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        queued.swap(m_queue);
+    }
+
+    bool ok = true;
+    for (const auto& [path, data] : queued) {
+        if (!writeFile(path, data)) {
+            LOGE("DeferredWriter: Failed to write {}", path);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool DeferredWriter::writeFile(const std::string& path, const std::string& data) {
+    size_t slash = path.rfind('/');
+    if (slash != std::string::npos) {
+        mkdir(path.substr(0, slash).c_str(), 0755);
+    }
+
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!out.good()) return false;
+    }
+    std::remove(path.c_str());
+    return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
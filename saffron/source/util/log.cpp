@@ -0,0 +1,99 @@
+#include "util/log.hpp"
+
+#include <chrono>
+
+AsyncLog* AsyncLog::getInstance() {
+    static AsyncLog instance;
+    return &instance;
+}
+
+AsyncLog::AsyncLog() {
+    for (size_t i = 0; i < CAPACITY; i++) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    m_thread = std::thread([this]() { run(); });
+}
+
+AsyncLog::~AsyncLog() {
+    shutdown();
+}
+
+void AsyncLog::shutdown() {
+    if (!m_running.exchange(false)) return;
+    m_cv.notify_one();
+    if (m_thread.joinable()) m_thread.join();
+    // Producers that saw the flag still set may hold a claimed slot that is
+    // not committed yet; drain() stops at the first such slot, so wait for
+    // them before the final pass
+    while (m_writers.load() > 0) std::this_thread::yield();
+    drain();
+
+    uint64_t dropped = getDropped();
+    if (dropped > 0) brls::Logger::warning("AsyncLog: {} messages dropped with the ring full", dropped);
+}
+
+char* AsyncLog::claim(size_t& ticket) {
+    size_t pos = m_tail.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = m_slots[pos & (CAPACITY - 1)];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                ticket = pos;
+                return slot.text;
+            }
+        } else if (diff < 0) {
+            // The writer has not freed this slot since the last lap
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            pos = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void AsyncLog::commit(size_t ticket, brls::LogLevel level, size_t length) {
+    Slot& slot = m_slots[ticket & (CAPACITY - 1)];
+    slot.level = level;
+    slot.length = length;
+    slot.text[length] = '\0';
+    slot.sequence.store(ticket + 1, std::memory_order_release);
+
+    // The writer polls while idle as well, so a wakeup lost to this race
+    // only delays the message
+    if (m_waiting.load(std::memory_order_relaxed)) m_cv.notify_one();
+}
+
+bool AsyncLog::drain() {
+    bool wrote = false;
+    while (true) {
+        Slot& slot = m_slots[m_head & (CAPACITY - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != m_head + 1) return wrote;
+        output(slot.level, slot.text);
+        slot.sequence.store(m_head + CAPACITY, std::memory_order_release);
+        m_head++;
+        wrote = true;
+    }
+}
+
+void AsyncLog::run() {
+    while (m_running.load(std::memory_order_acquire)) {
+        if (drain()) continue;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_waiting.store(true, std::memory_order_relaxed);
+        m_cv.wait_for(lock, std::chrono::milliseconds(50));
+        m_waiting.store(false, std::memory_order_relaxed);
+    }
+}
+
+void AsyncLog::output(brls::LogLevel level, const char* text) {
+    switch (level) {
+        case brls::LogLevel::LOG_ERROR: brls::Logger::error("{}", text); break;
+        case brls::LogLevel::LOG_WARNING: brls::Logger::warning("{}", text); break;
+        case brls::LogLevel::LOG_INFO: brls::Logger::info("{}", text); break;
+        case brls::LogLevel::LOG_DEBUG: brls::Logger::debug("{}", text); break;
+        default: brls::Logger::verbose("{}", text); break;
+    }
+}
@@ -1,5 +1,6 @@
 // Ported from Switchfin: https://github.com/dragonflylee/switchfin
 #include "util/overclock.hpp"
+#include "util/log.hpp"
 
 #ifdef __SWITCH__
 
@@ -21,7 +22,7 @@ void SwitchSys::init() {
             stock_gpu_clock = getClock(Module::Gpu);
             stock_emc_clock = getClock(Module::Emc);
             initialized = true;
-            brls::Logger::info("SwitchSys: Initialized (pcv) - CPU: {} MHz, GPU: {} MHz, EMC: {} MHz",
+            LOGI("SwitchSys: Initialized (pcv) - CPU: {} MHz, GPU: {} MHz, EMC: {} MHz",
                 stock_cpu_clock / 1000000, stock_gpu_clock / 1000000, stock_emc_clock / 1000000);
         }
     } else {
@@ -30,7 +31,7 @@ void SwitchSys::init() {
             stock_gpu_clock = getClock(Module::Gpu);
             stock_emc_clock = getClock(Module::Emc);
             initialized = true;
-            brls::Logger::info("SwitchSys: Initialized (clkrst) - CPU: {} MHz, GPU: {} MHz, EMC: {} MHz",
+            LOGI("SwitchSys: Initialized (clkrst) - CPU: {} MHz, GPU: {} MHz, EMC: {} MHz",
                 stock_cpu_clock / 1000000, stock_gpu_clock / 1000000, stock_emc_clock / 1000000);
         }
     }
@@ -50,12 +51,12 @@ void SwitchSys::exit() {
     }
 
     initialized = false;
-    brls::Logger::info("SwitchSys: Exited and restored stock clocks");
+    LOGI("SwitchSys: Exited and restored stock clocks");
 }
 
 void SwitchSys::setClock(bool overclock) {
     if (!initialized) {
-        brls::Logger::warning("SwitchSys: Not initialized, cannot set clock");
+        LOGW("SwitchSys: Not initialized, cannot set clock");
         return;
     }
 
@@ -63,12 +64,12 @@ void SwitchSys::setClock(bool overclock) {
         setClock(Module::Cpu, (int)CPUClock::Max);
         setClock(Module::Gpu, (int)GPUClock::Max);
         setClock(Module::Emc, (int)EMCClock::Max);
-        brls::Logger::info("SwitchSys: Overclock enabled - CPU: 1785 MHz, GPU: 921 MHz, EMC: 1600 MHz");
+        LOGI("SwitchSys: Overclock enabled - CPU: 1785 MHz, GPU: 921 MHz, EMC: 1600 MHz");
     } else if (getClock(Module::Cpu) != getClock(Module::Cpu, true)) {
         setClock(Module::Cpu, (int)CPUClock::Stock);
         setClock(Module::Gpu, (int)GPUClock::Stock);
         setClock(Module::Emc, (int)EMCClock::Stock);
-        brls::Logger::info("SwitchSys: Restored stock clocks - CPU: {} MHz, GPU: {} MHz, EMC: {} MHz",
+        LOGI("SwitchSys: Restored stock clocks - CPU: {} MHz, GPU: {} MHz, EMC: {} MHz",
             stock_cpu_clock / 1000000, stock_gpu_clock / 1000000, stock_emc_clock / 1000000);
     }
 }
@@ -0,0 +1,204 @@
+#include "util/startup_metrics.hpp"
+#include "util/log.hpp"
+
+#include <borealis.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+bool StartupMetrics::s_active = false;
+bool StartupMetrics::s_marked[static_cast<int>(Stage::Count)] = {};
+StartupMetrics::Clock::time_point StartupMetrics::s_marks[static_cast<int>(Stage::Count)];
+bool StartupMetrics::s_directPlay = false;
+std::string StartupMetrics::s_server;
+StartupMetrics::Result StartupMetrics::s_last;
+bool StartupMetrics::s_historyLoaded = false;
+std::vector<StartupMetrics::Record> StartupMetrics::s_history;
+DeferredWriter StartupMetrics::s_writer;
+
+const char* StartupMetrics::stageName(Stage stage) {
+    switch (stage) {
+        case Stage::Begin: return "begin";
+        case Stage::OptionsChecked: return "options";
+        case Stage::QualityChosen: return "menu";
+        case Stage::PlayerOpened: return "open";
+        case Stage::DecisionReady: return "decision";
+        case Stage::LoadFile: return "load";
+        case Stage::FileLoaded: return "demux";
+        case Stage::FirstFrame: return "frame";
+        default: return "unknown";
+    }
+}
+
+void StartupMetrics::begin() {
+    std::fill(std::begin(s_marked), std::end(s_marked), false);
+    s_active = true;
+    s_directPlay = false;
+    s_server.clear();
+    s_marks[static_cast<int>(Stage::Begin)] = Clock::now();
+    s_marked[static_cast<int>(Stage::Begin)] = true;
+}
+
+void StartupMetrics::mark(Stage stage, Clock::time_point at) {
+    int index = static_cast<int>(stage);
+
+    // Players opened without going through Play (or left over from a run
+    // that never got a frame) start their own measurement
+    if (stage == Stage::PlayerOpened && (!s_active || s_marked[index])) {
+        begin();
+        s_marks[static_cast<int>(Stage::Begin)] = at;
+    }
+    if (!s_active || s_marked[index]) return;
+    if (stage == Stage::FirstFrame && !s_marked[static_cast<int>(Stage::FileLoaded)]) return;
+
+    s_marks[index] = at;
+    s_marked[index] = true;
+    if (stage == Stage::FirstFrame) finish();
+}
+
+void StartupMetrics::setRoute(bool directPlay, const std::string& server) {
+    s_directPlay = directPlay;
+    s_server = server;
+}
+
+StartupMetrics::Summary StartupMetrics::getSummary(bool directPlay, const std::string& server) {
+    std::vector<int64_t> totals;
+    for (const auto& record : s_history) {
+        if (record.directPlay == directPlay && record.server == sanitize(server)) totals.push_back(record.totalMs);
+    }
+
+    Summary summary;
+    summary.count = static_cast<int>(totals.size());
+    if (totals.empty()) return summary;
+
+    // Nearest-rank percentiles
+    std::sort(totals.begin(), totals.end());
+    auto rank = [&totals](double p) {
+        size_t n = static_cast<size_t>(std::ceil(p * totals.size()));
+        return totals[std::min(totals.size(), std::max<size_t>(n, 1)) - 1];
+    };
+    summary.p50Ms = rank(0.50);
+    summary.p95Ms = rank(0.95);
+    return summary;
+}
+
+void StartupMetrics::finish() {
+    s_active = false;
+
+    Result result;
+    result.valid = true;
+    result.directPlay = s_directPlay;
+    result.server = s_server;
+
+    Clock::time_point previous = s_marks[static_cast<int>(Stage::Begin)];
+    result.spanMs[static_cast<int>(Stage::Begin)] = 0;
+    for (int i = 1; i < static_cast<int>(Stage::Count); i++) {
+        if (!s_marked[i]) {
+            result.spanMs[i] = -1;
+            continue;
+        }
+        result.spanMs[i] = std::chrono::duration_cast<std::chrono::milliseconds>(s_marks[i] - previous).count();
+        previous = s_marks[i];
+    }
+
+    int64_t menuMs = std::max<int64_t>(0, result.spanMs[static_cast<int>(Stage::QualityChosen)]);
+    result.totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        s_marks[static_cast<int>(Stage::FirstFrame)] - s_marks[static_cast<int>(Stage::Begin)]).count() - menuMs;
+    s_last = result;
+
+    std::string spans;
+    for (int i = 1; i < static_cast<int>(Stage::Count); i++) {
+        if (result.spanMs[i] < 0) continue;
+        spans += fmt::format(" {} {}", stageName(static_cast<Stage>(i)), result.spanMs[i]);
+    }
+    LOGI("StartupMetrics: first frame after {} ms ({} on {}):{}", result.totalMs,
+         result.directPlay ? "direct" : "hls", result.server, spans);
+
+    std::string line = fmt::format("{},{},{},{}", static_cast<long long>(time(nullptr)), sanitize(result.server),
+                                   result.directPlay ? "direct" : "hls", result.totalMs);
+    for (int i = 1; i < static_cast<int>(Stage::Count); i++) {
+        line += "," + std::to_string(result.spanMs[i]);
+    }
+    s_history.push_back({sanitize(result.server), result.directPlay, result.totalMs, line});
+    if (s_history.size() > MAX_HISTORY) s_history.erase(s_history.begin());
+
+    Summary summary = getSummary(result.directPlay, result.server);
+    LOGI("StartupMetrics: p50 {} ms, p95 {} ms over {} runs", summary.p50Ms, summary.p95Ms,
+         summary.count);
+
+    // Until the saved runs are in, a rewrite would drop them; the load
+    // saves once it has merged this run
+    if (s_historyLoaded) saveHistory();
+}
+
+void StartupMetrics::loadHistory() {
+    brls::async([]() {
+        std::vector<Record> saved = readHistory();
+        brls::sync([saved = std::move(saved)]() mutable {
+            bool pending = !s_history.empty();
+            saved.insert(saved.end(), std::make_move_iterator(s_history.begin()),
+                         std::make_move_iterator(s_history.end()));
+            if (saved.size() > MAX_HISTORY) {
+                saved.erase(saved.begin(), saved.end() - MAX_HISTORY);
+            }
+            s_history = std::move(saved);
+            s_historyLoaded = true;
+            if (pending) saveHistory();
+        });
+    });
+}
+
+std::vector<StartupMetrics::Record> StartupMetrics::readHistory() {
+    std::vector<Record> history;
+    FILE* file = fopen(HISTORY_FILE, "r");
+    if (!file) return history;
+
+    char buffer[512];
+    while (fgets(buffer, sizeof(buffer), file)) {
+        buffer[strcspn(buffer, "\r\n")] = '\0';
+        std::string line = buffer;
+
+        // time,server,route,total_ms,...
+        char* fields[4] = {};
+        char* cursor = buffer;
+        int count = 0;
+        while (count < 4 && cursor) {
+            fields[count++] = cursor;
+            cursor = strchr(cursor, ',');
+            if (cursor) *cursor++ = '\0';
+        }
+        if (count < 4 || strcmp(fields[0], "time") == 0) continue;
+
+        history.push_back({fields[1], strcmp(fields[2], "direct") == 0, strtoll(fields[3], nullptr, 10), line});
+    }
+    fclose(file);
+
+    // Files written before the history was trimmed can be much longer
+    if (history.size() > MAX_HISTORY) {
+        history.erase(history.begin(), history.end() - MAX_HISTORY);
+    }
+    return history;
+}
+
+void StartupMetrics::saveHistory() {
+    std::string data = "time,server,route,total_ms";
+    for (int i = 1; i < static_cast<int>(Stage::Count); i++) {
+        data += std::string(",") + stageName(static_cast<Stage>(i)) + "_ms";
+    }
+    data += "\n";
+    for (const auto& record : s_history) {
+        data += record.line + "\n";
+    }
+    s_writer.write(HISTORY_FILE, std::move(data));
+}
+
+std::string StartupMetrics::sanitize(const std::string& value) {
+    std::string result = value;
+    std::replace(result.begin(), result.end(), ',', ' ');
+    std::replace(result.begin(), result.end(), '\n', ' ');
+    return result;
+}
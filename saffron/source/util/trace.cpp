@@ -0,0 +1,230 @@
+#include "util/trace.hpp"
+#include "util/json_escape.hpp"
+#include "util/log.hpp"
+
+#ifdef SAFFRON_TRACE
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <sys/stat.h>
+#include <vector>
+
+namespace trace {
+
+namespace {
+
+struct Event {
+    const char* name = nullptr;
+    uint64_t timeUs = 0;
+    uint64_t durationUs = 0;  // complete events
+    uint64_t flow = 0;        // flow events
+    char phase = 'X';
+};
+
+// Written only by its own thread. head counts every event ever appended;
+// the reader takes the last BUFFER_EVENTS below it and drops any that were
+// overwritten while it copied them.
+struct ThreadBuffer {
+    int tid = 0;
+    std::string name;
+    std::atomic<uint64_t> head{0};
+    Event events[BUFFER_EVENTS];
+};
+
+struct Registry {
+    std::mutex mutex;
+    // Buffers outlive their threads so a dump still shows finished work
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+const std::chrono::steady_clock::time_point s_epoch = std::chrono::steady_clock::now();
+std::atomic<uint64_t> s_nextFlow{1};
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+// Flow of the traced async task running on this thread, 0 outside one
+thread_local uint64_t t_flow = 0;
+
+uint64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_epoch).count();
+}
+
+ThreadBuffer* buffer() {
+    if (!t_buffer) {
+        auto created = std::make_unique<ThreadBuffer>();
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        created->tid = static_cast<int>(reg.buffers.size()) + 1;
+        created->name = "thread " + std::to_string(created->tid);
+        t_buffer = created.get();
+        reg.buffers.push_back(std::move(created));
+    }
+    return t_buffer;
+}
+
+void append(const Event& event) {
+    ThreadBuffer* buf = buffer();
+    uint64_t index = buf->head.load(std::memory_order_relaxed);
+    buf->events[index % BUFFER_EVENTS] = event;
+    buf->head.store(index + 1, std::memory_order_release);
+}
+
+void flowEvent(char phase, const char* name, uint64_t flow) {
+    Event event;
+    event.name = name;
+    event.timeUs = nowUs();
+    event.flow = flow;
+    event.phase = phase;
+    append(event);
+}
+
+// Runs a task under a flow and restores the previous one afterwards
+class FlowContext {
+public:
+    explicit FlowContext(uint64_t flow) : m_previous(t_flow) { t_flow = flow; }
+    ~FlowContext() { t_flow = m_previous; }
+
+private:
+    uint64_t m_previous;
+};
+
+}  // namespace
+
+Scope::Scope(const char* name) : m_name(name), m_startUs(nowUs()) {}
+
+Scope::~Scope() {
+    Event event;
+    event.name = m_name;
+    event.timeUs = m_startUs;
+    event.durationUs = nowUs() - m_startUs;
+    event.phase = 'X';
+    append(event);
+}
+
+void instant(const char* name) {
+    Event event;
+    event.name = name;
+    event.timeUs = nowUs();
+    event.phase = 'i';
+    append(event);
+}
+
+// Flow events attach to the slice around them, so each one is emitted
+// inside a scope of its own
+void async(const char* name, std::function<void()> task, bool dedicated) {
+    uint64_t flow = s_nextFlow.fetch_add(1, std::memory_order_relaxed);
+    {
+        Scope scope(name);
+        flowEvent('s', name, flow);
+    }
+    brls::async([name, flow, task = std::move(task)]() {
+        Scope scope(name);
+        flowEvent('t', name, flow);
+        FlowContext context(flow);
+        task();
+    }, dedicated);
+}
+
+void sync(const char* name, std::function<void()> task) {
+    uint64_t flow = t_flow;
+    if (flow == 0) {
+        flow = s_nextFlow.fetch_add(1, std::memory_order_relaxed);
+        Scope scope(name);
+        flowEvent('s', name, flow);
+    }
+    brls::sync([name, flow, task = std::move(task)]() {
+        Scope scope(name);
+        flowEvent('f', name, flow);
+        task();
+    });
+}
+
+void setThreadName(const char* name) {
+    ThreadBuffer* buf = buffer();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    buf->name = name;
+}
+
+bool dump(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) return false;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool first = true;
+    auto separator = [&]() {
+        const char* s = first ? "\n" : ",\n";
+        first = false;
+        return s;
+    };
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    std::vector<Event> events;
+    for (const auto& buf : reg.buffers) {
+        fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                separator(), buf->tid, escapeJson(buf->name).c_str());
+
+        uint64_t head = buf->head.load(std::memory_order_acquire);
+        uint64_t from = head > BUFFER_EVENTS ? head - BUFFER_EVENTS : 0;
+        events.clear();
+        for (uint64_t i = from; i < head; i++) events.push_back(buf->events[i % BUFFER_EVENTS]);
+
+        // Whatever the owner appended meanwhile has replaced the oldest
+        uint64_t after = buf->head.load(std::memory_order_acquire);
+        uint64_t valid = after > BUFFER_EVENTS ? after - BUFFER_EVENTS : 0;
+        size_t skip = valid > from ? static_cast<size_t>(std::min<uint64_t>(valid - from, events.size())) : 0;
+
+        for (size_t i = skip; i < events.size(); i++) {
+            const Event& e = events[i];
+            std::string name = escapeJson(e.name ? e.name : "");
+            switch (e.phase) {
+                case 'X':
+                    fprintf(file, "%s{\"ph\":\"X\",\"name\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%llu,\"dur\":%llu}",
+                            separator(), name.c_str(), buf->tid, static_cast<unsigned long long>(e.timeUs),
+                            static_cast<unsigned long long>(e.durationUs));
+                    break;
+                case 'i':
+                    fprintf(file, "%s{\"ph\":\"i\",\"s\":\"t\",\"name\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%llu}",
+                            separator(), name.c_str(), buf->tid, static_cast<unsigned long long>(e.timeUs));
+                    break;
+                default:
+                    // The finish binds to the slice it is in rather than the next one
+                    fprintf(file, "%s{\"ph\":\"%c\",\"cat\":\"flow\",\"name\":\"%s\",\"id\":%llu,\"pid\":1,\"tid\":%d,"
+                                  "\"ts\":%llu%s}",
+                            separator(), e.phase, name.c_str(), static_cast<unsigned long long>(e.flow), buf->tid,
+                            static_cast<unsigned long long>(e.timeUs), e.phase == 'f' ? ",\"bp\":\"e\"" : "");
+                    break;
+            }
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
+
+std::string dumpToCard() {
+    mkdir(DUMP_DIR, 0755);
+    char stamp[32];
+    time_t now = time(nullptr);
+    strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", localtime(&now));
+    std::string path = std::string(DUMP_DIR) + "/" + stamp + ".json";
+    if (!dump(path)) {
+        LOGE("Trace: Failed to write {}", path);
+        return "";
+    }
+    LOGI("Trace: Wrote {}", path);
+    return path;
+}
+
+}  // namespace trace
+
+#endif
@@ -22,7 +22,7 @@ RecyclingGridItem* MediaCardDataSource::cellForRow(RecyclingView* recycler, size
 
 void MediaCardDataSource::onItemSelected(brls::Box* recycler, size_t index) {
     if (m_onItemClick && index < m_items.size()) {
-        m_onItemClick(m_items[index]);
+        m_onItemClick(m_items[index]->toMediaItem());
     }
 }
 
@@ -31,14 +31,22 @@ void MediaCardDataSource::clearData() {
 }
 
 void MediaCardDataSource::setData(const std::vector<plex::MediaItem>& items) {
+    m_items = EntityStore::getInstance()->mergeAll(items);
+}
+
+void MediaCardDataSource::setData(const std::vector<EntityRef>& items) {
     m_items = items;
 }
 
 void MediaCardDataSource::appendData(const std::vector<plex::MediaItem>& items) {
+    appendData(EntityStore::getInstance()->mergeAll(items));
+}
+
+void MediaCardDataSource::appendData(const std::vector<EntityRef>& items) {
     m_items.insert(m_items.end(), items.begin(), items.end());
 }
 
-const plex::MediaItem& MediaCardDataSource::getItem(size_t index) const {
+const EntityRef& MediaCardDataSource::getItem(size_t index) const {
     return m_items[index];
 }
 
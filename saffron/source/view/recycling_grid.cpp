@@ -3,6 +3,7 @@
 
 #include <utility>
 #include "view/recycling_grid.hpp"
+#include "util/log.hpp"
 
 RecyclingGridItem::RecyclingGridItem() {
     this->setFocusable(true);
@@ -66,7 +67,7 @@ void RecyclingView::registerCell(std::string identifier, std::function<Recycling
 }
 
 RecyclingGridItem* RecyclingView::dequeueReusableCell(std::string identifier) {
-    brls::Logger::verbose("RecyclingView::dequeueReusableCell: {}", identifier);
+    LOGV("RecyclingView::dequeueReusableCell: {}", identifier);
     RecyclingGridItem* cell = nullptr;
     auto it = queueMap.find(identifier);
 
@@ -116,7 +117,7 @@ RecyclingGridDataSource* RecyclingView::getDataSource() const { return this->dat
 void RecyclingView::showSkeleton(unsigned int num) { this->setDataSource(new DataSourceSkeleton(num)); }
 
 RecyclingGrid::RecyclingGrid() {
-    brls::Logger::debug("View RecyclingGrid: create");
+    LOGD("View RecyclingGrid: create");
 
     this->hintLabel = new brls::Label();
     this->hintLabel->detach();
@@ -163,7 +164,7 @@ RecyclingGrid::RecyclingGrid() {
 }
 
 RecyclingGrid::~RecyclingGrid() {
-    brls::Logger::debug("View RecyclingGrid: delete");
+    LOGD("View RecyclingGrid: delete");
     if (this->hintLabel) this->hintLabel->freeView();
     this->hintLabel = nullptr;
     delete this->dataSource;
@@ -216,7 +217,7 @@ void RecyclingGrid::addCellAt(size_t index, bool downSide) {
             cellHeight = cellHeightCache[index];
         }
 
-        brls::Logger::verbose("Add cell at: y {} height {}", getHeightByCellIndex(index) + paddingTop, cellHeight);
+        LOGV("Add cell at: y {} height {}", getHeightByCellIndex(index) + paddingTop, cellHeight);
     } else {
         cell->setWidth(cellWidth - estimatedRowSpace);
         cellX += (renderedFrame.getWidth() - paddingLeft - paddingRight) / spanCount * (index % spanCount);
@@ -250,7 +251,7 @@ void RecyclingGrid::addCellAt(size_t index, bool downSide) {
     if (isFlowMode)
         contentBox->setHeight(getHeightByCellIndex(this->dataSource->getItemCount()) + paddingTop + paddingBottom);
 
-    brls::Logger::verbose("RecyclingGrid Cell #{} - added", index);
+    LOGV("RecyclingGrid Cell #{} - added", index);
 }
 
 void RecyclingGrid::setDataSource(RecyclingGridDataSource* source) {
@@ -407,7 +408,7 @@ void RecyclingGrid::itemsRecyclingLoop() {
         queueReusableCell(minCell);
         this->removeCell(minCell);
 
-        brls::Logger::verbose("Cell #{} - destroyed", visibleMin);
+        LOGV("Cell #{} - destroyed", visibleMin);
 
         visibleMin++;
     }
@@ -433,7 +434,7 @@ void RecyclingGrid::itemsRecyclingLoop() {
         queueReusableCell(maxCell);
         this->removeCell(maxCell);
 
-        brls::Logger::verbose("Cell #{} - destroyed", visibleMax);
+        LOGV("Cell #{} - destroyed", visibleMax);
 
         visibleMax--;
     }
@@ -461,7 +462,7 @@ void RecyclingGrid::itemsRecyclingLoop() {
     if (visibleMax + 1 >= this->getItemCount()) {
         if (!requestNextPage && nextPageCallback) {
             if (dataSource && !dynamic_cast<DataSourceSkeleton*>(dataSource) && dataSource->getItemCount() > 0) {
-                brls::Logger::debug("RecyclingGrid request next page");
+                LOGD("RecyclingGrid request next page");
                 requestNextPage = true;
                 this->nextPageCallback();
             }
@@ -486,7 +487,7 @@ float RecyclingGrid::getHeightByCellIndex(size_t index, size_t start) {
     if (!isFlowMode) return (estimatedRowHeight + estimatedRowSpace) * (size_t)((index - start) / spanCount);
 
     if (cellHeightCache.size() == 0) {
-        brls::Logger::error("cellHeightCache.size() cannot be zero in flow mode {} {}", start, index);
+        LOGE("cellHeightCache.size() cannot be zero in flow mode {} {}", start, index);
         return 0;
     }
 
@@ -603,7 +604,7 @@ void RecyclingGrid::onLayout() {
     if (!this->contentBox) return;
     this->contentBox->setWidth(width);
     if (checkWidth()) {
-        brls::Logger::debug("RecyclingGrid::onLayout reloadData()");
+        LOGD("RecyclingGrid::onLayout reloadData()");
         layouted = true;
         reloadData();
     }
@@ -615,7 +616,7 @@ bool RecyclingGrid::checkWidth() {
         oldWidth = width;
     }
     if ((int)oldWidth != (int)width && width != 0) {
-        brls::Logger::debug("RecyclingGrid::checkWidth from {} to {}", oldWidth, width);
+        LOGD("RecyclingGrid::checkWidth from {} to {}", oldWidth, width);
         oldWidth = width;
         return true;
     }
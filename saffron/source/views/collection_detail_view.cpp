@@ -7,6 +7,7 @@
 #include "core/plex_server.hpp"
 #include "core/plex_api.hpp"
 #include "util/image_loader.hpp"
+#include "util/log.hpp"
 
 CollectionDetailView* CollectionDetailView::s_instance = nullptr;
 
@@ -158,7 +159,7 @@ void CollectionDetailView::loadCollectionItems() {
         },
         [requestId](const std::string& error) {
             brls::Application::unblockInputs();
-            brls::Logger::error("Failed to load collection items: {}", error);
+            LOGE("Failed to load collection items: {}", error);
             if (s_instance && s_instance->m_requestId == requestId && s_instance->m_isVisible) {
                 s_instance->m_grid->setError(error);
             }
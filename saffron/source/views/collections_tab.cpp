@@ -5,6 +5,7 @@
 #include "core/settings_manager.hpp"
 #include "core/plex_api.hpp"
 #include "util/image_loader.hpp"
+#include "util/log.hpp"
 
 CollectionsTab* CollectionsTab::s_currentInstance = nullptr;
 bool CollectionsTab::s_isActive = false;
@@ -95,14 +96,14 @@ void CollectionsTab::loadCollections() {
                         if (spinnerContainer) spinnerContainer->setVisibility(brls::Visibility::GONE);
                     },
                     [this](const std::string& error) {
-                        brls::Logger::error("Failed to load collections: {}", error);
+                        LOGE("Failed to load collections: {}", error);
                         if (spinnerContainer) spinnerContainer->setVisibility(brls::Visibility::GONE);
                     }
                 );
             }
         },
         [this](const std::string& error) {
-            brls::Logger::error("Failed to load libraries: {}", error);
+            LOGE("Failed to load libraries: {}", error);
             if (spinnerContainer) spinnerContainer->setVisibility(brls::Visibility::GONE);
         }
     );
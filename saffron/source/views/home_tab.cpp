@@ -6,6 +6,7 @@
 #include "core/settings_manager.hpp"
 #include "core/plex_api.hpp"
 #include "util/image_loader.hpp"
+#include "util/log.hpp"
 
 HomeTab* HomeTab::s_currentInstance = nullptr;
 bool HomeTab::s_isActive = false;
@@ -69,7 +70,7 @@ void HomeTab::loadHubs() {
 
     if (spinnerContainer) spinnerContainer->setVisibility(brls::Visibility::VISIBLE);
 
-    brls::Logger::info("Loading hubs from {}", server->getName());
+    LOGI("Loading hubs from {}", server->getName());
 
     PlexApi::getHubs(
         server,
@@ -107,12 +108,12 @@ void HomeTab::loadHubs() {
             }
             if (spinnerContainer) spinnerContainer->setVisibility(brls::Visibility::GONE);
 
-            brls::Logger::info("Loaded {} hubs", m_hubRows.size());
+            LOGI("Loaded {} hubs", m_hubRows.size());
         },
         [this](const std::string& error) {
             if (!s_isActive || s_currentInstance != this) return;
 
-            brls::Logger::error("Failed to load hubs: {}", error);
+            LOGE("Failed to load hubs: {}", error);
             if (emptyMessage) {
                 emptyMessage->setVisibility(brls::Visibility::VISIBLE);
             }
@@ -122,7 +123,7 @@ void HomeTab::loadHubs() {
 }
 
 HubRowView::HubRowView(PlexServer* server, const plex::Hub& hub)
-    : m_server(server), m_hub(hub) {
+    : m_server(server), m_items(EntityStore::getInstance()->mergeAll(hub.items)) {
 
     this->setAxis(brls::Axis::COLUMN);
     this->setWidthPercentage(100);
@@ -162,18 +163,18 @@ void HubRowView::cancelPendingImages() {
 }
 
 void HubRowView::addItems() {
-    for (const auto& item : m_hub.items) {
+    for (const auto& item : m_items) {
         auto* itemView = new HubItemView(m_server, item);
         itemView->setOnClick([this, item]() {
             if (m_onItemClick) {
-                m_onItemClick(item);
+                m_onItemClick(item->toMediaItem());
             }
         });
         m_itemsContainer->addView(itemView);
     }
 }
 
-HubItemView::HubItemView(PlexServer* server, const plex::MediaItem& item)
+HubItemView::HubItemView(PlexServer* server, const EntityRef& item)
     : m_server(server), m_item(item) {
 
     this->setAxis(brls::Axis::COLUMN);
@@ -215,36 +216,42 @@ HubItemView::HubItemView(PlexServer* server, const plex::MediaItem& item)
     m_originalTitleColor = m_titleLabel->getTextColor();
     m_originalSubtitleColor = m_subtitleLabel->getTextColor();
 
+    m_changeSubscription = EntityStore::getInstance()->getChangeEvent()->subscribe([this](int ratingKey) {
+        if (m_item && m_item->ratingKey == ratingKey) {
+            applyItem();
+        }
+    });
+
+    applyItem();
+    loadImage();
+}
+
+HubItemView::~HubItemView() {
+    EntityStore::getInstance()->getChangeEvent()->unsubscribe(m_changeSubscription);
+}
+
+void HubItemView::applyItem() {
+    const plex::CardItem& item = *m_item;
+
     std::string displayTitle = item.title;
     if (!item.editionTitle.empty()) {
-        displayTitle += " (" + item.editionTitle + ")";
+        displayTitle += " (" + item.editionTitle.str() + ")";
     }
     m_titleLabel->setText(displayTitle);
 
     if (item.mediaType == plex::MediaType::Episode) {
-        m_subtitleLabel->setText(item.grandparentTitle);
+        m_subtitleLabel->setText(item.grandparentTitle.str());
     } else if (item.mediaType == plex::MediaType::Movie && item.year > 0) {
         std::string subtitle = std::to_string(item.year);
-        if (!item.media.empty()) {
-            bool has4k = false, has1080 = false, has720 = false;
-            for (const auto& m : item.media) {
-                std::string res = m.videoResolution;
-                if (res == "4k" || res == "4K") has4k = true;
-                else if (res == "1080" || res == "1080p") has1080 = true;
-                else if (res == "720" || res == "720p") has720 = true;
-            }
-            if (has720) subtitle += " • 720p";
-            if (has1080) subtitle += " • 1080p";
-            if (has4k) subtitle += " • 4K";
-        }
+        if (item.resolutions & plex::RESOLUTION_720) subtitle += " • 720p";
+        if (item.resolutions & plex::RESOLUTION_1080) subtitle += " • 1080p";
+        if (item.resolutions & plex::RESOLUTION_4K) subtitle += " • 4K";
         m_subtitleLabel->setText(subtitle);
     } else if (item.mediaType == plex::MediaType::Show) {
         m_subtitleLabel->setText("TV Show");
     } else if (item.mediaType == plex::MediaType::Season) {
-        m_subtitleLabel->setText(item.parentTitle);
+        m_subtitleLabel->setText(item.parentTitle.str());
     }
-
-    loadImage();
 }
 
 void HubItemView::setOnClick(std::function<void()> callback) {
@@ -262,14 +269,8 @@ void HubItemView::cancelPendingImage() {
 void HubItemView::loadImage() {
     if (!m_server) return;
 
-    std::string thumbKey = m_item.thumb;
-    if (thumbKey.empty() && !m_item.grandparentThumb.empty()) {
-        thumbKey = m_item.grandparentThumb;
-    }
-    if (thumbKey.empty() && !m_item.parentThumb.empty()) {
-        thumbKey = m_item.parentThumb;
-    }
-
+    // CardItem already falls back to the show or season poster
+    std::string thumbKey = m_item->thumb;
     if (thumbKey.empty()) return;
 
     std::string url = m_server->getTranscodePictureUrl(thumbKey, 180, 270);
@@ -2,6 +2,7 @@
 #include "views/media_detail_view.hpp"
 #include "core/plex_server.hpp"
 #include "core/plex_api.hpp"
+#include "util/log.hpp"
 
 LibraryBrowseView::LibraryBrowseView(PlexServer* server, const plex::Library& library)
     : m_server(server), m_library(library) {
@@ -63,7 +64,7 @@ void LibraryBrowseView::willAppear(bool resetState) {
 static constexpr int PAGE_SIZE = 30;
 
 void LibraryBrowseView::loadItems() {
-    brls::Logger::info("Loading items from library: {}", m_library.title);
+    LOGI("Loading items from library: {}", m_library.title);
 
     // Set up load-more callback
     m_gridView->setOnLoadMore([this]() {
@@ -76,7 +77,7 @@ void LibraryBrowseView::loadItems() {
         0,
         PAGE_SIZE,
         [this](std::vector<plex::MediaItem> items, int totalSize) {
-            brls::Logger::info("Loaded {} items (total: {})", items.size(), totalSize);
+            LOGI("Loaded {} items (total: {})", items.size(), totalSize);
 
             m_loadingBox->setVisibility(brls::Visibility::GONE);
             m_scrollView->setVisibility(brls::Visibility::VISIBLE);
@@ -85,7 +86,7 @@ void LibraryBrowseView::loadItems() {
             m_gridView->setItems(items);
         },
         [this](const std::string& error) {
-            brls::Logger::error("Failed to load items: {}", error);
+            LOGE("Failed to load items: {}", error);
             brls::Application::notify("Failed to load items");
         }
     );
@@ -93,7 +94,7 @@ void LibraryBrowseView::loadItems() {
 
 void LibraryBrowseView::loadMoreItems() {
     int currentOffset = m_gridView->getLoadedCount();
-    brls::Logger::debug("LibraryBrowseView: Loading more items from offset {}", currentOffset);
+    LOGD("LibraryBrowseView: Loading more items from offset {}", currentOffset);
 
     PlexApi::getLibraryItems(
         m_server,
@@ -101,11 +102,11 @@ void LibraryBrowseView::loadMoreItems() {
         currentOffset,
         PAGE_SIZE,
         [this](std::vector<plex::MediaItem> items, int) {
-            brls::Logger::debug("LibraryBrowseView: Loaded {} more items", items.size());
+            LOGD("LibraryBrowseView: Loaded {} more items", items.size());
             m_gridView->appendItems(items);
         },
         [](const std::string& error) {
-            brls::Logger::error("LibraryBrowseView: Failed to load more items: {}", error);
+            LOGE("LibraryBrowseView: Failed to load more items: {}", error);
         }
     );
 }
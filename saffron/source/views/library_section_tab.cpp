@@ -6,10 +6,15 @@
 #include "view/media_card_data_source.hpp"
 #include "core/plex_server.hpp"
 #include "core/plex_api.hpp"
+#include "core/library_cache.hpp"
+#include "core/search_index.hpp"
+#include "core/library_sync.hpp"
+#include "core/entity_store.hpp"
+#include "util/launch_metrics.hpp"
+#include "util/log.hpp"
 
 LibrarySectionTab* LibrarySectionTab::s_currentInstance = nullptr;
 bool LibrarySectionTab::s_isActive = false;
-std::unordered_map<int, LibraryCacheEntry> LibrarySectionTab::s_cache;
 
 LibrarySectionTab::LibrarySectionTab(PlexServer* server, const plex::Library& library)
     : m_server(server), m_library(library) {
@@ -61,8 +66,13 @@ void LibrarySectionTab::willAppear(bool resetState) {
     s_currentInstance = this;
     s_isActive = true;
 
-    if (s_cache.find(m_library.key) != s_cache.end()) {
-        restoreFromCache();
+    const LibraryCache::Section* cached = LibraryCache::getInstance()->get(m_library.key);
+    if (cached) {
+        // Entries restored from disk render immediately, then get reconciled
+        restoreFromCache(cached->stale);
+        if (LibrarySync::getInstance()->needsSync(m_server, m_library.key)) {
+            startSync();
+        }
     } else {
         loadItems();
     }
@@ -76,19 +86,38 @@ void LibrarySectionTab::willDisappear(bool resetState) {
     if (m_grid) {
         m_grid->cancelAllPendingImages();
     }
+
+    // Serializing the index is a full pass over it, so skip tab switches
+    // that changed nothing
+    LibraryCache::getInstance()->save();
+    SearchIndex* index = SearchIndex::getInstance();
+    if (index->isDirty()) {
+        index->save();
+    }
 }
 
-void LibrarySectionTab::restoreFromCache() {
+void LibrarySectionTab::attachDataSource() {
+    // setDataSource deletes the previous source, so only hand it over once
+    if (m_grid->getDataSource() != m_dataSource) {
+        m_grid->setDataSource(m_dataSource);
+    } else {
+        m_grid->reloadData();
+    }
+}
+
+void LibrarySectionTab::restoreFromCache(bool fromDisk) {
     if (!m_grid || !m_dataSource) return;
 
-    auto& entry = s_cache[m_library.key];
-    brls::Logger::info("LibrarySectionTab: Restoring '{}' from cache ({} items)",
-                       m_library.title, entry.items.size());
+    const LibraryCache::Section* entry = LibraryCache::getInstance()->get(m_library.key);
+    if (!entry) return;
+    LOGI("LibrarySectionTab: Restoring '{}' from {} cache ({} items)",
+         m_library.title, fromDisk ? "disk" : "memory", entry->items.size());
 
-    m_totalItems = entry.totalSize;
-    m_dataSource->setData(entry.items);
-    m_grid->setDataSource(m_dataSource);
+    m_totalItems = entry->totalSize;
+    m_dataSource->setData(entry->items);
+    attachDataSource();
     if (m_spinnerContainer) m_spinnerContainer->setVisibility(brls::Visibility::GONE);
+    LaunchMetrics::markFirstSectionRender(fromDisk ? "disk cache" : "memory cache");
 
     m_grid->onNextPage([this]() {
         if (static_cast<int>(m_dataSource->getItemCount()) < m_totalItems) {
@@ -98,7 +127,38 @@ void LibrarySectionTab::restoreFromCache() {
 }
 
 void LibrarySectionTab::clearCache() {
-    s_cache.clear();
+    LibraryCache::getInstance()->clear();
+}
+
+void LibrarySectionTab::startSync() {
+    if (!m_server) return;
+
+    int libraryKey = m_library.key;
+    std::string title = m_library.title;
+
+    LibrarySync::getInstance()->sync(m_server, libraryKey,
+        [this, libraryKey](const LibrarySync::Result& result) {
+            if (!s_isActive || s_currentInstance != this) return;
+            if (!result.membershipChanged) return;  // merged fields already reached the cells
+
+            const LibraryCache::Section* section = LibraryCache::getInstance()->get(libraryKey);
+            if (!section) return;
+
+            // A full sync only extends the listing we already show, so the
+            // grid can grow without losing its scroll position
+            m_totalItems = section->totalSize;
+            m_dataSource->setData(section->items);
+            if (result.full) {
+                m_grid->notifyDataChanged();
+            } else {
+                attachDataSource();
+            }
+        },
+        // A multi-page sync can outlive the tab, so this must not touch it
+        [title](const std::string& error) {
+            LOGW("LibrarySectionTab: Sync of '{}' failed, keeping cached items: {}", title, error);
+        }
+    );
 }
 
 void LibrarySectionTab::loadItems() {
@@ -106,7 +166,7 @@ void LibrarySectionTab::loadItems() {
         return;
     }
 
-    brls::Logger::info("LibrarySectionTab: Loading '{}' (key={})", m_library.title, m_library.key);
+    LOGI("LibrarySectionTab: Loading '{}' (key={})", m_library.title, m_library.key);
 
     m_dataSource->clearData();
     m_grid->showSkeleton();
@@ -128,16 +188,21 @@ void LibrarySectionTab::loadItems() {
         [this, libraryKey](std::vector<plex::MediaItem> items, int totalSize) {
             if (!s_isActive || s_currentInstance != this) return;
 
-            brls::Logger::info("LibrarySectionTab: Loaded {} items (total: {})", items.size(), totalSize);
+            LOGI("LibrarySectionTab: Loaded {} items (total: {})", items.size(), totalSize);
             m_totalItems = totalSize;
-            m_dataSource->setData(items);
-            m_grid->setDataSource(m_dataSource);
+            std::vector<EntityRef> cards = EntityStore::getInstance()->mergeAll(items);
+            m_dataSource->setData(cards);
+            attachDataSource();
             if (m_spinnerContainer) m_spinnerContainer->setVisibility(brls::Visibility::GONE);
+            LaunchMetrics::markFirstSectionRender("network");
+
+            LibraryCache::getInstance()->put(libraryKey, std::move(cards), totalSize);
 
-            s_cache[libraryKey] = {items, totalSize};
+            // Build the complete local copy in the background
+            startSync();
         },
         [this](const std::string& error) {
-            brls::Logger::error("LibrarySectionTab: Failed to load '{}': {}", m_library.title, error);
+            LOGE("LibrarySectionTab: Failed to load '{}': {}", m_library.title, error);
             m_grid->setError(error);
             if (m_spinnerContainer) m_spinnerContainer->setVisibility(brls::Visibility::GONE);
         }
@@ -150,7 +215,7 @@ void LibrarySectionTab::loadMoreItems() {
     }
 
     int currentOffset = static_cast<int>(m_dataSource->getItemCount());
-    brls::Logger::debug("LibrarySectionTab: Loading more from offset {}", currentOffset);
+    LOGD("LibrarySectionTab: Loading more from offset {}", currentOffset);
 
     int libraryKey = m_library.key;
 
@@ -162,15 +227,15 @@ void LibrarySectionTab::loadMoreItems() {
         [this, libraryKey](std::vector<plex::MediaItem> items, int) {
             if (!s_isActive || s_currentInstance != this) return;
 
-            brls::Logger::debug("LibrarySectionTab: Loaded {} more items", items.size());
-            m_dataSource->appendData(items);
+            LOGD("LibrarySectionTab: Loaded {} more items", items.size());
+            std::vector<EntityRef> cards = EntityStore::getInstance()->mergeAll(items);
+            m_dataSource->appendData(cards);
             m_grid->notifyDataChanged();
 
-            auto& entry = s_cache[libraryKey];
-            entry.items.insert(entry.items.end(), items.begin(), items.end());
+            LibraryCache::getInstance()->append(libraryKey, cards);
         },
         [](const std::string& error) {
-            brls::Logger::error("LibrarySectionTab: Failed to load more: {}", error);
+            LOGE("LibrarySectionTab: Failed to load more: {}", error);
         }
     );
 }
@@ -4,6 +4,7 @@
 #include "core/plex_server.hpp"
 #include "core/settings_manager.hpp"
 #include "core/plex_api.hpp"
+#include "util/log.hpp"
 
 LibraryTab* LibraryTab::s_currentInstance = nullptr;
 bool LibraryTab::s_isActive = false;
@@ -74,7 +75,7 @@ void LibraryTab::loadLibraries() {
         serverLabel->setText(m_server->getName());
     }
 
-    brls::Logger::debug("LibraryTab: Loading libraries from {}", m_server->getName());
+    LOGD("LibraryTab: Loading libraries from {}", m_server->getName());
 
     PlexApi::getLibrarySections(
         m_server,
@@ -85,7 +86,7 @@ void LibraryTab::loadLibraries() {
             std::vector<std::string> libraryNames;
 
             for (const auto& library : libraries) {
-                brls::Logger::info("LibraryTab: Found library '{}' type '{}'", library.title, library.type);
+                LOGI("LibraryTab: Found library '{}' type '{}'", library.title, library.type);
                 if (library.type != "movie" && library.type != "show") {
                     continue;
                 }
@@ -127,25 +128,25 @@ void LibraryTab::loadLibraries() {
 
             onLibrarySelected(0);
 
-            brls::Logger::debug("LibraryTab: Loaded {} libraries", m_libraries.size());
+            LOGD("LibraryTab: Loaded {} libraries", m_libraries.size());
         },
         [this](const std::string& error) {
-            brls::Logger::error("LibraryTab: Failed to load libraries: {}", error);
+            LOGE("LibraryTab: Failed to load libraries: {}", error);
             brls::Application::notify("Failed to load libraries");
         }
     );
 }
 
 void LibraryTab::onLibrarySelected(int index) {
-    brls::Logger::info("LibraryTab: onLibrarySelected called with index {}", index);
+    LOGI("LibraryTab: onLibrarySelected called with index {}", index);
 
     if (index < 0 || index >= static_cast<int>(m_libraries.size())) {
-        brls::Logger::error("LibraryTab: Invalid library index {}", index);
+        LOGE("LibraryTab: Invalid library index {}", index);
         return;
     }
 
     m_selectedLibraryIndex = index;
-    brls::Logger::info("LibraryTab: Selecting library '{}'", m_libraries[index].title);
+    LOGI("LibraryTab: Selecting library '{}'", m_libraries[index].title);
     loadLibraryContent(m_libraries[index]);
 }
 
@@ -154,7 +155,7 @@ void LibraryTab::loadLibraryContent(const plex::Library& library) {
         return;
     }
 
-    brls::Logger::debug("LibraryTab: Loading content from library: {}", library.title);
+    LOGD("LibraryTab: Loading content from library: {}", library.title);
 
     m_gridView->setServer(m_server);
     m_gridView->clearItems();
@@ -173,12 +174,12 @@ void LibraryTab::loadLibraryContent(const plex::Library& library) {
         [this](std::vector<plex::MediaItem> items, int totalSize) {
             if (!s_isActive || s_currentInstance != this) return;
 
-            brls::Logger::debug("LibraryTab: Loaded {} items (total: {})", items.size(), totalSize);
+            LOGD("LibraryTab: Loaded {} items (total: {})", items.size(), totalSize);
             m_gridView->setTotalItems(totalSize);
             m_gridView->setItems(items);
         },
         [](const std::string& error) {
-            brls::Logger::error("LibraryTab: Failed to load items: {}", error);
+            LOGE("LibraryTab: Failed to load items: {}", error);
         }
     );
 }
@@ -191,7 +192,7 @@ void LibraryTab::loadMoreItems() {
     int currentOffset = m_gridView->getLoadedCount();
     const auto& library = m_libraries[m_selectedLibraryIndex];
 
-    brls::Logger::debug("LibraryTab: Loading more items from offset {}", currentOffset);
+    LOGD("LibraryTab: Loading more items from offset {}", currentOffset);
 
     PlexApi::getLibraryItems(
         m_server,
@@ -201,11 +202,11 @@ void LibraryTab::loadMoreItems() {
         [this](std::vector<plex::MediaItem> items, int totalSize) {
             if (!s_isActive || s_currentInstance != this) return;
 
-            brls::Logger::debug("LibraryTab: Loaded {} more items", items.size());
+            LOGD("LibraryTab: Loaded {} more items", items.size());
             m_gridView->appendItems(items);
         },
         [](const std::string& error) {
-            brls::Logger::error("LibraryTab: Failed to load more items: {}", error);
+            LOGE("LibraryTab: Failed to load more items: {}", error);
         }
     );
 }
@@ -3,11 +3,15 @@
 #include "views/tag_media_view.hpp"
 #include "core/plex_server.hpp"
 #include "core/plex_api.hpp"
+#include "core/bandwidth_estimator.hpp"
 #include "core/settings_manager.hpp"
+#include "core/subtitle_cache.hpp"
 #include "util/image_loader.hpp"
+#include "util/startup_metrics.hpp"
 #include "view/recycling_grid.hpp"
 #include "view/cast_card_cell.hpp"
 #include "styles/plex.hpp"
+#include "util/log.hpp"
 
 static std::string formatFileSize(int64_t bytes) {
     if (bytes <= 0) return "";
@@ -141,9 +145,25 @@ MediaDetailView::MediaDetailView(PlexServer* server, const plex::MediaItem& item
 
     setupUI();
     updateUI();
+
+    // Pick up watch progress reported from the player or other views
+    m_changeSubscription = EntityStore::getInstance()->getChangeEvent()->subscribe([this](int ratingKey) {
+        if (ratingKey != m_item.ratingKey) return;
+        EntityRef entity = EntityStore::getInstance()->find(ratingKey);
+        if (!entity) return;
+        if (entity->viewOffset == m_item.viewOffset && entity->viewCount == m_item.viewCount) return;
+
+        m_item.viewOffset = entity->viewOffset;
+        m_item.viewCount = entity->viewCount;
+        m_item.lastViewedAt = entity->lastViewedAt;
+        if (m_metadataLoaded && m_isVisible) {
+            updateUI();
+        }
+    });
 }
 
 MediaDetailView::~MediaDetailView() {
+    EntityStore::getInstance()->getChangeEvent()->unsubscribe(m_changeSubscription);
     if (s_instance == this) {
         s_instance = nullptr;
     }
@@ -327,7 +347,12 @@ void MediaDetailView::setupUI() {
     m_playButton->setState(brls::ButtonState::DISABLED);
     m_playButton->registerClickAction([this](brls::View*) {
         if (!m_metadataLoaded) return true;
-        playMedia();
+        playMedia(false);
+        return true;
+    });
+    m_playButton->registerAction("Quality", brls::BUTTON_Y, [this](brls::View*) {
+        if (!m_metadataLoaded) return true;
+        playMedia(true);
         return true;
     });
     buttonRow->addView(m_playButton);
@@ -453,7 +478,13 @@ void MediaDetailView::updateUI() {
         m_taglineLabel->setVisibility(brls::Visibility::VISIBLE);
     }
 
-    m_summaryLabel->setText(m_item.summary);
+    // Items opened from a grid are cards without summary or art; hold those
+    // until the full metadata arrives rather than show them blank
+    if (m_metadataLoaded || !m_item.summary.empty()) {
+        m_summaryLabel->setText(m_item.summary);
+    } else {
+        m_summaryLabel->setText("Loading...");
+    }
 
     if (m_metadataLoaded) {
         if (m_item.viewOffset > 0) {
@@ -467,6 +498,10 @@ void MediaDetailView::updateUI() {
             m_progressLabel->setText(formatProgress());
         } else {
             m_playButton->setText("Play");
+            auto* progressBox = m_progressBar->getParent();
+            if (progressBox) {
+                progressBox->setVisibility(brls::Visibility::GONE);
+            }
         }
         m_playButton->invalidate();
 
@@ -510,13 +545,16 @@ void MediaDetailView::updateUI() {
         }
     }
 
-    brls::Logger::info("MediaDetailView: thumb='{}', art='{}'", m_item.thumb, m_item.art);
+    LOGI("MediaDetailView: thumb='{}', art='{}'", m_item.thumb, m_item.art);
     if (!m_item.thumb.empty() && m_server) {
         std::string posterUrl = m_server->getTranscodePictureUrl(m_item.thumb, 200, 300);
         ImageLoader::load(m_posterImage, posterUrl);
     }
 
-    std::string artKey = m_item.art.empty() ? m_item.thumb : m_item.art;
+    std::string artKey = m_item.art;
+    if (artKey.empty() && m_metadataLoaded) {
+        artKey = m_item.thumb;
+    }
     if (!artKey.empty() && m_server) {
         std::string backdropUrl = m_server->getTranscodePictureUrl(artKey, 1280, 720);
         ImageLoader::load(m_backdropImage, backdropUrl);
@@ -633,7 +671,7 @@ void MediaDetailView::loadFullMetadata() {
     m_playButton->setState(brls::ButtonState::DISABLED);
 
     int requestId = ++m_requestId;
-    brls::Logger::debug("MediaDetailView: Loading metadata for ratingKey={} (request #{})", m_item.ratingKey, requestId);
+    LOGD("MediaDetailView: Loading metadata for ratingKey={} (request #{})", m_item.ratingKey, requestId);
     brls::Application::blockInputs();
 
     PlexApi::getMetadata(
@@ -641,32 +679,39 @@ void MediaDetailView::loadFullMetadata() {
         m_item.ratingKey,
         [requestId](plex::MediaItem item) {
             brls::Application::unblockInputs();
-            brls::Logger::debug("MediaDetailView: Metadata loaded, media count={}", item.media.size());
+            LOGD("MediaDetailView: Metadata loaded, media count={}", item.media.size());
             if (!s_instance) {
-                brls::Logger::debug("MediaDetailView: s_instance is null - view was destroyed");
+                LOGD("MediaDetailView: s_instance is null - view was destroyed");
                 return;
             }
             if (s_instance->m_requestId != requestId) {
-                brls::Logger::debug("MediaDetailView: Stale request #{} ignored (current #{})", requestId, s_instance->m_requestId);
+                LOGD("MediaDetailView: Stale request #{} ignored (current #{})", requestId, s_instance->m_requestId);
                 return;
             }
             if (!s_instance->m_isVisible) {
-                brls::Logger::debug("MediaDetailView: View not visible, skipping updateUI");
+                LOGD("MediaDetailView: View not visible, skipping updateUI");
                 return;
             }
-            brls::Logger::debug("MediaDetailView: s_instance valid, updating UI");
+            LOGD("MediaDetailView: s_instance valid, updating UI");
             s_instance->m_item = item;
             s_instance->m_metadataLoaded = true;
+            EntityStore::getInstance()->merge(item);
+            if (!item.media.empty() && !item.media[0].parts.empty()) {
+                SubtitleCache::getInstance()->prefetch(s_instance->m_server, item.media[0].parts[0]);
+            }
             s_instance->updateUI();
             s_instance->m_playButton->setState(brls::ButtonState::ENABLED);
             s_instance->m_playButton->invalidate();
             brls::Application::giveFocus(s_instance->m_playButton);
-            brls::Logger::debug("MediaDetailView: Button updated and focus given");
+            LOGD("MediaDetailView: Button updated and focus given");
         },
         [requestId](const std::string& error) {
             brls::Application::unblockInputs();
-            brls::Logger::error("Failed to load metadata: {}", error);
+            LOGE("Failed to load metadata: {}", error);
             if (s_instance && s_instance->m_requestId == requestId && s_instance->m_isVisible) {
+                if (s_instance->m_item.summary.empty()) {
+                    s_instance->m_summaryLabel->setText("");
+                }
                 s_instance->m_playButton->setText("Unavailable");
                 s_instance->m_playButton->setState(brls::ButtonState::DISABLED);
                 s_instance->m_playButton->invalidate();
@@ -675,7 +720,7 @@ void MediaDetailView::loadFullMetadata() {
     );
 }
 
-void MediaDetailView::playMedia() {
+void MediaDetailView::playMedia(bool askQuality) {
     if (!m_server) {
         brls::Application::notify("No server selected");
         return;
@@ -687,27 +732,33 @@ void MediaDetailView::playMedia() {
     }
 
     if (m_item.viewOffset > 0) {
-        showResumeDialog();
+        showResumeDialog(askQuality);
     } else {
-        startPlaybackFlow();
+        startPlaybackFlow(askQuality);
     }
 }
 
-void MediaDetailView::showResumeDialog() {
+void MediaDetailView::showResumeDialog(bool askQuality) {
     std::string resumeTime = formatDuration(m_item.viewOffset);
 
     brls::Dialog* dialog = new brls::Dialog("Resume Playback");
-    dialog->addButton("Resume from " + resumeTime, [this]() {
-        startPlaybackFlow();
+    dialog->addButton("Resume from " + resumeTime, [this, askQuality]() {
+        startPlaybackFlow(askQuality);
     });
-    dialog->addButton("Start from beginning", [this]() {
+    dialog->addButton("Start from beginning", [this, askQuality]() {
         m_item.viewOffset = 0;
-        startPlaybackFlow();
+        startPlaybackFlow(askQuality);
     });
     dialog->open();
 }
 
-void MediaDetailView::startPlaybackFlow() {
+void MediaDetailView::startPlaybackFlow(bool askQuality) {
+    StartupMetrics::begin();
+    if (!askQuality && SettingsManager::getInstance()->isAutoQualityEnabled()) {
+        playWithAutoQuality();
+        return;
+    }
+
     brls::Application::notify("Checking playback options...");
 
     PlexApi::getPlaybackDecision(m_server, m_item.ratingKey, 0, "", false, 0, m_selectedMediaIndex,
@@ -716,12 +767,30 @@ void MediaDetailView::startPlaybackFlow() {
             s_instance->showQualityMenu(info);
         },
         [](const std::string& error) {
-            brls::Logger::error("Failed to check playback options: {}", error);
+            LOGE("Failed to check playback options: {}", error);
             brls::Application::notify("Failed to check playback options");
         }
     );
 }
 
+void MediaDetailView::playWithAutoQuality() {
+    int mediaIndex = m_selectedMediaIndex;
+    if (mediaIndex >= static_cast<int>(m_item.media.size())) mediaIndex = 0;
+    const auto& media = m_item.media[mediaIndex];
+
+    auto* estimator = BandwidthEstimator::getInstance();
+    std::string baseUrl = m_server->getBaseUrl();
+    QualityStep quality = estimator->chooseQuality(baseUrl, media.bitrate, media.height);
+    if (SettingsManager::getInstance()->isRemuxOnlyEnabled()) {
+        quality = {0, 0, "Original"};
+    }
+    LOGI("Auto quality: {} (link {} kbps, rtt {} ms, source {} kbps)", quality.label,
+         estimator->getThroughputKbps(baseUrl), estimator->getRttMs(baseUrl), media.bitrate);
+
+    std::string resolution = quality.height > 0 ? std::to_string(quality.height) + "p" : "";
+    brls::Application::pushActivity(new PlayerActivity(m_server, m_item, quality.bitrate, resolution, m_selectedMediaIndex, true));
+}
+
 void MediaDetailView::showSourceSelector() {
     if (m_item.media.size() <= 1) return;
 
@@ -747,27 +816,15 @@ void MediaDetailView::showSourceSelector() {
 }
 
 void MediaDetailView::showQualityMenu(const plex::PlaybackInfo& info) {
+    StartupMetrics::mark(StartupMetrics::Stage::OptionsChecked);
     int mediaIndex = m_selectedMediaIndex;
     if (mediaIndex >= static_cast<int>(m_item.media.size())) mediaIndex = 0;
     int sourceHeight = m_item.media[mediaIndex].height;
 
-    // Plex recommended bitrate/resolution pairings
-    struct QualityPreset {
-        int bitrate;
-        int height;
-        const char* label;
-    };
-    static const QualityPreset presets[] = {
-        {20000, 1080, "20 Mbps 1080p"},
-        {12000, 1080, "12 Mbps 1080p"},
-        {10000, 1080, "10 Mbps 1080p"},
-        {8000, 1080, "8 Mbps 1080p"},
-        {4000, 720, "4 Mbps 720p"},
-        {3000, 720, "3 Mbps 720p"},
-        {2000, 480, "2 Mbps 480p"},
-        {1500, 480, "1.5 Mbps 480p"},
-        {720, 360, "720 Kbps 360p"},
-    };
+    // The entry automatic quality would pick starts focused
+    QualityStep recommended = BandwidthEstimator::getInstance()->chooseQuality(
+        m_server->getBaseUrl(), m_item.media[mediaIndex].bitrate, sourceHeight);
+    int selection = 0;
 
     std::vector<std::string> options;
     std::vector<std::pair<int, int>> qualityPairs;
@@ -778,9 +835,10 @@ void MediaDetailView::showQualityMenu(const plex::PlaybackInfo& info) {
     qualityPairs.push_back({0, 0});
 
     // Add transcode options based on source resolution
-    for (const auto& preset : presets) {
+    for (const auto& preset : BandwidthEstimator::qualityLadder()) {
         if (preset.height > sourceHeight) continue;
 
+        if (preset.bitrate == recommended.bitrate) selection = static_cast<int>(options.size());
         options.push_back(preset.label);
         qualityPairs.push_back({preset.bitrate, preset.height});
     }
@@ -794,9 +852,10 @@ void MediaDetailView::showQualityMenu(const plex::PlaybackInfo& info) {
         "Select Quality",
         options,
         [](int) {},
-        0,
+        selection,
         [this, qualityPairs](int selected) {
             if (selected < 0 || selected >= static_cast<int>(qualityPairs.size())) return;
+            StartupMetrics::mark(StartupMetrics::Stage::QualityChosen);
             auto quality = qualityPairs[selected];
             std::string resolution = quality.second > 0 ? std::to_string(quality.second) + "p" : "";
             brls::Application::pushActivity(new PlayerActivity(m_server, m_item, quality.first, resolution, m_selectedMediaIndex));
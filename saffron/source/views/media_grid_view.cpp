@@ -185,6 +185,19 @@ MediaCardView::MediaCardView() {
     m_progressBar->setMarginTop(4);
     m_progressBar->setVisibility(brls::Visibility::GONE);
     m_textContainer->addView(m_progressBar);
+
+    m_changeSubscription = EntityStore::getInstance()->getChangeEvent()->subscribe([this](int ratingKey) {
+        if (m_item && m_item->ratingKey == ratingKey) {
+            applyItem();
+            if (m_item->thumb != m_loadedThumb) {
+                loadPosterImage();
+            }
+        }
+    });
+}
+
+MediaCardView::~MediaCardView() {
+    EntityStore::getInstance()->getChangeEvent()->unsubscribe(m_changeSubscription);
 }
 
 RecyclingGridItem* MediaCardView::create() {
@@ -204,6 +217,7 @@ void MediaCardView::prepareForReuse() {
 void MediaCardView::cacheForReuse() {
     ImageLoader::cancel(m_posterImage);
     m_posterImage->clear();
+    m_item.reset();
 }
 
 void MediaCardView::cancelPendingRequests() {
@@ -211,29 +225,32 @@ void MediaCardView::cancelPendingRequests() {
 }
 
 void MediaCardView::setData(PlexServer* server, const plex::MediaItem& item) {
+    setData(server, EntityStore::getInstance()->merge(item));
+}
+
+void MediaCardView::setData(PlexServer* server, const EntityRef& item) {
     m_server = server;
     m_item = item;
+    if (!m_item) return;
+
+    applyItem();
+    loadPosterImage();
+}
+
+void MediaCardView::applyItem() {
+    const plex::CardItem& item = *m_item;
 
     std::string displayTitle = item.title;
     if (!item.editionTitle.empty()) {
-        displayTitle += " (" + item.editionTitle + ")";
+        displayTitle += " (" + item.editionTitle.str() + ")";
     }
     m_titleLabel->setText(displayTitle);
 
     if (item.mediaType == plex::MediaType::Movie) {
         std::string subtitle = std::to_string(item.year);
-        if (!item.media.empty()) {
-            bool has4k = false, has1080 = false, has720 = false;
-            for (const auto& m : item.media) {
-                std::string res = m.videoResolution;
-                if (res == "4k" || res == "4K") has4k = true;
-                else if (res == "1080" || res == "1080p") has1080 = true;
-                else if (res == "720" || res == "720p") has720 = true;
-            }
-            if (has720) subtitle += " • 720p";
-            if (has1080) subtitle += " • 1080p";
-            if (has4k) subtitle += " • 4K";
-        }
+        if (item.resolutions & plex::RESOLUTION_720) subtitle += " • 720p";
+        if (item.resolutions & plex::RESOLUTION_1080) subtitle += " • 1080p";
+        if (item.resolutions & plex::RESOLUTION_4K) subtitle += " • 4K";
         m_subtitleLabel->setText(subtitle);
     } else if (item.mediaType == plex::MediaType::Show) {
         m_subtitleLabel->setText("TV Show");
@@ -259,8 +276,6 @@ void MediaCardView::setData(PlexServer* server, const plex::MediaItem& item) {
         m_progressFill = nullptr;
         registerProgressBar(nullptr, nullptr);
     }
-
-    loadPosterImage();
 }
 
 void MediaCardView::setOnClick(std::function<void()> callback) {
@@ -271,13 +286,14 @@ void MediaCardView::setOnClick(std::function<void()> callback) {
 }
 
 std::string MediaCardView::buildImageUrl() {
-    if (!m_server || m_item.thumb.empty()) {
+    if (!m_server || !m_item || m_item->thumb.empty()) {
         return "";
     }
-    return m_server->getTranscodePictureUrl(m_item.thumb, 200, 300);
+    return m_server->getTranscodePictureUrl(m_item->thumb, 200, 300);
 }
 
 void MediaCardView::loadPosterImage() {
+    m_loadedThumb = m_item ? m_item->thumb : "";
     std::string url = buildImageUrl();
     if (url.empty()) {
         return;
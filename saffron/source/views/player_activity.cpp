@@ -1,9 +1,10 @@
 #include "views/player_activity.hpp"
 
-PlayerActivity::PlayerActivity(PlexServer* server, const plex::MediaItem& item, int bitrate, const std::string& resolution, int mediaIndex)
-    : m_server(server), m_item(item), m_bitrate(bitrate), m_resolution(resolution), m_mediaIndex(mediaIndex) {
+PlayerActivity::PlayerActivity(PlexServer* server, const plex::MediaItem& item, int bitrate, const std::string& resolution, int mediaIndex, bool adaptive)
+    : m_server(server), m_item(item), m_bitrate(bitrate), m_resolution(resolution), m_mediaIndex(mediaIndex),
+      m_adaptive(adaptive) {
 }
 
 brls::View* PlayerActivity::createContentView() {
-    return new PlayerView(m_server, m_item, m_bitrate, m_resolution, m_mediaIndex);
+    return new PlayerView(m_server, m_item, m_bitrate, m_resolution, m_mediaIndex, m_adaptive);
 }
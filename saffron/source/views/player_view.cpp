@@ -2,35 +2,27 @@
 #include "views/video_profile.hpp"
 #include "core/plex_api.hpp"
 #include "core/plex_server.hpp"
+#include "core/entity_store.hpp"
 #include "core/settings_manager.hpp"
+#include "core/subtitle_cache.hpp"
+#include "util/callback_task.hpp"
 #include "util/image_loader.hpp"
 #include "util/overclock.hpp"
+#include "util/startup_metrics.hpp"
+#include "util/log.hpp"
+
+#include <algorithm>
 
 PlayerView* PlayerView::s_currentInstance = nullptr;
 bool PlayerView::s_isActive = false;
 
-class OsdTask : public brls::RepeatingTask {
-public:
-    OsdTask(brls::Time period, std::function<void()> callback)
-        : brls::RepeatingTask(period), m_callback(std::move(callback)) {}
-    void run() override { if (m_callback) m_callback(); }
-private:
-    std::function<void()> m_callback;
-};
-
-class TimelineTask : public brls::RepeatingTask {
-public:
-    TimelineTask(brls::Time period, std::function<void()> callback)
-        : brls::RepeatingTask(period), m_callback(std::move(callback)) {}
-    void run() override { if (m_callback) m_callback(); }
-private:
-    std::function<void()> m_callback;
-};
-
-PlayerView::PlayerView(PlexServer* server, const plex::MediaItem& item, int bitrate, const std::string& resolution, int mediaIndex)
-    : m_server(server), m_item(item), m_bitrate(bitrate), m_resolution(resolution), m_mediaIndex(mediaIndex) {
+PlayerView::PlayerView(PlexServer* server, const plex::MediaItem& item, int bitrate, const std::string& resolution,
+                       int mediaIndex, bool adaptive)
+    : m_server(server), m_item(item), m_bitrate(bitrate), m_resolution(resolution), m_mediaIndex(mediaIndex),
+      m_adaptive(adaptive) {
 
     s_currentInstance = this;
+    StartupMetrics::mark(StartupMetrics::Stage::PlayerOpened);
 
     setFocusable(true);
     setHideHighlight(true);
@@ -112,7 +104,7 @@ PlayerView::PlayerView(PlexServer* server, const plex::MediaItem& item, int bitr
         return true;
     });
 
-    m_osdTimer = new OsdTask(1000, [this]() {
+    m_osdTimer = new CallbackTask(1000, [this]() {
         if (!s_isActive || s_currentInstance != this) return;
         if (m_osdVisible) {
             m_osdTimeout++;
@@ -126,11 +118,17 @@ PlayerView::PlayerView(PlexServer* server, const plex::MediaItem& item, int bitr
     });
     m_osdTimer->start();
 
-    m_timelineTimer = new TimelineTask(10000, [this]() {
+    m_timelineTimer = new CallbackTask(10000, [this]() {
         if (!s_isActive || s_currentInstance != this) return;
         reportTimeline();
     });
     m_timelineTimer->start();
+
+    m_abrTimer = new CallbackTask(1000, [this]() {
+        if (!s_isActive || s_currentInstance != this) return;
+        sampleAbr();
+    });
+    m_abrTimer->start();
 }
 
 PlayerView::~PlayerView() {
@@ -149,6 +147,10 @@ PlayerView::~PlayerView() {
         m_timelineTimer->stop();
         delete m_timelineTimer;
     }
+    if (m_abrTimer) {
+        m_abrTimer->stop();
+        delete m_abrTimer;
+    }
 }
 
 brls::View* PlayerView::create() {
@@ -172,13 +174,28 @@ void PlayerView::initMpv() {
 
     mpv->setOnError([this](const std::string& error) {
         if (!s_isActive || s_currentInstance != this) return;
+        if (m_seek.active && m_seek.path == SeekMetrics::Path::Session) {
+            LOGW("In-session seek failed ({}), restarting transcode", error);
+            fallBackToRestart();
+            return;
+        }
         onError(error);
     });
 
+    mpv->setOnFileLoaded([this]() {
+        if (!s_isActive || s_currentInstance != this) return;
+        loadSidecarSubtitles();
+    });
+
     mpv->setOnEndFile([this](bool reachedEof) {
         if (!s_isActive || s_currentInstance != this) return;
         onEndFile(reachedEof);
     });
+
+    mpv->setOnPlaybackRestart([this]() {
+        if (!s_isActive || s_currentInstance != this) return;
+        onPlaybackRestart();
+    });
 }
 
 void PlayerView::setupOsd() {
@@ -273,6 +290,7 @@ void PlayerView::willAppear(bool resetState) {
     if (SettingsManager::getInstance()->isOverclockEnabled()) {
         SwitchSys::setClock(true);
     }
+    MPVCore::getInstance()->getTelemetry()->beginSession(m_item.ratingKey, m_item.title);
     startPlayback();
 }
 
@@ -284,6 +302,13 @@ void PlayerView::willDisappear(bool resetState) {
         SwitchSys::setClock(false);
     }
     reportStopped();
+    SeekMetrics::logSummary();
+
+    auto* telemetry = MPVCore::getInstance()->getTelemetry();
+    telemetry->endSession();
+    if (SettingsManager::getInstance()->isTelemetryExportEnabled()) {
+        telemetry->exportSession();
+    }
 }
 
 brls::View* PlayerView::getDefaultFocus() {
@@ -299,7 +324,7 @@ void PlayerView::onStateChanged(PlaybackState state) {
             m_stateLabel->setText("Playing");
             if (m_pendingSeek) {
                 m_pendingSeek = false;
-                brls::Logger::info("Seeking to resume position: {}ms", m_startOffset);
+                LOGI("Seeking to resume position: {}ms", m_startOffset);
                 MPVCore::getInstance()->seek(m_startOffset);
             }
             break;
@@ -323,10 +348,16 @@ void PlayerView::onProgress(int64_t position, int64_t duration) {
         m_progressSlider->setProgress(progress);
     }
     m_timeLabel->setText(formatTime(actualPosition) + " / " + formatTime(totalDuration));
+
+    int preloadMs = SettingsManager::getInstance()->getPreloadNextSeconds() * 1000;
+    if (m_next.state == NextEpisode::State::Idle && preloadMs > 0 && totalDuration > 0 &&
+        totalDuration - actualPosition <= preloadMs) {
+        prepareNextEpisode();
+    }
 }
 
 void PlayerView::onError(const std::string& error) {
-    brls::Logger::error("Playback error: {}", error);
+    LOGE("Playback error: {}", error);
     m_stateLabel->setText("Error");
     showOsd();
 
@@ -405,7 +436,7 @@ void PlayerView::startPlayback() {
 
     bool forceTranscode = (m_bitrate > 0);
     m_startOffset = m_item.viewOffset;
-    brls::Logger::info("Starting stream - bitrate: {} kbps, resolution: {}, forceTranscode: {}, offset: {}ms",
+    LOGI("Starting stream - bitrate: {} kbps, resolution: {}, forceTranscode: {}, offset: {}ms",
         m_bitrate, m_resolution.empty() ? "original" : m_resolution, forceTranscode ? "yes" : "no", m_startOffset);
 
     PlexApi::getPlaybackDecision(m_server, m_item.ratingKey, m_bitrate, m_resolution, forceTranscode, m_startOffset, m_mediaIndex,
@@ -420,12 +451,16 @@ void PlayerView::startPlayback() {
             m_isDirectPlay = (info.protocol == "http");
             m_sessionId = info.sessionId;
             m_pendingSeek = m_isDirectPlay && m_startOffset > 0;
+            StartupMetrics::mark(StartupMetrics::Stage::DecisionReady);
+            StartupMetrics::setRoute(m_isDirectPlay, m_server->getName());
+            setSidecarSubtitles(info);
 
-            brls::Logger::info("Starting playback ({}): {}", info.protocol, info.playbackUrl);
+            LOGI("Starting playback ({}): {}", info.protocol, info.playbackUrl);
             auto* mpv = MPVCore::getInstance();
             int actualBitrate = m_isDirectPlay ?
                 (m_item.media.empty() ? 0 : m_item.media[m_mediaIndex].bitrate) : 0;
             mpv->play(info.playbackUrl, m_isDirectPlay, actualBitrate);
+            startAbr();
         },
         [this](const std::string& error) {
             if (!s_isActive || s_currentInstance != this) return;
@@ -459,6 +494,7 @@ void PlayerView::reportTimeline() {
     int64_t actualPosition = m_isDirectPlay ? mpv->getPosition() : (mpv->getPosition() + m_startOffset);
     int64_t totalDuration = m_item.duration > 0 ? m_item.duration : mpv->getDuration();
     m_lastReportedPosition = actualPosition;
+    EntityStore::getInstance()->updateProgress(m_item.ratingKey, actualPosition);
     PlexApi::reportTimeline(
         m_server,
         m_item.ratingKey,
@@ -477,6 +513,8 @@ void PlayerView::reportStopped() {
 void PlayerView::onEndFile(bool reachedEof) {
     if (!reachedEof) return;
 
+    EntityStore::getInstance()->markWatched(m_item.ratingKey);
+
     auto* mpv = MPVCore::getInstance();
     auto* settings = SettingsManager::getInstance();
     if (!settings->isAutoPlayNextEnabled()) {
@@ -486,7 +524,13 @@ void PlayerView::onEndFile(bool reachedEof) {
     }
 
     if (isEpisode()) {
-        playNextEpisode();
+        if (m_next.state == NextEpisode::State::Queued) {
+            handOverToNext(true);
+        } else if (m_next.state == NextEpisode::State::Ready) {
+            handOverToNext(false);
+        } else {
+            playNextEpisode();
+        }
     } else {
         mpv->disableSyncCallbacks();
         brls::Application::popActivity();
@@ -523,11 +567,8 @@ void PlayerView::playNextEpisode() {
 
             if (foundNext && !nextEpisode.media.empty()) {
                 m_item = nextEpisode;
-                std::string nextTitle = m_item.title;
-                if (!m_item.editionTitle.empty()) {
-                    nextTitle += " - " + m_item.editionTitle + " Edition";
-                }
-                m_titleLabel->setText(nextTitle);
+                m_next = NextEpisode();
+                updateTitleLabel();
                 brls::Application::notify("Playing next: " + m_item.title);
                 startPlayback();
             } else {
@@ -539,13 +580,183 @@ void PlayerView::playNextEpisode() {
         [this](const std::string& error) {
             if (!s_isActive || s_currentInstance != this) return;
 
-            brls::Logger::error("Failed to get next episode: {}", error);
+            LOGE("Failed to get next episode: {}", error);
             MPVCore::getInstance()->disableSyncCallbacks();
             brls::Application::popActivity();
         }
     );
 }
 
+void PlayerView::prepareNextEpisode() {
+    auto* settings = SettingsManager::getInstance();
+    if (!m_server || !isEpisode() || m_item.parentRatingKey == 0 || !settings->isAutoPlayNextEnabled()) {
+        m_next.state = NextEpisode::State::Failed;
+        return;
+    }
+
+    m_next = NextEpisode();
+    m_next.state = NextEpisode::State::Resolving;
+    m_next.forRatingKey = m_item.ratingKey;
+
+    int currentKey = m_item.ratingKey;
+    int currentIndex = m_item.index;
+    LOGI("Preparing episode after {} (index {})", currentKey, currentIndex);
+
+    // Results are dropped if the item changed or a restart reset the state
+    auto isCurrent = [this, currentKey]() {
+        return s_isActive && s_currentInstance == this &&
+               m_next.forRatingKey == currentKey && m_next.state == NextEpisode::State::Resolving;
+    };
+
+    PlexApi::getChildren(m_server, m_item.parentRatingKey,
+        [this, currentIndex, isCurrent](std::vector<plex::MediaItem> episodes) {
+            if (!isCurrent()) return;
+
+            auto it = std::find_if(episodes.begin(), episodes.end(),
+                [currentIndex](const plex::MediaItem& ep) { return ep.index == currentIndex + 1; });
+            if (it == episodes.end() || it->media.empty()) {
+                m_next.state = NextEpisode::State::Failed;
+                return;
+            }
+            m_next.item = *it;
+
+            // Starts the next transcode now so its first segments are ready
+            bool forceTranscode = (m_bitrate > 0);
+            PlexApi::getPlaybackDecision(m_server, m_next.item.ratingKey, m_bitrate, m_resolution, forceTranscode, 0, 0,
+                [this, isCurrent](const plex::PlaybackInfo& info) {
+                    if (!isCurrent()) return;
+                    if (info.playbackUrl.empty()) {
+                        m_next.state = NextEpisode::State::Failed;
+                        return;
+                    }
+
+                    m_next.info = info;
+                    m_next.state = NextEpisode::State::Ready;
+
+                    // play() sets stream options per kind, so only a stream of
+                    // the same kind can ride along in mpv's playlist
+                    bool nextDirect = (info.protocol == "http");
+                    if (nextDirect == m_isDirectPlay) {
+                        MPVCore::getInstance()->queueNext(info.playbackUrl, nextDirect);
+                        m_next.state = NextEpisode::State::Queued;
+                    }
+                    LOGI("Next episode '{}' ready ({}, {})", m_next.item.title, info.protocol,
+                         m_next.state == NextEpisode::State::Queued ? "queued" : "on demand");
+                },
+                [this, isCurrent](const std::string& error) {
+                    if (!isCurrent()) return;
+                    LOGE("Failed to prepare next episode: {}", error);
+                    m_next.state = NextEpisode::State::Failed;
+                }
+            );
+        },
+        [this, isCurrent](const std::string& error) {
+            if (!isCurrent()) return;
+            LOGE("Failed to resolve next episode: {}", error);
+            m_next.state = NextEpisode::State::Failed;
+        }
+    );
+}
+
+void PlayerView::handOverToNext(bool alreadyQueued) {
+    reportStopped();
+
+    NextEpisode next = std::move(m_next);
+    m_next = NextEpisode();
+    m_item = next.item;
+    m_mediaIndex = 0;
+    m_startOffset = 0;
+    m_lastReportedPosition = 0;
+    m_pendingSeek = false;
+    m_seek.active = false;
+    m_isDirectPlay = (next.info.protocol == "http");
+    m_sessionId = next.info.sessionId;
+    setSidecarSubtitles(next.info);
+    updateTitleLabel();
+    startAbr();
+    brls::Application::notify("Playing next: " + m_item.title);
+
+    // A queued entry is already being opened by mpv as the playlist advances
+    if (!alreadyQueued) {
+        auto* mpv = MPVCore::getInstance();
+        int actualBitrate = m_isDirectPlay ?
+            (m_item.media.empty() ? 0 : m_item.media[0].bitrate) : 0;
+        mpv->play(next.info.playbackUrl, m_isDirectPlay, actualBitrate);
+    }
+}
+
+void PlayerView::updateTitleLabel() {
+    std::string title = m_item.title;
+    if (!m_item.editionTitle.empty()) {
+        title += " - " + m_item.editionTitle + " Edition";
+    }
+    m_titleLabel->setText(title);
+}
+
+void PlayerView::setSidecarSubtitles(const plex::PlaybackInfo& info) {
+    // The decision carries the part's streams; fall back to the item's own
+    // metadata when it does not
+    const plex::MediaItem& source = info.metadata.media.empty() ? m_item : info.metadata;
+    m_sidecarSubs.clear();
+    m_sidecarGeneration++;
+    if (source.media.empty() || source.media[0].parts.empty()) return;
+
+    // A forced transcode already delivers the selected track itself
+    bool serverHandlesSelected = !m_isDirectPlay && m_bitrate > 0;
+    auto* cache = SubtitleCache::getInstance();
+    for (const auto& stream : source.media[0].parts[0].streams) {
+        if (!SubtitleCache::isSidecar(stream)) continue;
+        if (serverHandlesSelected && stream.selected) continue;
+        m_sidecarSubs.push_back(stream);
+        cache->fetch(m_server, stream, nullptr);
+    }
+}
+
+void PlayerView::loadSidecarSubtitles() {
+    int generation = m_sidecarGeneration;
+    auto* cache = SubtitleCache::getInstance();
+    for (const auto& stream : m_sidecarSubs) {
+        std::string title = stream.displayTitle;
+        std::string lang = stream.languageCode;
+        bool select = stream.selected;
+        cache->fetch(m_server, stream, [this, generation, title, lang, select](const std::string& path) {
+            if (!s_isActive || s_currentInstance != this || m_sidecarGeneration != generation) return;
+            MPVCore::getInstance()->addSubtitle(path, title, lang, select);
+        });
+    }
+}
+
+void PlayerView::startAbr() {
+    m_abr.stop();
+    if (!m_adaptive || m_isDirectPlay || m_bitrate <= 0 || m_item.media.empty()) return;
+
+    int idx = (m_mediaIndex < static_cast<int>(m_item.media.size())) ? m_mediaIndex : 0;
+    const auto& media = m_item.media[idx];
+    m_abr.start(m_item.ratingKey, m_bitrate, media.bitrate, media.height, m_server->getBaseUrl());
+}
+
+void PlayerView::sampleAbr() {
+    if (!m_abr.isActive() || m_seek.active) return;
+
+    auto* mpv = MPVCore::getInstance();
+    PlaybackState state = mpv->getState();
+    if (!mpv->isValid() || (state != PlaybackState::Playing && state != PlaybackState::Buffering)) return;
+
+    AbrController::Sample sample;
+    sample.positionMs = m_lastReportedPosition;
+    sample.cacheSeconds = mpv->getCacheSeconds();
+    sample.downloadKbps = mpv->getInt("cache-speed") * 8.0 / 1000.0;
+    sample.buffering = state == PlaybackState::Buffering || mpv->isPausedForCache();
+    if (!m_abr.update(sample, std::chrono::steady_clock::now())) return;
+
+    const QualityStep& step = m_abr.getCurrentStep();
+    m_bitrate = step.bitrate;
+    m_resolution = std::to_string(step.height) + "p";
+    mpv->markTelemetry(PlaybackTelemetry::Mark::QualitySwitch);
+    brls::Application::notify(std::string("Switching to ") + step.label);
+    startPlaybackWithOffset(m_lastReportedPosition);
+}
+
 void PlayerView::seekRelative(int64_t deltaMs) {
     m_pendingSeekDelta += deltaMs;
     showOsd();
@@ -574,9 +785,68 @@ void PlayerView::executeSeek() {
     int64_t duration = m_item.duration;
     if (duration > 0 && newOffset > duration) newOffset = duration - 1000;
 
-    brls::Logger::info("HLS seek: current={}ms, delta={}ms, newOffset={}ms", currentPos, accumulatedDelta, newOffset);
+    // The HLS stream starts at m_startOffset, so anything earlier can only
+    // be reached with a new transcode
+    int64_t streamTarget = newOffset - m_startOffset;
+    int64_t streamDuration = mpv->getDuration();
+    bool inStream = streamTarget >= 0 && (streamDuration <= 0 || streamTarget < streamDuration);
+
+    LOGI("HLS seek: current={}ms, delta={}ms, newOffset={}ms", currentPos, accumulatedDelta, newOffset);
+
+    if (inStream && mpv->isPositionCached(streamTarget)) {
+        beginSeek(SeekMetrics::Path::Cache, newOffset);
+        mpv->seek(streamTarget);
+    } else if (inStream && !m_sessionId.empty()) {
+        // Requesting segments past what is transcoded makes the server move
+        // the running session, which is far cheaper than a new decision
+        beginSeek(SeekMetrics::Path::Session, newOffset);
+        m_stateLabel->setText("Seeking...");
+        mpv->seek(streamTarget);
+
+        int seekId = m_seek.id;
+        brls::delay(SESSION_SEEK_TIMEOUT_MS, [this, seekId]() {
+            if (s_currentInstance != this || !s_isActive) return;
+            if (!m_seek.active || m_seek.id != seekId) return;
+            LOGW("In-session seek timed out, restarting transcode");
+            fallBackToRestart();
+        });
+    } else {
+        beginSeek(SeekMetrics::Path::Restart, newOffset);
+        startPlaybackWithOffset(newOffset);
+    }
+}
 
-    startPlaybackWithOffset(newOffset);
+void PlayerView::beginSeek(SeekMetrics::Path path, int64_t targetMs) {
+    m_seek.active = true;
+    m_seek.id++;
+    m_seek.path = path;
+    m_seek.targetMs = targetMs;
+    m_seek.start = std::chrono::steady_clock::now();
+    m_abr.onRestart(m_seek.start);
+    LOGD("Seeking to {}ms via {}", targetMs, SeekMetrics::pathName(path));
+}
+
+void PlayerView::fallBackToRestart() {
+    // Keep the original start time so the latency covers the failed attempt
+    m_seek.path = SeekMetrics::Path::Restart;
+    m_seek.id++;
+    startPlaybackWithOffset(m_seek.targetMs);
+}
+
+void PlayerView::onPlaybackRestart() {
+    if (!m_seek.active) return;
+    m_seek.active = false;
+
+    int64_t latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - m_seek.start).count();
+    SeekMetrics::record(m_seek.path, latency);
+
+    auto* mpv = MPVCore::getInstance();
+    if (mpv->isPlaying()) {
+        m_stateLabel->setText("Playing");
+    } else if (mpv->isPaused()) {
+        m_stateLabel->setText("Paused");
+    }
 }
 
 void PlayerView::startPlaybackWithOffset(int64_t offsetMs) {
@@ -593,8 +863,9 @@ void PlayerView::startPlaybackWithOffset(int64_t offsetMs) {
 
     bool forceTranscode = (m_bitrate > 0);
     m_startOffset = offsetMs;
+    m_abr.onRestart(std::chrono::steady_clock::now());
 
-    brls::Logger::info("Restarting stream at offset {}ms", offsetMs);
+    LOGI("Restarting stream at offset {}ms", offsetMs);
 
     PlexApi::getPlaybackDecision(m_server, m_item.ratingKey, m_bitrate, m_resolution, forceTranscode, m_startOffset, m_mediaIndex,
         [this](const plex::PlaybackInfo& info) {
@@ -608,12 +879,18 @@ void PlayerView::startPlaybackWithOffset(int64_t offsetMs) {
             m_isDirectPlay = (info.protocol == "http");
             m_sessionId = info.sessionId;
             m_pendingSeek = false;
+            setSidecarSubtitles(info);
 
-            brls::Logger::info("Restarting playback ({}): {}", info.protocol, info.playbackUrl);
+            LOGI("Restarting playback ({}): {}", info.protocol, info.playbackUrl);
             auto* mpv = MPVCore::getInstance();
             int actualBitrate = m_isDirectPlay ?
                 (m_item.media.empty() ? 0 : m_item.media[m_mediaIndex].bitrate) : 0;
             mpv->play(info.playbackUrl, m_isDirectPlay, actualBitrate);
+
+            // Stopping for the restart cleared mpv's playlist
+            if (m_next.state == NextEpisode::State::Queued) {
+                mpv->queueNext(m_next.info.playbackUrl, m_next.info.protocol == "http");
+            }
         },
         [this](const std::string& error) {
             if (!s_isActive || s_currentInstance != this) return;
@@ -3,6 +3,7 @@
 #include "core/settings_manager.hpp"
 #include "core/plex_api.hpp"
 #include "util/image_loader.hpp"
+#include "util/log.hpp"
 
 PlaylistsTab* PlaylistsTab::s_currentInstance = nullptr;
 bool PlaylistsTab::s_isActive = false;
@@ -85,10 +86,10 @@ void PlaylistsTab::loadPlaylists() {
             }
             if (spinnerContainer) spinnerContainer->setVisibility(brls::Visibility::GONE);
 
-            brls::Logger::info("Loaded {} playlists", m_items.size());
+            LOGI("Loaded {} playlists", m_items.size());
         },
         [this](const std::string& error) {
-            brls::Logger::error("Failed to load playlists: {}", error);
+            LOGE("Failed to load playlists: {}", error);
             if (emptyMessage) {
                 emptyMessage->setVisibility(brls::Visibility::VISIBLE);
             }
@@ -6,8 +6,13 @@
 #include "core/plex_server.hpp"
 #include "core/settings_manager.hpp"
 #include "core/plex_api.hpp"
+#include "core/search_index.hpp"
 #include "util/image_loader.hpp"
 #include "styles/plex.hpp"
+#include "util/log.hpp"
+
+#include <algorithm>
+#include <unordered_set>
 
 SearchView* SearchView::s_currentInstance = nullptr;
 bool SearchView::s_isActive = false;
@@ -106,8 +111,11 @@ void SearchView::performSearch(const std::string& query) {
         return;
     }
 
+    // Answer from the local index straight away; server hubs are merged
+    // in below it when (and if) the request comes back
     if (spinnerContainer) spinnerContainer->setVisibility(brls::Visibility::VISIBLE);
-    if (emptyMessage) emptyMessage->setVisibility(brls::Visibility::GONE);
+    searchLocal(query);
+    displayResults({});
 
     int requestId = ++m_searchRequestId;
 
@@ -119,26 +127,49 @@ void SearchView::performSearch(const std::string& query) {
             if (!s_isActive || s_currentInstance != this) return;
             if (requestId != m_searchRequestId) return;
 
-            displayResults(hubs);
             if (spinnerContainer) spinnerContainer->setVisibility(brls::Visibility::GONE);
+            displayResults(hubs);
         },
         [this, requestId](const std::string& error) {
             if (!s_isActive || s_currentInstance != this) return;
             if (requestId != m_searchRequestId) return;
 
-            brls::Logger::error("Search failed: {}", error);
+            LOGE("Search failed: {}", error);
             if (spinnerContainer) spinnerContainer->setVisibility(brls::Visibility::GONE);
+            if (!m_localHub.items.empty()) return;
             if (emptyMessage) emptyMessage->setVisibility(brls::Visibility::VISIBLE);
             if (emptyLabel) emptyLabel->setText("Search failed");
         }
     );
 }
 
-void SearchView::displayResults(const std::vector<plex::Hub>& hubs) {
+void SearchView::searchLocal(const std::string& query) {
+    m_localHub = plex::Hub();
+    m_localHub.title = "In Your Libraries";
+    m_localHub.items = SearchIndex::getInstance()->search(query, LOCAL_RESULT_LIMIT);
+}
+
+void SearchView::displayResults(const std::vector<plex::Hub>& serverHubs) {
     clearResults();
 
     if (!m_server) return;
 
+    // Local matches lead; server hubs follow without the items already shown
+    std::unordered_set<int> shown;
+    for (const auto& item : m_localHub.items) {
+        shown.insert(item.ratingKey);
+    }
+
+    std::vector<plex::Hub> hubs;
+    hubs.push_back(m_localHub);
+    for (const auto& serverHub : serverHubs) {
+        plex::Hub hub = serverHub;
+        hub.items.erase(std::remove_if(hub.items.begin(), hub.items.end(),
+            [&shown](const plex::MediaItem& item) { return shown.count(item.ratingKey) > 0; }),
+            hub.items.end());
+        hubs.push_back(std::move(hub));
+    }
+
     for (const auto& hub : hubs) {
         if (hub.items.empty()) continue;
 
@@ -172,7 +203,9 @@ void SearchView::displayResults(const std::vector<plex::Hub>& hubs) {
     }
 
     if (m_hubRows.empty()) {
-        if (emptyMessage) emptyMessage->setVisibility(brls::Visibility::VISIBLE);
+        // Keep quiet while the server may still answer
+        bool pending = spinnerContainer && spinnerContainer->getVisibility() == brls::Visibility::VISIBLE;
+        if (emptyMessage) emptyMessage->setVisibility(pending ? brls::Visibility::GONE : brls::Visibility::VISIBLE);
         if (emptyLabel) emptyLabel->setText("No results found");
     } else {
         if (emptyMessage) emptyMessage->setVisibility(brls::Visibility::GONE);
@@ -3,6 +3,7 @@
 #include "core/plex_server.hpp"
 #include "core/plex_api.hpp"
 #include "util/image_loader.hpp"
+#include "util/log.hpp"
 
 SeasonView* SeasonView::s_instance = nullptr;
 
@@ -93,11 +94,11 @@ void SeasonView::loadEpisodes() {
         [requestId](std::vector<plex::MediaItem> episodes) {
             if (!s_instance) return;
             if (s_instance->m_requestId != requestId) {
-                brls::Logger::debug("SeasonView: Stale request #{} ignored", requestId);
+                LOGD("SeasonView: Stale request #{} ignored", requestId);
                 return;
             }
             if (!s_instance->m_isVisible) {
-                brls::Logger::debug("SeasonView: View not visible, skipping episode update");
+                LOGD("SeasonView: View not visible, skipping episode update");
                 return;
             }
 
@@ -209,7 +210,7 @@ void SeasonView::loadEpisodes() {
             }
         },
         [requestId](const std::string& error) {
-            brls::Logger::error("Failed to load episodes: {}", error);
+            LOGE("Failed to load episodes: {}", error);
         }
     );
 }
@@ -3,6 +3,7 @@
 #include "core/settings_manager.hpp"
 #include "core/server_discovery.hpp"
 #include "core/auth_manager.hpp"
+#include "util/log.hpp"
 
 ServerListTab* ServerListTab::s_currentInstance = nullptr;
 bool ServerListTab::s_isActive = false;
@@ -45,7 +46,7 @@ brls::View* ServerListTab::create() {
 void ServerListTab::willAppear(bool resetState) {
     Box::willAppear(resetState);
     s_isActive = true;
-    brls::Logger::debug("ServerListTab::willAppear - resuming discovery callbacks");
+    LOGD("ServerListTab::willAppear - resuming discovery callbacks");
     syncServerList();
 
     if (m_auth->isAuthenticated()) {
@@ -56,7 +57,7 @@ void ServerListTab::willAppear(bool resetState) {
 void ServerListTab::willDisappear(bool resetState) {
     Box::willDisappear(resetState);
     s_isActive = false;
-    brls::Logger::debug("ServerListTab::willDisappear - pausing discovery callbacks");
+    LOGD("ServerListTab::willDisappear - pausing discovery callbacks");
 }
 
 void ServerListTab::initButtons() {
@@ -221,25 +222,25 @@ void ServerListTab::updateServerItem(PlexServer* server) {
 }
 
 void ServerListTab::refreshServers() {
-    brls::Logger::info("Refreshing server list");
+    LOGI("Refreshing server list");
 
     m_discovery->discoverLocalServersAsync([]() {
-        brls::Logger::info("Local discovery complete");
+        LOGI("Local discovery complete");
     });
 
     if (m_auth->isAuthenticated()) {
         m_discovery->discoverRemoteServersAsync(
             m_auth->getAuthToken(),
             [this](std::vector<PlexServer*> servers) {
-                brls::Logger::info("Found {} remote servers", servers.size());
+                LOGI("Found {} remote servers", servers.size());
                 m_settings->writeFile();
-                brls::Logger::info("Saved server config to disk");
+                LOGI("Saved server config to disk");
                 if (s_isActive && s_currentInstance) {
                     s_currentInstance->syncServerList();
                 }
             },
             [](const std::string& error) {
-                brls::Logger::error("Remote discovery failed: {}", error);
+                LOGE("Remote discovery failed: {}", error);
             }
         );
     }
@@ -1,5 +1,6 @@
 #include "views/settings_tab.hpp"
 #include "core/settings_manager.hpp"
+#include "core/http_recorder.hpp"
 #include <fstream>
 
 SettingsTab::SettingsTab() {
@@ -61,6 +62,47 @@ void SettingsTab::createPlaybackSection(brls::Box* container) {
     });
     container->addView(m_autoPlayCell);
 
+    m_preloadSelector = new brls::SelectorCell();
+    m_preloadSelector->title->setText("Preload Next Episode");
+    m_preloadSelector->detail->setText("Prepare the next episode before the current one ends");
+    m_preloadSelector->setData({"Disabled", "15 seconds", "30 seconds", "60 seconds", "120 seconds"});
+
+    int preloadIndex = 2;
+    int preloadVal = settings->getPreloadNextSeconds();
+    if (preloadVal == 0) preloadIndex = 0;
+    else if (preloadVal == 15) preloadIndex = 1;
+    else if (preloadVal == 30) preloadIndex = 2;
+    else if (preloadVal == 60) preloadIndex = 3;
+    else if (preloadVal == 120) preloadIndex = 4;
+    m_preloadSelector->setSelection(preloadIndex);
+
+    m_preloadSelector->getEvent()->subscribe([this, settings](int selected) {
+        int values[] = {0, 15, 30, 60, 120};
+        settings->setPreloadNextSeconds(values[selected]);
+        settings->writeFile();
+    });
+    container->addView(m_preloadSelector);
+
+    m_autoQualityCell = new brls::BooleanCell();
+    m_autoQualityCell->title->setText("Automatic Quality");
+    m_autoQualityCell->detail->setText("Pick the quality from measured network speed instead of asking");
+    m_autoQualityCell->setOn(settings->isAutoQualityEnabled());
+    m_autoQualityCell->getEvent()->subscribe([this, settings](bool on) {
+        settings->setAutoQuality(on);
+        settings->writeFile();
+    });
+    container->addView(m_autoQualityCell);
+
+    m_remuxOnlyCell = new brls::BooleanCell();
+    m_remuxOnlyCell->title->setText("Remux Only");
+    m_remuxOnlyCell->detail->setText("Keep the original video and let the server convert only what cannot play");
+    m_remuxOnlyCell->setOn(settings->isRemuxOnlyEnabled());
+    m_remuxOnlyCell->getEvent()->subscribe([this, settings](bool on) {
+        settings->setRemuxOnly(on);
+        settings->writeFile();
+    });
+    container->addView(m_remuxOnlyCell);
+
     m_seekSelector = new brls::SelectorCell();
     m_seekSelector->title->setText("Seek Increment");
     m_seekSelector->setData({"5 seconds", "10 seconds", "15 seconds", "30 seconds", "45 seconds", "60 seconds"});
@@ -103,6 +145,26 @@ void SettingsTab::createPlaybackSection(brls::Box* container) {
         settings->writeFile();
     });
     container->addView(m_cacheSelector);
+
+    m_diskCacheSelector = new brls::SelectorCell();
+    m_diskCacheSelector->title->setText("SD Card Cache");
+    m_diskCacheSelector->detail->setText("Buffer to the SD card so rewinds stay off the network");
+    m_diskCacheSelector->setData({"Disabled", "512 MB", "1 GB", "2 GB", "4 GB"});
+
+    int diskIndex = 0;
+    int diskVal = settings->getDiskCache();
+    if (diskVal == 512) diskIndex = 1;
+    else if (diskVal == 1024) diskIndex = 2;
+    else if (diskVal == 2048) diskIndex = 3;
+    else if (diskVal == 4096) diskIndex = 4;
+    m_diskCacheSelector->setSelection(diskIndex);
+
+    m_diskCacheSelector->getEvent()->subscribe([this, settings](int selected) {
+        int values[] = {0, 512, 1024, 2048, 4096};
+        settings->setDiskCache(values[selected]);
+        settings->writeFile();
+    });
+    container->addView(m_diskCacheSelector);
 }
 
 void SettingsTab::createPowerUserSection(brls::Box* container) {
@@ -148,6 +210,52 @@ void SettingsTab::createPowerUserSection(brls::Box* container) {
     });
     m_powerUserSection->addView(m_bufferBeforePlayCell);
 
+    m_connectionsSelector = new brls::SelectorCell();
+    m_connectionsSelector->title->setText("Direct Play Connections");
+    m_connectionsSelector->detail->setText("Parallel range requests for high-bitrate files");
+    m_connectionsSelector->setData({"1 (Single Stream)", "2", "4", "6"});
+
+    int connIndex = 2;
+    int connVal = settings->getDirectPlayConnections();
+    if (connVal == 1) connIndex = 0;
+    else if (connVal == 2) connIndex = 1;
+    else if (connVal == 4) connIndex = 2;
+    else if (connVal == 6) connIndex = 3;
+    m_connectionsSelector->setSelection(connIndex);
+
+    m_connectionsSelector->getEvent()->subscribe([settings](int selected) {
+        int values[] = {1, 2, 4, 6};
+        settings->setDirectPlayConnections(values[selected]);
+        settings->writeFile();
+    });
+    m_powerUserSection->addView(m_connectionsSelector);
+
+    m_telemetryExportCell = new brls::BooleanCell();
+    m_telemetryExportCell->title->setText("Export Playback Telemetry");
+    m_telemetryExportCell->detail->setText("Save drop, sync and cache stats of each session to switch/saffron/telemetry");
+    m_telemetryExportCell->setOn(settings->isTelemetryExportEnabled());
+    m_telemetryExportCell->getEvent()->subscribe([settings](bool on) {
+        settings->setTelemetryExport(on);
+        settings->writeFile();
+    });
+    m_powerUserSection->addView(m_telemetryExportCell);
+
+    m_networkRecordingCell = new brls::BooleanCell();
+    m_networkRecordingCell->title->setText("Record Network Traffic");
+    m_networkRecordingCell->detail->setText("Save API and image responses to switch/saffron/recordings for replay on a PC");
+    m_networkRecordingCell->setOn(settings->isNetworkRecordingEnabled());
+    m_networkRecordingCell->getEvent()->subscribe([settings](bool on) {
+        settings->setNetworkRecording(on);
+        settings->writeFile();
+        // Turning it off writes out what was recorded so far
+        if (on) {
+            HttpRecorder::getInstance()->startRecordingSession();
+        } else {
+            brls::async([]() { HttpRecorder::getInstance()->stop(); });
+        }
+    });
+    m_powerUserSection->addView(m_networkRecordingCell);
+
     auto* mpvHeader = new brls::Header();
     mpvHeader->setTitle("Debugging MPV Options");
     mpvHeader->setFocusable(false);
@@ -183,6 +291,16 @@ void SettingsTab::createPowerUserSection(brls::Box* container) {
     });
     m_powerUserSection->addView(m_framebufferSelector);
 
+    m_pipelinedRenderCell = new brls::BooleanCell();
+    m_pipelinedRenderCell->title->setText("Pipelined Video Rendering");
+    m_pipelinedRenderCell->detail->setText("Turn off if video stutters or tears. Requires restart");
+    m_pipelinedRenderCell->setOn(settings->isPipelinedRenderEnabled());
+    m_pipelinedRenderCell->getEvent()->subscribe([settings](bool on) {
+        settings->setPipelinedRender(on);
+        settings->writeFile();
+    });
+    m_powerUserSection->addView(m_pipelinedRenderCell);
+
     updatePowerUserVisibility();
 }
 
@@ -7,6 +7,7 @@
 #include "view/recycling_grid.hpp"
 #include "view/cast_card_cell.hpp"
 #include "styles/plex.hpp"
+#include "util/log.hpp"
 
 ShowDetailView* ShowDetailView::s_instance = nullptr;
 
@@ -246,14 +247,23 @@ void ShowDetailView::updateUI() {
         m_taglineLabel->setVisibility(brls::Visibility::VISIBLE);
     }
 
-    m_summaryLabel->setText(m_show.summary);
+    // Shows opened from a grid are cards without summary or art; hold those
+    // until the full metadata arrives rather than show them blank
+    if (m_metadataLoaded || !m_show.summary.empty()) {
+        m_summaryLabel->setText(m_show.summary);
+    } else {
+        m_summaryLabel->setText("Loading...");
+    }
 
     if (!m_show.thumb.empty() && m_server) {
         std::string posterUrl = m_server->getTranscodePictureUrl(m_show.thumb, 200, 300);
         ImageLoader::load(m_posterImage, posterUrl);
     }
 
-    std::string artKey = m_show.art.empty() ? m_show.thumb : m_show.art;
+    std::string artKey = m_show.art;
+    if (artKey.empty() && m_metadataLoaded) {
+        artKey = m_show.thumb;
+    }
     if (!artKey.empty() && m_server) {
         std::string backdropUrl = m_server->getTranscodePictureUrl(artKey, 1280, 720);
         ImageLoader::load(m_backdropImage, backdropUrl);
@@ -306,11 +316,11 @@ void ShowDetailView::loadFullMetadata() {
             brls::Application::unblockInputs();
             if (!s_instance) return;
             if (s_instance->m_metadataRequestId != requestId) {
-                brls::Logger::debug("ShowDetailView: Stale metadata request #{} ignored", requestId);
+                LOGD("ShowDetailView: Stale metadata request #{} ignored", requestId);
                 return;
             }
             if (!s_instance->m_isVisible) {
-                brls::Logger::debug("ShowDetailView: View not visible, skipping updateUI");
+                LOGD("ShowDetailView: View not visible, skipping updateUI");
                 return;
             }
 
@@ -320,7 +330,10 @@ void ShowDetailView::loadFullMetadata() {
         },
         [requestId](const std::string& error) {
             brls::Application::unblockInputs();
-            brls::Logger::error("Failed to load show metadata: {}", error);
+            LOGE("Failed to load show metadata: {}", error);
+            if (s_instance && s_instance->m_metadataRequestId == requestId && s_instance->m_show.summary.empty()) {
+                s_instance->m_summaryLabel->setText("");
+            }
         }
     );
 }
@@ -336,11 +349,11 @@ void ShowDetailView::loadSeasons() {
         [requestId](std::vector<plex::MediaItem> seasons) {
             if (!s_instance) return;
             if (s_instance->m_seasonsRequestId != requestId) {
-                brls::Logger::debug("ShowDetailView: Stale seasons request #{} ignored", requestId);
+                LOGD("ShowDetailView: Stale seasons request #{} ignored", requestId);
                 return;
             }
             if (!s_instance->m_isVisible) {
-                brls::Logger::debug("ShowDetailView: View not visible, skipping season update");
+                LOGD("ShowDetailView: View not visible, skipping season update");
                 return;
             }
 
@@ -359,7 +372,7 @@ void ShowDetailView::loadSeasons() {
             brls::Application::giveFocus(s_instance->m_seasonButton);
         },
         [requestId](const std::string& error) {
-            brls::Logger::error("Failed to load seasons: {}", error);
+            LOGE("Failed to load seasons: {}", error);
             if (s_instance && s_instance->m_seasonsRequestId == requestId && s_instance->m_isVisible) {
                 s_instance->m_seasonButton->setText("Error");
             }
@@ -5,6 +5,7 @@
 #include "core/plex_server.hpp"
 #include "core/plex_api.hpp"
 #include "util/image_loader.hpp"
+#include "util/log.hpp"
 
 static const int PAGE_SIZE = 50;
 
@@ -268,7 +269,7 @@ void TagMediaView::loadMedia() {
         [this, requestId](const std::string& error) {
             if (!s_instance || requestId != m_requestId) return;
 
-            brls::Logger::error("Failed to load tag media: {}", error);
+            LOGE("Failed to load tag media: {}", error);
             m_spinnerContainer->setVisibility(brls::Visibility::GONE);
             m_isLoading = false;
 
@@ -305,10 +306,10 @@ RecyclingGridItem* TagMediaDataSource::cellForRow(RecyclingView* recycler, size_
 
     if (index < m_items.size()) {
         cell->setData(m_server, m_items[index]);
-        plex::MediaItem item = m_items[index];
+        EntityRef item = m_items[index];
         cell->setOnClick([this, item]() {
             if (m_onItemClick) {
-                m_onItemClick(item);
+                m_onItemClick(item->toMediaItem());
             }
         });
     }
@@ -318,7 +319,7 @@ RecyclingGridItem* TagMediaDataSource::cellForRow(RecyclingView* recycler, size_
 
 void TagMediaDataSource::onItemSelected(brls::Box* recycler, size_t index) {
     if (index < m_items.size() && m_onItemClick) {
-        m_onItemClick(m_items[index]);
+        m_onItemClick(m_items[index]->toMediaItem());
     }
 }
 
@@ -327,5 +328,6 @@ void TagMediaDataSource::clearData() {
 }
 
 void TagMediaDataSource::appendItems(const std::vector<plex::MediaItem>& items) {
-    m_items.insert(m_items.end(), items.begin(), items.end());
+    auto refs = EntityStore::getInstance()->mergeAll(items);
+    m_items.insert(m_items.end(), refs.begin(), refs.end());
 }
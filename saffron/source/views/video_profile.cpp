@@ -1,5 +1,6 @@
 #include "views/video_profile.hpp"
 #include "core/mpv_core.hpp"
+#include "util/startup_metrics.hpp"
 #include <fmt/format.h>
 
 VideoProfile::VideoProfile() {
@@ -63,4 +64,28 @@ void VideoProfile::update(const plex::Media* media) {
     labelAudioChannel->setText(std::to_string(mpv->getInt("audio-params/channel-count")));
 
     labelCache->setText(fmt::format("{:.1f}s", mpv->getDouble("demuxer-cache-duration")));
+
+    const auto& startup = StartupMetrics::getLast();
+    if (startup.valid) {
+        labelStartupTotal->setText(fmt::format("{} ms ({})", startup.totalMs, startup.directPlay ? "direct" : "HLS"));
+
+        // The quality menu waits on the user, so it is not part of the total
+        std::string stages;
+        for (int i = static_cast<int>(StartupMetrics::Stage::OptionsChecked);
+             i < static_cast<int>(StartupMetrics::Stage::Count); i++) {
+            if (startup.spanMs[i] < 0 || i == static_cast<int>(StartupMetrics::Stage::QualityChosen)) continue;
+            if (!stages.empty()) stages += ", ";
+            stages += fmt::format("{} {}", StartupMetrics::stageName(static_cast<StartupMetrics::Stage>(i)),
+                                  startup.spanMs[i]);
+        }
+        labelStartupStages->setText(stages);
+
+        auto summary = StartupMetrics::getSummary(startup.directPlay, startup.server);
+        labelStartupHistory->setText(fmt::format("p50 {} ms, p95 {} ms ({} runs)",
+                                                 summary.p50Ms, summary.p95Ms, summary.count));
+    } else {
+        labelStartupTotal->setText("N/A");
+        labelStartupStages->setText("N/A");
+        labelStartupHistory->setText("N/A");
+    }
 }
@@ -14,9 +14,9 @@ void VideoView::draw(NVGcontext* ctx, float x, float y, float width, float heigh
         brls::Rect rect = {x, y, width, height};
         mpv->draw(rect, m_alpha);
 
-        int64_t pos = mpv->getPosition();
-        int64_t dur = mpv->getDuration();
-        float progress = (dur > 0) ? static_cast<float>(pos) / static_cast<float>(dur) : 0.0f;
+        PlaybackSnapshot snapshot = mpv->getSnapshot();
+        float progress = (snapshot.duration > 0) ?
+            static_cast<float>(snapshot.position) / static_cast<float>(snapshot.duration) : 0.0f;
         if (progress > 1.0f) progress = 1.0f;
 
         nvgBeginPath(ctx);